@@ -0,0 +1,152 @@
+/*  KStars Testing - BinFileHelper
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#include "testbinfilehelper.h"
+
+#include <cmath>
+
+#include "HTMesh.h"
+#include "MeshIterator.h"
+#include "deepstarcomponent.h"
+#include "starblock.h"
+#include "starblockfactory.h"
+#include "starblocklist.h"
+#include "skyobjects/starobject.h"
+
+// Number of frames in the slew, and field of view during the slew
+#define SLEW_STEPS 200
+#define SLEW_RADIUS 3.0
+
+// Magnitude limit of the deep stars drawn at the wide fields of view
+// used while slewing
+#define SLEW_MAG_LIMIT 12.0
+
+TestBinFileHelper::TestBinFileHelper(): QObject(), component( 0 ), htmLevel( 0 )
+{
+}
+
+TestBinFileHelper::~TestBinFileHelper()
+{
+}
+
+void TestBinFileHelper::initTestCase()
+{
+    // The deep star catalogs are optional downloads
+    const char *catalogs[] = { "USNO-NOMAD-1e8.dat", "tycho2.dat", "deepstars.dat" };
+    QString catalog;
+    for( unsigned int i = 0; i < sizeof( catalogs ) / sizeof( catalogs[0] ); ++i ) {
+        if( BinFileHelper::testFileExists( catalogs[i] ) ) {
+            catalog = catalogs[i];
+            break;
+        }
+    }
+    if( catalog.isEmpty() )
+        QSKIP( "No deep star catalog installed" );
+
+    // The component opens and maps the catalog, and owns the reader
+    // that StarBlockList::fillToMag() loads the stars with
+    component = new DeepStarComponent( 0, catalog, SLEW_MAG_LIMIT );
+    QVERIFY( component->fileOpen() );
+
+    BinFileHelper reader;
+    QVERIFY( reader.openFile( catalog ) );
+    QVERIFY( reader.readHeader() );
+    qint16 faintmag;
+    quint8 level;
+    QVERIFY( fread( &faintmag, 2, 1, reader.getFileHandle() ) == 1 );
+    QVERIFY( fread( &level, 1, 1, reader.getFileHandle() ) == 1 );
+    htmLevel = level;
+
+    // A slew from the south celestial pole region up through the Milky
+    // Way in Sagittarius and Cygnus and on to Cassiopeia, as when
+    // dragging the map across the sky
+    for( int i = 0; i < SLEW_STEPS; ++i ) {
+        double t = double( i ) / ( SLEW_STEPS - 1 );
+        slewPath.append( qMakePair( fmod( 240.0 + 150.0 * t, 360.0 ), -70.0 + 130.0 * t ) );
+    }
+}
+
+void TestBinFileHelper::cleanupTestCase()
+{
+    delete component;
+}
+
+double TestBinFileHelper::replaySlew( bool mapped, bool withPositions )
+{
+    BinFileHelper *reader = component->getStarReader();
+    if( mapped )
+        reader->mapFile();
+    else
+        reader->unmapFile();
+
+    HTMesh mesh( htmLevel, htmLevel, 1 );
+    QVector<StarBlockList *> lists( mesh.size(), 0 );
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+    double checksum = 0;
+
+    for( int i = 0; i < slewPath.size(); ++i ) {
+        // A new draw cycle, blocks of trixels out of view may be recycled
+        ++factory->drawID;
+        mesh.intersect( slewPath[i].first, slewPath[i].second, SLEW_RADIUS );
+        MeshIterator region( &mesh );
+        while( region.hasNext() ) {
+            Trixel trixel = region.next();
+            if( !lists[trixel] )
+                lists[trixel] = new StarBlockList( trixel, component );
+            StarBlockList *list = lists[trixel];
+            list->fillToMag( SLEW_MAG_LIMIT );
+
+            if( !withPositions ) {
+                checksum += list->getStarCount();
+                continue;
+            }
+            for( int j = 0; j < list->getBlockCount(); ++j ) {
+                StarBlock *block = list->block( j );
+                for( int k = 0; k < block->getStarCount(); ++k )
+                    checksum += block->star( k )->ra0().Degrees();
+            }
+        }
+    }
+
+    // The blocks release themselves from their lists when deleted
+    factory->freeAll();
+    qDeleteAll( lists );
+    return checksum;
+}
+
+void TestBinFileHelper::testMappedRecords()
+{
+    // Both ways of reading the catalog must load the same stars
+    double mapped = replaySlew( true, true );
+    QVERIFY( component->getStarReader()->getRecords( 0 ) != 0 );
+    double read = replaySlew( false, true );
+    QVERIFY( component->getStarReader()->getRecords( 0 ) == 0 );
+    QVERIFY( mapped != 0 );
+    QCOMPARE( mapped, read );
+}
+
+void TestBinFileHelper::benchmarkSlewFill_data()
+{
+    QTest::addColumn<bool>( "mapped" );
+    QTest::newRow( "fread" ) << false;
+    QTest::newRow( "mmap" ) << true;
+}
+
+void TestBinFileHelper::benchmarkSlewFill()
+{
+    QFETCH( bool, mapped );
+
+    double checksum = 0;
+    QBENCHMARK {
+        checksum += replaySlew( mapped, false );
+    }
+    QVERIFY( checksum != 0 );
+}
+
+QTEST_GUILESS_MAIN(TestBinFileHelper)
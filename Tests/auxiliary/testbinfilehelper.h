@@ -0,0 +1,56 @@
+/*  KStars Testing - BinFileHelper
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#ifndef TESTBINFILEHELPER_H
+#define TESTBINFILEHELPER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+#include <QPair>
+#include <QVector>
+
+#include "auxiliary/binfilehelper.h"
+
+class DeepStarComponent;
+
+/**
+ * Replays a slew across the sky on the installed deep star catalog and
+ * measures how long StarBlockList::fillToMag() takes to load the stars
+ * of every trixel that comes into view, once with fseek/fread per record
+ * and once through the memory mapping.
+ */
+class TestBinFileHelper: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestBinFileHelper();
+  ~TestBinFileHelper();
+
+ private slots:
+   void initTestCase();
+   void cleanupTestCase();
+   void testMappedRecords();
+   void benchmarkSlewFill_data();
+   void benchmarkSlewFill();
+
+ private:
+   /**
+    * Fill the StarBlockLists of every trixel along the slew path, as the
+    * sky map does while drawing. Returns a checksum of the loaded stars,
+    * from their positions if withPositions is true, else from their count.
+    */
+   double replaySlew( bool mapped, bool withPositions );
+
+   DeepStarComponent *component;
+   int htmLevel;
+   QVector< QPair<double, double> > slewPath;
+};
+
+#endif
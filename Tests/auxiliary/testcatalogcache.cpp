@@ -0,0 +1,387 @@
+/*  KStars Testing - KSCatalogCache
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#include "testcatalogcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include "auxiliary/kspaths.h"
+
+namespace {
+
+struct MixedRow {
+    KSStreamParser::Field text1, text2;
+    int number;
+    KSStreamParser::Field quoted;
+    float real;
+    double precise;
+    KSStreamParser::Field text3;
+};
+
+const KSStreamParser::Column<MixedRow> mixedColumns[] = {
+    KSStreamParser::column(&MixedRow::text1, 5),
+    KSStreamParser::column(&MixedRow::text2, 6),
+    KSStreamParser::column(&MixedRow::number, 4),
+    KSStreamParser::column(&MixedRow::quoted, 10),
+    KSStreamParser::column(&MixedRow::real, 7),
+    KSStreamParser::column(&MixedRow::precise, 19),
+    KSStreamParser::skip<MixedRow>(3),
+    KSStreamParser::column(&MixedRow::text3)
+};
+
+/** The same file read with one column less */
+const KSStreamParser::Column<MixedRow> fewerColumns[] = {
+    KSStreamParser::column(&MixedRow::text1),
+    KSStreamParser::column(&MixedRow::text2),
+    KSStreamParser::column(&MixedRow::number),
+    KSStreamParser::column(&MixedRow::quoted),
+    KSStreamParser::column(&MixedRow::real),
+    KSStreamParser::skip<MixedRow>(),
+    KSStreamParser::skip<MixedRow>(),
+    KSStreamParser::column(&MixedRow::text3)
+};
+
+/** The rows of ngcic.dat and comets.dat */
+struct NGCICRow {
+    KSStreamParser::Field flag;
+    int id;
+    KSStreamParser::Field suffix;
+    int raH, raM;
+    float raS;
+    KSStreamParser::Field decSign;
+    int decD, decM, decS;
+    KSStreamParser::Field bMag;
+    int type;
+    float a, b;
+    KSStreamParser::Field pa;
+    int pgc;
+    KSStreamParser::Field otherCatalog, other1, other2, messier;
+    int messierNumber;
+    KSStreamParser::Field longName;
+};
+
+const KSStreamParser::Column<NGCICRow> ngcicColumns[] = {
+    KSStreamParser::column(&NGCICRow::flag, 1),
+    KSStreamParser::column(&NGCICRow::id, 4),
+    KSStreamParser::column(&NGCICRow::suffix, 1),
+    KSStreamParser::column(&NGCICRow::raH, 2),
+    KSStreamParser::column(&NGCICRow::raM, 2),
+    KSStreamParser::column(&NGCICRow::raS, 4),
+    KSStreamParser::column(&NGCICRow::decSign, 2),
+    KSStreamParser::column(&NGCICRow::decD, 2),
+    KSStreamParser::column(&NGCICRow::decM, 2),
+    KSStreamParser::column(&NGCICRow::decS, 2),
+    KSStreamParser::column(&NGCICRow::bMag, 6),
+    KSStreamParser::column(&NGCICRow::type, 2),
+    KSStreamParser::column(&NGCICRow::a, 6),
+    KSStreamParser::column(&NGCICRow::b, 6),
+    KSStreamParser::column(&NGCICRow::pa, 4),
+    KSStreamParser::column(&NGCICRow::pgc, 7),
+    KSStreamParser::column(&NGCICRow::otherCatalog, 4),
+    KSStreamParser::column(&NGCICRow::other1, 6),
+    KSStreamParser::column(&NGCICRow::other2, 6),
+    KSStreamParser::column(&NGCICRow::messier, 2),
+    KSStreamParser::column(&NGCICRow::messierNumber, 4),
+    KSStreamParser::column(&NGCICRow::longName)
+};
+
+struct CometRow {
+    KSStreamParser::Field name;
+    int epoch;
+    double q, e, i, w, om, tp;
+    KSStreamParser::Field orbitID, neo;
+    float M1, M2, diameter;
+    KSStreamParser::Field extent;
+    float albedo, rotPeriod, period;
+    double moid;
+    KSStreamParser::Field orbitClass;
+    float K1, K2;
+};
+
+const KSStreamParser::Column<CometRow> cometColumns[] = {
+    KSStreamParser::column(&CometRow::name),
+    KSStreamParser::column(&CometRow::epoch),
+    KSStreamParser::column(&CometRow::q),
+    KSStreamParser::column(&CometRow::e),
+    KSStreamParser::column(&CometRow::i),
+    KSStreamParser::column(&CometRow::w),
+    KSStreamParser::column(&CometRow::om),
+    KSStreamParser::column(&CometRow::tp),
+    KSStreamParser::column(&CometRow::orbitID),
+    KSStreamParser::column(&CometRow::neo),
+    KSStreamParser::column(&CometRow::M1),
+    KSStreamParser::column(&CometRow::M2),
+    KSStreamParser::column(&CometRow::diameter),
+    KSStreamParser::column(&CometRow::extent),
+    KSStreamParser::column(&CometRow::albedo),
+    KSStreamParser::column(&CometRow::rotPeriod),
+    KSStreamParser::column(&CometRow::period),
+    KSStreamParser::column(&CometRow::moid),
+    KSStreamParser::column(&CometRow::orbitClass),
+    KSStreamParser::column(&CometRow::K1),
+    KSStreamParser::column(&CometRow::K2)
+};
+
+const QStringList csvLines = QStringList()
+    << "# comment line,with,commas,,,,,\n"
+    << "alpha,beta,42,\"a, quoted, field\",3.25,2.557665961167666,x,last\n"
+    << ",,,\"\",,,,\n"
+    << "too,few,fields\n"
+    << "gamma, delta , -7 ,\"it's \"\"quoted\"\"\",.0758,1e-5,y,  spaced  \n"
+    << "\xc3\xa9t\xc3\xa9,\xc3\xbc,0,\"\xc3\xa0 la,carte\",-0.5,123456789012345678,s,fin\n";
+
+/** Check that the rows of the cache are those of the text */
+void compareRows(const QVector<MixedRow> &cached, const QVector<MixedRow> &parsed)
+{
+    QCOMPARE(cached.size(), parsed.size());
+    for (int i = 0; i < parsed.size(); i++)
+    {
+        const MixedRow &row = cached.at(i), &expected = parsed.at(i);
+        QCOMPARE(row.text1.toString(), expected.text1.toString());
+        QCOMPARE(row.text2.toString(), expected.text2.toString());
+        QCOMPARE(row.number, expected.number);
+        QCOMPARE(row.quoted.toString(), expected.quoted.toString());
+        QCOMPARE(row.real, expected.real);
+        QCOMPARE(row.precise, expected.precise);
+        QCOMPARE(row.text3.toString(), expected.text3.toString());
+    }
+}
+
+}
+
+TestCatalogCache::TestCatalogCache(): QObject()
+{
+}
+
+TestCatalogCache::~TestCatalogCache()
+{
+}
+
+void TestCatalogCache::initTestCase()
+{
+    // Keep the cache files of the tests out of the user's cache
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_Dir.isValid());
+}
+
+void TestCatalogCache::cleanupTestCase()
+{
+    foreach (const QFileInfo &file, QDir(m_Dir.path()).entryInfoList(QDir::Files))
+        KSCatalogCache::remove(file.filePath());
+}
+
+QString TestCatalogCache::writeFile(const QString &name, const QStringList &lines)
+{
+    QString fileName = m_Dir.path() + '/' + name;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return QString();
+    foreach (const QString &line, lines)
+        file.write(line.toUtf8());
+    file.close();
+    return fileName;
+}
+
+void TestCatalogCache::testCSV()
+{
+    QString fileName = writeFile("cache_csv.dat", csvLines);
+    QVERIFY(!fileName.isEmpty());
+    KSCatalogCache::remove(fileName);
+
+    KSStreamParser parser(fileName, '#');
+    QVector<MixedRow> parsed = parser.readAllCSV(mixedColumns);
+    QCOMPARE(parsed.size(), 4);
+
+    // The first load parses the text and writes the cache
+    {
+        KSCatalogCache catalog(fileName, '#');
+        QVector<MixedRow> rows = catalog.readAllCSV(mixedColumns);
+        QVERIFY(!catalog.isCached());
+        compareRows(rows, parsed);
+    }
+    QVERIFY(QFile::exists(KSCatalogCache::cacheFileName(fileName)));
+
+    // The second one reads the cache
+    KSCatalogCache catalog(fileName, '#');
+    QVector<MixedRow> rows = catalog.readAllCSV(mixedColumns);
+    QVERIFY(catalog.isCached());
+    compareRows(rows, parsed);
+    QCOMPARE(rows[3].quoted.toString(), QString::fromUtf8("\xc3\xa0 la,carte"));
+
+    // The cache file is readable as any other binary data file
+    BinFileHelper helper;
+    QVERIFY(helper.openFile(KSCatalogCache::cacheFileName(fileName)) != NULL);
+    QVERIFY(helper.readHeader());
+    QCOMPARE(int(helper.getVersion()), int(KSCatalogCache::FORMAT_VERSION));
+    QVERIFY(helper.getHeaderText().contains("cache_csv.dat"));
+    QCOMPARE(helper.getFieldCount(), 7);
+    QCOMPARE(int(helper.getRecordCount(0)), 4);
+    helper.closeFile();
+}
+
+void TestCatalogCache::testFixedWidth()
+{
+    QStringList lines;
+    lines << "# comment\n"
+          << "alphabeta    42a quoted     3.25  2.557665961167666x  last one\n"
+          << "short line\n"
+          << "gam  delta   -7            .0758               1e-5y  \r\n"
+          << "bad  nums   12ax         x.5                    --1s  \xc3\xa9t\xc3\xa9\n";
+    QString fileName = writeFile("cache_fixed.dat", lines);
+    QVERIFY(!fileName.isEmpty());
+    KSCatalogCache::remove(fileName);
+
+    KSStreamParser parser(fileName, '#');
+    QVector<MixedRow> parsed = parser.readAllFixedWidth(mixedColumns);
+    QCOMPARE(parsed.size(), 3);
+
+    KSCatalogCache(fileName, '#').readAllFixedWidth(mixedColumns);
+    KSCatalogCache catalog(fileName, '#');
+    QVector<MixedRow> rows = catalog.readAllFixedWidth(mixedColumns);
+    QVERIFY(catalog.isCached());
+    compareRows(rows, parsed);
+    QCOMPARE(rows[2].text3.toString(), QString::fromUtf8("\xc3\xa9t\xc3\xa9"));
+}
+
+void TestCatalogCache::testSourceChanged()
+{
+    QString fileName = writeFile("cache_changed.dat", csvLines);
+    QVERIFY(!fileName.isEmpty());
+    KSCatalogCache::remove(fileName);
+    KSCatalogCache(fileName, '#').readAllCSV(mixedColumns);
+
+    // Same size, different contents
+    QStringList lines = csvLines;
+    lines[1].replace("42", "43");
+    writeFile("cache_changed.dat", lines);
+
+    KSCatalogCache catalog(fileName, '#');
+    QVector<MixedRow> rows = catalog.readAllCSV(mixedColumns);
+    QVERIFY(!catalog.isCached());
+    QCOMPARE(rows[0].number, 43);
+
+    KSCatalogCache reloaded(fileName, '#');
+    rows = reloaded.readAllCSV(mixedColumns);
+    QVERIFY(reloaded.isCached());
+    QCOMPARE(rows[0].number, 43);
+}
+
+void TestCatalogCache::testLayoutChanged()
+{
+    QString fileName = writeFile("cache_layout.dat", csvLines);
+    QVERIFY(!fileName.isEmpty());
+    KSCatalogCache::remove(fileName);
+    KSCatalogCache(fileName, '#').readAllCSV(mixedColumns);
+
+    KSCatalogCache catalog(fileName, '#');
+    QVector<MixedRow> rows = catalog.readAllCSV(fewerColumns);
+    QVERIFY(!catalog.isCached());
+    QCOMPARE(rows.size(), 4);
+    QCOMPARE(rows[0].precise, 0.0);
+
+    KSCatalogCache reloaded(fileName, '#');
+    rows = reloaded.readAllCSV(mixedColumns);
+    QVERIFY(!reloaded.isCached());
+    QCOMPARE(rows[0].precise, 2.557665961167666);
+}
+
+void TestCatalogCache::testBrokenCache()
+{
+    QString fileName = writeFile("cache_broken.dat", csvLines);
+    QVERIFY(!fileName.isEmpty());
+    KSCatalogCache::remove(fileName);
+    KSCatalogCache(fileName, '#').readAllCSV(mixedColumns);
+
+    // Cut off the string area
+    QString cacheName = KSCatalogCache::cacheFileName(fileName);
+    QFile cache(cacheName);
+    QVERIFY(cache.open(QIODevice::ReadWrite));
+    QVERIFY(cache.resize(cache.size() - 10));
+    cache.close();
+
+    KSCatalogCache truncated(fileName, '#');
+    QVector<MixedRow> rows = truncated.readAllCSV(mixedColumns);
+    QVERIFY(!truncated.isCached());
+    QCOMPARE(rows.size(), 4);
+    QCOMPARE(rows[3].text3.toString(), QString("fin"));
+
+    // Not a cache file at all
+    QVERIFY(cache.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    cache.write("garbage");
+    cache.close();
+
+    KSCatalogCache garbage(fileName, '#');
+    rows = garbage.readAllCSV(mixedColumns);
+    QVERIFY(!garbage.isCached());
+    QCOMPARE(rows.size(), 4);
+}
+
+void TestCatalogCache::testMissingFile()
+{
+    KSCatalogCache catalog("/this/file/does/not/exist.dat", '#');
+    QVERIFY(catalog.readAllCSV(mixedColumns).isEmpty());
+    QVERIFY(!catalog.isCached());
+    QVERIFY(!QFile::exists(KSCatalogCache::cacheFileName("/this/file/does/not/exist.dat")));
+}
+
+void TestCatalogCache::benchmarkDataFiles_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("cached");
+
+    const char *files[] = { "ngcic.dat", "comets.dat" };
+    for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        QString fileName(files[i]);
+        QTest::newRow(QString("%1 text").arg(fileName).toLatin1().constData()) << fileName << false;
+        QTest::newRow(QString("%1 cache").arg(fileName).toLatin1().constData()) << fileName << true;
+    }
+}
+
+void TestCatalogCache::benchmarkDataFiles()
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, cached);
+
+    QString path = KSPaths::locate(QStandardPaths::GenericDataLocation, fileName);
+    if (path.isEmpty())
+        QSKIP("The data file is not installed");
+
+    // Build the cache before measuring
+    KSCatalogCache::remove(path);
+    bool ngcic = (fileName == "ngcic.dat");
+    if (cached)
+    {
+        if (ngcic)
+            KSCatalogCache(path, '#').readAllFixedWidth(ngcicColumns);
+        else
+            KSCatalogCache(path, '#').readAllCSV(cometColumns);
+    }
+
+    int rows = 0;
+    QBENCHMARK
+    {
+        if (cached)
+        {
+            KSCatalogCache catalog(path, '#');
+            rows = ngcic ? catalog.readAllFixedWidth(ngcicColumns).size() : catalog.readAllCSV(cometColumns).size();
+            QVERIFY(catalog.isCached());
+        }
+        else
+        {
+            KSStreamParser parser(path, '#');
+            rows = ngcic ? parser.readAllFixedWidth(ngcicColumns).size() : parser.readAllCSV(cometColumns).size();
+        }
+    }
+    QVERIFY(rows > 0);
+    KSCatalogCache::remove(path);
+}
+
+QTEST_GUILESS_MAIN(TestCatalogCache)
@@ -0,0 +1,52 @@
+/*  KStars Testing - KSCatalogCache
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#ifndef TESTCATALOGCACHE_H
+#define TESTCATALOGCACHE_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+#include <QTemporaryDir>
+
+#include "kscatalogcache.h"
+
+/**
+ * Checks that rows read back from the binary catalog cache are the rows
+ * KSStreamParser reads from the text, that the cache is rebuilt when the
+ * text or the row layout change, and measures how much faster the data
+ * files load from the cache.
+ */
+class TestCatalogCache: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestCatalogCache();
+  ~TestCatalogCache();
+
+ private slots:
+   void initTestCase();
+   void cleanupTestCase();
+   void testCSV();
+   void testFixedWidth();
+   void testSourceChanged();
+   void testLayoutChanged();
+   void testBrokenCache();
+   void testMissingFile();
+   void benchmarkDataFiles_data();
+   void benchmarkDataFiles();
+
+ private:
+   /** Write the given lines to the named file in the temporary directory, returns its path */
+   QString writeFile(const QString &name, const QStringList &lines);
+
+   QTemporaryDir m_Dir;
+};
+
+#endif
@@ -0,0 +1,436 @@
+/*  KStars Testing - KSStreamParser
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#include "teststreamparser.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#include "auxiliary/kspaths.h"
+
+namespace {
+
+/** A row of the CSV test file, with all types of fields */
+struct MixedRow {
+    KSStreamParser::Field text1, text2;
+    int number;
+    KSStreamParser::Field quoted;
+    float real;
+    double precise;
+    KSStreamParser::Field text3;
+};
+
+const KSStreamParser::Column<MixedRow> mixedColumns[] = {
+    KSStreamParser::column(&MixedRow::text1, 5),
+    KSStreamParser::column(&MixedRow::text2, 6),
+    KSStreamParser::column(&MixedRow::number, 4),
+    KSStreamParser::column(&MixedRow::quoted, 10),
+    KSStreamParser::column(&MixedRow::real, 7),
+    KSStreamParser::column(&MixedRow::precise, 19),
+    KSStreamParser::skip<MixedRow>(3),
+    KSStreamParser::column(&MixedRow::text3)
+};
+
+/** The rows of ngcic.dat, asteroids.dat and comets.dat, as loaded by KStars */
+struct NGCICRow {
+    KSStreamParser::Field flag;
+    int id;
+    KSStreamParser::Field suffix;
+    int raH, raM;
+    float raS;
+    KSStreamParser::Field decSign;
+    int decD, decM, decS;
+    KSStreamParser::Field bMag;
+    int type;
+    float a, b;
+    KSStreamParser::Field pa;
+    int pgc;
+    KSStreamParser::Field otherCatalog, other1, other2, messier;
+    int messierNumber;
+    KSStreamParser::Field longName;
+};
+
+const KSStreamParser::Column<NGCICRow> ngcicColumns[] = {
+    KSStreamParser::column(&NGCICRow::flag, 1),
+    KSStreamParser::column(&NGCICRow::id, 4),
+    KSStreamParser::column(&NGCICRow::suffix, 1),
+    KSStreamParser::column(&NGCICRow::raH, 2),
+    KSStreamParser::column(&NGCICRow::raM, 2),
+    KSStreamParser::column(&NGCICRow::raS, 4),
+    KSStreamParser::column(&NGCICRow::decSign, 2),
+    KSStreamParser::column(&NGCICRow::decD, 2),
+    KSStreamParser::column(&NGCICRow::decM, 2),
+    KSStreamParser::column(&NGCICRow::decS, 2),
+    KSStreamParser::column(&NGCICRow::bMag, 6),
+    KSStreamParser::column(&NGCICRow::type, 2),
+    KSStreamParser::column(&NGCICRow::a, 6),
+    KSStreamParser::column(&NGCICRow::b, 6),
+    KSStreamParser::column(&NGCICRow::pa, 4),
+    KSStreamParser::column(&NGCICRow::pgc, 7),
+    KSStreamParser::column(&NGCICRow::otherCatalog, 4),
+    KSStreamParser::column(&NGCICRow::other1, 6),
+    KSStreamParser::column(&NGCICRow::other2, 6),
+    KSStreamParser::column(&NGCICRow::messier, 2),
+    KSStreamParser::column(&NGCICRow::messierNumber, 4),
+    KSStreamParser::column(&NGCICRow::longName)
+};
+
+struct OrbitRow {
+    KSStreamParser::Field name;
+    int epoch;
+    double q, a, e, i, w, om, ma, tp;
+    KSStreamParser::Field orbitID;
+    double H, G;
+    KSStreamParser::Field neo;
+    float M1, M2, diameter;
+    KSStreamParser::Field extent;
+    float albedo, rotPeriod, period;
+    double moid;
+    KSStreamParser::Field orbitClass;
+    float K1, K2;
+};
+
+const KSStreamParser::Column<OrbitRow> asteroidColumns[] = {
+    KSStreamParser::column(&OrbitRow::name),
+    KSStreamParser::column(&OrbitRow::epoch),
+    KSStreamParser::column(&OrbitRow::q),
+    KSStreamParser::column(&OrbitRow::a),
+    KSStreamParser::column(&OrbitRow::e),
+    KSStreamParser::column(&OrbitRow::i),
+    KSStreamParser::column(&OrbitRow::w),
+    KSStreamParser::column(&OrbitRow::om),
+    KSStreamParser::column(&OrbitRow::ma),
+    KSStreamParser::skip<OrbitRow>(),
+    KSStreamParser::column(&OrbitRow::orbitID),
+    KSStreamParser::column(&OrbitRow::H),
+    KSStreamParser::column(&OrbitRow::G),
+    KSStreamParser::column(&OrbitRow::neo),
+    KSStreamParser::skip<OrbitRow>(),
+    KSStreamParser::skip<OrbitRow>(),
+    KSStreamParser::column(&OrbitRow::diameter),
+    KSStreamParser::column(&OrbitRow::extent),
+    KSStreamParser::column(&OrbitRow::albedo),
+    KSStreamParser::column(&OrbitRow::rotPeriod),
+    KSStreamParser::column(&OrbitRow::period),
+    KSStreamParser::column(&OrbitRow::moid),
+    KSStreamParser::column(&OrbitRow::orbitClass)
+};
+
+const KSStreamParser::Column<OrbitRow> cometColumns[] = {
+    KSStreamParser::column(&OrbitRow::name),
+    KSStreamParser::column(&OrbitRow::epoch),
+    KSStreamParser::column(&OrbitRow::q),
+    KSStreamParser::column(&OrbitRow::e),
+    KSStreamParser::column(&OrbitRow::i),
+    KSStreamParser::column(&OrbitRow::w),
+    KSStreamParser::column(&OrbitRow::om),
+    KSStreamParser::column(&OrbitRow::tp),
+    KSStreamParser::column(&OrbitRow::orbitID),
+    KSStreamParser::column(&OrbitRow::neo),
+    KSStreamParser::column(&OrbitRow::M1),
+    KSStreamParser::column(&OrbitRow::M2),
+    KSStreamParser::column(&OrbitRow::diameter),
+    KSStreamParser::column(&OrbitRow::extent),
+    KSStreamParser::column(&OrbitRow::albedo),
+    KSStreamParser::column(&OrbitRow::rotPeriod),
+    KSStreamParser::column(&OrbitRow::period),
+    KSStreamParser::column(&OrbitRow::moid),
+    KSStreamParser::column(&OrbitRow::orbitClass),
+    KSStreamParser::column(&OrbitRow::K1),
+    KSStreamParser::column(&OrbitRow::K2)
+};
+
+enum ParserKind { LEGACY, STREAM, STREAM_PARALLEL };
+
+/** A KSParser reading the same fields as columns */
+template <typename Record, int N>
+KSParser *legacyParser(const QString &fileName, const KSStreamParser::Column<Record> (&columns)[N], bool fixedWidth)
+{
+    QList< QPair<QString, KSParser::DataTypes> > sequence;
+    QList<int> widths;
+    for (int i = 0; i < N; i++)
+    {
+        sequence.append(qMakePair(QString::number(i), columns[i].type));
+        if (i < N - 1)
+            widths.append(columns[i].width);
+    }
+    if (fixedWidth)
+        return new KSParser(fileName, '#', sequence, widths);
+    return new KSParser(fileName, '#', sequence);
+}
+
+/** Parse the given file with one of the parsers, returns the number of rows */
+template <typename Record, int N>
+int parseFile(const QString &fileName, const KSStreamParser::Column<Record> (&columns)[N], bool fixedWidth, ParserKind kind)
+{
+    int rows = 0;
+    if (kind == LEGACY)
+    {
+        KSParser *parser = legacyParser(fileName, columns, fixedWidth);
+        while (parser->HasNextRow())
+        {
+            QHash<QString, QVariant> row = parser->ReadNextRow();
+            rows += row.size() > 0;
+        }
+        delete parser;
+    }
+    else
+    {
+        KSStreamParser parser(fileName, '#');
+        if (kind == STREAM_PARALLEL)
+            rows = fixedWidth ? parser.readAllFixedWidth(columns).size() : parser.readAllCSV(columns).size();
+        else if (fixedWidth)
+            parser.readFixedWidth(columns, [&rows](const Record &) { rows++; });
+        else
+            parser.readCSV(columns, [&rows](const Record &) { rows++; });
+    }
+    return rows;
+}
+
+/** Check that both parsers read the same rows from the file */
+template <int N>
+void compareWithKSParser(const QString &fileName, const KSStreamParser::Column<MixedRow> (&columns)[N], bool fixedWidth, int expectedRows)
+{
+    QList< QHash<QString, QVariant> > legacyRows;
+    KSParser *legacy = legacyParser(fileName, columns, fixedWidth);
+    while (legacy->HasNextRow())
+        legacyRows.append(legacy->ReadNextRow());
+    delete legacy;
+
+    KSStreamParser parser(fileName, '#');
+    QVERIFY(parser.isOpen());
+    QVector<MixedRow> rows = fixedWidth ? parser.readAllFixedWidth(columns) : parser.readAllCSV(columns);
+
+    QCOMPARE(rows.size(), expectedRows);
+    QCOMPARE(legacyRows.size(), expectedRows);
+    for (int i = 0; i < rows.size(); i++)
+    {
+        const MixedRow &row = rows.at(i);
+        const QHash<QString, QVariant> &legacyRow = legacyRows.at(i);
+        QCOMPARE(row.text1.toString(), legacyRow["0"].toString());
+        QCOMPARE(row.text2.toString(), legacyRow["1"].toString());
+        QCOMPARE(row.number, legacyRow["2"].toInt());
+        QCOMPARE(row.quoted.toString(), legacyRow["3"].toString());
+        QCOMPARE(row.real, legacyRow["4"].toFloat());
+        QCOMPARE(row.precise, legacyRow["5"].toDouble());
+        QCOMPARE(row.text3.toString(), legacyRow["7"].toString());
+    }
+}
+
+}
+
+TestStreamParser::TestStreamParser(): QObject()
+{
+}
+
+TestStreamParser::~TestStreamParser()
+{
+}
+
+void TestStreamParser::initTestCase()
+{
+}
+
+void TestStreamParser::cleanupTestCase()
+{
+    foreach (const QString &fileName, m_Files)
+        QFile::remove(fileName);
+}
+
+QString TestStreamParser::writeFile(const QStringList &lines)
+{
+    QTemporaryFile file;
+    file.setAutoRemove(false);
+    if (!file.open())
+        return QString();
+    foreach (const QString &line, lines)
+        file.write(line.toUtf8());
+    file.close();
+    m_Files.append(file.fileName());
+    return file.fileName();
+}
+
+void TestStreamParser::testCSV()
+{
+    QStringList lines;
+    lines << "# comment line,with,commas,,,,,\n"
+          << "\n"
+          << "alpha,beta,42,\"a, quoted, field\",3.25,2.557665961167666,x,last\n"
+          << ",,,\"\",,,,\n"
+          << "too,few,fields\n"
+          << "gamma, delta , -7 ,\"it's \"\"quoted\"\"\",.0758,1e-5,y,  spaced  \n"
+          << "crlf,line,1,\"q\",1.5,2.5,z,end\r\n"
+          << "bad,nums,12a,\"q\",x.5,--1,s,t\n"
+          << "too,many,fields,in,this,row,for,the,schema\n"
+          << "\xc3\xa9t\xc3\xa9,\xc3\xbc,0,\"\xc3\xa0 la,carte\",-0.5,123456789012345678,s,fin\n";
+    QString fileName = writeFile(lines);
+    QVERIFY(!fileName.isEmpty());
+
+    compareWithKSParser(fileName, mixedColumns, false, 6);
+
+    KSStreamParser parser(fileName, '#');
+    QVector<MixedRow> rows = parser.readAllCSV(mixedColumns);
+    QCOMPARE(rows.size(), 6);
+    QCOMPARE(rows[0].quoted.toString(), QString("a, quoted, field"));
+    QCOMPARE(rows[0].precise, 2.557665961167666);
+    QCOMPARE(rows[2].text2.toString(), QString(" delta "));
+    QCOMPARE(rows[2].number, -7);
+    QCOMPARE(rows[3].text3.toString(), QString("end"));
+    QCOMPARE(rows[4].number, 0);
+    QCOMPARE(rows[5].text1.toString(), QString::fromUtf8("\xc3\xa9t\xc3\xa9"));
+    QCOMPARE(rows[5].quoted.toString(), QString::fromUtf8("\xc3\xa0 la,carte"));
+}
+
+void TestStreamParser::testFixedWidth()
+{
+    // Widths 5, 6, 4, 10, 7, 19, 3, and the rest of the line
+    QStringList lines;
+    lines << "# comment\n"
+          << "alphabeta    42a quoted     3.25  2.557665961167666x  last one\n"
+          << "short line\n"
+          << "                                                        \n"
+          << "gam  delta   -7            .0758               1e-5y  \r\n"
+          << "bad  nums   12ax         x.5                    --1s  \xc3\xa9t\xc3\xa9\n";
+    QString fileName = writeFile(lines);
+    QVERIFY(!fileName.isEmpty());
+
+    compareWithKSParser(fileName, mixedColumns, true, 4);
+
+    KSStreamParser parser(fileName, '#');
+    QVector<MixedRow> rows = parser.readAllFixedWidth(mixedColumns);
+    QCOMPARE(rows.size(), 4);
+    QCOMPARE(rows[0].text1.toString(), QString("alpha"));
+    QCOMPARE(rows[0].text2.toString(), QString("beta"));
+    QCOMPARE(rows[0].number, 42);
+    QCOMPARE(rows[0].quoted.toString(), QString("a quoted"));
+    QCOMPARE(rows[0].text3.toString(), QString("last one"));
+    QVERIFY(rows[1].text1.isEmpty());
+    QCOMPARE(rows[2].number, -7);
+    QCOMPARE(rows[3].text3.toString(), QString::fromUtf8("\xc3\xa9t\xc3\xa9"));
+}
+
+void TestStreamParser::testNumbers()
+{
+    const char *numbers[] = { "0", "1", "-2.5", "+3", ".0758", "9.", "1e5", "1E-5", "  3.14  ", "0.1",
+                              "2.557665961167666", "20130916.6150519", "0.30000000000000004",
+                              "123456789012345678", "1e400", "5e-324", "-0", "inf", "nan",
+                              "", " ", "abc", "1.2.3", "12a", "e5", "1e", "2147483647", "2147483648",
+                              "-2147483648", "15.0" };
+    for (unsigned int i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+    {
+        const char *number = numbers[i];
+        KSStreamParser::Field field(number, number + strlen(number));
+        QString string = QString::fromLatin1(number).trimmed();
+
+        bool ok, expectedOk;
+        double value = field.toDouble(&ok);
+        double expected = string.toDouble(&expectedOk);
+        QCOMPARE(ok, expectedOk);
+        if (expectedOk && !qIsNaN(expected))
+            QCOMPARE(memcmp(&value, &expected, sizeof(double)), 0);
+        else if (!expectedOk)
+            QCOMPARE(value, KSParser::EBROKEN_DOUBLE);
+
+        int integer = field.toInt(&ok);
+        int expectedInteger = string.toInt(&expectedOk);
+        QCOMPARE(ok, expectedOk);
+        QCOMPARE(integer, expectedInteger);
+    }
+
+    // Random decimals, as written by the catalog tools
+    qsrand(42);
+    for (int i = 0; i < 100000; i++)
+    {
+        double x = (qrand() / double(RAND_MAX) - 0.5) * pow(10.0, qrand() % 12 - 4);
+        QByteArray text = QByteArray::number(x, 'f', qrand() % 16);
+        KSStreamParser::Field field(text.constData(), text.constData() + text.size());
+        QCOMPARE(field.toDouble(), QString(text).toDouble());
+    }
+}
+
+void TestStreamParser::testParallel()
+{
+    // Large enough to be split over several threads
+    QStringList lines;
+    for (int i = 0; i < 100000; i++)
+        lines << QString("name%1,x,%1,\"q, %1\",%2,%3,s,t%1\n").arg(i).arg(i * 0.25).arg(i * 1e-3, 0, 'g', 12);
+    QString fileName = writeFile(lines);
+    QVERIFY(!fileName.isEmpty());
+
+    KSStreamParser parser(fileName, '#');
+    QVector<MixedRow> serial;
+    QCOMPARE(parser.readCSV(mixedColumns, [&serial](const MixedRow &row) { serial.append(row); }), lines.size());
+    QVector<MixedRow> parallel = parser.readAllCSV(mixedColumns);
+
+    QCOMPARE(parallel.size(), serial.size());
+    for (int i = 0; i < serial.size(); i++)
+    {
+        QCOMPARE(parallel[i].number, i);
+        QCOMPARE(parallel[i].number, serial[i].number);
+        QVERIFY(parallel[i].text1.begin() == serial[i].text1.begin());
+        QCOMPARE(parallel[i].real, serial[i].real);
+        QCOMPARE(parallel[i].precise, serial[i].precise);
+    }
+}
+
+void TestStreamParser::testMissingFile()
+{
+    KSStreamParser parser("/this/file/does/not/exist.dat", '#');
+    QVERIFY(!parser.isOpen());
+    QCOMPARE(parser.readCSV(mixedColumns, [](const MixedRow &) {}), 0);
+    QVERIFY(parser.readAllFixedWidth(mixedColumns).isEmpty());
+}
+
+void TestStreamParser::benchmarkDataFiles_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<int>("kind");
+
+    const char *files[] = { "ngcic.dat", "asteroids.dat", "comets.dat" };
+    for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        QString fileName(files[i]);
+        QTest::newRow(QString("%1 KSParser").arg(fileName).toLatin1().constData()) << fileName << int(LEGACY);
+        QTest::newRow(QString("%1 KSStreamParser").arg(fileName).toLatin1().constData()) << fileName << int(STREAM);
+        QTest::newRow(QString("%1 KSStreamParser, threads").arg(fileName).toLatin1().constData()) << fileName << int(STREAM_PARALLEL);
+    }
+}
+
+void TestStreamParser::benchmarkDataFiles()
+{
+    QFETCH(QString, fileName);
+    QFETCH(int, kind);
+
+    QString path = KSPaths::locate(QStandardPaths::GenericDataLocation, fileName);
+    if (path.isEmpty())
+        QSKIP("The data file is not installed");
+
+    int rows = 0, iterations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK
+    {
+        if (fileName == "ngcic.dat")
+            rows = parseFile(path, ngcicColumns, true, ParserKind(kind));
+        else if (fileName == "asteroids.dat")
+            rows = parseFile(path, asteroidColumns, false, ParserKind(kind));
+        else
+            rows = parseFile(path, cometColumns, false, ParserKind(kind));
+        iterations++;
+    }
+    double seconds = timer.nsecsElapsed() * 1e-9;
+    QVERIFY(rows > 0);
+    qDebug() << fileName << rows << "rows," << QFileInfo(path).size() * iterations / seconds / 1e6 << "MB/s";
+}
+
+QTEST_GUILESS_MAIN(TestStreamParser)
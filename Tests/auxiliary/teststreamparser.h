@@ -0,0 +1,50 @@
+/*  KStars Testing - KSStreamParser
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+ */
+
+#ifndef TESTSTREAMPARSER_H
+#define TESTSTREAMPARSER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "ksparser.h"
+#include "ksstreamparser.h"
+
+/**
+ * Checks that KSStreamParser reads CSV and fixed width files exactly like
+ * KSParser, and measures the parse throughput of both over the data
+ * files shipped with KStars.
+ */
+class TestStreamParser: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestStreamParser();
+  ~TestStreamParser();
+
+ private slots:
+   void initTestCase();
+   void cleanupTestCase();
+   void testCSV();
+   void testFixedWidth();
+   void testNumbers();
+   void testParallel();
+   void testMissingFile();
+   void benchmarkDataFiles_data();
+   void benchmarkDataFiles();
+
+ private:
+   /** Write the given lines to a new temporary file, returns its name */
+   QString writeFile(const QStringList &lines);
+
+   QStringList m_Files;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/*  KStars Testing - Ekos Scheduler constraint solver
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testconstraintsolver.h"
+
+#include <cmath>
+
+#define JOB_COUNT 300
+
+using namespace Ekos;
+
+TestConstraintSolver::TestConstraintSolver(): QObject(), dawn(0.2), dusk(0.85), earlyDawn(0.18)
+{
+}
+
+TestConstraintSolver::~TestConstraintSolver()
+{
+}
+
+void TestConstraintSolver::initTestCase()
+{
+    // An evening at 45 degrees north, with a bright Moon moving about
+    // 13 degrees a day along the equator
+    start = QDateTime(QDate(2026, 3, 20), QTime(19, 30));
+    solver.setPeriod(start, 45.0 * M_PI / 180.0, 1.2, dawn, dusk, earlyDawn);
+
+    QVector<ConstraintSolver::MoonPosition> moon;
+    for (int i = 0; i <= 50; i++)
+    {
+        ConstraintSolver::MoonPosition p;
+        p.ra           = fmod(2.0 + i * 0.5 * 13.2 / 24.0 * M_PI / 180.0, 2 * M_PI);
+        p.dec          = 5.0 * M_PI / 180.0;
+        p.illumination = 0.8;
+        moon.append(p);
+    }
+    solver.setMoonEphemeris(moon, 1800.0);
+
+    // Synthetic jobs all over the sky, a third of them with a moon constraint
+    qsrand(42);
+    for (int i = 0; i < JOB_COUNT; i++)
+    {
+        ConstraintSolver::Target t;
+        t.ra                = 2 * M_PI * (qrand() / double(RAND_MAX));
+        t.dec               = asin(2 * (qrand() / double(RAND_MAX)) - 1);
+        t.minAltitude       = 60.0 * (qrand() / double(RAND_MAX));
+        t.minMoonSeparation = (i % 3 == 0) ? 30.0 : -1;
+        targets.append(t);
+    }
+}
+
+ConstraintSolver::Result TestConstraintSolver::scan(const ConstraintSolver::Target &target) const
+{
+    ConstraintSolver::Result result;
+    result.status   = ConstraintSolver::SOLVE_NOT_FOUND;
+    result.altitude = 0;
+
+    double startFraction = start.time().msecsSinceStartOfDay() / (24.0 * 3600.0 * 1000.0);
+    for (double t = 0; t < 24 * 3600.0; t += 60)
+    {
+        double fraction = fmod(startFraction + t / (24 * 3600.0), 1.0);
+        if (fraction >= dawn && fraction <= dusk)
+            continue;
+
+        double altitude = solver.altitude(target, t);
+        if (altitude <= target.minAltitude)
+            continue;
+
+        result.time     = start.addSecs(t);
+        result.altitude = altitude;
+
+        if (fraction > earlyDawn && fraction < dawn)
+        {
+            result.status = ConstraintSolver::SOLVE_PRE_DAWN;
+            return result;
+        }
+
+        if (target.minMoonSeparation > 0)
+        {
+            ConstraintSolver::MoonPosition moon;
+            double moonAltitude;
+            if (solver.moonPosition(t, moon, moonAltitude) == false)
+                break;
+            double cosSep = sin(target.dec) * sin(moon.dec) + cos(target.dec) * cos(moon.dec) * cos(target.ra - moon.ra);
+            double separation = acos(qBound(-1.0, cosSep, 1.0)) * 180.0 / M_PI;
+            if (moonAltitude > 0 && separation < target.minMoonSeparation)
+                continue;
+        }
+
+        result.status = ConstraintSolver::SOLVE_FOUND;
+        return result;
+    }
+    return result;
+}
+
+void TestConstraintSolver::testWindowOperations()
+{
+    ConstraintSolver::WindowList a, b;
+    a << ConstraintSolver::Window(0, 10) << ConstraintSolver::Window(20, 30);
+    b << ConstraintSolver::Window(5, 25);
+
+    ConstraintSolver::WindowList i = ConstraintSolver::intersect(a, b);
+    QCOMPARE(i.size(), 2);
+    QCOMPARE(i[0], ConstraintSolver::Window(5, 10));
+    QCOMPARE(i[1], ConstraintSolver::Window(20, 25));
+
+    ConstraintSolver::WindowList u = ConstraintSolver::unite(a, b);
+    QCOMPARE(u.size(), 1);
+    QCOMPARE(u[0], ConstraintSolver::Window(0, 30));
+}
+
+void TestConstraintSolver::testAgainstMinuteScan()
+{
+    QVector<ConstraintSolver::Result> results = solver.solve(targets, start);
+    QCOMPARE(results.size(), targets.size());
+
+    for (int i = 0; i < targets.size(); i++)
+    {
+        ConstraintSolver::Result expected = scan(targets[i]);
+        QCOMPARE(int(results[i].status), int(expected.status));
+        if (expected.status == ConstraintSolver::SOLVE_NOT_FOUND)
+            continue;
+
+        // The scan finds the first whole minute in the window
+        qint64 early = results[i].time.secsTo(expected.time);
+        QVERIFY2(early >= 0 && early <= 60, qPrintable(QString("Job %1 differs by %2 seconds").arg(i).arg(early)));
+    }
+}
+
+void TestConstraintSolver::benchmarkMinuteScan()
+{
+    QBENCHMARK
+    {
+        foreach (const ConstraintSolver::Target &target, targets)
+            scan(target);
+    }
+}
+
+void TestConstraintSolver::benchmarkSolver()
+{
+    QBENCHMARK
+    {
+        solver.solve(targets, start);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestConstraintSolver)
@@ -0,0 +1,47 @@
+/*  KStars Testing - Ekos Scheduler constraint solver
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTCONSTRAINTSOLVER_H
+#define TESTCONSTRAINTSOLVER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "ekos/constraintsolver.h"
+
+/**
+ * Checks the windows of Ekos::ConstraintSolver against the minute by minute scan it
+ * replaces, on a few hundred synthetic scheduler jobs, and benchmarks both.
+ */
+class TestConstraintSolver: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestConstraintSolver();
+  ~TestConstraintSolver();
+
+ private slots:
+   void initTestCase();
+   void testWindowOperations();
+   void testAgainstMinuteScan();
+   void benchmarkMinuteScan();
+   void benchmarkSolver();
+
+ private:
+   /** The former Scheduler::calculateAltitudeTime() loop, on the same model of the sky */
+   Ekos::ConstraintSolver::Result scan(const Ekos::ConstraintSolver::Target &target) const;
+
+   Ekos::ConstraintSolver solver;
+   QVector<Ekos::ConstraintSolver::Target> targets;
+   QDateTime start;
+   double dawn, dusk, earlyDawn;
+};
+
+#endif
@@ -0,0 +1,456 @@
+/*  KStars Testing - Ekos Focus curve fitting
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testfocuscurve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Settings of the Focus module for both algorithms
+#define STEP            250
+#define TOLERANCE       1.0
+#define MAX_TRAVEL      10000
+#define MAX_POSITION    100000
+#define SAMPLE_COUNT    7
+#define MAX_ITERATIONS  30
+#define MAX_RETRIES     3
+#define RUNS            20
+
+// Beyond this HFR, the star is lost in half of the exposures
+#define LOST_STAR_HFR   12.0
+
+using namespace Ekos;
+
+namespace
+{
+
+/** A focuser on a replayed curve, counting exposures */
+class SimulatedFocuser
+{
+public:
+    SimulatedFocuser(const TestFocusCurve::Curve &curve, unsigned int seed): m_curve(curve), m_random(seed), exposures(0) {}
+
+    /** @return the HFR of the curve at a position, extrapolated linearly beyond its ends */
+    double truth(double position) const
+    {
+        const QVector<double> &x = m_curve.positions, &h = m_curve.HFRs;
+        int i = std::upper_bound(x.begin(), x.end(), position) - x.begin();
+        i = qBound(1, i, x.size() - 1);
+        return h[i - 1] + (h[i] - h[i - 1]) * (position - x[i - 1]) / (x[i] - x[i - 1]);
+    }
+
+    /** @return the lowest HFR of the curve */
+    double best() const
+    {
+        double best = truth(m_curve.positions.first());
+        for (double x = m_curve.positions.first(); x <= m_curve.positions.last(); x += 1)
+            best = qMin(best, truth(x));
+        return best;
+    }
+
+    /** @return the HFR of one exposure at a position, or -1 if no star was detected */
+    double expose(double position)
+    {
+        exposures++;
+
+        const double h = truth(position);
+        if (h > LOST_STAR_HFR && uniform() < 0.5)
+            return -1;
+
+        // Box-Muller, so that the noise does not depend on the standard library
+        const double gauss = sqrt(-2 * log(1 - uniform())) * cos(2 * M_PI * uniform());
+        double measure = h * (1 + m_curve.noise * gauss);
+        if (uniform() < m_curve.outliers)
+            measure *= 1.6;
+        return measure;
+    }
+
+private:
+    double uniform() { return m_random() / (double(m_random.max()) + 1); }
+
+    const TestFocusCurve::Curve &m_curve;
+    std::mt19937 m_random;
+
+public:
+    int exposures;
+};
+
+/**
+ * The decisions of Focus::autoFocusAbs() on an absolute focuser, without its user interface.
+ * @return true if it reports that autofocus completed, with the position it stopped at.
+ */
+bool iterativeFocus(SimulatedFocuser &focuser, double start, double &final)
+{
+    enum { NONE, IN, OUT } direction = NONE;
+    double position = start, lastHFR = 0, minHFR = 0, initSlopeHFR = 0, initialPosition = start;
+    int lastHFRPos = 0, minHFRPos = 0, initSlopePos = 0, focusOutLimit = 0, focusInLimit = 0;
+    int HFRInc = 0, HFRDec = 0, iterations = 0, noStarCount = 0, pulse = STEP;
+    bool reverseDir = false;
+
+    final = start;
+
+    for (;;)
+    {
+        double HFR = focuser.expose(position);
+        double target = 0;
+
+        final = position;
+
+        if (++iterations > MAX_ITERATIONS)
+            return false;
+
+        if (HFR == -1)
+        {
+            if (noStarCount < MAX_RETRIES)
+            {
+                noStarCount++;
+                continue;
+            }
+            else if (noStarCount == MAX_RETRIES)
+            {
+                HFR = 20;
+                noStarCount++;
+            }
+            else
+                return false;
+        }
+        else
+            noStarCount = 0;
+
+        if (direction == NONE)
+        {
+            lastHFR = minHFR = HFR;
+            initialPosition = minHFRPos = position;
+            HFRDec = HFRInc = 0;
+            focusOutLimit = focusInLimit = 0;
+            direction = OUT;
+            position += pulse;
+            continue;
+        }
+
+        if (reverseDir && focusInLimit && focusOutLimit && fabs(HFR - minHFR) < TOLERANCE / 100.0 && HFRInc == 0)
+            return iterations > 2 && noStarCount == 0;
+        else if (HFR < lastHFR)
+        {
+            if (initSlopeHFR == 0 && HFRInc == 0 && HFRDec >= 1)
+            {
+                initSlopeHFR = lastHFR;
+                initSlopePos = lastHFRPos;
+            }
+
+            if (direction == OUT && lastHFRPos < focusInLimit && fabs(HFR - lastHFR) > 0.1)
+                focusInLimit = lastHFRPos;
+            else if (direction == IN && lastHFRPos > focusOutLimit && fabs(HFR - lastHFR) > 0.1)
+                focusOutLimit = lastHFRPos;
+
+            if (initSlopeHFR)
+            {
+                double factor = 0.5;
+                const double slope = (HFR - initSlopeHFR) / (position - initSlopePos);
+                if (fabs(HFR - minHFR) * 100.0 < 0.5)
+                    factor = 1 - fabs(HFR - minHFR) * 10;
+                target = position + (HFR * factor - HFR) / slope;
+                if (target < 0)
+                {
+                    factor = 1;
+                    while (target < 0 && factor > 0)
+                    {
+                        factor -= 0.005;
+                        target = position + (HFR * factor - HFR) / slope;
+                    }
+                }
+            }
+            else
+                target = direction == IN ? position - pulse : position + pulse;
+
+            lastHFR = HFR;
+            if (lastHFR < minHFR)
+            {
+                minHFR    = lastHFR;
+                minHFRPos = position;
+            }
+            lastHFRPos = position;
+            HFRDec++;
+            HFRInc = 0;
+        }
+        else
+        {
+            reverseDir   = true;
+            lastHFR      = HFR;
+            lastHFRPos   = position;
+            initSlopeHFR = 0;
+            HFRInc       = 0;
+            HFRDec       = 0;
+
+            if (direction == IN)
+                focusInLimit = position;
+            else
+                focusOutLimit = position;
+
+            pulse  = pulse * 0.75;
+            target = direction == OUT ? minHFRPos - pulse / 2 : minHFRPos + pulse / 2;
+        }
+
+        if (focusInLimit != 0 && direction == IN && target < focusInLimit)
+            target = focusInLimit;
+        else if (focusOutLimit != 0 && direction == OUT && target > focusOutLimit)
+            target = focusOutLimit;
+
+        target = qBound(0.0, target, double(MAX_POSITION));
+
+        if (target == position)
+            return true;
+        if (focusOutLimit && focusOutLimit == focusInLimit)
+            return false;
+        if (fabs(target - initialPosition) > MAX_TRAVEL)
+            return false;
+
+        // FocusIn() and FocusOut() take whole ticks
+        const double delta = target - position;
+        if (delta > 0)
+        {
+            direction = OUT;
+            position += int(delta);
+        }
+        else
+        {
+            direction = IN;
+            position -= int(fabs(delta));
+        }
+    }
+}
+
+/** The decisions of Focus::autoFocusCurve() on an absolute focuser */
+bool curveFocus(SimulatedFocuser &focuser, double start, double &final)
+{
+    FocusCurve curve;
+    curve.start(start, STEP, SAMPLE_COUNT, 0, MAX_POSITION, MAX_TRAVEL, TOLERANCE);
+
+    double position = start;
+    int noStarCount = 0;
+
+    for (int iterations = 1; iterations <= MAX_ITERATIONS; iterations++)
+    {
+        final = position;
+
+        const double HFR = focuser.expose(position);
+        if (HFR == -1 && noStarCount++ < MAX_RETRIES)
+            continue;
+        noStarCount = 0;
+
+        switch (curve.addSample(position, HFR))
+        {
+            case FocusCurve::CURVE_COMPLETE:
+                return true;
+            case FocusCurve::CURVE_NEXT:
+                position = curve.nextPosition();
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+}
+
+TestFocusCurve::TestFocusCurve(): QObject()
+{
+}
+
+TestFocusCurve::~TestFocusCurve()
+{
+}
+
+TestFocusCurve::Curve TestFocusCurve::hyperbola(double focus, double minimumHFR, double inSlope, double outSlope, double noise, double outliers)
+{
+    Curve curve;
+    curve.noise    = noise;
+    curve.outliers = outliers;
+
+    for (double x = focus - 8000; x <= focus + 8000; x += 200)
+    {
+        const double slope = x < focus ? inSlope : outSlope;
+        curve.positions.append(x);
+        curve.HFRs.append(sqrt(minimumHFR * minimumHFR + slope * slope * (x - focus) * (x - focus)));
+    }
+
+    return curve;
+}
+
+void TestFocusCurve::initTestCase()
+{
+    curves["symmetric"]   = hyperbola(30000, 1.8, 0.004, 0.004, 0.02, 0);
+    curves["asymmetric"]  = hyperbola(30300, 2.2, 0.003, 0.005, 0.03, 0);
+    curves["steep"]       = hyperbola(29700, 1.5, 0.01, 0.01, 0.02, 0);
+    curves["bad seeing"]  = hyperbola(30150, 2.5, 0.004, 0.004, 0.06, 0);
+    curves["outliers"]    = hyperbola(29800, 2.0, 0.004, 0.004, 0.02, 0.1);
+    curves["flat bottom"] = hyperbola(30000, 3.0, 0.002, 0.002, 0.03, 0);
+
+    // Recorded curves, if any
+    QDir dir(qgetenv("KSTARS_FOCUS_CURVES"));
+    if (qgetenv("KSTARS_FOCUS_CURVES").isEmpty() || dir.exists() == false)
+        return;
+
+    foreach (const QString &name, dir.entryList(QDir::Files))
+    {
+        QFile file(dir.filePath(name));
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text) == false)
+            continue;
+
+        QMap<double, double> points;
+        while (file.atEnd() == false)
+        {
+            QStringList fields = QString(file.readLine()).split(',');
+            bool okPosition = false, okHFR = false;
+            if (fields.size() < 2)
+                continue;
+            const double position = fields[0].toDouble(&okPosition), HFR = fields[1].toDouble(&okHFR);
+            if (okPosition && okHFR && HFR > 0)
+                points[position] = HFR;
+        }
+
+        if (points.size() < 5)
+            continue;
+
+        // The noise of the recording is replayed as it is, with a little more on top
+        Curve curve;
+        curve.positions = points.keys().toVector();
+        curve.HFRs      = points.values().toVector();
+        curve.noise     = 0.02;
+        curve.outliers  = 0.05;
+        curves[name]    = curve;
+    }
+}
+
+void TestFocusCurve::testFitExact()
+{
+    QVector<FocusCurve::Sample> samples;
+    for (int i = -3; i <= 3; i++)
+    {
+        FocusCurve::Sample sample;
+        sample.position = 31234 + 250 * i + 100;
+        sample.HFR      = sqrt(2.1 * 2.1 + pow(0.006 * (sample.position - 31234), 2));
+        samples.append(sample);
+    }
+
+    FocusCurve::Fit fit = FocusCurve::fitHyperbola(samples);
+    QVERIFY(fit.valid);
+    QVERIFY(fabs(fit.position - 31234) < 1e-3);
+    QVERIFY(fabs(fit.HFR - 2.1) < 1e-6);
+    QVERIFY(fabs(fit.slope - 0.006) < 1e-8);
+    QVERIFY(fit.residual < 1e-6);
+}
+
+void TestFocusCurve::testFitOutliers()
+{
+    QVector<FocusCurve::Sample> samples;
+    for (int i = -5; i <= 5; i++)
+    {
+        FocusCurve::Sample sample;
+        sample.position = 20000 + 200 * i;
+        sample.HFR      = sqrt(3.0 * 3.0 + pow(0.005 * (sample.position - 20150), 2));
+        // Two exposures caught a passing satellite or a cloud
+        if (i == -1 || i == 4)
+            sample.HFR *= 1.6;
+        samples.append(sample);
+    }
+
+    FocusCurve::Fit fit = FocusCurve::fitHyperbola(samples);
+    QVERIFY(fit.valid);
+    QVERIFY(fabs(fit.position - 20150) < 5);
+    QVERIFY(fabs(fit.HFR - 3.0) < 0.05);
+}
+
+void TestFocusCurve::testNoMinimum()
+{
+    // The HFR of a star moving away from focus only grows
+    QVector<FocusCurve::Sample> samples;
+    for (int i = 0; i < 7; i++)
+    {
+        FocusCurve::Sample sample;
+        sample.position = 10000 + 100 * i;
+        sample.HFR      = 8 - 0.5 * (i - 3) * (i - 3) / 9.0;
+        samples.append(sample);
+    }
+    QVERIFY(FocusCurve::fitHyperbola(samples).valid == false);
+
+    // Sampling from a focuser at one end of its travel cannot go past it
+    FocusCurve curve;
+    curve.start(0, 100, 7, 0, 1000, 5000, 1);
+    int exposures = 0;
+    FocusCurve::Status status = FocusCurve::CURVE_NEXT;
+    for (double position = 0; status == FocusCurve::CURVE_NEXT && exposures < 20; position = curve.nextPosition(), exposures++)
+        status = curve.addSample(position, 2 + 0.01 * position);
+
+    QCOMPARE(int(status), int(FocusCurve::CURVE_TRAVEL_LIMIT));
+}
+
+void TestFocusCurve::testSimulator_data()
+{
+    QTest::addColumn<Curve>("curve");
+    QTest::addColumn<int>("offset");
+
+    // Start at focus, within the sampled range, and beyond it on either side
+    const int offsets[] = { 0, 600, -1500, 2000 };
+
+    for (QMap<QString, Curve>::const_iterator it = curves.constBegin(); it != curves.constEnd(); ++it)
+        for (int offset : offsets)
+            QTest::newRow(qPrintable(QString("%1, %2 ticks from focus").arg(it.key()).arg(offset))) << it.value() << offset;
+}
+
+void TestFocusCurve::testSimulator()
+{
+    QFETCH(Curve, curve);
+    QFETCH(int, offset);
+
+    int iterativeExposures = 0, curveExposures = 0, iterativeDone = 0, curveDone = 0;
+    double iterativeExcess = 0, curveExcess = 0;
+
+    for (int run = 0; run < RUNS; run++)
+    {
+        SimulatedFocuser iterative(curve, run), fitted(curve, run);
+
+        // Start from the best position of the curve, which may be off from its nominal focus
+        double focus = curve.positions.first();
+        for (double x = curve.positions.first(); x <= curve.positions.last(); x += 1)
+            if (fitted.truth(x) < fitted.truth(focus))
+                focus = x;
+
+        // A run that fails leaves the focuser where it stopped, and says so
+        double final;
+        if (iterativeFocus(iterative, qRound(focus) + offset, final))
+        {
+            iterativeDone++;
+            iterativeExcess += iterative.truth(final) - iterative.best();
+        }
+        if (curveFocus(fitted, qRound(focus) + offset, final))
+        {
+            curveDone++;
+            curveExcess += fitted.truth(final) - fitted.best();
+        }
+
+        iterativeExposures += iterative.exposures;
+        curveExposures     += fitted.exposures;
+    }
+
+    qDebug() << "Exposures to focus: iterative" << iterativeExposures / double(RUNS) << "completed" << iterativeDone << "of" << RUNS
+             << "excess HFR" << iterativeExcess / qMax(1, iterativeDone);
+    qDebug() << "Exposures to focus: curve fit" << curveExposures / double(RUNS) << "completed" << curveDone << "of" << RUNS
+             << "excess HFR" << curveExcess / qMax(1, curveDone);
+
+    // Fewer exposures, for runs that complete at least as often and end at least as close to the best focus
+    QVERIFY(curveExposures <= iterativeExposures);
+    QVERIFY(curveDone >= qMin(iterativeDone, RUNS * 3 / 4));
+    QVERIFY(curveExcess / qMax(1, curveDone) <= qMax(iterativeExcess / qMax(1, iterativeDone), 0.1 * SimulatedFocuser(curve, 0).best()));
+}
+
+QTEST_GUILESS_MAIN(TestFocusCurve)
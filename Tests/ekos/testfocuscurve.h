@@ -0,0 +1,61 @@
+/*  KStars Testing - Ekos Focus curve fitting
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTFOCUSCURVE_H
+#define TESTFOCUSCURVE_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "ekos/focuscurve.h"
+
+/**
+ * Checks the robust hyperbola fit of Ekos::FocusCurve, and replays HFR curves on a simulated
+ * focuser to compare the exposures it takes to reach focus with those of the iterative
+ * Focus::autoFocusAbs() algorithm.
+ *
+ * The curves are synthetic V-curves by default. Recorded curves can be replayed too: every
+ * file of the directory named by the KSTARS_FOCUS_CURVES environment variable is read as
+ * one "position,HFR" pair per line.
+ */
+class TestFocusCurve: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestFocusCurve();
+  ~TestFocusCurve();
+
+  /** @short An HFR curve, with the noise added when it is replayed */
+  struct Curve
+  {
+      QVector<double> positions;    // Increasing
+      QVector<double> HFRs;
+      double noise;                 // Relative standard deviation of a measured HFR
+      double outliers;              // Fraction of the measures that hit a spurious, larger star
+  };
+
+ private slots:
+   void initTestCase();
+   void testFitExact();
+   void testFitOutliers();
+   void testNoMinimum();
+   void testSimulator_data();
+   void testSimulator();
+
+ private:
+   /** A curve sampled from a hyperbola, with different slopes on either side of focus */
+   static Curve hyperbola(double focus, double minimumHFR, double inSlope, double outSlope, double noise, double outliers);
+
+   QMap<QString, Curve> curves;
+};
+
+Q_DECLARE_METATYPE(TestFocusCurve::Curve)
+
+#endif
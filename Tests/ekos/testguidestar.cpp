@@ -0,0 +1,186 @@
+/*  KStars Testing - Ekos guide star detection
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testguidestar.h"
+
+#include <cmath>
+
+#define STAR_X 320.3
+#define STAR_Y 240.7
+#define STAR_SIGMA 1.5
+
+TestGuideStar::TestGuideStar(): QObject(), width(640), height(480)
+{
+}
+
+TestGuideStar::~TestGuideStar()
+{
+}
+
+void TestGuideStar::initTestCase()
+{
+    makeFrame(STAR_X, STAR_Y, 20000);
+}
+
+void TestGuideStar::makeFrame(double x, double y, double flux)
+{
+    frame.resize(width * height);
+
+    qsrand(42);
+    for (int j = 0; j < height; j++)
+    {
+        for (int i = 0; i < width; i++)
+        {
+            double r2 = (i - x) * (i - x) + (j - y) * (j - y);
+            frame[j * width + i] = 1000 + qrand() % 50 + flux * exp(-r2 / (2 * STAR_SIGMA * STAR_SIGMA));
+        }
+    }
+}
+
+QPoint TestGuideStar::scan(const QRect &trackingBox) const
+{
+    static double P0 = 0.906, P1 = 0.584, P2 = 0.365, P3 = 0.117, P4 = 0.049, P5 = -0.05, P6 = -0.064, P7 = -0.074, P8 = -0.094;
+
+    const float *psrc = frame.constData() + trackingBox.y() * width + trackingBox.x();
+    const int video_width = width;
+    float i0, i1, i2, i3, i4, i5, i6, i7, i8;
+    int ix = -1, iy = -1;
+    int xM4;
+    const float *p;
+    double average, fit, bestFit = 0;
+
+    for (int x = 0; x < trackingBox.width(); x++)
+        for (int y = 0; y < trackingBox.height(); y++)
+        {
+            i0 = i1 = i2 = i3 = i4 = i5 = i6 = i7 = i8 = 0;
+            xM4 = x - 4;
+            p = psrc + (y - 4) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y - 3) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i7 += *p++; i6 += *p++; i7 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y - 2) * video_width + xM4; i8 += *p++; i8 += *p++; i5 += *p++; i4 += *p++; i3 += *p++; i4 += *p++; i5 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y - 1) * video_width + xM4; i8 += *p++; i7 += *p++; i4 += *p++; i2 += *p++; i1 += *p++; i2 += *p++; i4 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y + 0) * video_width + xM4; i8 += *p++; i6 += *p++; i3 += *p++; i1 += *p++; i0 += *p++; i1 += *p++; i3 += *p++; i6 += *p++; i8 += *p++;
+            p = psrc + (y + 1) * video_width + xM4; i8 += *p++; i7 += *p++; i4 += *p++; i2 += *p++; i1 += *p++; i2 += *p++; i4 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y + 2) * video_width + xM4; i8 += *p++; i8 += *p++; i5 += *p++; i4 += *p++; i3 += *p++; i4 += *p++; i5 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y + 3) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i7 += *p++; i6 += *p++; i7 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
+            p = psrc + (y + 4) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
+            average = (i0 + i1 + i2 + i3 + i4 + i5 + i6 + i7 + i8) / 85.0;
+            fit = P0 * (i0 - average) + P1 * (i1 - 4 * average) + P2 * (i2 - 4 * average) + P3 * (i3 - 4 * average) + P4 * (i4 - 8 * average) + P5 * (i5 - 4 * average) + P6 * (i6 - 4 * average) + P7 * (i7 - 8 * average) + P8 * (i8 - 48 * average);
+            if (bestFit < fit)
+            {
+                bestFit = fit;
+                ix = x;
+                iy = y;
+            }
+        }
+
+    if (bestFit <= 50)
+        return QPoint(-1, -1);
+
+    return QPoint(trackingBox.x() + ix, trackingBox.y() + iy);
+}
+
+void TestGuideStar::testAgainstTemplateScan_data()
+{
+    QTest::addColumn<QRect>("trackingBox");
+
+    QTest::newRow("16 centered") << QRect(312, 232, 16, 16);
+    QTest::newRow("32 centered") << QRect(304, 224, 32, 32);
+    QTest::newRow("64 off center") << QRect(270, 200, 64, 64);
+    QTest::newRow("128 centered") << QRect(256, 176, 128, 128);
+}
+
+void TestGuideStar::testAgainstTemplateScan()
+{
+    QFETCH(QRect, trackingBox);
+
+    QPoint best = scan(trackingBox);
+    Vector star = cgmath::findTemplateStarPosition(frame.constData(), width, height, trackingBox);
+
+    QVERIFY(best.x() >= 0);
+    // The template peak is the same, and the sub-pixel position refines it by less than a pixel
+    QVERIFY(fabs(star.x - best.x()) < 1.0);
+    QVERIFY(fabs(star.y - best.y()) < 1.0);
+}
+
+void TestGuideStar::testSubPixel()
+{
+    QRect trackingBox(304, 224, 32, 32);
+
+    for (int i = 0; i < 5; i++)
+    {
+        double x = STAR_X + i * 0.2, y = STAR_Y - i * 0.15;
+        makeFrame(x, y, 20000);
+        Vector star = cgmath::findTemplateStarPosition(frame.constData(), width, height, trackingBox);
+        QVERIFY2(fabs(star.x - x) < 0.1 && fabs(star.y - y) < 0.1,
+                 qPrintable(QString("(%1, %2) found at (%3, %4)").arg(x).arg(y).arg(star.x).arg(star.y)));
+    }
+
+    makeFrame(STAR_X, STAR_Y, 20000);
+}
+
+void TestGuideStar::testNoStar()
+{
+    makeFrame(STAR_X, STAR_Y, 0);
+    Vector star = cgmath::findTemplateStarPosition(frame.constData(), width, height, QRect(304, 224, 32, 32));
+    QCOMPARE(star.x, -1.0);
+    QCOMPARE(star.y, -1.0);
+
+    makeFrame(STAR_X, STAR_Y, 20000);
+}
+
+void TestGuideStar::testImageEdges()
+{
+    // Boxes that extend past the image must not read outside of it
+    makeFrame(3.5, 5.2, 20000);
+    Vector star = cgmath::findTemplateStarPosition(frame.constData(), width, height, QRect(-8, -8, 32, 32));
+    QVERIFY(fabs(star.x - 3.5) < 1.0 && fabs(star.y - 5.2) < 1.0);
+
+    star = cgmath::findTemplateStarPosition(frame.constData(), width, height, QRect(width - 2, height - 2, 32, 32));
+    QCOMPARE(star.x, -1.0);
+
+    makeFrame(STAR_X, STAR_Y, 20000);
+}
+
+void TestGuideStar::benchmarkTemplateScan_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("32") << 32;
+    QTest::newRow("64") << 64;
+    QTest::newRow("128") << 128;
+}
+
+void TestGuideStar::benchmarkTemplateScan()
+{
+    QFETCH(int, size);
+    QRect trackingBox(320 - size / 2, 240 - size / 2, size, size);
+
+    QBENCHMARK
+    {
+        scan(trackingBox);
+    }
+}
+
+void TestGuideStar::benchmarkSummedArea_data()
+{
+    benchmarkTemplateScan_data();
+}
+
+void TestGuideStar::benchmarkSummedArea()
+{
+    QFETCH(int, size);
+    QRect trackingBox(320 - size / 2, 240 - size / 2, size, size);
+
+    QBENCHMARK
+    {
+        cgmath::findTemplateStarPosition(frame.constData(), width, height, trackingBox);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestGuideStar)
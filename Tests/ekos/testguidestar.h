@@ -0,0 +1,53 @@
+/*  KStars Testing - Ekos guide star detection
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTGUIDESTAR_H
+#define TESTGUIDESTAR_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "ekos/guide/gmath.h"
+
+/**
+ * Checks cgmath::findTemplateStarPosition() against the 9x9 template scan it replaces,
+ * on synthetic guide frames, and benchmarks both.
+ */
+class TestGuideStar: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestGuideStar();
+  ~TestGuideStar();
+
+ private slots:
+   void initTestCase();
+   void testAgainstTemplateScan_data();
+   void testAgainstTemplateScan();
+   void testSubPixel();
+   void testNoStar();
+   void testImageEdges();
+   void benchmarkTemplateScan_data();
+   void benchmarkTemplateScan();
+   void benchmarkSummedArea_data();
+   void benchmarkSummedArea();
+
+ private:
+   /** Fill the frame with a noisy background and a Gaussian star at (x, y) */
+   void makeFrame(double x, double y, double flux);
+
+   /** The former template scan of cgmath::findLocalStarPosition(), returning the best match only */
+   QPoint scan(const QRect &trackingBox) const;
+
+   QVector<float> frame;
+   int width, height;
+};
+
+#endif
@@ -0,0 +1,55 @@
+/*  KStars Testing - synthetic FITS frames
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "fitstestframe.h"
+
+#include <cstdlib>
+
+#include <QtGlobal>
+
+#include <fitsio.h>
+
+QVector<double> createSkyNoise(int samples, bool fractional)
+{
+    QVector<double> pixels(samples);
+    qsrand(42);
+    for (int i = 0; i < samples; i++)
+    {
+        pixels[i] = 1000 + qrand() % 500;
+        if (fractional)
+            pixels[i] += (qrand() % 1000) / 1000.0;
+    }
+
+    return pixels;
+}
+
+QByteArray createFITSFrame(int width, int height, int bitpix, const QVector<double> &pixels, const QString &bayerPattern)
+{
+    fitsfile *fptr = NULL;
+    int status = 0;
+    size_t memSize = 2880;
+    void *memPointer = malloc(memSize);
+    long naxes[2] = { width, height };
+
+    fits_create_memfile(&fptr, &memPointer, &memSize, 2880, realloc, &status);
+    fits_create_img(fptr, bitpix, 2, naxes, &status);
+    if (!bayerPattern.isEmpty())
+    {
+        QByteArray pattern = bayerPattern.toLatin1();
+        fits_write_key(fptr, TSTRING, "BAYERPAT", pattern.data(), NULL, &status);
+    }
+    fits_write_img(fptr, TDOUBLE, 1, pixels.size(), const_cast<double *>(pixels.constData()), &status);
+    fits_close_file(fptr, &status);
+
+    QByteArray frame;
+    if (status == 0)
+        frame = QByteArray(static_cast<char *>(memPointer), memSize);
+    free(memPointer);
+    return frame;
+}
@@ -0,0 +1,31 @@
+/*  KStars Testing - synthetic FITS frames
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef FITSTESTFRAME_H
+#define FITSTESTFRAME_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @return the given number of samples of noise around a sky background,
+ * always the same ones. With fractional, the samples are not integers.
+ */
+QVector<double> createSkyNoise(int samples, bool fractional = false);
+
+/**
+ * @return a FITS file in memory of the given CFITSIO image type (bitpix)
+ * and size, holding the given pixels, or an empty array on error. A
+ * non-empty bayerPattern is written in the BAYERPAT keyword.
+ */
+QByteArray createFITSFrame(int width, int height, int bitpix, const QVector<double> &pixels,
+                           const QString &bayerPattern = QString());
+
+#endif
@@ -0,0 +1,195 @@
+/*  KStars Testing - FITS debayering
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testfitsdebayer.h"
+
+#include <cmath>
+
+#include <fitsio.h>
+
+#include "fitsviewer/bayerdecoder.h"
+
+#include "fitstestframe.h"
+
+Q_DECLARE_METATYPE(dc1394bayer_method_t)
+
+static const char *methodNames[] = { "nearest", "simple", "bilinear", "HQ linear", "VNG" };
+static const char *filterNames[] = { "RGGB", "GBRG", "GRBG", "BGGR" };
+
+TestFITSDebayer::TestFITSDebayer(): QObject()
+{
+}
+
+TestFITSDebayer::~TestFITSDebayer()
+{
+}
+
+template <typename T>
+void TestFITSDebayer::compareDecode(int width, int height, const BayerParams &params, int margin, int maximum)
+{
+    const int samples = width * height;
+
+    // dc1394 reads a little past the mosaic when there is an offset
+    QVector<T> bayer(samples);
+    QVector<float> floatBayer(samples + 2 * width + 2, 0.0f);
+    qsrand(42);
+    for (int i = 0; i < samples; i++)
+    {
+        bayer[i] = static_cast<T>(qrand() % (maximum + 1));
+        floatBayer[i] = bayer[i];
+    }
+
+    QVector<float> rgb(3 * samples, 0.0f);
+    QCOMPARE(dc1394_bayer_decoding_float(floatBayer.data(), rgb.data(), width, height, params.offsetX, params.offsetY,
+                                         params.filter, params.method), DC1394_SUCCESS);
+
+    QVector<T> planes(3 * samples);
+    QCOMPARE(BayerDecoder::decode(bayer.constData(), planes.data(), width, height, params), DC1394_SUCCESS);
+
+    for (int y = margin; y < height - margin; y++)
+        for (int x = margin; x < width - margin; x++)
+            for (int c = 0; c < 3; c++)
+            {
+                const float expected = qBound(0.0f, rgb[3 * (y * width + x) + c], float(maximum));
+                if (planes[c * samples + y * width + x] != static_cast<T>(expected))
+                    QFAIL(qPrintable(QString("Color %1 of (%2, %3) is %4 instead of %5").arg(c).arg(x).arg(y)
+                                     .arg(planes[c * samples + y * width + x]).arg(expected)));
+            }
+}
+
+void TestFITSDebayer::testDecode_data()
+{
+    QTest::addColumn<dc1394bayer_method_t>("method");
+    QTest::addColumn<int>("filter");
+    QTest::addColumn<int>("offsetX");
+    QTest::addColumn<int>("offsetY");
+
+    for (int method = DC1394_BAYER_METHOD_NEAREST; method <= DC1394_BAYER_METHOD_VNG; method++)
+        for (int filter = DC1394_COLOR_FILTER_MIN; filter <= DC1394_COLOR_FILTER_MAX; filter++)
+            for (int offset = 0; offset < 4; offset++)
+            {
+                // The simple method of dc1394 ignores the offsets
+                if (method == DC1394_BAYER_METHOD_SIMPLE && offset)
+                    continue;
+
+                QTest::newRow(qPrintable(QString("%1 %2, offsets %3 %4").arg(methodNames[method - DC1394_BAYER_METHOD_NEAREST])
+                                         .arg(filterNames[filter - DC1394_COLOR_FILTER_MIN]).arg(offset & 1).arg(offset >> 1)))
+                        << dc1394bayer_method_t(method) << filter << (offset & 1) << (offset >> 1);
+            }
+}
+
+void TestFITSDebayer::testDecode()
+{
+    QFETCH(dc1394bayer_method_t, method);
+    QFETCH(int, filter);
+    QFETCH(int, offsetX);
+    QFETCH(int, offsetY);
+
+    BayerParams params;
+    params.method  = method;
+    params.filter  = dc1394color_filter_t(filter);
+    params.offsetX = offsetX;
+    params.offsetY = offsetY;
+
+    // With offsets, dc1394 wraps around the rows and leaves the borders uninitialized
+    const int margin = (offsetX || offsetY) ? 4 : 0;
+
+    // Odd sizes, so that the vectors and tiles do not line up with the image
+    compareDecode<uint8_t>(67, 53, params, margin, 255);
+    if (QTest::currentTestFailed())
+        return;
+    compareDecode<uint16_t>(1021, 769, params, margin, 65535);
+}
+
+void TestFITSDebayer::testFITSData()
+{
+    const int width = 211, height = 157;
+
+    QVector<double> pixels = createSkyNoise(width * height);
+    QByteArray frame = createFITSFrame(width, height, USHORT_IMG, pixels, "GRBG");
+    QVERIFY(!frame.isEmpty());
+
+    FITSData data(FITS_NORMAL);
+    QVERIFY(data.loadFITS("bayer.fits", true, frame));
+    QCOMPARE(data.getNumOfChannels(), 3);
+
+    QVector<uint16_t> bayer(pixels.size());
+    for (int i = 0; i < pixels.size(); i++)
+        bayer[i] = static_cast<uint16_t>(pixels[i]);
+
+    BayerParams params;
+    data.getBayerParams(&params);
+    QCOMPARE(params.filter, DC1394_COLOR_FILTER_GRBG);
+
+    QVector<uint16_t> planes(3 * pixels.size());
+    QCOMPARE(BayerDecoder::decode(bayer.constData(), planes.data(), width, height, params), DC1394_SUCCESS);
+    QVERIFY(memcmp(data.getImageBuffer(), planes.constData(), planes.size() * sizeof(uint16_t)) == 0);
+}
+
+void TestFITSDebayer::benchmarkDecode_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<dc1394bayer_method_t>("method");
+
+    for (int method = DC1394_BAYER_METHOD_NEAREST; method <= DC1394_BAYER_METHOD_VNG; method++)
+    {
+        const char *name = methodNames[method - DC1394_BAYER_METHOD_NEAREST];
+        QTest::newRow(qPrintable(QString("legacy, %1").arg(name)))  << true << dc1394bayer_method_t(method);
+        QTest::newRow(qPrintable(QString("decoder, %1").arg(name))) << false << dc1394bayer_method_t(method);
+    }
+}
+
+void TestFITSDebayer::benchmarkDecode()
+{
+    QFETCH(bool, legacy);
+    QFETCH(dc1394bayer_method_t, method);
+
+    // A 24 megapixel 16 bit mosaic
+    const int width = 6000, height = 4000, samples = width * height;
+
+    QVector<uint16_t> bayer(samples);
+    qsrand(42);
+    for (int i = 0; i < samples; i++)
+        bayer[i] = 1000 + qrand() % 500;
+
+    BayerParams params;
+    params.method  = method;
+    params.filter  = DC1394_COLOR_FILTER_RGGB;
+    params.offsetX = params.offsetY = 0;
+
+    QVector<uint16_t> planes(3 * samples);
+
+    if (legacy)
+    {
+        QVector<float> floatBayer(samples), rgb(3 * samples);
+
+        // What FITSData did before BayerDecoder: convert the mosaic to float,
+        // decode it to interleaved RGB, and split the result into layers
+        QBENCHMARK
+        {
+            for (int i = 0; i < samples; i++)
+                floatBayer[i] = bayer[i];
+
+            dc1394_bayer_decoding_float(floatBayer.data(), rgb.data(), width, height, 0, 0, params.filter, params.method);
+
+            for (int i = 0; i < samples; i++)
+                for (int c = 0; c < 3; c++)
+                    planes[c * samples + i] = static_cast<uint16_t>(qBound(0.0f, rgb[3 * i + c], 65535.0f));
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            BayerDecoder::decode(bayer.constData(), planes.data(), width, height, params);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestFITSDebayer)
@@ -0,0 +1,43 @@
+/*  KStars Testing - FITS debayering
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTFITSDEBAYER_H
+#define TESTFITSDEBAYER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "fitsviewer/fitsdata.h"
+
+/**
+ * Checks BayerDecoder against dc1394_bayer_decoding_float() for all methods and
+ * patterns on 8 and 16 bit mosaics, checks that FITSData debayers bayered files
+ * with it, and benchmarks both on a 24 megapixel mosaic.
+ */
+class TestFITSDebayer: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestFITSDebayer();
+  ~TestFITSDebayer();
+
+ private slots:
+   void testDecode_data();
+   void testDecode();
+   void testFITSData();
+   void benchmarkDecode_data();
+   void benchmarkDecode();
+
+ private:
+   /** Compare BayerDecoder with dc1394 on a random mosaic, away from the given margin */
+   template <typename T> void compareDecode(int width, int height, const BayerParams &params, int margin, int maximum);
+};
+
+#endif
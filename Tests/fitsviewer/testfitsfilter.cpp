@@ -0,0 +1,104 @@
+/*  KStars Testing - FITS filters
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testfitsfilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <fitsio.h>
+
+#include "fitstestframe.h"
+
+Q_DECLARE_METATYPE(FITSScale)
+
+TestFITSFilter::TestFITSFilter(): QObject()
+{
+}
+
+TestFITSFilter::~TestFITSFilter()
+{
+}
+
+void TestFITSFilter::testLinear()
+{
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("linear.fits", true, createFITSFrame(97, 61, USHORT_IMG, createSkyNoise(97 * 61))));
+
+    data.applyFilter(FITS_LINEAR, NULL, 1100, 1300);
+
+    const uint16_t *buffer = reinterpret_cast<const uint16_t *>(data.getImageBuffer());
+    for (unsigned int i = 0; i < data.getSize(); i++)
+    {
+        QVERIFY(buffer[i] >= 1100);
+        QVERIFY(buffer[i] <= 1300);
+    }
+}
+
+void TestFITSFilter::testMedian()
+{
+    // Odd sizes, so that the tiles do not line up with the image
+    const int width = 97, height = 61;
+
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("median.fits", true, createFITSFrame(width, height, USHORT_IMG, createSkyNoise(width * height))));
+
+    const uint16_t *buffer = reinterpret_cast<const uint16_t *>(data.getImageBuffer());
+    QVector<uint16_t> original(width * height);
+    memcpy(original.data(), buffer, original.size() * sizeof(uint16_t));
+
+    data.applyFilter(FITS_MEDIAN);
+
+    // Brute force 3x3 median, replicating the pixels at the edges
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            QVector<uint16_t> window;
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                    window.append(original[qBound(0, y + dy, height - 1) * width + qBound(0, x + dx, width - 1)]);
+            std::nth_element(window.begin(), window.begin() + 4, window.end());
+            QCOMPARE(buffer[y * width + x], window[4]);
+        }
+}
+
+void TestFITSFilter::benchmarkFilter_data()
+{
+    QTest::addColumn<int>("megapixels");
+    QTest::addColumn<FITSScale>("filter");
+
+    const int sizes[] = { 10, 24, 50 };
+    for (int megapixels : sizes)
+    {
+        QTest::newRow(qPrintable(QString("%1 MP linear").arg(megapixels)))       << megapixels << FITS_LINEAR;
+        QTest::newRow(qPrintable(QString("%1 MP log").arg(megapixels)))          << megapixels << FITS_LOG;
+        QTest::newRow(qPrintable(QString("%1 MP auto stretch").arg(megapixels))) << megapixels << FITS_AUTO_STRETCH;
+        QTest::newRow(qPrintable(QString("%1 MP median").arg(megapixels)))       << megapixels << FITS_MEDIAN;
+    }
+}
+
+void TestFITSFilter::benchmarkFilter()
+{
+    QFETCH(int, megapixels);
+    QFETCH(FITSScale, filter);
+
+    // 3:2 frames, like most camera sensors
+    int width  = sqrt(megapixels * 1e6 * 1.5);
+    int height = megapixels * 1e6 / width;
+
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("benchmark.fits", true, createFITSFrame(width, height, USHORT_IMG, createSkyNoise(width * height))));
+
+    QBENCHMARK
+    {
+        data.applyFilter(filter);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestFITSFilter)
@@ -0,0 +1,37 @@
+/*  KStars Testing - FITS filters
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTFITSFILTER_H
+#define TESTFITSFILTER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "fitsviewer/fitsdata.h"
+
+/**
+ * Checks FITSData::applyFilter() on small synthetic 16 bit frames, and benchmarks
+ * the filters on synthetic 10, 24 and 50 megapixel frames.
+ */
+class TestFITSFilter: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestFITSFilter();
+  ~TestFITSFilter();
+
+ private slots:
+   void testLinear();
+   void testMedian();
+   void benchmarkFilter_data();
+   void benchmarkFilter();
+};
+
+#endif
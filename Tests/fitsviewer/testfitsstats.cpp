@@ -0,0 +1,141 @@
+/*  KStars Testing - FITS statistics
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testfitsstats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <fitsio.h>
+
+#include "fitstestframe.h"
+
+TestFITSStats::TestFITSStats(): QObject()
+{
+}
+
+TestFITSStats::~TestFITSStats()
+{
+}
+
+void TestFITSStats::testStats_data()
+{
+    QTest::addColumn<int>("bitpix");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+
+    // Odd sizes, so that the tiles and chunks do not line up with the image
+    QTest::newRow("16 bit, small") << int(USHORT_IMG) << 97 << 61;
+    QTest::newRow("16 bit, several tiles") << int(USHORT_IMG) << 1021 << 769;
+    QTest::newRow("float, small") << int(FLOAT_IMG) << 97 << 61;
+    QTest::newRow("float, several tiles") << int(FLOAT_IMG) << 1021 << 769;
+}
+
+void TestFITSStats::testStats()
+{
+    QFETCH(int, bitpix);
+    QFETCH(int, width);
+    QFETCH(int, height);
+
+    QVector<double> pixels = createSkyNoise(width * height, bitpix == FLOAT_IMG);
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("stats.fits", true, createFITSFrame(width, height, bitpix, pixels)));
+    data.calculateStats(true);
+
+    // Two pass reference
+    double sum = 0, squares = 0;
+    for (int i = 0; i < pixels.size(); i++)
+        sum += pixels[i];
+    const double mean = sum / pixels.size();
+    for (int i = 0; i < pixels.size(); i++)
+        squares += (pixels[i] - mean) * (pixels[i] - mean);
+    const double stddev = sqrt(squares / (pixels.size() - 1));
+
+    QVector<double> sorted = pixels;
+    std::sort(sorted.begin(), sorted.end());
+
+    // Float pixels are stored in single precision
+    const double tolerance = bitpix == FLOAT_IMG ? 1e-3 : 1e-9;
+    QVERIFY(fabs(data.getMin() - sorted.first()) <= tolerance);
+    QVERIFY(fabs(data.getMax() - sorted.last()) <= tolerance);
+    QVERIFY(fabs(data.getMean() - mean) <= tolerance);
+    QVERIFY(fabs(data.getStdDev() - stddev) <= tolerance);
+
+    const double median = sorted[(sorted.size() - 1) / 2];
+    if (bitpix == USHORT_IMG)
+        // The median of integer pixels is exact
+        QCOMPARE(data.getMedian(), median);
+    else
+        // Otherwise it is known to one bin
+        QVERIFY(fabs(data.getMedian() - median) <= data.getHistogramBinWidth());
+}
+
+void TestFITSStats::testHistogram()
+{
+    QVector<double> pixels = createSkyNoise(211 * 157);
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("histogram.fits", true, createFITSFrame(211, 157, USHORT_IMG, pixels)));
+    data.calculateStats(true);
+
+    const int binCount = data.getHistogramBinCount();
+    const double binWidth = data.getHistogramBinWidth();
+    const double min = data.getMin();
+
+    QVector<double> expected(binCount);
+    for (int i = 0; i < pixels.size(); i++)
+        expected[qBound(0, int(round((pixels[i] - min) / binWidth)), binCount - 1)]++;
+
+    QCOMPARE(data.getHistogramFrequency(0), expected);
+
+    // A new range bins the samples again. With an odd range, no sample falls
+    // half way between two bins, where rounding could go either way.
+    data.setMinMax(1100, 1301);
+    QCOMPARE(data.getHistogramBinCount(), binCount);
+    const double newWidth = data.getHistogramBinWidth();
+    QVERIFY(fabs(newWidth - 201.0 / (binCount - 1)) < 1e-9);
+
+    expected.fill(0);
+    for (int i = 0; i < pixels.size(); i++)
+        expected[qBound(0, int(round((pixels[i] - 1100) / newWidth)), binCount - 1)]++;
+
+    QCOMPARE(data.getHistogramFrequency(0), expected);
+}
+
+void TestFITSStats::benchmarkStats_data()
+{
+    QTest::addColumn<int>("megapixels");
+    QTest::addColumn<int>("bitpix");
+
+    const int sizes[] = { 10, 24, 50 };
+    for (int megapixels : sizes)
+    {
+        QTest::newRow(qPrintable(QString("%1 MP 16 bit").arg(megapixels))) << megapixels << int(USHORT_IMG);
+        QTest::newRow(qPrintable(QString("%1 MP float").arg(megapixels)))  << megapixels << int(FLOAT_IMG);
+    }
+}
+
+void TestFITSStats::benchmarkStats()
+{
+    QFETCH(int, megapixels);
+    QFETCH(int, bitpix);
+
+    // 3:2 frames, like most camera sensors
+    int width  = sqrt(megapixels * 1e6 * 1.5);
+    int height = megapixels * 1e6 / width;
+
+    FITSData data(FITS_FOCUS);
+    QVERIFY(data.loadFITS("benchmark.fits", true, createFITSFrame(width, height, bitpix, createSkyNoise(width * height, bitpix == FLOAT_IMG))));
+
+    QBENCHMARK
+    {
+        data.calculateStats(true);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestFITSStats)
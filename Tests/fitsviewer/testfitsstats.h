@@ -0,0 +1,38 @@
+/*  KStars Testing - FITS statistics
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTFITSSTATS_H
+#define TESTFITSSTATS_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "fitsviewer/fitsdata.h"
+
+/**
+ * Checks FITSData::calculateStats() against direct computations on synthetic
+ * 16 bit and float frames, and benchmarks it on 10, 24 and 50 megapixel frames.
+ */
+class TestFITSStats: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestFITSStats();
+  ~TestFITSStats();
+
+ private slots:
+   void testStats_data();
+   void testStats();
+   void testHistogram();
+   void benchmarkStats_data();
+   void benchmarkStats();
+};
+
+#endif
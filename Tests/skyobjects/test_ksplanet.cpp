@@ -0,0 +1,96 @@
+/***************************************************************************
+                   test_ksplanet.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+/* Project Includes */
+#include "test_ksplanet.h"
+
+#include <cmath>
+
+#include "kstars/Options.h"
+
+// Segment span of the ephemeris cache, in days
+static const double SPAN = 16.0;
+
+// Julian millenia per day
+static const double DAY = 1.0 / 365250.0;
+
+void TestKSPlanet::makeSeries( KSPlanet::OrbitDataColl &orbit ) {
+    // Amplitude, phase and frequency (radians per millenium) of the terms
+    // of the longitude, latitude and distance
+    const double terms[3][3] = {
+        { 1.0,  0.5, 6283.0758 },
+        { 0.05, 1.0, 3340.6124 },
+        { 0.2,  2.0, 8399.6847 }
+    };
+
+    for ( int c = 0; c < 3; ++c ) {
+        orbit.A.append( terms[c][0] );
+        orbit.B.append( terms[c][1] );
+        orbit.C.append( terms[c][2] );
+        orbit.start[c][0] = c;
+        for ( int i = 1; i < 7; ++i )
+            orbit.start[c][i] = c + 1;
+    }
+}
+
+void TestKSPlanet::initTestCase() {
+    Options::setPlanetEphemerisSpan( SPAN );
+}
+
+void TestKSPlanet::testDateJump() {
+    KSPlanet::OrbitDataColl orbit;
+    makeSeries( orbit );
+
+    // A jump to a date computes the position of the planet, then repeats it
+    // at the times corrected for the light time, as findGeocentricPosition()
+    // does. None of this is worth a fit.
+    const double Tau = 3.5 * SPAN * DAY;
+    const double delays[3] = { 0.0, 0.0029, 0.0030 };   // days, for 0.5 AU
+    double lbr[3];
+    for ( int i = 0; i < 3; ++i ) {
+        orbit.position( Tau - delays[i], lbr );
+        for ( int c = 0; c < 3; ++c )
+            QCOMPARE( lbr[c], orbit.evaluate( KSPlanet::OrbitDataColl::Coordinate( c ), Tau - delays[i] ) );
+    }
+    QCOMPARE( orbit.fitCount, quint64( 0 ) );
+
+    // The same for a few other dates, in other segments
+    for ( int i = 1; i <= 5; ++i ) {
+        orbit.position( Tau + i * 10 * SPAN * DAY, lbr );
+        orbit.position( Tau + ( i * 10 * SPAN - 0.01 ) * DAY, lbr );
+    }
+    QCOMPARE( orbit.fitCount, quint64( 0 ) );
+}
+
+void TestKSPlanet::testRunningClock() {
+    KSPlanet::OrbitDataColl orbit;
+    makeSeries( orbit );
+
+    // A clock stepping an hour at a time fits each segment it goes through once
+    const double Tau = 7.0 * SPAN * DAY;
+    double lbr[3];
+    for ( int hour = 0; hour < 24 * 2 * SPAN; ++hour ) {
+        const double t = Tau + hour / 24.0 * DAY;
+        orbit.position( t, lbr );
+        for ( int c = 0; c < 3; ++c )
+            QVERIFY( fabs( lbr[c] - orbit.evaluate( KSPlanet::OrbitDataColl::Coordinate( c ), t ) ) < 1e-9 );
+    }
+    QCOMPARE( orbit.fitCount, quint64( 2 ) );
+}
+
+QTEST_GUILESS_MAIN( TestKSPlanet )
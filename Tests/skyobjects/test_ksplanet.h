@@ -0,0 +1,54 @@
+/***************************************************************************
+                    test_ksplanet.h  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef TEST_KSPLANET_H
+#define TEST_KSPLANET_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#define UNIT_TEST
+
+#include "skyobjects/ksplanet.h"
+
+/**
+ * @class TestKSPlanet
+ * @short Tests for the ephemeris cache of the VSOP87 expansion
+ */
+
+class TestKSPlanet : public QObject {
+
+    Q_OBJECT
+
+public:
+
+    TestKSPlanet() : QObject() {};
+    ~TestKSPlanet() {};
+
+private slots:
+    void initTestCase();
+    void testDateJump();
+    void testRunningClock();
+
+private:
+    // Fill orbit with one periodic term per coordinate
+    static void makeSeries( KSPlanet::OrbitDataColl &orbit );
+};
+
+#endif
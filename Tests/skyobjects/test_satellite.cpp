@@ -0,0 +1,105 @@
+/***************************************************************************
+                   test_satellite.cpp  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+/* Project Includes */
+#include "test_satellite.h"
+#include "auxiliary/geolocation.h"
+#include "time/kstarsdatetime.h"
+#include "auxiliary/dms.h"
+
+// Two-line elements of the ISS, epoch 2008 Sep 20 12:25:40 UT
+static const char *ISS_LINE1 = "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927";
+static const char *ISS_LINE2 = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537";
+static const double ISS_EPOCH_JD = 2454730.01782528;
+
+void TestSatellite::testBatchUpdate() {
+    GeoLocation geo( dms( 10.0 ), dms( 45.0 ) );
+    Satellite::Context ctx = Satellite::context( KStarsDateTime( ISS_EPOCH_JD + 0.3 ), &geo );
+
+    // The same satellite, propagated once on its own and many times as a batch
+    Satellite reference( "ISS", ISS_LINE1, ISS_LINE2 );
+    QCOMPARE( reference.updatePos( ctx ), 0 );
+
+    QVector<Satellite *> sats;
+    for ( int i = 0; i < 200; ++i )
+        sats.append( new Satellite( "ISS", ISS_LINE1, ISS_LINE2 ) );
+
+    QVector<int> rc = Satellite::updatePositions( sats, ctx );
+    QCOMPARE( rc.size(), sats.size() );
+    for ( int i = 0; i < sats.size(); ++i ) {
+        QCOMPARE( rc.at( i ), 0 );
+        QCOMPARE( sats.at( i )->alt().Degrees(), reference.alt().Degrees() );
+        QCOMPARE( sats.at( i )->az().Degrees(), reference.az().Degrees() );
+        QCOMPARE( sats.at( i )->range(), reference.range() );
+        QCOMPARE( sats.at( i )->isVisible(), reference.isVisible() );
+    }
+
+    qDeleteAll( sats );
+
+    // Altitude above the ground of a low orbit satellite
+    QVERIFY( reference.altitude() > 300.0 && reference.altitude() < 400.0 );
+}
+
+void TestSatellite::testPasses() {
+    GeoLocation geo( dms( 10.0 ), dms( 45.0 ) );
+    KStarsDateTime start( ISS_EPOCH_JD );
+    KStarsDateTime end( ISS_EPOCH_JD + 2.0 );
+
+    Satellite iss( "ISS", ISS_LINE1, ISS_LINE2 );
+    QCOMPARE( iss.updatePos( Satellite::context( start, &geo ) ), 0 );
+    const double altitude = iss.alt().Degrees();
+    QList<SatellitePass> passes = iss.passes( start, end, &geo );
+
+    // The ISS passes over mid-latitudes several times a day
+    QVERIFY( passes.size() >= 4 );
+
+    const double second = 1.0 / 86400.0;
+    Satellite probe( "ISS", ISS_LINE1, ISS_LINE2 );
+    for ( int i = 0; i < passes.size(); ++i ) {
+        const SatellitePass &pass = passes.at( i );
+        qDebug() << pass.rise.toString( Qt::ISODate ) << pass.maxAlt.toDMSString() << pass.set.toString( Qt::ISODate );
+
+        QVERIFY( start < pass.rise );
+        QVERIFY( pass.rise < pass.culmination );
+        QVERIFY( pass.culmination < pass.set );
+        QVERIFY( pass.set < end );
+        QVERIFY( pass.set.djd() - pass.rise.djd() < 15.0 / 1440.0 );
+        QVERIFY( pass.maxAlt.Degrees() > 0.0 && pass.maxAlt.Degrees() <= 90.0 );
+        if ( i > 0 )
+            QVERIFY( passes.at( i - 1 ).set < pass.rise );
+
+        // Below the horizon just before rise and just after set, above it just after rise
+        probe.updatePos( Satellite::context( KStarsDateTime( pass.rise.djd() - 2 * second ), &geo ) );
+        QVERIFY( probe.alt().Degrees() < 0.0 );
+        probe.updatePos( Satellite::context( KStarsDateTime( pass.rise.djd() + 2 * second ), &geo ) );
+        QVERIFY( probe.alt().Degrees() > 0.0 );
+        probe.updatePos( Satellite::context( KStarsDateTime( pass.set.djd() + 2 * second ), &geo ) );
+        QVERIFY( probe.alt().Degrees() < 0.0 );
+
+        // Culmination is the highest point of the pass
+        probe.updatePos( Satellite::context( KStarsDateTime( pass.culmination.djd() - 30 * second ), &geo ) );
+        QVERIFY( probe.alt().Degrees() <= pass.maxAlt.Degrees() );
+        probe.updatePos( Satellite::context( KStarsDateTime( pass.culmination.djd() + 30 * second ), &geo ) );
+        QVERIFY( probe.alt().Degrees() <= pass.maxAlt.Degrees() );
+    }
+
+    // Predicting passes leaves the satellite alone
+    QCOMPARE( iss.alt().Degrees(), altitude );
+}
+
+QTEST_GUILESS_MAIN( TestSatellite )
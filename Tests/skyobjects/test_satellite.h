@@ -0,0 +1,49 @@
+/***************************************************************************
+                    test_satellite.h  -  KStars Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef TEST_SATELLITE_H
+#define TEST_SATELLITE_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#define UNIT_TEST
+
+#include "skyobjects/satellite.h"
+
+/**
+ * @class TestSatellite
+ * @short Tests for the batched propagation and the pass prediction of satellites
+ */
+
+class TestSatellite : public QObject {
+
+    Q_OBJECT
+
+public:
+
+    TestSatellite() : QObject() {};
+    ~TestSatellite() {};
+
+private slots:
+    void testBatchUpdate();
+    void testPasses();
+};
+
+#endif
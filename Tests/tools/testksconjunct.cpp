@@ -0,0 +1,214 @@
+/*  KStars Testing - Conjunctions
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testksconjunct.h"
+
+#include <cmath>
+
+#include "ksnumbers.h"
+#include "kstarsdatetime.h"
+#include "skyobjects/ksasteroid.h"
+#include "skyobjects/ksplanet.h"
+
+// 2023-03-01 12:00 UT, a day before Venus passed half a degree from Jupiter
+#define VENUS_JUPITER_JD 2460005.0
+
+// Start of the benchmark decade, 2020-01-01 00:00 UT
+#define DECADE_JD 2458849.5
+
+TestKSConjunct::TestKSConjunct(): QObject(), m_Geo(dms(0.0), dms(51.4769), "Greenwich"), m_HaveData(false)
+{
+}
+
+TestKSConjunct::~TestKSConjunct()
+{
+}
+
+void TestKSConjunct::initTestCase()
+{
+    KSPlanet earth("Earth");
+    m_HaveData = earth.loadData();
+}
+
+QList<SkyObject *> TestKSConjunct::createAsteroids(int count)
+{
+    QList<SkyObject *> asteroids;
+    for (int i = 0; i < count; i++)
+    {
+        double a = 2.2 + 1.0 * i / count;
+        asteroids.append(new KSAsteroid(i, QString("Asteroid %1").arg(i), QString(), DECADE_JD, a, 0.02 + 0.2 * (i % 7) / 7.0,
+                                        dms(1.0 + (i % 13)), dms(37.0 * i), dms(71.0 * i), dms(113.0 * i), 12.0, 0.15));
+    }
+    return asteroids;
+}
+
+void TestKSConjunct::testVenusJupiter()
+{
+    if (!m_HaveData)
+        QSKIP("The VSOP87 data files are not installed");
+
+    KSPlanet venus(KSPlanetBase::VENUS), jupiter(KSPlanetBase::JUPITER);
+    QVERIFY(venus.loadData());
+    QVERIFY(jupiter.loadData());
+
+    KSConjunct ksc;
+    ksc.setGeoLocation(&m_Geo);
+    QMap<long double, dms> conjunctions =
+        ksc.findClosestApproach(venus, jupiter, VENUS_JUPITER_JD - 10, VENUS_JUPITER_JD + 10, dms(2.0));
+
+    QCOMPARE(conjunctions.size(), 1);
+    QVERIFY(fabs(double(conjunctions.firstKey() - VENUS_JUPITER_JD)) < 1.0);
+    QVERIFY(conjunctions.first().Degrees() < 0.7);
+
+    // The minimum is a minimum
+    double before = legacyDistance(conjunctions.firstKey() - 0.01, &venus, &jupiter);
+    double after  = legacyDistance(conjunctions.firstKey() + 0.01, &venus, &jupiter);
+    QVERIFY(conjunctions.first().radians() <= before);
+    QVERIFY(conjunctions.first().radians() <= after);
+}
+
+void TestKSConjunct::testCancel()
+{
+    if (!m_HaveData)
+        QSKIP("The VSOP87 data files are not installed");
+
+    KSPlanet mars(KSPlanetBase::MARS);
+    QVERIFY(mars.loadData());
+    QList<SkyObject *> asteroids = createAsteroids(50);
+
+    KSConjunct ksc;
+    ksc.setGeoLocation(&m_Geo);
+    QTimer::singleShot(0, &ksc, SLOT(cancel()));
+    QVector<QMap<long double, dms>> conjunctions =
+        ksc.findClosestApproaches(asteroids, mars, DECADE_JD, DECADE_JD + 100 * 365.25, dms(5.0));
+
+    QCOMPARE(conjunctions.size(), asteroids.size());
+    qDeleteAll(asteroids);
+}
+
+void TestKSConjunct::benchmarkAsteroids_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("legacy, 10 asteroids") << true << 10;
+    QTest::newRow("engine, 10 asteroids") << false << 10;
+    QTest::newRow("legacy, 100 asteroids") << true << 100;
+    QTest::newRow("engine, 100 asteroids") << false << 100;
+}
+
+void TestKSConjunct::benchmarkAsteroids()
+{
+    if (!m_HaveData)
+        QSKIP("The VSOP87 data files are not installed");
+
+    QFETCH(bool, legacy);
+    QFETCH(int, count);
+
+    KSPlanet mars(KSPlanetBase::MARS);
+    QVERIFY(mars.loadData());
+    QList<SkyObject *> asteroids = createAsteroids(count);
+
+    KSConjunct ksc;
+    ksc.setGeoLocation(&m_Geo);
+    int found = 0;
+
+    QBENCHMARK_ONCE
+    {
+        if (legacy)
+        {
+            foreach (SkyObject *asteroid, asteroids)
+                found += legacySearch(asteroid, &mars, DECADE_JD, DECADE_JD + 3652.5, dms(5.0)).size();
+        }
+        else
+        {
+            foreach (const auto &conjunctions, ksc.findClosestApproaches(asteroids, mars, DECADE_JD, DECADE_JD + 3652.5, dms(5.0)))
+                found += conjunctions.size();
+        }
+    }
+
+    qDebug() << found << "conjunctions closer than 5 degrees";
+    qDeleteAll(asteroids);
+}
+
+double TestKSConjunct::legacyDistance(long double jd, SkyObject *Object1, KSPlanetBase *Object2)
+{
+    KStarsDateTime t(jd);
+    KSNumbers num(jd);
+
+    KSPlanet *earth = new KSPlanet("Earth", QString(), QColor("white"), 12756.28);
+    earth->findPosition(&num);
+    CachingDms LST(m_Geo.GSTtoLST(t.gst()));
+
+    KSPlanetBase *p = dynamic_cast<KSPlanetBase *>(Object1);
+    if (p)
+        p->findPosition(&num, m_Geo.lat(), &LST, earth);
+    else
+        Object1->updateCoordsNow(&num);
+    Object2->findPosition(&num, m_Geo.lat(), &LST, earth);
+
+    delete earth;
+    return Object1->angularDistanceTo(Object2).radians();
+}
+
+QMap<long double, dms> TestKSConjunct::legacySearch(SkyObject *Object1, KSPlanetBase *Object2, long double startJD,
+                                                    long double stopJD, dms maxSeparation)
+{
+    QMap<long double, dms> Separations;
+
+    // Step sizes of the old heuristic for an asteroid against Mars
+    double step0 = qMin(double(stopJD - startJD) / 4.0, 10.0);
+    double step  = step0;
+
+    long double jd  = startJD;
+    double prevDist = legacyDistance(jd, Object1, Object2), Dist = 0;
+    int prevSign = 0, Sign;
+    jd += step;
+
+    while (jd <= stopJD)
+    {
+        Dist = legacyDistance(jd, Object1, Object2);
+        Sign = (Dist > prevDist) ? 1 : ((Dist < prevDist) ? -1 : 0);
+
+        double factor = fabs((Dist - prevDist) / Dist);
+        step = (factor > 10.0) ? step0 * factor / 10.0 : step0;
+
+        if (Sign != prevSign && prevSign == -1)
+        {
+            // Bisect back to the minimum, as the old findPrecise() did
+            long double pjd = jd;
+            double pstep = -step / 2.0, pprev = Dist;
+            int psign = -Sign;
+            while (fabs(pstep) >= 1.0 / (24.0 * 60.0))
+            {
+                pjd += pstep;
+                double d = legacyDistance(pjd, Object1, Object2);
+                int s = (d > pprev) ? 1 : ((d < pprev) ? -1 : 0);
+                if (s != psign)
+                {
+                    pstep = -pstep / 2.0;
+                    s     = -s;
+                }
+                psign = s;
+                pprev = d;
+            }
+            double minDist = legacyDistance(pjd - pstep / 2.0, Object1, Object2);
+            if (minDist < legacyDistance(pjd - 5.0, Object1, Object2) && minDist < maxSeparation.radians())
+                Separations.insert(pjd - pstep / 2.0, dms(minDist * 180.0 / dms::PI));
+        }
+
+        prevDist = Dist;
+        prevSign = Sign;
+        jd += step;
+    }
+
+    return Separations;
+}
+
+QTEST_GUILESS_MAIN(TestKSConjunct)
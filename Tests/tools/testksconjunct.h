@@ -0,0 +1,53 @@
+/*  KStars Testing - Conjunctions
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTKSCONJUNCT_H
+#define TESTKSCONJUNCT_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "geolocation.h"
+#include "ksconjunct.h"
+
+/**
+ * Checks KSConjunct against known planetary conjunctions, and benchmarks a
+ * decade of asteroid-planet conjunctions against the previous step search.
+ */
+class TestKSConjunct: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestKSConjunct();
+  ~TestKSConjunct();
+
+ private slots:
+   void initTestCase();
+   void testVenusJupiter();
+   void testCancel();
+   void benchmarkAsteroids_data();
+   void benchmarkAsteroids();
+
+ private:
+   /** A belt of synthetic asteroids */
+   QList<SkyObject *> createAsteroids(int count);
+
+   /**
+    * The step search KSConjunct used before it bracketed minima: a new Earth
+    * and full positions of both bodies at every step, one object at a time.
+    */
+   QMap<long double, dms> legacySearch(SkyObject *Object1, KSPlanetBase *Object2, long double startJD, long double stopJD, dms maxSeparation);
+   double legacyDistance(long double jd, SkyObject *Object1, KSPlanetBase *Object2);
+
+   GeoLocation m_Geo;
+   bool m_HaveData;
+};
+
+#endif
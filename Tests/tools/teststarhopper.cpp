@@ -0,0 +1,169 @@
+/*  KStars Testing - Star Hopper
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "teststarhopper.h"
+
+#include <cmath>
+
+#include "tools/starhopper.h"
+
+// Size of the synthetic star field: a 40 x 40 degree patch centered
+// on RA 6h, Dec +20
+#define FIELD_STARS 40000
+#define FIELD_RA 90.0
+#define FIELD_DEC 20.0
+#define FIELD_SIZE 40.0
+
+/**
+ * A StarHopper that takes its stars from a fixed list instead of the
+ * star catalogs, so that the tests do not need KStarsData.
+ */
+class FieldStarHopper: public StarHopper
+{
+ public:
+  explicit FieldStarHopper(const QList<StarObject *> &field): m_Field(field) {}
+
+  QList<const StarObject *> path(const SkyPoint &src, const SkyPoint &dest, float fov, float maglim, QStringList *metadata = 0)
+  {
+      return computePath_const(src, dest, fov, maglim, metadata);
+  }
+
+ protected:
+  void collectStars(QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim)
+  {
+      foreach (StarObject *star, m_Field)
+      {
+          if (star->mag() <= maglim && star->angularDistanceTo(&center).Degrees() <= radius)
+              list.append(star);
+      }
+  }
+
+ private:
+  const QList<StarObject *> &m_Field;
+};
+
+TestStarHopper::TestStarHopper(): QObject()
+{
+}
+
+TestStarHopper::~TestStarHopper()
+{
+}
+
+void TestStarHopper::initTestCase()
+{
+    // A deterministic field, with the number of stars growing by about
+    // a factor of three per magnitude like the real sky
+    const char spectralClasses[] = "OBAFGKM";
+    quint32 seed = 12345;
+    for (int i = 0; i < FIELD_STARS; i++)
+    {
+        double u[3];
+        for (int j = 0; j < 3; j++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            u[j] = (seed >> 8) / double(1 << 24);
+        }
+        double ra  = FIELD_RA - FIELD_SIZE / 2 + FIELD_SIZE * u[0];
+        double dec = FIELD_DEC - FIELD_SIZE / 2 + FIELD_SIZE * u[1];
+        float mag  = 10.0 + log(u[2] + 1e-6) / log(3.0);
+        QString sptype = QString(QChar(spectralClasses[i % 7])) + '5';
+        m_Field.append(new StarObject(dms(ra), dms(dec), mag, QString(), QString(), sptype));
+    }
+}
+
+void TestStarHopper::cleanupTestCase()
+{
+    qDeleteAll(m_Field);
+    m_Field.clear();
+}
+
+void TestStarHopper::pathData()
+{
+    QTest::addColumn<double>("srcRA");
+    QTest::addColumn<double>("srcDec");
+    QTest::addColumn<double>("destRA");
+    QTest::addColumn<double>("destDec");
+    QTest::addColumn<double>("fov");
+    QTest::addColumn<double>("maglim");
+
+    QTest::newRow("short hop") << 90.0 << 20.0 << 93.0 << 21.0 << 2.0 << 8.0;
+    QTest::newRow("across the field") << 78.0 << 10.0 << 100.0 << 30.0 << 3.0 << 7.0;
+    QTest::newRow("narrow field") << 85.0 << 15.0 << 92.0 << 18.0 << 1.0 << 9.0;
+    QTest::newRow("binoculars") << 80.0 << 25.0 << 98.0 << 12.0 << 5.0 << 6.0;
+}
+
+void TestStarHopper::testPath_data()
+{
+    pathData();
+}
+
+void TestStarHopper::testPath()
+{
+    QFETCH(double, srcRA);
+    QFETCH(double, srcDec);
+    QFETCH(double, destRA);
+    QFETCH(double, destDec);
+    QFETCH(double, fov);
+    QFETCH(double, maglim);
+
+    SkyPoint src(dms(srcRA), dms(srcDec)), dest(dms(destRA), dms(destDec));
+    FieldStarHopper hopper(m_Field);
+    QStringList directions;
+    QList<const StarObject *> path = hopper.path(src, dest, fov, maglim, &directions);
+
+    QVERIFY(!path.isEmpty());
+    QCOMPARE(directions.size(), path.size());
+
+    // Every hop stays within the field of view, uses stars up to the
+    // limiting magnitude, and the last star has the destination within
+    // half a field of view
+    const SkyPoint *prev = &src;
+    foreach (const StarObject *star, path)
+    {
+        QVERIFY(star->mag() <= maglim);
+        QVERIFY(prev->angularDistanceTo(star).Degrees() <= fov + 1e-6);
+        prev = star;
+    }
+    QVERIFY(path.last()->angularDistanceTo(&dest).Degrees() < 0.5 * fov);
+}
+
+void TestStarHopper::testNoPath()
+{
+    // No stars are bright enough to hop on
+    SkyPoint src(dms(80.0), dms(15.0)), dest(dms(100.0), dms(25.0));
+    FieldStarHopper hopper(m_Field);
+    QVERIFY(hopper.path(src, dest, 2.0, -5.0).isEmpty());
+}
+
+void TestStarHopper::benchmarkPath_data()
+{
+    pathData();
+}
+
+void TestStarHopper::benchmarkPath()
+{
+    QFETCH(double, srcRA);
+    QFETCH(double, srcDec);
+    QFETCH(double, destRA);
+    QFETCH(double, destDec);
+    QFETCH(double, fov);
+    QFETCH(double, maglim);
+
+    SkyPoint src(dms(srcRA), dms(srcDec)), dest(dms(destRA), dms(destDec));
+    FieldStarHopper hopper(m_Field);
+    QStringList directions;
+    QBENCHMARK
+    {
+        directions.clear();
+        hopper.path(src, dest, fov, maglim, &directions);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestStarHopper)
@@ -0,0 +1,46 @@
+/*  KStars Testing - Star Hopper
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTSTARHOPPER_H
+#define TESTSTARHOPPER_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "skyobjects/starobject.h"
+
+/**
+ * Checks the paths StarHopper finds through a synthetic star field, and
+ * benchmarks the search over a few source / destination pairs.
+ */
+class TestStarHopper: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestStarHopper();
+  ~TestStarHopper();
+
+ private slots:
+   void initTestCase();
+   void cleanupTestCase();
+   void testPath_data();
+   void testPath();
+   void testNoPath();
+   void benchmarkPath_data();
+   void benchmarkPath();
+
+ private:
+   /** Fill the rows shared by testPath and benchmarkPath */
+   void pathData();
+
+   QList<StarObject *> m_Field;
+};
+
+#endif
@@ -0,0 +1,232 @@
+/*  KStars Testing - Visibility engine
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testvisibilityengine.h"
+
+#include <cmath>
+
+#include "kstarsdatetime.h"
+#include "skypoint.h"
+
+// 2026-10-18 18:00 UT
+#define EVENING_JD 2461332.25L
+
+TestVisibilityEngine::TestVisibilityEngine(): QObject(), m_Geo(dms(0.0), dms(51.4769), "Greenwich")
+{
+}
+
+TestVisibilityEngine::~TestVisibilityEngine()
+{
+}
+
+void TestVisibilityEngine::createObjects(int count, QVector<double> &ra, QVector<double> &dec)
+{
+    ra.resize(count);
+    dec.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        // A spiral with uniform density on the sphere
+        double z = 1.0 - (2.0 * i + 1.0) / count;
+        ra[i]  = fmod(2.399963229728653 * i, 2.0 * dms::PI);
+        dec[i] = asin(z);
+    }
+}
+
+void TestVisibilityEngine::testAgainstSampling_data()
+{
+    QTest::addColumn<double>("latitude");
+    QTest::addColumn<double>("hours");
+
+    QTest::newRow("Greenwich, a night") << 51.4769 << 8.0;
+    QTest::newRow("Equator, an hour") << 0.0 << 1.0;
+    QTest::newRow("Tropics, 20 hours") << 15.0 << 20.0;
+    QTest::newRow("Antarctica, two days") << -75.0 << 48.0;
+}
+
+void TestVisibilityEngine::testAgainstSampling()
+{
+    QFETCH(double, latitude);
+    QFETCH(double, hours);
+
+    GeoLocation geo(dms(-30.0), dms(latitude), "Test");
+    KStarsDateTime start(EVENING_JD);
+    const double duration = hours * 3600.0;
+    const double horizon  = 10.0;
+
+    QVector<double> ra, dec;
+    createObjects(200, ra, dec);
+
+    VisibilityEngine engine;
+    engine.setPeriod(start, duration, &geo);
+    engine.setHorizon(horizon);
+    QVector<VisibilityEngine::Result> results = engine.compute(ra, dec);
+    QCOMPARE(results.size(), ra.size());
+
+    const long double middleJD = start.djd() + duration / 2.0 / 86400.0;
+    const int minutes = int(hours * 60.0);
+
+    for (int i = 0; i < ra.size(); i++)
+    {
+        const VisibilityEngine::Result &result = results.at(i);
+        QVERIFY(result.valid);
+
+        SkyPoint p(dms(ra[i] * 180.0 / dms::PI), dms(dec[i] * 180.0 / dms::PI));
+        p.precessFromAnyEpoch(J2000, middleJD);
+
+        // Altitudes at every minute, and at the middle of every minute
+        double maxAlt = -90.0, minAlt = 90.0, aboveTime = 0.0;
+        for (int k = 0; k <= minutes; k++)
+        {
+            KStarsDateTime t(start.djd() + k / 1440.0L);
+            dms LST = geo.GSTtoLST(t.gst());
+            p.EquatorialToHorizontal(&LST, geo.lat());
+            maxAlt = qMax(maxAlt, p.alt().Degrees());
+            minAlt = qMin(minAlt, p.alt().Degrees());
+
+            if (k < minutes)
+            {
+                KStarsDateTime tm(start.djd() + (k + 0.5) / 1440.0L);
+                dms midLST = geo.GSTtoLST(tm.gst());
+                p.EquatorialToHorizontal(&midLST, geo.lat());
+                if (p.alt().Degrees() >= horizon)
+                    aboveTime += 60.0;
+            }
+        }
+
+        // Sampling can only miss the extremes by a little
+        QVERIFY(result.maxAltitude >= maxAlt - 0.05);
+        QVERIFY(result.maxAltitude <= maxAlt + 0.05);
+        QVERIFY(result.minAltitude >= minAlt - 0.05);
+        QVERIFY(result.minAltitude <= minAlt + 0.05);
+
+        // Each rise or set is off by at most a minute of sampling
+        QVERIFY(fabs(result.aboveTime - aboveTime) <= 60.0 * (2 * result.intervalCount + 1));
+
+        // The hour angle is zero at transit
+        KStarsDateTime transit(start.djd() + result.transit / 86400.0L);
+        dms transitLST = geo.GSTtoLST(transit.gst());
+        double ha = remainder(transitLST.radians() - p.ra().radians(), 2.0 * dms::PI);
+        QVERIFY(fabs(ha) < 1e-3);
+
+        for (int j = 0; j < qMin(result.intervalCount, int(VisibilityEngine::MAX_INTERVALS)); j++)
+        {
+            const VisibilityEngine::Interval &interval = result.intervals[j];
+            QVERIFY(interval.begin >= 0.0);
+            QVERIFY(interval.begin <= interval.end);
+            QVERIFY(interval.end <= duration);
+
+            KStarsDateTime middle(start.djd() + (interval.begin + interval.end) / 2.0 / 86400.0L);
+            dms LST = geo.GSTtoLST(middle.gst());
+            p.EquatorialToHorizontal(&LST, geo.lat());
+            QVERIFY(p.alt().Degrees() >= horizon - 0.05);
+        }
+    }
+}
+
+void TestVisibilityEngine::testInstant()
+{
+    KStarsDateTime start(EVENING_JD);
+    QVector<double> ra, dec;
+    createObjects(100, ra, dec);
+
+    VisibilityEngine engine;
+    engine.setPeriod(start, 0.0, &m_Geo);
+    QVector<VisibilityEngine::Result> results = engine.compute(ra, dec);
+
+    dms LST = m_Geo.GSTtoLST(start.gst());
+    for (int i = 0; i < ra.size(); i++)
+    {
+        SkyPoint p(dms(ra[i] * 180.0 / dms::PI), dms(dec[i] * 180.0 / dms::PI));
+        p.precessFromAnyEpoch(J2000, start.djd());
+        p.EquatorialToHorizontal(&LST, m_Geo.lat());
+
+        QVERIFY(fabs(results.at(i).maxAltitude - p.alt().Degrees()) < 0.01);
+        QVERIFY(fabs(results.at(i).minAltitude - p.alt().Degrees()) < 0.01);
+        QCOMPARE(results.at(i).aboveTime, 0.0);
+    }
+}
+
+void TestVisibilityEngine::testCancel()
+{
+    QVector<double> ra, dec;
+    createObjects(1000000, ra, dec);
+
+    VisibilityEngine engine;
+    engine.setPeriod(KStarsDateTime(EVENING_JD), 6 * 3600.0, &m_Geo);
+    QTimer::singleShot(0, &engine, SLOT(cancel()));
+    QVector<VisibilityEngine::Result> results = engine.compute(ra, dec);
+
+    QCOMPARE(results.size(), ra.size());
+
+    // A computation that was not canceled is complete
+    int valid = 0;
+    foreach (const VisibilityEngine::Result &result, results)
+        valid += result.valid ? 1 : 0;
+    if (engine.isCanceled())
+        QVERIFY(valid < ra.size());
+    else
+        QCOMPARE(valid, ra.size());
+}
+
+void TestVisibilityEngine::benchmarkNight_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("legacy, 10000 objects") << true << 10000;
+    QTest::newRow("engine, 10000 objects") << false << 10000;
+    QTest::newRow("legacy, 100000 objects") << true << 100000;
+    QTest::newRow("engine, 100000 objects") << false << 100000;
+    QTest::newRow("engine, 1000000 objects") << false << 1000000;
+}
+
+void TestVisibilityEngine::benchmarkNight()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, count);
+
+    QVector<double> ra, dec;
+    createObjects(count, ra, dec);
+
+    KStarsDateTime evening(EVENING_JD);
+    int visible = 0;
+
+    QBENCHMARK_ONCE
+    {
+        if (legacy)
+        {
+            // The hourly check of ObsListWizard, from 18:00 to midnight
+            for (int i = 0; i < count; i++)
+            {
+                SkyPoint p(dms(ra[i] * 180.0 / dms::PI), dms(dec[i] * 180.0 / dms::PI));
+                for (KStarsDateTime t = evening; t < evening.addSecs(6 * 3600.0); t = t.addSecs(3600.0))
+                {
+                    dms LST = m_Geo.GSTtoLST(t.gst());
+                    p.EquatorialToHorizontal(&LST, m_Geo.lat());
+                    if (p.alt().Degrees() >= 15.0)
+                    {
+                        ++visible;
+                        break;
+                    }
+                }
+            }
+        }
+        else
+        {
+            VisibilityEngine engine;
+            engine.setPeriod(evening, 6 * 3600.0, &m_Geo);
+            foreach (const VisibilityEngine::Result &result, engine.compute(ra, dec))
+                visible += result.reaches(15.0, 90.0) ? 1 : 0;
+        }
+    }
+
+    qDebug() << visible << "objects above 15 degrees";
+}
+
+QTEST_GUILESS_MAIN(TestVisibilityEngine)
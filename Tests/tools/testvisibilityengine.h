@@ -0,0 +1,46 @@
+/*  KStars Testing - Visibility engine
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTVISIBILITYENGINE_H
+#define TESTVISIBILITYENGINE_H
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include "geolocation.h"
+#include "visibilityengine.h"
+
+/**
+ * Checks VisibilityEngine against altitudes sampled every minute with
+ * SkyPoint, and benchmarks it against the hourly check ObsListWizard used.
+ */
+class TestVisibilityEngine: public QObject
+{
+  Q_OBJECT
+ public:
+
+  TestVisibilityEngine();
+  ~TestVisibilityEngine();
+
+ private slots:
+   void testAgainstSampling_data();
+   void testAgainstSampling();
+   void testInstant();
+   void testCancel();
+   void benchmarkNight_data();
+   void benchmarkNight();
+
+ private:
+   /** Objects spread over the whole sky, J2000 radians */
+   void createObjects(int count, QVector<double> &ra, QVector<double> &dec);
+
+   GeoLocation m_Geo;
+};
+
+#endif
@@ -31,6 +31,10 @@
 #include <QSqlRecord>
 #include <QSqlQuery>
 
+CatalogDB::CatalogDB() : fuzzy_query_(NULL), dso_query_(NULL),
+                         designation_query_(NULL) {
+}
+
 bool CatalogDB::Initialize() {
   skydb_ = QSqlDatabase::addDatabase("QSQLITE", "skydb");
   QString dbfile = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("skycomponents.sqlite"));
@@ -53,6 +57,14 @@ bool CatalogDB::Initialize() {
       if (first_run == true) {
           FirstRun();
       }
+      // Index on the position of the DSOs, so that FindFuzzyEntry() does not
+      // have to scan the whole table. Also added to databases created by
+      // older versions.
+      QSqlQuery index_query(skydb_);
+      if (!index_query.exec("CREATE INDEX IF NOT EXISTS DSO_Position "
+                            "ON DSO (Dec, RA)")) {
+          qDebug() << index_query.lastError();
+      }
   }
   skydb_.close();
   return true;
@@ -113,6 +125,7 @@ void CatalogDB::FirstRun() {
 
 
 CatalogDB::~CatalogDB() {
+  ClearEntryQueries();
   skydb_.close();
 }
 
@@ -241,6 +254,38 @@ void CatalogDB::ClearDSOEntries(int catalog_id) {
     skydb_.close();
 }
 
+void CatalogDB::PrepareEntryQueries() {
+  if (fuzzy_query_ != NULL)
+    return;
+
+  // The bounds are written as ranges on the columns themselves, so that
+  // SQLite can serve them from the DSO_Position index.
+  fuzzy_query_ = new QSqlQuery(skydb_);
+  fuzzy_query_->prepare("SELECT UID FROM DSO WHERE"
+                        " Dec BETWEEN :DecMin AND :DecMax AND"
+                        " RA BETWEEN :RAMin AND :RAMax AND"
+                        " Magnitude BETWEEN :MagMin AND :MagMax LIMIT 1");
+
+  dso_query_ = new QSqlQuery(skydb_);
+  dso_query_->prepare("INSERT INTO DSO (RA, Dec, Type, Magnitude, PositionAngle,"
+                      " MajorAxis, MinorAxis, Flux) VALUES (:RA, :Dec, :Type,"
+                      " :Magnitude, :PositionAngle, :MajorAxis, :MinorAxis,"
+                      " :Flux)");
+
+  designation_query_ = new QSqlQuery(skydb_);
+  designation_query_->prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
+                              ", IDNumber) VALUES (:catid, :rowuid, :longname, :id)");
+}
+
+void CatalogDB::ClearEntryQueries() {
+  delete fuzzy_query_;
+  delete dso_query_;
+  delete designation_query_;
+  fuzzy_query_ = NULL;
+  dso_query_ = NULL;
+  designation_query_ = NULL;
+}
+
 int CatalogDB::FindFuzzyEntry(const double ra, const double dec,
                               const double magnitude) {
   /*
@@ -248,27 +293,23 @@ int CatalogDB::FindFuzzyEntry(const double ra, const double dec,
    * with certain fuzz. If found, store it in rowuid
    * This Fuzz has not been established after due discussion
   */
-  //skydb_.open();
-  QSqlTableModel dsoentries(0, skydb_);
-
-  QString filter =
-    "((RA - " + QString().setNum(ra) + ") between -0.0016 and 0.0016) and "
-    "((Dec - " + QString().setNum(dec) + ") between -0.0016 and 0.0016) and"
-    "((Magnitude - " + QString().setNum(magnitude) + ") between -0.1 and 0.1)";
-//   qDebug() << filter;
-  dsoentries.setTable("DSO");
-  dsoentries.setFilter(filter);
-  dsoentries.select();
+  PrepareEntryQueries();
 
-  int entry_count = dsoentries.rowCount();
-  QSqlRecord record = dsoentries.record(0);
+  fuzzy_query_->bindValue(":DecMin", dec - 0.0016);
+  fuzzy_query_->bindValue(":DecMax", dec + 0.0016);
+  fuzzy_query_->bindValue(":RAMin", ra - 0.0016);
+  fuzzy_query_->bindValue(":RAMax", ra + 0.0016);
+  fuzzy_query_->bindValue(":MagMin", magnitude - 0.1);
+  fuzzy_query_->bindValue(":MagMax", magnitude + 0.1);
 
   int returnval = -1;
-  if (entry_count > 0)
-    returnval = record.value("UID").toInt();
+  if (!fuzzy_query_->exec()) {
+    qWarning() << fuzzy_query_->lastError();
+  } else if (fuzzy_query_->next()) {
+    returnval = fuzzy_query_->value(0).toInt();
+  }
 
-  dsoentries.clear();
-  //skydb_.close();
+  fuzzy_query_->finish();
 //   qDebug() << returnval;
   return returnval;
 }
@@ -280,6 +321,7 @@ bool CatalogDB::AddEntry(const CatalogEntryData& catalog_entry, int catid) {
         return false;
     }
     bool retVal = _AddEntry( catalog_entry, catid );
+    ClearEntryQueries();
     skydb_.close();
     return retVal;
 }
@@ -306,15 +348,12 @@ bool CatalogDB::_AddEntry(const CatalogEntryData& catalog_entry, int catid)
   // out the lastInsertId
 
   // Part 2: Fuzzy Match or Create New Entry
+  PrepareEntryQueries();
   int rowuid = FindFuzzyEntry(catalog_entry.ra, catalog_entry.dec, catalog_entry.magnitude);
   //skydb_.open();
 
   if ( rowuid == -1) { //i.e. No fuzzy match found. Proceed to add new entry
-    QSqlQuery add_query(skydb_);
-    add_query.prepare("INSERT INTO DSO (RA, Dec, Type, Magnitude, PositionAngle,"
-                      " MajorAxis, MinorAxis, Flux) VALUES (:RA, :Dec, :Type,"
-                      " :Magnitude, :PositionAngle, :MajorAxis, :MinorAxis,"
-                      " :Flux)");
+    QSqlQuery &add_query = *dso_query_;
     add_query.bindValue(":RA", catalog_entry.ra);
     add_query.bindValue(":Dec", catalog_entry.dec);
     add_query.bindValue(":Type", catalog_entry.type);
@@ -331,7 +370,7 @@ bool CatalogDB::_AddEntry(const CatalogEntryData& catalog_entry, int catid)
 
     // Find UID of the Row just added
     rowuid = add_query.lastInsertId().toInt();
-    add_query.clear();
+    add_query.finish();
   }
   int ID = catalog_entry.ID;
 
@@ -349,10 +388,9 @@ bool CatalogDB::_AddEntry(const CatalogEntryData& catalog_entry, int catid)
 
   // Part 3: Add in Object Designation
   //skydb_.open();
-  QSqlQuery add_od(skydb_);
+  QSqlQuery local_od(skydb_);
+  QSqlQuery &add_od = ( ID >= 0 ) ? *designation_query_ : local_od;
   if( ID >= 0 ) {
-      add_od.prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
-                     ", IDNumber) VALUES (:catid, :rowuid, :longname, :id)");
       add_od.bindValue(":id", ID);
   }
   else{
@@ -372,7 +410,7 @@ bool CatalogDB::_AddEntry(const CatalogEntryData& catalog_entry, int catid)
       qWarning() << skydb_.lastError();
       retVal = false;
   }
-  add_od.clear();
+  add_od.finish();
   //skydb_.close();
 
   return retVal;
@@ -449,48 +487,47 @@ bool CatalogDB::AddCatalogContents(const QString& fname) {
 
       /*
         * Now 'Columns' should be a StringList of the Header contents
-        * Hence, we 1) Convert the Columns to a KSParser compatible format
-        *           2) Use KSParser to read stuff and store in DB
+        * Hence, we 1) Convert the Columns to a KSStreamParser compatible format
+        *           2) Use KSStreamParser to read stuff and store in DB
         */
 
-      // Part 1) Conversion to KSParser compatible format
-      QList< QPair<QString, KSParser::DataTypes> > sequence =
+      // Part 1) Conversion to KSStreamParser compatible format
+      QVector< KSStreamParser::Column<CatalogRow> > sequence =
                                           buildParserSequence(columns);
 
       // Part 2) Read file and store into DB
-      KSParser catalog_text_parser(filename, '#', sequence, delimiter);
+      KSStreamParser catalog_text_parser(filename, '#');
 
       int catid = FindCatalog(catalog_name);
 
       skydb_.open();
       skydb_.transaction();
 
-      QHash<QString, QVariant> row_content;
-      while (catalog_text_parser.HasNextRow())
+      catalog_text_parser.readCSV(sequence.constData(), sequence.size(),
+                                  [&](const CatalogRow &row_content)
       {
-        row_content = catalog_text_parser.ReadNextRow();
-
         CatalogEntryData catalog_entry;
 
-        dms read_ra(row_content["RA"].toString(), false);
-        dms read_dec(row_content["Dc"].toString(), true);
-        //qDebug()<<row_content["Nm"].toString();
+        dms read_ra(row_content.ra.toString(), false);
+        dms read_dec(row_content.dec.toString(), true);
+        //qDebug()<<row_content.name.toString();
         catalog_entry.catalog_name = catalog_name;
-        catalog_entry.ID = row_content["ID"].toInt();
-        catalog_entry.long_name = row_content["Nm"].toString();
+        catalog_entry.ID = row_content.id.toInt();
+        catalog_entry.long_name = row_content.name.toString();
         catalog_entry.ra = read_ra.Degrees();
         catalog_entry.dec = read_dec.Degrees();
-        catalog_entry.type = row_content["Tp"].toInt();
-        catalog_entry.magnitude = row_content["Mg"].toFloat();
-        catalog_entry.position_angle = row_content["PA"].toFloat();
-        catalog_entry.major_axis = row_content["Mj"].toFloat();
-        catalog_entry.minor_axis = row_content["Mn"].toFloat();
-        catalog_entry.flux = row_content["Flux"].toFloat();
+        catalog_entry.type = row_content.type;
+        catalog_entry.magnitude = row_content.magnitude;
+        catalog_entry.position_angle = row_content.position_angle;
+        catalog_entry.major_axis = row_content.major_axis;
+        catalog_entry.minor_axis = row_content.minor_axis;
+        catalog_entry.flux = row_content.flux;
 
         _AddEntry(catalog_entry, catid);
-      }
+      }, delimiter);
 
       skydb_.commit();
+      ClearEntryQueries();
       skydb_.close();
   }
   return true;
@@ -861,39 +898,36 @@ void CatalogDB::GetAllObjects(const QString &catalog,
 }
 
 
-QList< QPair<QString, KSParser::DataTypes> > CatalogDB::
+QVector< KSStreamParser::Column<CatalogDB::CatalogRow> > CatalogDB::
                             buildParserSequence(const QStringList& Columns) {
-  QList< QPair<QString, KSParser::DataTypes> > sequence;
+  QVector< KSStreamParser::Column<CatalogRow> > sequence;
   QStringList::const_iterator iter = Columns.begin();
 
   while (iter != Columns.end()) {
   // Available Types: ID RA Dc Tp Nm Mg Flux Mj Mn PA Ig
-    KSParser::DataTypes current_type;
-
     if (*iter == QString("ID"))
-        current_type = KSParser::D_QSTRING;
+        sequence.append(KSStreamParser::column(&CatalogRow::id));
     else if (*iter == QString("RA"))
-        current_type = KSParser::D_QSTRING;
+        sequence.append(KSStreamParser::column(&CatalogRow::ra));
     else if (*iter == QString("Dc"))
-        current_type = KSParser::D_QSTRING;
+        sequence.append(KSStreamParser::column(&CatalogRow::dec));
     else if (*iter == QString("Tp"))
-        current_type = KSParser::D_INT;
+        sequence.append(KSStreamParser::column(&CatalogRow::type));
     else if (*iter == QString("Nm"))
-        current_type = KSParser::D_QSTRING;
+        sequence.append(KSStreamParser::column(&CatalogRow::name));
     else if (*iter == QString("Mg"))
-        current_type = KSParser::D_FLOAT;
+        sequence.append(KSStreamParser::column(&CatalogRow::magnitude));
     else if (*iter == QString("Flux"))
-        current_type = KSParser::D_FLOAT;
+        sequence.append(KSStreamParser::column(&CatalogRow::flux));
     else if (*iter == QString("Mj"))
-        current_type = KSParser::D_FLOAT;
+        sequence.append(KSStreamParser::column(&CatalogRow::major_axis));
     else if (*iter == QString("Mn"))
-        current_type = KSParser::D_FLOAT;
+        sequence.append(KSStreamParser::column(&CatalogRow::minor_axis));
     else if (*iter == QString("PA"))
-        current_type = KSParser::D_FLOAT;
-    else if (*iter == QString("Ig"))
-        current_type = KSParser::D_SKIP;
+        sequence.append(KSStreamParser::column(&CatalogRow::position_angle));
+    else  // Ig, and anything we do not know
+        sequence.append(KSStreamParser::skip<CatalogRow>());
 
-    sequence.append(qMakePair(*iter, current_type));
     ++iter;
   }
 
@@ -31,6 +31,7 @@
 #endif
 
 #include "ksparser.h"
+#include "ksstreamparser.h"
 
 #include <QString>
 #include <QStringList>
@@ -53,6 +54,10 @@ class CatalogEntryData;
 
 class CatalogDB {
  public:
+   /**
+    * @brief Constructor. The database is set up by Initialize()
+    **/
+   CatalogDB();
    /**
     * @brief Initializes the database and sets up pointers to Catalog DB
     * Performs the following actions:
@@ -105,6 +110,10 @@ class CatalogDB {
    * @brief returns the id of the row if it matches with certain fuzz.
    * Else return -1 if none found
    *
+   * @note The candidates come from the DSO_Position index with a prepared
+   * statement, so this method is cheap enough to be called for every row
+   * of a catalog import. The database must be open.
+   *
    * @param ra Right Ascension of new object to be added
    * @param dec Declination of new object to be added
    * @return int RowUID of the new row
@@ -195,6 +204,30 @@ class CatalogDB {
    **/
   bool _AddEntry(const CatalogEntryData &catalog_entry, int catid);
 
+  /**
+   * @brief Prepares the statements used for every imported entry, unless
+   * they are prepared already. The database must be open.
+   *
+   * @return void
+   **/
+  void PrepareEntryQueries();
+
+  /**
+   * @brief Releases the prepared statements. Must be called before the
+   * database is closed.
+   *
+   * @return void
+   **/
+  void ClearEntryQueries();
+
+  /**
+   * @brief Prepared statements for FindFuzzyEntry() and _AddEntry(),
+   * reused across the rows of an import. NULL while not prepared.
+   **/
+  QSqlQuery *fuzzy_query_;
+  QSqlQuery *dso_query_;
+  QSqlQuery *designation_query_;
+
   /**
    * @brief Database object for the sky object. Assigned and Initialized by
    *        Initialize()
@@ -229,13 +262,23 @@ class CatalogDB {
                             QString &catalog_name, char &delimiter);
 
   /**
-   * @brief Prepares the sequence required by KSParser according to header.
-   * Information on the sequence is stored inside the header
+   * @brief One row of a catalog file, as read by KSStreamParser. Columns
+   * that are not in the file are left empty or 0.
+   **/
+  struct CatalogRow {
+      KSStreamParser::Field id, ra, dec, name;
+      int type;
+      float magnitude, flux, major_axis, minor_axis, position_angle;
+  };
+
+  /**
+   * @brief Prepares the schema required by KSStreamParser according to header.
+   * Information on the schema is stored inside the header
    *
    * @param Columns List of the columns names as strings
-   * @return QList of the format usable by KSParser
+   * @return Columns of the format usable by KSStreamParser
    **/
-  QList< QPair< QString, KSParser::DataTypes > >
+  QVector< KSStreamParser::Column<CatalogRow> >
                               buildParserSequence(const QStringList& Columns);
   /**
    * @brief Clears out the DSO table for the given catalog ID
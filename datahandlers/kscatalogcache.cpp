@@ -0,0 +1,236 @@
+/***************************************************************************
+                 kscatalogcache.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "kscatalogcache.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "auxiliary/kspaths.h"
+
+// Size of the header text of the binary file format
+#define HEADER_TEXT_SIZE 124
+
+// Endianness marker of the binary file format, "KS"
+#define ENDIAN_ID 0x4B53
+
+KSCatalogCache::KSCatalogCache(const QString &filename, char comment_char)
+    : m_FileName(filename), m_CacheFileName(cacheFileName(filename)), m_CommentChar(comment_char),
+      m_SourceRead(false), m_SourceSize(0), m_Checksum(0), m_Cached(false) {
+}
+
+KSCatalogCache::~KSCatalogCache() {
+}
+
+QString KSCatalogCache::cacheFileName(const QString &filename) {
+    return KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QFileInfo(filename).fileName() + ".cache";
+}
+
+void KSCatalogCache::remove(const QString &filename) {
+    QFile::remove(cacheFileName(filename));
+}
+
+quint64 KSCatalogCache::checksum(const char *data, qint64 size) {
+    // FNV-1a over 64 bit words. Every step is a bijection of both the
+    // hash and the word, so any change of a single word changes the
+    // result, which is all a cache needs.
+    const quint64 prime = Q_UINT64_C(1099511628211);
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    qint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ uchar(data[i])) * prime;
+    return hash ^ quint64(size);
+}
+
+KSStreamParser &KSCatalogCache::parser() {
+    if (!m_Parser)
+        m_Parser.reset(new KSStreamParser(m_FileName, m_CommentChar));
+    return *m_Parser;
+}
+
+QString KSCatalogCache::headerText(int record_size) const {
+    return QString("KStars catalog cache of %1 (%2 bytes, checksum %3), %4 byte rows")
+        .arg(QFileInfo(m_FileName).fileName().left(40))
+        .arg(m_SourceSize)
+        .arg(m_Checksum, 16, 16, QChar('0'))
+        .arg(record_size);
+}
+
+dataElement KSCatalogCache::fieldDescriptor(const Slot &slot, int index) {
+    dataElement field;
+    memset(&field, 0, sizeof(field));
+    qsnprintf(field.name, sizeof(field.name), "f%d", index);
+    field.size = slot.size;
+    // Floating point numbers are stored as their raw bytes, and strings
+    // as an (offset, length) pair into the string area
+    switch (slot.type) {
+        case KSParser::D_INT:
+            field.type = BinFileHelper::DT_INT32;
+            break;
+        case KSParser::D_QSTRING:
+            field.type = BinFileHelper::DT_SPCL | BinFileHelper::DT_STR;
+            break;
+        default:
+            field.type = BinFileHelper::DT_SPCL | BinFileHelper::DT_CHARV;
+            break;
+    }
+    field.scale = slot.offset;
+    return field;
+}
+
+const char *KSCatalogCache::openCache(const QVector<Slot> &layout, int record_size, int &count) {
+    m_Cached = false;
+    count = 0;
+
+    if (!m_SourceRead) {
+        QFile source(m_FileName);
+        if (!source.open(QIODevice::ReadOnly))
+            return NULL;
+        m_SourceSize = source.size();
+        const uchar *map = (m_SourceSize > 0) ? source.map(0, m_SourceSize) : 0;
+        if (map) {
+            m_Checksum = checksum(reinterpret_cast<const char *>(map), m_SourceSize);
+            source.unmap(const_cast<uchar *>(map));
+        } else {
+            QByteArray contents = source.readAll();
+            m_Checksum = checksum(contents.constData(), contents.size());
+        }
+        m_SourceRead = true;
+    }
+
+    if (!QFile::exists(m_CacheFileName) || !m_Cache.openFile(m_CacheFileName))
+        return NULL;
+
+    m_Cache.setRecordSize(record_size);
+    bool valid = m_Cache.readHeader() && !m_Cache.getByteSwap()
+                 && m_Cache.getVersion() == FORMAT_VERSION
+                 && m_Cache.getHeaderText() == headerText(record_size)
+                 && m_Cache.getFieldCount() == layout.size();
+    for (int i = 0; valid && i < layout.size(); ++i) {
+        dataElement expected = fieldDescriptor(layout.at(i), i);
+        QString name(expected.name);
+        if (!m_Cache.isField(name)) {
+            valid = false;
+            break;
+        }
+        dataElement field = m_Cache.getField(name);
+        valid = field.size == expected.size && field.type == expected.type && field.scale == expected.scale;
+    }
+
+    const char *records = NULL;
+    if (valid && m_Cache.mapFile())
+        records = m_Cache.getRecords(0);
+    if (!records) {
+        qDebug() << "Rebuilding the catalog cache" << m_CacheFileName;
+        m_Cache.closeFile();
+        return NULL;
+    }
+    count = m_Cache.getRecordCount(0);
+    return records;
+}
+
+bool KSCatalogCache::resolveStrings(const QVector<Slot> &layout, int record_size, char *records, int count) const {
+    const char *strings = m_Cache.getRecords(0) + qint64(count) * record_size;
+    const qint64 stringsSize = m_Cache.getMappedData() + m_Cache.getMappedSize() - strings;
+
+    for (int i = 0; i < count; ++i) {
+        char *record = records + qint64(i) * record_size;
+        foreach (const Slot &slot, layout) {
+            if (slot.type != KSParser::D_QSTRING)
+                continue;
+            quint32 location[2];
+            memcpy(location, record + slot.offset, sizeof(location));
+            if (qint64(location[0]) + location[1] > stringsSize)
+                return false;
+            KSStreamParser::Field field(strings + location[0], strings + location[0] + location[1]);
+            memcpy(record + slot.offset, &field, sizeof(field));
+        }
+    }
+    return true;
+}
+
+void KSCatalogCache::writeCache(const QVector<Slot> &layout, int record_size, const char *records, int count) const {
+    static_assert(sizeof(KSStreamParser::Field) >= 2 * sizeof(quint32), "A string field must hold its location");
+
+    if (!m_SourceRead)
+        return;
+
+    QDir().mkpath(QFileInfo(m_CacheFileName).path());
+    QSaveFile file(m_CacheFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write catalog cache" << m_CacheFileName;
+        return;
+    }
+
+    // Preamble
+    QByteArray text(HEADER_TEXT_SIZE, '\0');
+    QByteArray header = headerText(record_size).toLatin1().left(HEADER_TEXT_SIZE - 1);
+    memcpy(text.data(), header.constData(), header.size());
+    file.write(text);
+    qint16 endian_id = ENDIAN_ID;
+    file.write(reinterpret_cast<const char *>(&endian_id), sizeof(endian_id));
+    quint8 version = FORMAT_VERSION;
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+
+    // Field descriptor
+    qint16 nfields = layout.size();
+    file.write(reinterpret_cast<const char *>(&nfields), sizeof(nfields));
+    for (int i = 0; i < layout.size(); ++i) {
+        dataElement field = fieldDescriptor(layout.at(i), i);
+        file.write(reinterpret_cast<const char *>(&field), sizeof(field));
+    }
+
+    // Index table, with a single entry holding all rows
+    quint32 index[4];
+    index[0] = 1;
+    index[1] = 0;
+    index[2] = file.pos() + sizeof(index);
+    index[3] = count;
+    file.write(reinterpret_cast<const char *>(index), sizeof(index));
+
+    // Rows, with the string fields replaced by their place in the string area
+    QByteArray row(record_size, '\0');
+    QByteArray strings;
+    for (int i = 0; i < count; ++i) {
+        const char *record = records + qint64(i) * record_size;
+        row.fill('\0');
+        foreach (const Slot &slot, layout) {
+            if (slot.type == KSParser::D_QSTRING) {
+                const KSStreamParser::Field *field = reinterpret_cast<const KSStreamParser::Field *>(record + slot.offset);
+                quint32 location[2] = { quint32(strings.size()), quint32(field->size()) };
+                strings.append(field->begin(), field->size());
+                memcpy(row.data() + slot.offset, location, sizeof(location));
+            } else {
+                memcpy(row.data() + slot.offset, record + slot.offset, slot.size);
+            }
+        }
+        file.write(row);
+    }
+    file.write(strings);
+
+    if (!file.commit())
+        qWarning() << "Unable to write catalog cache" << m_CacheFileName;
+}
@@ -0,0 +1,236 @@
+/***************************************************************************
+                 kscatalogcache.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef KSTARS_KSCATALOGCACHE_H
+#define KSTARS_KSCATALOGCACHE_H
+
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+
+#include <cstring>
+
+#include "binfilehelper.h"
+#include "ksstreamparser.h"
+
+/**
+ * @brief Binary cache of the rows of a text catalog.
+ *
+ * Parsing ngcic.dat, asteroids.dat or comets.dat is the same work on
+ * every start of KStars, although the files only change when they are
+ * updated. KSCatalogCache reads a text catalog with KSStreamParser once,
+ * and saves the parsed rows to a binary file in the cache directory.
+ * Later loads map that file and copy the rows out of it, without
+ * looking at the text at all:
+ *
+ * KSCatalogCache catalog(filename, '#');
+ * QVector<Row> rows = catalog.readAllCSV(columns);
+ *
+ * The rows are the same as KSStreamParser::readAllCSV() would return.
+ * String fields point into the cache file or the text file, and stay
+ * valid as long as the KSCatalogCache exists.
+ *
+ * The cache file has the format of the binary star catalogs (see
+ * BinFileHelper), so it can be inspected with the same tools:
+ *
+ * @li The header text names the source file, its size and a 64 bit
+ * checksum of its contents, and the size of a row. The cache is only
+ * used if all of them match the current source file, so an updated
+ * catalog (e.g. by AsteroidsComponent::updateDataFile()) or a changed
+ * Record type rebuild it on the next load.
+ * @li The version byte is FORMAT_VERSION.
+ * @li The field descriptor has one entry per stored column. The scale of
+ * an entry is the offset of the column in the row. It has to match the
+ * columns the cache is read with.
+ * @li A single index entry holds all rows, as the bytes of the Record
+ * structs. A string field is stored as two quint32, the offset and
+ * length of the string in the string area.
+ * @li The string area, the UTF-8 text of all string fields, fills the
+ * rest of the file.
+ *
+ * The rows are stored in the byte order and struct layout of the
+ * machine, as a cache should. A cache file from another machine is
+ * ignored and rebuilt.
+ *
+ * @note Record must be a plain struct of int, float, double and
+ * KSStreamParser::Field members, which can be copied with memcpy.
+ **/
+class KSCatalogCache {
+ public:
+    /** Version of the cache file format, to be increased on every change */
+    static const quint8 FORMAT_VERSION = 1;
+
+    /**
+     * @brief Prepare to read the given text catalog
+     * @param filename Full Path (Dir + Filename) of source file
+     * @param comment_char lines starting with this character are skipped
+     **/
+    explicit KSCatalogCache(const QString &filename, char comment_char = '#');
+
+    ~KSCatalogCache();
+
+    /**
+     * @brief Read all rows of a CSV file, from the cache if it is valid.
+     * @see KSStreamParser::readAllCSV()
+     **/
+    template <typename Record, int N>
+    QVector<Record> readAllCSV(const KSStreamParser::Column<Record> (&columns)[N], char delimiter = ',') {
+        QVector<Record> rows;
+        QVector<Slot> layout = slotsOf(columns, N);
+        if (load(layout, rows))
+            return rows;
+        rows = parser().readAllCSV(columns, delimiter);
+        save(layout, rows);
+        return rows;
+    }
+
+    /**
+     * @brief Read all rows of a fixed width file, from the cache if it is valid.
+     * @see KSStreamParser::readAllFixedWidth()
+     **/
+    template <typename Record, int N>
+    QVector<Record> readAllFixedWidth(const KSStreamParser::Column<Record> (&columns)[N]) {
+        QVector<Record> rows;
+        QVector<Slot> layout = slotsOf(columns, N);
+        if (load(layout, rows))
+            return rows;
+        rows = parser().readAllFixedWidth(columns);
+        save(layout, rows);
+        return rows;
+    }
+
+    /** @return true if the last read came from the cache file */
+    inline bool isCached() const { return m_Cached; }
+
+    /** @return the path of the cache file of the given text catalog */
+    static QString cacheFileName(const QString &filename);
+
+    /**
+     * @brief Delete the cache file of the given text catalog, so that
+     * the next load parses the text again.
+     **/
+    static void remove(const QString &filename);
+
+    /** @return the 64 bit checksum of the given bytes, as used in the cache header */
+    static quint64 checksum(const char *data, qint64 size);
+
+ private:
+    /** Where and how a column is stored in a Record */
+    struct Slot {
+        KSParser::DataTypes type;
+        int offset;
+        int size;
+    };
+
+    template <typename Record>
+    static QVector<Slot> slotsOf(const KSStreamParser::Column<Record> *columns, int count) {
+        Record row = Record();
+        const char *base = reinterpret_cast<const char *>(&row);
+        QVector<Slot> layout;
+        for (int i = 0; i < count; ++i) {
+            const KSStreamParser::Column<Record> &column = columns[i];
+            Slot slot = { column.type, 0, 0 };
+            switch (column.type) {
+                case KSParser::D_INT:
+                    slot.offset = reinterpret_cast<const char *>(&(row.*column.intMember)) - base;
+                    slot.size = sizeof(int);
+                    break;
+                case KSParser::D_FLOAT:
+                    slot.offset = reinterpret_cast<const char *>(&(row.*column.floatMember)) - base;
+                    slot.size = sizeof(float);
+                    break;
+                case KSParser::D_DOUBLE:
+                    slot.offset = reinterpret_cast<const char *>(&(row.*column.doubleMember)) - base;
+                    slot.size = sizeof(double);
+                    break;
+                case KSParser::D_QSTRING:
+                    slot.offset = reinterpret_cast<const char *>(&(row.*column.fieldMember)) - base;
+                    slot.size = sizeof(KSStreamParser::Field);
+                    break;
+                default:
+                    continue;
+            }
+            layout.append(slot);
+        }
+        return layout;
+    }
+
+    template <typename Record>
+    bool load(const QVector<Slot> &layout, QVector<Record> &rows) {
+        int count;
+        const char *records = openCache(layout, sizeof(Record), count);
+        if (!records)
+            return false;
+        rows.resize(count);
+        if (count > 0) {
+            char *data = reinterpret_cast<char *>(rows.data());
+            memcpy(data, records, size_t(count) * sizeof(Record));
+            if (!resolveStrings(layout, sizeof(Record), data, count)) {
+                rows.clear();
+                m_Cache.closeFile();
+                return false;
+            }
+        }
+        m_Cached = true;
+        return true;
+    }
+
+    template <typename Record>
+    void save(const QVector<Slot> &layout, const QVector<Record> &rows) {
+        m_Cached = false;
+        writeCache(layout, sizeof(Record), reinterpret_cast<const char *>(rows.constData()), rows.size());
+    }
+
+    /**
+     * @brief Check the cache file against the source file and the
+     * layout, and map it.
+     * @return the first row in the mapping, or NULL if the cache file
+     * is missing or out of date
+     **/
+    const char *openCache(const QVector<Slot> &layout, int record_size, int &count);
+
+    /**
+     * @brief Turn the (offset, length) pairs of the string fields of the
+     * given rows into Field objects pointing into the string area.
+     * @return false if a string lies outside of the string area
+     **/
+    bool resolveStrings(const QVector<Slot> &layout, int record_size, char *records, int count) const;
+
+    /** @brief Write the given rows to the cache file */
+    void writeCache(const QVector<Slot> &layout, int record_size, const char *records, int count) const;
+
+    /** @return the header text that a valid cache file has */
+    QString headerText(int record_size) const;
+
+    /** @return the field descriptor entry of the given column */
+    static dataElement fieldDescriptor(const Slot &slot, int index);
+
+    /** @return the parser of the text file, created on first use */
+    KSStreamParser &parser();
+
+    QString m_FileName;
+    QString m_CacheFileName;
+    char m_CommentChar;
+    bool m_SourceRead;          // True once m_SourceSize and m_Checksum are set
+    qint64 m_SourceSize;
+    quint64 m_Checksum;
+    bool m_Cached;
+    BinFileHelper m_Cache;      // Owns the mapping the string fields point into
+    QScopedPointer<KSStreamParser> m_Parser;
+};
+
+#endif  // KSTARS_KSCATALOGCACHE_H
@@ -0,0 +1,256 @@
+/***************************************************************************
+                 ksstreamparser.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ksstreamparser.h"
+
+#include <QDebug>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <climits>
+
+// Below this many bytes per range, handing a range to the thread pool
+// costs more than parsing it.
+#define MIN_BYTES_PER_RANGE 65536
+
+// Number of ranges per worker thread, to even out the load
+#define RANGES_PER_THREAD 2
+
+// Powers of ten that are exact in double precision
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+KSStreamParser::Field KSStreamParser::Field::trimmed() const {
+    const char *begin = m_Begin, *end = m_End;
+    while (begin < end && isSpace(*begin))
+        ++begin;
+    while (end > begin && isSpace(end[-1]))
+        --end;
+    return Field(begin, end);
+}
+
+bool KSStreamParser::Field::operator==(const char *s) const {
+    int length = strlen(s);
+    return length == size() && memcmp(m_Begin, s, length) == 0;
+}
+
+int KSStreamParser::Field::toInt(bool *ok) const {
+    Field field = trimmed();
+    const char *p = field.begin(), *end = field.end();
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    // An int has at most 10 digits
+    if (p == end || end - p > 10) {
+        if (ok) *ok = false;
+        return KSParser::EBROKEN_INT;
+    }
+
+    qint64 value = 0;
+    for (; p < end; ++p) {
+        if (*p < '0' || *p > '9') {
+            if (ok) *ok = false;
+            return KSParser::EBROKEN_INT;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    if (negative)
+        value = -value;
+    if (value < INT_MIN || value > INT_MAX) {
+        if (ok) *ok = false;
+        return KSParser::EBROKEN_INT;
+    }
+    if (ok) *ok = true;
+    return int(value);
+}
+
+double KSStreamParser::Field::toDouble(bool *ok) const {
+    Field field = trimmed();
+    const char *p = field.begin(), *end = field.end();
+    if (p == end) {
+        if (ok) *ok = false;
+        return KSParser::EBROKEN_DOUBLE;
+    }
+
+    // Fast path for plain decimal numbers with up to 15 significant
+    // digits and a small exponent, where both the mantissa and the
+    // power of ten are exact doubles and a single rounding gives the
+    // correctly rounded result.
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        ++p;
+    }
+    quint64 mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool hasDigits = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        hasDigits = true;
+        if (mantissa || *p != '0') {
+            mantissa = mantissa * 10 + (*p - '0');
+            ++digits;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            hasDigits = true;
+            if (mantissa || *p != '0') {
+                mantissa = mantissa * 10 + (*p - '0');
+                ++digits;
+            }
+            --exponent;
+        }
+    }
+    if (hasDigits && p < end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExponent = (*e == '-');
+            ++e;
+        }
+        int value = 0;
+        const char *digitsBegin = e;
+        for (; e < end && *e >= '0' && *e <= '9' && e - digitsBegin < 4; ++e)
+            value = value * 10 + (*e - '0');
+        if (e > digitsBegin) {
+            exponent += negativeExponent ? -value : value;
+            p = e;
+        }
+    }
+    if (hasDigits && p == end && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double value = double(mantissa);
+        value = (exponent < 0) ? value / exactPowersOfTen[-exponent] : value * exactPowersOfTen[exponent];
+        if (ok) *ok = true;
+        return negative ? -value : value;
+    }
+
+    // Everything else (long mantissas, large exponents, inf and nan,
+    // and malformed numbers) goes through Qt
+    bool converted;
+    double value = QByteArray(field.begin(), field.size()).toDouble(&converted);
+    if (ok) *ok = converted;
+    return converted ? value : KSParser::EBROKEN_DOUBLE;
+}
+
+KSStreamParser::KSStreamParser(const QString &filename, char comment_char)
+    : m_File(filename), m_Begin(0), m_End(0), m_CommentChar(comment_char) {
+    if (!m_File.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open file: " << filename;
+        return;
+    }
+
+    qint64 size = m_File.size();
+    const uchar *map = (size > 0) ? m_File.map(0, size) : 0;
+    if (map) {
+        m_Begin = reinterpret_cast<const char *>(map);
+        m_End = m_Begin + size;
+    } else {
+        m_Buffer = m_File.readAll();
+        m_Begin = m_Buffer.constData();
+        m_End = m_Begin + m_Buffer.size();
+    }
+}
+
+KSStreamParser::~KSStreamParser() {
+    m_File.close();
+}
+
+int KSStreamParser::splitCSV(const Field &line, char delimiter, Field *fields, int max_fields) {
+    const char *p = line.begin(), *end = line.end();
+    int count = 0;
+    while (true) {
+        const char *fieldBegin = p, *fieldEnd, *next;
+        if (p < end && *p == '"') {
+            // Like KSParser::CombineQuoteParts(), a quoted field extends over
+            // the parts between delimiters up to the first one that ends
+            // with a quote mark or is empty
+            fieldBegin = p + 1;
+            const char *part = fieldBegin;
+            while (true) {
+                next = static_cast<const char *>(memchr(part, delimiter, end - part));
+                if (!next)
+                    next = end;
+                if (next == part || next[-1] == '"') {
+                    fieldEnd = (next == part) ? next : next - 1;
+                    break;
+                }
+                if (next == end) {
+                    fieldEnd = end;
+                    break;
+                }
+                part = next + 1;
+            }
+        } else {
+            next = static_cast<const char *>(memchr(p, delimiter, end - p));
+            if (!next)
+                next = end;
+            fieldEnd = next;
+        }
+
+        if (count == max_fields)
+            return max_fields + 1;
+        fields[count++] = Field(fieldBegin, fieldEnd);
+
+        if (next >= end)
+            break;
+        p = next + 1;
+    }
+    return count;
+}
+
+QVector<KSStreamParser::Field> KSStreamParser::splitRanges() const {
+    QVector<Field> ranges;
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    qint64 rangeSize = size() / qMax(1, nThreads * RANGES_PER_THREAD) + 1;
+    if (rangeSize < MIN_BYTES_PER_RANGE)
+        rangeSize = MIN_BYTES_PER_RANGE;
+
+    // Move every boundary past the end of the line it falls into
+    const char *begin = m_Begin;
+    while (begin < m_End) {
+        const char *end = m_End;
+        if (m_End - begin > rangeSize) {
+            end = static_cast<const char *>(memchr(begin + rangeSize, '\n', m_End - begin - rangeSize));
+            end = end ? end + 1 : m_End;
+        }
+        ranges.append(Field(begin, end));
+        begin = end;
+    }
+    return ranges;
+}
+
+void KSStreamParser::runRanges(const QVector<Field> &ranges, const std::function<void(int)> &task) {
+    if (ranges.size() <= 1 || QThreadPool::globalInstance()->maxThreadCount() <= 1) {
+        for (int i = 0; i < ranges.size(); ++i)
+            task(i);
+        return;
+    }
+
+    QVector<int> indices(ranges.size());
+    for (int i = 0; i < indices.size(); ++i)
+        indices[i] = i;
+    QtConcurrent::blockingMap(indices, [&task](int &i) { task(i); });
+}
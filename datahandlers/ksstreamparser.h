@@ -0,0 +1,367 @@
+/***************************************************************************
+                  ksstreamparser.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef KSTARS_KSSTREAMPARSER_H
+#define KSTARS_KSSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include <cstring>
+#include <functional>
+
+#include "ksparser.h"
+
+/**
+ * @brief Streaming parser for the CSV and fixed width text files of KStars.
+ *
+ * KSStreamParser reads the same files as KSParser, with the same rules
+ * (comment lines, skipped incomplete rows, quoted CSV fields, 0 for
+ * numbers that cannot be converted), but instead of building a
+ * QHash< QString, QVariant > for every row it writes the fields straight
+ * into the members of a plain struct. The layout of the file is given by
+ * an array of Column, one per field of a row:
+ *
+ * struct Row { KSStreamParser::Field name; int id; double ra; };
+ * static const KSStreamParser::Column<Row> columns[] = {
+ *     KSStreamParser::column(&Row::name),
+ *     KSStreamParser::skip<Row>(),
+ *     KSStreamParser::column(&Row::id),
+ *     KSStreamParser::column(&Row::ra)
+ * };
+ *
+ * KSStreamParser parser(filename, '#');
+ * parser.readCSV(columns, [&](const Row &row) { ... });
+ *
+ * The Column constructors are constexpr, so such a schema is set up at
+ * compile time and the type of each field follows from the type of the
+ * member it goes to.
+ *
+ * The file is mapped into memory and never copied: string fields are
+ * Field objects pointing into the file, which stay valid as long as the
+ * parser exists, and are only turned into a QString (with
+ * Field::toString()) when needed. Reading a row allocates nothing.
+ *
+ * readAllCSV() and readAllFixedWidth() parse large files on several
+ * threads, each thread taking a range of whole lines, and return the
+ * rows in file order.
+ *
+ * @note Fixed widths are counted in bytes. The files are read as UTF-8,
+ * so columns after one with non ASCII characters would be shifted; all
+ * KStars fixed width files only have such characters in the last column.
+ **/
+class KSStreamParser {
+ public:
+    /**
+     * @brief A part of a line of the file. This is a view: it does not
+     * own the characters, and is cheap to copy.
+     **/
+    class Field {
+     public:
+        Field() : m_Begin(0), m_End(0) {}
+        Field(const char *begin, const char *end) : m_Begin(begin), m_End(end) {}
+
+        inline const char *begin() const { return m_Begin; }
+        inline const char *end() const { return m_End; }
+        inline int size() const { return m_End - m_Begin; }
+        inline bool isEmpty() const { return m_End == m_Begin; }
+        inline char at(int i) const { return m_Begin[i]; }
+
+        /** @return the field without leading and trailing white space */
+        Field trimmed() const;
+
+        /** @return true if the field is exactly the given Latin-1 string */
+        bool operator==(const char *s) const;
+        inline bool operator!=(const char *s) const { return !(*this == s); }
+
+        /**
+         * @return the field converted to an integer, ignoring surrounding
+         * white space, or KSParser::EBROKEN_INT if it is not an integer
+         **/
+        int toInt(bool *ok = 0) const;
+
+        /**
+         * @return the field converted to a double, ignoring surrounding
+         * white space, or KSParser::EBROKEN_DOUBLE if it is not a number.
+         * The result is identical to QString::toDouble().
+         **/
+        double toDouble(bool *ok = 0) const;
+
+        /** @return the field converted to a float, see toDouble() */
+        inline float toFloat(bool *ok = 0) const { return float(toDouble(ok)); }
+
+        /** @return a copy of the field, decoded from UTF-8 */
+        inline QString toString() const { return QString::fromUtf8(m_Begin, size()); }
+
+     private:
+        const char *m_Begin;
+        const char *m_End;
+    };
+
+    /**
+     * @brief Description of one field of a row: its type, the member of
+     * Record it is stored into, and for fixed width files its width.
+     * Use column() and skip() to build one.
+     **/
+    template <typename Record>
+    struct Column {
+        KSParser::DataTypes type;
+        int width;              // Width in bytes, for fixed width files. Ignored for the last column
+        int Record::*intMember;
+        float Record::*floatMember;
+        double Record::*doubleMember;
+        Field Record::*fieldMember;
+    };
+
+    static constexpr int NO_WIDTH = 0;
+
+    template <typename Record>
+    static constexpr Column<Record> column(int Record::*member, int width = NO_WIDTH) {
+        return Column<Record> { KSParser::D_INT, width, member, 0, 0, 0 };
+    }
+    template <typename Record>
+    static constexpr Column<Record> column(float Record::*member, int width = NO_WIDTH) {
+        return Column<Record> { KSParser::D_FLOAT, width, 0, member, 0, 0 };
+    }
+    template <typename Record>
+    static constexpr Column<Record> column(double Record::*member, int width = NO_WIDTH) {
+        return Column<Record> { KSParser::D_DOUBLE, width, 0, 0, member, 0 };
+    }
+    template <typename Record>
+    static constexpr Column<Record> column(Field Record::*member, int width = NO_WIDTH) {
+        return Column<Record> { KSParser::D_QSTRING, width, 0, 0, 0, member };
+    }
+    /** @return a column that is not stored anywhere */
+    template <typename Record>
+    static constexpr Column<Record> skip(int width = NO_WIDTH) {
+        return Column<Record> { KSParser::D_SKIP, width, 0, 0, 0, 0 };
+    }
+
+    /** The most fields a CSV row may have */
+    static const int MAX_FIELDS = 64;
+
+    /**
+     * @brief Open the given file
+     * @param filename Full Path (Dir + Filename) of source file
+     * @param comment_char lines starting with this character are skipped
+     **/
+    explicit KSStreamParser(const QString &filename, char comment_char = '#');
+
+    ~KSStreamParser();
+
+    /** @return true if the file could be opened */
+    inline bool isOpen() const { return m_Begin != 0; }
+
+    /** @return the size of the file in bytes */
+    inline qint64 size() const { return m_End - m_Begin; }
+
+    /**
+     * @brief Read every row of a CSV file, and call callback with it.
+     *
+     * Rows whose number of fields differs from the number of columns are
+     * skipped. A field starting with a quote mark extends to the first
+     * quote mark followed by the delimiter (or to the first empty field),
+     * and the quote marks are removed. Fields are not trimmed.
+     *
+     * @param columns the schema of the rows
+     * @param callback called with a const Record & for every row, in order
+     * @param delimiter the field separator
+     * @return the number of rows read
+     **/
+    template <typename Record, typename Callback>
+    int readCSV(const Column<Record> *columns, int count, Callback callback, char delimiter = ',') const {
+        return readCSV(m_Begin, m_End, columns, count, callback, delimiter);
+    }
+    template <typename Record, int N, typename Callback>
+    int readCSV(const Column<Record> (&columns)[N], Callback callback, char delimiter = ',') const {
+        return readCSV(m_Begin, m_End, columns, N, callback, delimiter);
+    }
+
+    /**
+     * @brief Read every row of a fixed width file, and call callback with it.
+     *
+     * The last column extends to the end of the line, and rows that are
+     * shorter than the widths of the other columns are skipped. All
+     * fields are trimmed.
+     *
+     * @param columns the schema of the rows
+     * @param callback called with a const Record & for every row, in order
+     * @return the number of rows read
+     **/
+    template <typename Record, typename Callback>
+    int readFixedWidth(const Column<Record> *columns, int count, Callback callback) const {
+        return readFixedWidth(m_Begin, m_End, columns, count, callback);
+    }
+    template <typename Record, int N, typename Callback>
+    int readFixedWidth(const Column<Record> (&columns)[N], Callback callback) const {
+        return readFixedWidth(m_Begin, m_End, columns, N, callback);
+    }
+
+    /**
+     * @brief Read all rows of a CSV file on several threads.
+     * @see readCSV()
+     **/
+    template <typename Record, int N>
+    QVector<Record> readAllCSV(const Column<Record> (&columns)[N], char delimiter = ',') const {
+        return readAll<Record>( [&](const char *begin, const char *end, QVector<Record> &rows) {
+            readCSV(begin, end, columns, N, [&rows](const Record &row) { rows.append(row); }, delimiter);
+        } );
+    }
+
+    /**
+     * @brief Read all rows of a fixed width file on several threads.
+     * @see readFixedWidth()
+     **/
+    template <typename Record, int N>
+    QVector<Record> readAllFixedWidth(const Column<Record> (&columns)[N]) const {
+        return readAll<Record>( [&](const char *begin, const char *end, QVector<Record> &rows) {
+            readFixedWidth(begin, end, columns, N, [&rows](const Record &row) { rows.append(row); });
+        } );
+    }
+
+ private:
+    /**
+     * @brief Find the next line in [pos, end) that is neither empty nor a
+     * comment, and advance pos past it.
+     * @return false if there are no more lines
+     **/
+    inline bool nextLine(const char *&pos, const char *end, Field &line) const {
+        while (pos < end) {
+            const char *lineBegin = pos;
+            const char *lineEnd = static_cast<const char *>(memchr(pos, '\n', end - pos));
+            if (!lineEnd)
+                lineEnd = end;
+            pos = lineEnd + 1;
+            if (lineEnd > lineBegin && lineEnd[-1] == '\r')
+                --lineEnd;
+            if (lineEnd == lineBegin || *lineBegin == m_CommentChar)
+                continue;
+            line = Field(lineBegin, lineEnd);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Split a CSV line into at most max_fields fields
+     * @return the number of fields, or max_fields + 1 if there are more
+     **/
+    static int splitCSV(const Field &line, char delimiter, Field *fields, int max_fields);
+
+    template <typename Record>
+    static inline void store(Record &row, const Column<Record> &column, const Field &field) {
+        switch (column.type) {
+            case KSParser::D_INT:
+                row.*column.intMember = field.toInt();
+                break;
+            case KSParser::D_FLOAT:
+                row.*column.floatMember = field.toFloat();
+                break;
+            case KSParser::D_DOUBLE:
+                row.*column.doubleMember = field.toDouble();
+                break;
+            case KSParser::D_QSTRING:
+                row.*column.fieldMember = field;
+                break;
+            case KSParser::D_SKIP:
+            default:
+                break;
+        }
+    }
+
+    template <typename Record, typename Callback>
+    int readCSV(const char *pos, const char *end, const Column<Record> *columns, int count, Callback callback, char delimiter) const {
+        if (count > MAX_FIELDS) {
+            qWarning() << "Too many columns for KSStreamParser:" << count;
+            return 0;
+        }
+        Field fields[MAX_FIELDS];
+        Field line;
+        int rows = 0;
+        while (nextLine(pos, end, line)) {
+            if (splitCSV(line, delimiter, fields, count) != count)
+                continue;
+            Record row = Record();
+            for (int i = 0; i < count; ++i)
+                store(row, columns[i], fields[i]);
+            callback(row);
+            ++rows;
+        }
+        return rows;
+    }
+
+    template <typename Record, typename Callback>
+    int readFixedWidth(const char *pos, const char *end, const Column<Record> *columns, int count, Callback callback) const {
+        int min_length = 0;
+        for (int i = 0; i < count - 1; ++i)
+            min_length += columns[i].width;
+
+        Field line;
+        int rows = 0;
+        while (nextLine(pos, end, line)) {
+            if (line.size() < min_length)
+                continue;
+            Record row = Record();
+            const char *field = line.begin();
+            for (int i = 0; i < count; ++i) {
+                const char *fieldEnd = (i == count - 1) ? line.end() : field + columns[i].width;
+                store(row, columns[i], Field(field, fieldEnd).trimmed());
+                field = fieldEnd;
+            }
+            callback(row);
+            ++rows;
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Split the file into ranges of whole lines, and run
+     * parse on every range concurrently.
+     **/
+    template <typename Record>
+    QVector<Record> readAll(std::function<void(const char *, const char *, QVector<Record> &)> parse) const {
+        QVector<Field> ranges = splitRanges();
+        QVector< QVector<Record> > parts(ranges.size());
+        runRanges(ranges, [&](int i) { parse(ranges.at(i).begin(), ranges.at(i).end(), parts[i]); });
+
+        int total = 0;
+        for (int i = 0; i < parts.size(); ++i)
+            total += parts.at(i).size();
+        QVector<Record> rows;
+        rows.reserve(total);
+        for (int i = 0; i < parts.size(); ++i)
+            rows += parts.at(i);
+        return rows;
+    }
+
+    /** @return the file split into ranges of whole lines, one per task */
+    QVector<Field> splitRanges() const;
+
+    /** @brief Call task(i) for every range, on the global thread pool */
+    static void runRanges(const QVector<Field> &ranges, const std::function<void(int)> &task);
+
+    QFile m_File;
+    QByteArray m_Buffer;        // The contents of the file, if it could not be mapped
+    const char *m_Begin;
+    const char *m_End;
+    char m_CommentChar;
+};
+
+#endif  // KSTARS_KSSTREAMPARSER_H
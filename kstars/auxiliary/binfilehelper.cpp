@@ -18,14 +18,24 @@
 
 #include "binfilehelper.h"
 
+#include <QDir>
+#include <QFile>
 #include <QStandardPaths>
 #include "byteorder.h"
 #include "auxiliary/kspaths.h"
 
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 class BinFileHelper;
 
 BinFileHelper::BinFileHelper() {
     fileHandle = NULL;
+    mappedFile = NULL;
+    mappedData = NULL;
+    mappedSize = 0;
     init();
 }
 
@@ -36,6 +46,7 @@ BinFileHelper::~BinFileHelper() {
 }
 
 void BinFileHelper::init() {
+    unmapFile();
     if(fileHandle)
         fclose(fileHandle);
     fileHandle = NULL;
@@ -67,7 +78,8 @@ bool BinFileHelper::testFileExists( const QString &fileName ) {
 }
 
 FILE *BinFileHelper::openFile(const QString &fileName) {
-    QString FilePath = KSPaths::locate(QStandardPaths::GenericDataLocation, fileName );
+    QString FilePath = QDir::isAbsolutePath( fileName ) ? fileName
+                       : KSPaths::locate(QStandardPaths::GenericDataLocation, fileName );
     init();
     QByteArray b = FilePath.toLatin1();
     const char *filepath = b.data();
@@ -223,7 +235,68 @@ bool BinFileHelper::readHeader() {
     return false;
 }
 
+bool BinFileHelper::mapFile() {
+    if( mappedData )
+        return true;
+    if( !fileHandle )
+        return false;
+
+    mappedFile = new QFile;
+    if( mappedFile->open( fileHandle, QIODevice::ReadOnly ) ) {
+        mappedSize = mappedFile->size();
+        if( mappedSize > 0 )
+            mappedData = reinterpret_cast<const char *>( mappedFile->map( 0, mappedSize ) );
+    }
+
+    if( !mappedData ) {
+        delete mappedFile;
+        mappedFile = NULL;
+        mappedSize = 0;
+        return false;
+    }
+    return true;
+}
+
+void BinFileHelper::unmapFile() {
+    if( !mappedFile )
+        return;
+    // Closing the QFile unmaps the file, but leaves fileHandle open
+    mappedFile->close();
+    delete mappedFile;
+    mappedFile = NULL;
+    mappedData = NULL;
+    mappedSize = 0;
+}
+
+const char *BinFileHelper::getRecords( int id ) const {
+    if( !mappedData || !indexUpdated || id < 0 || id >= indexOffset.size() )
+        return NULL;
+    qint64 end = (qint64) indexOffset.at( id ) + (qint64) indexCount.at( id ) * recordSize;
+    if( end > mappedSize )
+        return NULL;
+    return mappedData + indexOffset.at( id );
+}
+
+void BinFileHelper::prefetch( int id, unsigned int first ) const {
+#ifdef Q_OS_UNIX
+    const char *records = getRecords( id );
+    if( !records || first >= indexCount.at( id ) )
+        return;
+
+    // madvise() wants a page aligned start address
+    static const quintptr pageSize = sysconf( _SC_PAGESIZE );
+    quintptr begin = reinterpret_cast<quintptr>( records + (qint64) first * recordSize );
+    quintptr end = reinterpret_cast<quintptr>( records + (qint64) indexCount.at( id ) * recordSize );
+    begin -= begin % pageSize;
+    madvise( reinterpret_cast<void *>( begin ), end - begin, MADV_WILLNEED );
+#else
+    Q_UNUSED( id );
+    Q_UNUSED( first );
+#endif
+}
+
 void BinFileHelper::closeFile() {
+    unmapFile();
     fclose(fileHandle);
     fileHandle = NULL;
 }
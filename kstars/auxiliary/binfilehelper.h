@@ -26,6 +26,7 @@
 #include <cstdio>
 
 class QString;
+class QFile;
 
 /**
  *@short   A structure describing a data field in the file
@@ -73,12 +74,68 @@ class BinFileHelper {
     /**
      *WARNING: This function may not be compatible in other locales, because it calls QString::toAscii
      *@short Open a Binary data file and set the handle
-     *@param fileName  Reference to QString containing the name of the file
+     *@param fileName  Reference to QString containing the name of the file. Relative names
+     *        are looked up in the KStars data directories, absolute paths are opened as is.
      *@return Handle to the file if successful, NULL if an error occurred, sets the error.
      */
 
     FILE *openFile(const QString &fileName);
 
+    /**
+     *@short  Map the currently open file into memory
+     *
+     *Once the file is mapped, getRecords() returns pointers straight into
+     *the mapping, so that records can be copied out without any seeking
+     *or reading through the file handle. The file handle remains valid,
+     *and reading from it still works.
+     *
+     *@return true if the file is mapped, false if no file is open or the
+     *platform could not map it. Callers should fall back to reading
+     *through getFileHandle() in that case.
+     */
+    bool mapFile();
+
+    /**
+     *@short  Unmap the file, if it is mapped
+     */
+    void unmapFile();
+
+    /**
+     *@return true if the file is mapped into memory
+     */
+    inline bool isMapped() const { return mappedData != NULL; }
+
+    /**
+     *@return The size of the mapping in bytes, or zero if the file is not mapped
+     */
+    inline qint64 getMappedSize() const { return mappedSize; }
+
+    /**
+     *@return Pointer to the start of the mapped file, or NULL if it is not mapped
+     */
+    inline const char *getMappedData() const { return mappedData; }
+
+    /**
+     *@short  Returns a zero-copy view of the records under the given index ID
+     *@param  id  ID of the index entry
+     *@return Pointer to the first of the getRecordCount( id ) records of that
+     *        index ID inside the mapping, or NULL if the file is not mapped,
+     *        the index has not been read or the records lie outside the file.
+     *@note   The records are in file byte order, and need not be aligned.
+     */
+    const char *getRecords( int id ) const;
+
+    /**
+     *@short  Ask the operating system to start paging in the records under
+     *        the given index ID, so that a later getRecords() does not block
+     *@param  id  ID of the index entry
+     *@param  first  Number of leading records to skip, because they are
+     *        already loaded
+     *@note   This is only a hint, and does nothing if the file is not mapped
+     *        or the platform does not support it.
+     */
+    void prefetch( int id, unsigned int first = 0 ) const;
+
     /**
      *@short  Read the header and index table from the file and fill up the QVector s with the entries
      *@return True if successful, false if an error occurred, sets the error.
@@ -187,6 +244,12 @@ class BinFileHelper {
      */
     inline QString getHeaderText() const { return (preambleUpdated ? headerText : ""); }
 
+    /**
+     *@short  Returns the version number of the file format
+     *@return The version byte from the preamble if the header has been read, zero otherwise
+     */
+    inline quint8 getVersion() const { return (preambleUpdated ? versionNumber : 0); }
+
     /**
      *@short  Returns the offset at which the data begins
      *@return The value of dataOffset if indexUpdated, else zero
@@ -266,6 +329,9 @@ class BinFileHelper {
     void init();
 
     FILE *fileHandle;                     // Handle to the file.
+    QFile *mappedFile;                    // File object that owns the memory mapping, if any
+    const char *mappedData;               // Start of the memory mapping of the file, NULL if not mapped
+    qint64 mappedSize;                    // Size of the memory mapping in bytes
     QVector<unsigned long> indexOffset;   // Stores offsets corresponding to each index table entry
     QVector<unsigned int> indexCount;     // Stores number of records under each index table entry
     bool indexUpdated;                    // True if the data from the index, and associated properties have been updated
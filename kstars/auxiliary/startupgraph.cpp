@@ -0,0 +1,146 @@
+/***************************************************************************
+                  startupgraph.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "startupgraph.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrentRun>
+
+StartupGraph::StartupGraph( const QString &name ) :
+    m_Name( name ), m_Done( 0 ), m_Total( 0 )
+{
+}
+
+int StartupGraph::addTask( const QString &name, Affinity affinity, const Task &task, const QList<int> &dependencies )
+{
+    int id = m_Nodes.size();
+
+    Node node;
+    node.name     = name;
+    node.affinity = affinity;
+    node.task     = task;
+    node.pending  = dependencies.size();
+    node.state    = Waiting;
+    node.start    = 0;
+    node.duration = 0;
+    m_Nodes.append( node );
+
+    foreach( int dependency, dependencies ) {
+        Q_ASSERT( dependency >= 0 && dependency < id );
+        m_Nodes[ dependency ].dependents.append( id );
+    }
+
+    return id;
+}
+
+void StartupGraph::execute( int id )
+{
+    qint64 start = m_Clock.elapsed();
+    bool ok = m_Nodes.at( id ).task();
+    qint64 end = m_Clock.elapsed();
+
+    QMutexLocker locker( &m_Mutex );
+    Node &node    = m_Nodes[ id ];
+    node.start    = start;
+    node.duration = end - start;
+    node.state    = ok ? Succeeded : Failed;
+    ++m_Done;
+
+    foreach( int dependent, node.dependents ) {
+        if( ! ok )
+            skip( dependent );
+        else
+            --m_Nodes[ dependent ].pending;
+    }
+
+    m_Changed.wakeAll();
+}
+
+void StartupGraph::skip( int id )
+{
+    Node &node = m_Nodes[ id ];
+    if( node.state != Waiting )
+        return;
+
+    node.state = Skipped;
+    ++m_Done;
+    foreach( int dependent, node.dependents )
+        skip( dependent );
+}
+
+void StartupGraph::run()
+{
+    m_Clock.start();
+
+    QMutexLocker locker( &m_Mutex );
+    while( m_Done < m_Nodes.size() ) {
+        int next = -1;
+
+        for( int id = 0; id < m_Nodes.size(); ++id ) {
+            Node &node = m_Nodes[ id ];
+            if( node.state != Waiting || node.pending > 0 )
+                continue;
+
+            if( node.affinity == WorkerThread ) {
+                node.state = Running;
+                QtConcurrent::run( [this, id]() { execute( id ); } );
+            } else if( next < 0 ) {
+                next = id;
+            }
+        }
+
+        if( next >= 0 ) {
+            // Main thread tasks run here, without holding the lock, so
+            // that the workers can finish their tasks in the meantime.
+            m_Nodes[ next ].state = Running;
+            locker.unlock();
+            execute( next );
+            locker.relock();
+        } else {
+            m_Changed.wait( &m_Mutex );
+        }
+    }
+
+    m_Total = m_Clock.elapsed();
+}
+
+bool StartupGraph::succeeded( int id ) const
+{
+    QMutexLocker locker( &m_Mutex );
+    return m_Nodes.at( id ).state == Succeeded;
+}
+
+void StartupGraph::report() const
+{
+    QMutexLocker locker( &m_Mutex );
+
+    qDebug() << m_Name << "took" << m_Total << "ms";
+    foreach( const Node &node, m_Nodes ) {
+        QString outcome;
+        switch( node.state ) {
+        case Succeeded: outcome = "done";    break;
+        case Failed:    outcome = "failed";  break;
+        case Skipped:   outcome = "skipped"; break;
+        default:        outcome = "not run"; break;
+        }
+
+        qDebug() << QString( "  %1: %2 ms, started at %3 ms on the %4 thread, %5" )
+                    .arg( node.name ).arg( node.duration ).arg( node.start )
+                    .arg( node.affinity == MainThread ? "main" : "worker" ).arg( outcome );
+    }
+}
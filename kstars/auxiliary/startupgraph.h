@@ -0,0 +1,107 @@
+/***************************************************************************
+                   startupgraph.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STARTUPGRAPH_H
+#define STARTUPGRAPH_H
+
+#include <functional>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+/**
+ *@class StartupGraph
+ *@short Runs the stages of the startup as a graph of dependent tasks
+ *
+ *Every task is a function that returns true on success, and lists
+ *the tasks that must finish before it may start. run() starts every
+ *task as soon as its dependencies are done: tasks with the WorkerThread
+ *affinity run concurrently on the global thread pool, while tasks with
+ *the MainThread affinity run one after the other on the thread that
+ *called run(), in the order they were added. The latter is meant for
+ *everything that touches widgets, the database connections of the main
+ *thread or the sky components, which are not thread-safe.
+ *
+ *If a task fails, the tasks that depend on it are skipped. Once all
+ *tasks are done, report() prints the time taken by every stage.
+ */
+class StartupGraph
+{
+public:
+    enum Affinity { MainThread, WorkerThread };
+
+    typedef std::function<bool()> Task;
+
+    /**
+     *@short Constructor
+     *@param name name of the graph, used in the timing report
+     */
+    explicit StartupGraph( const QString &name );
+
+    /**
+     *@short Add a task to the graph. Must not be called while run() is in progress.
+     *@param name name of the stage, used in the timing report
+     *@param affinity the thread the task must run on
+     *@param task the function to run
+     *@param dependencies the identifiers of the tasks that must be done first
+     *@return the identifier of the new task
+     */
+    int addTask( const QString &name, Affinity affinity, const Task &task, const QList<int> &dependencies = QList<int>() );
+
+    /** @short Run all tasks and return once they are all done, failed or skipped */
+    void run();
+
+    /** @return true if the task ran and returned true */
+    bool succeeded( int id ) const;
+
+    /** @short Print the start time, duration and outcome of every task */
+    void report() const;
+
+private:
+    enum State { Waiting, Running, Succeeded, Failed, Skipped };
+
+    struct Node {
+        QString name;
+        Affinity affinity;
+        Task task;
+        QList<int> dependents;
+        int pending;        // Dependencies that are not done yet
+        State state;
+        qint64 start;       // ms since the start of run()
+        qint64 duration;    // ms
+    };
+
+    /** Run the given task on the calling thread and record the outcome */
+    void execute( int id );
+
+    /** Mark the task and everything that depends on it as skipped. The mutex must be held. */
+    void skip( int id );
+
+    QString m_Name;
+    QVector<Node> m_Nodes;
+    int m_Done;
+    qint64 m_Total;
+    QElapsedTimer m_Clock;
+    mutable QMutex m_Mutex;
+    QWaitCondition m_Changed;
+};
+
+#endif
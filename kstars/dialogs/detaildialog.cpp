@@ -23,12 +23,15 @@
 #include <QTextStream>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QPushButton>
 #include <QTemporaryFile>
 #include <QDebug>
 #include <QDesktopServices>
 
+#include <cmath>
+
 #include <KMessageBox>
 #include <KToolInvocation>
 #include <KLocalizedString>
@@ -49,6 +52,7 @@
 #include "skyobjects/kscomet.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/supernova.h"
+#include "skyobjects/satellite.h"
 #include "skycomponents/catalogcomponent.h"
 #include "thumbnailpicker.h"
 #include "Options.h"
@@ -72,7 +76,7 @@
 DetailDialog::DetailDialog(SkyObject *o, const KStarsDateTime &ut, GeoLocation *geo, QWidget *parent ) :
     KPageDialog( parent ),
     selectedObject(o),
-    Data(0), DataComet(0), Pos(0), Links(0), Adv(0), Log(0)
+    Data(0), DataComet(0), Pos(0), Passes(0), Links(0), Adv(0), Log(0)
 {
     setFaceType( Tabbed );
     setBackgroundRole( QPalette::Base );
@@ -90,6 +94,8 @@ DetailDialog::DetailDialog(SkyObject *o, const KStarsDateTime &ut, GeoLocation *
 
     createGeneralTab();
     createPositionTab( ut, geo );
+    if ( selectedObject->type() == SkyObject::SATELLITE )
+        createPassesTab( ut, geo );
     createLinksTab();
     createAdvancedTab();
     createLogTab();
@@ -550,6 +556,37 @@ void DetailDialog::createPositionTab( const KStarsDateTime &ut, GeoLocation *geo
 
 }
 
+void DetailDialog::createPassesTab( const KStarsDateTime &ut, GeoLocation *geo ) {
+    Satellite *sat = (Satellite *)selectedObject;
+
+    Passes = new QTreeWidget( this );
+    Passes->setRootIsDecorated( false );
+    Passes->setHeaderLabels( QStringList() << i18n( "Rise" ) << i18n( "Azimuth" )
+                             << i18n( "Culmination" ) << i18n( "Max. Altitude" )
+                             << i18n( "Set" ) << i18n( "Azimuth" )
+                             << i18n( "Magnitude" ) << i18n( "Visible" ) );
+    addPage( Passes, i18n( "Passes" ) );
+
+    // Passes over the next three days, in local time
+    foreach ( const SatellitePass &pass, sat->passes( ut, ut.addDays( 3 ), geo ) ) {
+        QTreeWidgetItem *item = new QTreeWidgetItem( Passes );
+        item->setText( 0, QLocale().toString( geo->UTtoLT( pass.rise ), QLocale::ShortFormat ) );
+        item->setText( 1, pass.riseAz.toDMSString() );
+        item->setText( 2, QLocale().toString( geo->UTtoLT( pass.culmination ).time(), QLocale::ShortFormat ) );
+        item->setText( 3, pass.maxAlt.toDMSString() );
+        item->setText( 4, QLocale().toString( geo->UTtoLT( pass.set ).time(), QLocale::ShortFormat ) );
+        item->setText( 5, pass.setAz.toDMSString() );
+        if ( std::isnan( pass.magnitude ) )
+            item->setText( 6, "--" );
+        else
+            item->setText( 6, QLocale().toString( pass.magnitude, 'f', 1 ) );
+        item->setText( 7, pass.visible ? i18n( "Yes" ) : i18n( "No" ) );
+    }
+
+    for ( int i = 0; i < Passes->columnCount(); ++i )
+        Passes->resizeColumnToContents( i );
+}
+
 void DetailDialog::createLinksTab()
 {
     // don't create a link tab for an unnamed star
@@ -38,6 +38,7 @@
 
 class GeoLocation;
 class QHBoxLayout;
+class QTreeWidget;
 class QListWidgetItem;
 class QPixmap;
 class QString;
@@ -180,6 +181,10 @@ private:
     	*/
     void createPositionTab( const KStarsDateTime &ut, GeoLocation *geo );
 
+    /**Build the Passes Tab, listing the upcoming passes of a satellite.
+    	*/
+    void createPassesTab( const KStarsDateTime &ut, GeoLocation *geo );
+
     /**Build the Links Tab, populating the image and info lists with the
     	*known URLs for the current Object.
     	*/
@@ -221,6 +226,7 @@ private:
     DataWidget *Data;
     DataCometWidget *DataComet;
     PositionWidget *Pos;
+    QTreeWidget *Passes;
     LinksWidget *Links;
     DatabaseWidget *Adv;
     LogWidget *Log;
@@ -86,11 +86,10 @@ FindDialog::FindDialog( QWidget* parent ) :
     ui->FilterType->setCurrentIndex(0);  // show all types of objects
 
     fModel = new SkyObjectListModel( this );
+    // Only sorts the list; the names are filtered through the name index
     sortModel = new QSortFilterProxyModel(ui->SearchList);
-    sortModel->setFilterCaseSensitivity( Qt::CaseInsensitive );
     sortModel->setSourceModel( fModel );
     sortModel->setSortRole(Qt::DisplayRole);
-    sortModel->setFilterRole(Qt::DisplayRole);
     sortModel->setDynamicSortFilter(true);
     sortModel->sort( 0 );
 
@@ -172,81 +171,80 @@ void FindDialog::initSelection() {
     listFiltered = true;
 }
 
-void FindDialog::filterByType() {
-    KStarsData *data = KStarsData::Instance();
+QList<int> FindDialog::selectedTypes() const {
+    QList<int> types;
 
     switch ( ui->FilterType->currentIndex() ) {
     case 0: // All object types
-    {
-        QVector<QPair<QString, const SkyObject *>> allObjects;
-        foreach( int type, data->skyComposite()->objectLists().keys() ) {
-            allObjects.append(data->skyComposite()->objectLists(SkyObject::TYPE(type)));
-        }
-        fModel->setSkyObjectsList( allObjects );
         break;
-    }
     case 1: //Stars
-    {
-        QVector<QPair<QString, const SkyObject *>> starObjects;
-        starObjects.append(data->skyComposite()->objectLists(SkyObject::STAR));
-        starObjects.append(data->skyComposite()->objectLists(SkyObject::CATALOG_STAR));
-        fModel->setSkyObjectsList( starObjects );
+        types << SkyObject::STAR << SkyObject::CATALOG_STAR;
         break;
-    }
     case 2: //Solar system
-    {
-        QVector<QPair<QString, const SkyObject *>> ssObjects;
-        ssObjects.append(data->skyComposite()->objectLists(SkyObject::PLANET));
-        ssObjects.append(data->skyComposite()->objectLists(SkyObject::COMET));
-        ssObjects.append(data->skyComposite()->objectLists(SkyObject::ASTEROID));
-        ssObjects.append(data->skyComposite()->objectLists(SkyObject::MOON));
-
-        fModel->setSkyObjectsList(ssObjects);
+        types << SkyObject::PLANET << SkyObject::COMET << SkyObject::ASTEROID << SkyObject::MOON;
         break;
-    }
     case 3: //Open Clusters
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::OPEN_CLUSTER ) );
+        types << SkyObject::OPEN_CLUSTER;
         break;
     case 4: //Globular Clusters
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::GLOBULAR_CLUSTER ) );
+        types << SkyObject::GLOBULAR_CLUSTER;
         break;
     case 5: //Gaseous nebulae
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::GASEOUS_NEBULA ) );
+        types << SkyObject::GASEOUS_NEBULA;
         break;
     case 6: //Planetary nebula
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::PLANETARY_NEBULA ) );
+        types << SkyObject::PLANETARY_NEBULA;
         break;
     case 7: //Galaxies
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::GALAXY ) );
+        types << SkyObject::GALAXY;
         break;
     case 8: //Comets
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::COMET ) );
+        types << SkyObject::COMET;
         break;
     case 9: //Asteroids
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::ASTEROID ) );
+        types << SkyObject::ASTEROID;
         break;
     case 10: //Constellations
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::CONSTELLATION ) );
+        types << SkyObject::CONSTELLATION;
         break;
     case 11: //Supernovae
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::SUPERNOVA ) );
+        types << SkyObject::SUPERNOVA;
         break;
     case 12: //Satellites
-        fModel->setSkyObjectsList( data->skyComposite()->objectLists( SkyObject::SATELLITE ) );
+        types << SkyObject::SATELLITE;
         break;
     }
+
+    return types;
+}
+
+void FindDialog::filterByType() {
+    const NameIndex &index = KStarsData::Instance()->skyComposite()->nameIndex();
+    fModel->setSkyObjectsList( index.entries( selectedTypes() ) );
 }
 
 void FindDialog::filterList() {
     QString SearchText = processSearchText();
-    sortModel->setFilterFixedString( SearchText );
     ui->InternetSearchButton->setText( i18n( "or search the internet for %1", SearchText ) );
-    filterByType();
+
+    const NameIndex &index = KStarsData::Instance()->skyComposite()->nameIndex();
+    QList<int> types = selectedTypes();
+    if ( SearchText.isEmpty() )
+        fModel->setSkyObjectsList( index.entries( types ) );
+    else {
+        QVector<NameIndex::Entry> matches = index.findWords( SearchText, types );
+        // Nothing starts with the text, maybe it is misspelled
+        if ( matches.isEmpty() )
+            matches = index.findFuzzy( SearchText, types );
+        fModel->setSkyObjectsList( matches );
+    }
     initSelection();
 
     //Select the first item in the list that begins with the filter string
     if ( !SearchText.isEmpty() ) {
-        QStringList mItems = fModel->filter( QRegExp( '^'+SearchText, Qt::CaseInsensitive ) );
+        QStringList mItems;
+        foreach ( const NameIndex::Entry &entry, index.findPrefix( SearchText, types ) )
+            mItems.append( entry.first );
         mItems.sort();
 
         if ( mItems.size() ) {
@@ -64,7 +64,10 @@ public:
 
 public slots:
     /**When Text is entered in the QLineEdit, filter the List of objects
-     * so that only objects which start with the filter text are shown.
+     * so that only objects with a word that starts with the filter text
+     * are shown. If there is none, the objects whose names are within a
+     * small edit distance of the filter text are shown instead, to catch
+     * misspelled names. The matches come from SkyMapComposite::nameIndex().
      */
     void filterList();
 
@@ -121,6 +124,9 @@ private:
      */
     void filterByType();
 
+    /** @return the object types selected in the type filter, or an empty list for all types */
+    QList<int> selectedTypes() const;
+
     FindDialogUI* ui;
     SkyObjectListModel *fModel;
     QSortFilterProxyModel* sortModel;
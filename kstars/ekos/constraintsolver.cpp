@@ -0,0 +1,387 @@
+/*  Ekos Scheduler constraint solver
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "constraintsolver.h"
+
+#include <cmath>
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "geolocation.h"
+#include "skyobjects/ksmoon.h"
+
+// Length of the period to solve for, and its margin for the Moon ephemeris
+#define PERIOD_SECONDS          (24 * 3600.0)
+#define MOON_PERIOD_SECONDS     (25 * 3600.0)
+#define MOON_INTERVAL_SECONDS   1800.0
+
+// update() keeps the current setup for this long
+#define REFRESH_SECONDS         600
+
+// Sidereal days per solar day
+#define SIDEREAL_RATE           1.00273790935
+
+// The moon constraint is checked at this fraction of the ephemeris
+// interval, and its crossings refined to this precision in seconds
+#define MOON_SCAN_DIVISIONS     4
+#define MOON_PRECISION_SECONDS  1.0
+
+namespace Ekos
+{
+
+ConstraintSolver::ConstraintSolver()
+{
+    m_startFraction = 0;
+    m_latitude      = 0;
+    m_longitude     = 0;
+    m_startLST      = 0;
+    m_dawn          = -1;
+    m_dusk          = -1;
+    m_earlyDawn     = -1;
+    m_moonInterval  = MOON_INTERVAL_SECONDS;
+}
+
+void ConstraintSolver::setPeriod(const QDateTime &start, double latitude, double startLST, double dawn, double dusk, double earlyDawn)
+{
+    m_start         = start;
+    m_startFraction = start.time().msecsSinceStartOfDay() / (24.0 * 3600.0 * 1000.0);
+    m_latitude      = latitude;
+    m_startLST      = startLST;
+    m_dawn          = dawn;
+    m_dusk          = dusk;
+    m_earlyDawn     = earlyDawn;
+}
+
+void ConstraintSolver::setMoonEphemeris(const QVector<MoonPosition> &positions, double interval)
+{
+    m_moon         = positions;
+    m_moonInterval = interval;
+}
+
+void ConstraintSolver::update(const QDateTime &start, GeoLocation *geo, KSMoon *moon, double dawn, double dusk, double earlyDawn)
+{
+    if (m_start.isValid() && m_start <= start && m_start.secsTo(start) < REFRESH_SECONDS && dawn == m_dawn && dusk == m_dusk &&
+        earlyDawn == m_earlyDawn && geo->lat()->radians() == m_latitude && geo->lng()->radians() == m_longitude)
+        return;
+
+    KStarsDateTime ut = geo->LTtoUT(KStarsDateTime(start));
+    CachingDms LST = geo->GSTtoLST(ut.gst());
+    setPeriod(start, geo->lat()->radians(), LST.radians(), dawn, dusk, earlyDawn);
+    m_longitude = geo->lng()->radians();
+
+    QVector<MoonPosition> positions;
+    if (moon)
+    {
+        for (double t = 0; t <= MOON_PERIOD_SECONDS; t += MOON_INTERVAL_SECONDS)
+        {
+            KStarsDateTime when = ut.addSecs(t);
+            KSNumbers num(when.djd());
+            CachingDms whenLST = geo->GSTtoLST(when.gst());
+            moon->updateCoords(&num, true, geo->lat(), &whenLST, true);
+
+            MoonPosition p;
+            p.ra           = moon->ra().radians();
+            p.dec          = moon->dec().radians();
+            p.illumination = moon->illum();
+            positions.append(p);
+        }
+
+        // Put the Moon back where the sky map expects it
+        KStarsData *data = KStarsData::Instance();
+        moon->updateCoords(data->updateNum(), true, geo->lat(), data->lst(), true);
+    }
+    setMoonEphemeris(positions, MOON_INTERVAL_SECONDS);
+}
+
+bool ConstraintSolver::covers(const QDateTime &when) const
+{
+    if (m_start.isValid() == false || m_moon.isEmpty())
+        return false;
+    double t = offset(when);
+    return t >= 0 && t <= (m_moon.size() - 1) * m_moonInterval;
+}
+
+double ConstraintSolver::offset(const QDateTime &when) const
+{
+    return m_start.msecsTo(when) / 1000.0;
+}
+
+double ConstraintSolver::lst(double t) const
+{
+    return m_startLST + SIDEREAL_RATE * 2 * M_PI * t / (24 * 3600.0);
+}
+
+double ConstraintSolver::altitude(const Target &target, double t) const
+{
+    double sinAlt = sin(m_latitude) * sin(target.dec) + cos(m_latitude) * cos(target.dec) * cos(lst(t) - target.ra);
+    return asin(qBound(-1.0, sinAlt, 1.0)) * 180.0 / M_PI;
+}
+
+bool ConstraintSolver::moonPosition(double t, MoonPosition &position, double &altitude) const
+{
+    if (m_moon.isEmpty() || t < 0)
+        return false;
+
+    double x = t / m_moonInterval;
+    int i    = static_cast<int>(x);
+    if (i >= m_moon.size() - 1)
+    {
+        if (i > m_moon.size() - 1 || x > i)
+            return false;
+        i = m_moon.size() - 2;
+        if (i < 0)
+            return false;
+    }
+    double f = x - i;
+
+    // Interpolate the unit vectors, which does not care about the RA wrapping around
+    const MoonPosition &a = m_moon.at(i);
+    const MoonPosition &b = m_moon.at(i + 1);
+    double ax = cos(a.dec) * cos(a.ra), ay = cos(a.dec) * sin(a.ra), az = sin(a.dec);
+    double bx = cos(b.dec) * cos(b.ra), by = cos(b.dec) * sin(b.ra), bz = sin(b.dec);
+    double px = ax + (bx - ax) * f, py = ay + (by - ay) * f, pz = az + (bz - az) * f;
+    double norm = sqrt(px * px + py * py + pz * pz);
+
+    position.ra           = atan2(py, px);
+    position.dec          = asin(qBound(-1.0, pz / norm, 1.0));
+    position.illumination = a.illumination + (b.illumination - a.illumination) * f;
+
+    Target moon = { position.ra, position.dec, 0, 0 };
+    altitude    = this->altitude(moon, t);
+    return true;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::altitudeWindows(const Target &target, double from, double to) const
+{
+    WindowList windows;
+    double denominator = cos(m_latitude) * cos(target.dec);
+
+    // At the poles, or for a target at a celestial pole, the altitude does not change
+    if (fabs(denominator) < 1e-12)
+    {
+        if (altitude(target, from) > target.minAltitude)
+            windows.append(Window(from, to));
+        return windows;
+    }
+
+    double c = (sin(target.minAltitude * M_PI / 180.0) - sin(m_latitude) * sin(target.dec)) / denominator;
+    if (c <= -1)
+    {
+        windows.append(Window(from, to));
+        return windows;
+    }
+    if (c >= 1)
+        return windows;
+
+    // The target is above the altitude for hour angles in (-h, h)
+    double h     = acos(c);
+    double omega = SIDEREAL_RATE * 2 * M_PI / (24 * 3600.0);
+    double H0    = lst(0) - target.ra;
+
+    int kmin = static_cast<int>(floor((omega * from + H0 - h) / (2 * M_PI)));
+    int kmax = static_cast<int>(ceil((omega * to + H0 + h) / (2 * M_PI)));
+    for (int k = kmin; k <= kmax; ++k)
+    {
+        double start = qMax(from, (2 * M_PI * k - h - H0) / omega);
+        double end   = qMin(to, (2 * M_PI * k + h - H0) / omega);
+        if (start < end)
+            windows.append(Window(start, end));
+    }
+    return windows;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::nightWindows(double from, double to) const
+{
+    WindowList windows;
+    int kmin = static_cast<int>(floor(m_startFraction + from / (24 * 3600.0))) - 1;
+    int kmax = static_cast<int>(ceil(m_startFraction + to / (24 * 3600.0)));
+    for (int k = kmin; k <= kmax; ++k)
+    {
+        // From dusk of day k until dawn of day k + 1
+        double midnight = (k - m_startFraction) * 24 * 3600.0;
+        double start    = qMax(from, midnight + m_dusk * 24 * 3600.0);
+        double end      = qMin(to, midnight + (1 + m_dawn) * 24 * 3600.0);
+        if (start < end)
+            windows.append(Window(start, end));
+    }
+    return windows;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::preDawnWindows(double from, double to) const
+{
+    WindowList windows;
+    int kmin = static_cast<int>(floor(m_startFraction + from / (24 * 3600.0)));
+    int kmax = static_cast<int>(ceil(m_startFraction + to / (24 * 3600.0)));
+    for (int k = kmin; k <= kmax; ++k)
+    {
+        double midnight = (k - m_startFraction) * 24 * 3600.0;
+        double start    = qMax(from, midnight + m_earlyDawn * 24 * 3600.0);
+        double end      = qMin(to, midnight + m_dawn * 24 * 3600.0);
+        if (start < end)
+            windows.append(Window(start, end));
+    }
+    return windows;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::moonWindows(const Target &target, double from, double to) const
+{
+    WindowList windows;
+    if (target.minMoonSeparation <= 0 || m_moon.isEmpty())
+    {
+        windows.append(Window(from, to));
+        return windows;
+    }
+
+    double sinDec = sin(target.dec), cosDec = cos(target.dec);
+
+    // Positive where the moon constraint is met: the Moon is below the
+    // horizon, not illuminated, or far enough from the target
+    auto margin = [&](double t) -> double
+    {
+        MoonPosition moon;
+        double moonAltitude;
+        if (moonPosition(t, moon, moonAltitude) == false)
+            return 1;
+        if (moon.illumination <= 0)
+            return 1;
+        double cosSep     = sinDec * sin(moon.dec) + cosDec * cos(moon.dec) * cos(target.ra - moon.ra);
+        double separation = acos(qBound(-1.0, cosSep, 1.0)) * 180.0 / M_PI;
+        return qMax(-moonAltitude, separation - target.minMoonSeparation);
+    };
+
+    double step  = m_moonInterval / MOON_SCAN_DIVISIONS;
+    double start = -1;
+    double prevT = from;
+    bool prevOK  = margin(from) >= 0;
+    if (prevOK)
+        start = from;
+
+    for (double t = qMin(from + step, to); ; t = qMin(t + step, to))
+    {
+        bool ok = margin(t) >= 0;
+        if (ok != prevOK)
+        {
+            // Refine the crossing by bisection
+            double lo = prevT, hi = t;
+            while (hi - lo > MOON_PRECISION_SECONDS)
+            {
+                double mid = (lo + hi) / 2;
+                if ((margin(mid) >= 0) == prevOK)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            if (ok)
+                start = hi;
+            else
+                windows.append(Window(start, lo));
+        }
+        prevT  = t;
+        prevOK = ok;
+        if (t >= to)
+            break;
+    }
+    if (prevOK && start < to)
+        windows.append(Window(start, to));
+    return windows;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::intersect(const WindowList &a, const WindowList &b)
+{
+    WindowList result;
+    int i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        double start = qMax(a[i].first, b[j].first);
+        double end   = qMin(a[i].second, b[j].second);
+        if (start < end)
+            result.append(Window(start, end));
+        if (a[i].second < b[j].second)
+            i++;
+        else
+            j++;
+    }
+    return result;
+}
+
+ConstraintSolver::WindowList ConstraintSolver::unite(const WindowList &a, const WindowList &b)
+{
+    WindowList result;
+    int i = 0, j = 0;
+    while (i < a.size() || j < b.size())
+    {
+        Window next;
+        if (j >= b.size() || (i < a.size() && a[i].first <= b[j].first))
+            next = a[i++];
+        else
+            next = b[j++];
+
+        if (result.isEmpty() == false && next.first <= result.last().second)
+            result.last().second = qMax(result.last().second, next.second);
+        else
+            result.append(next);
+    }
+    return result;
+}
+
+ConstraintSolver::Result ConstraintSolver::solve(const Target &target, const QDateTime &from) const
+{
+    double begin = offset(from);
+    double end   = begin + PERIOD_SECONDS;
+
+    // The target may start at the first time it is in the night and above
+    // its minimum altitude, unless the Moon is too close. If by then it is
+    // too close to dawn, it may not start at all.
+    WindowList visible   = intersect(altitudeWindows(target, begin, end), nightWindows(begin, end));
+    WindowList preDawn   = preDawnWindows(begin, end);
+    WindowList decisions = intersect(visible, unite(moonWindows(target, begin, end), preDawn));
+
+    Result result;
+    result.altitude = 0;
+    if (decisions.isEmpty())
+    {
+        result.status = SOLVE_NOT_FOUND;
+        return result;
+    }
+
+    double t        = ceil(decisions.first().first);
+    result.time     = m_start.addMSecs(static_cast<qint64>(t * 1000));
+    result.altitude = altitude(target, t);
+    result.status   = SOLVE_FOUND;
+    foreach (const Window &w, preDawn)
+    {
+        if (decisions.first().first >= w.first && decisions.first().first < w.second)
+            result.status = SOLVE_PRE_DAWN;
+    }
+    return result;
+}
+
+QVector<ConstraintSolver::Result> ConstraintSolver::solve(const QVector<Target> &targets, const QDateTime &from) const
+{
+    struct Work
+    {
+        const Target *target;
+        Result result;
+    };
+
+    QVector<Work> work(targets.size());
+    for (int i = 0; i < targets.size(); i++)
+        work[i].target = &targets[i];
+
+    QtConcurrent::blockingMap(work, [this, &from](Work &w) { w.result = solve(*w.target, from); });
+
+    QVector<Result> results(targets.size());
+    for (int i = 0; i < targets.size(); i++)
+        results[i] = work[i].result;
+    return results;
+}
+
+}
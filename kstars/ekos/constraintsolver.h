@@ -0,0 +1,156 @@
+/*  Ekos Scheduler constraint solver
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef CONSTRAINTSOLVER_H
+#define CONSTRAINTSOLVER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+class KSMoon;
+class GeoLocation;
+
+namespace Ekos
+{
+
+/**
+ * @brief The ConstraintSolver class finds when fixed targets satisfy the scheduler altitude, twilight and moon constraints.
+ *
+ * Instead of stepping through the next 24 hours minute by minute, the solver works with time windows. The altitude of a
+ * fixed target only depends on its hour angle, so the windows where it is above a given altitude follow in closed form
+ * from the hour angle at that altitude. The night windows follow from the dawn and dusk day fractions. The Moon is
+ * sampled once for the whole period and interpolated in between, so that no KSMoon::updateCoords() call is needed per
+ * job and per step. The windows are then intersected.
+ *
+ * All time offsets are in seconds from the start of the period set with setPeriod().
+ * @author KStars developers
+ */
+class ConstraintSolver
+{
+public:
+    typedef QPair<double, double> Window;
+    typedef QList<Window> WindowList;
+
+    /** @brief A fixed target and its constraints */
+    struct Target
+    {
+        double ra;                  // Right ascension of date, radians
+        double dec;                 // Declination of date, radians
+        double minAltitude;         // Minimum altitude, degrees
+        double minMoonSeparation;   // Minimum separation from the Moon, degrees, or <= 0 to ignore
+    };
+
+    /** @brief Outcome of solve() */
+    typedef enum { SOLVE_FOUND, SOLVE_PRE_DAWN, SOLVE_NOT_FOUND } SolveStatus;
+
+    struct Result
+    {
+        SolveStatus status;
+        QDateTime time;             // Local time at which the target may start, or at which it runs into pre-dawn
+        double altitude;            // Altitude of the target at that time, degrees
+    };
+
+    /** @brief A position of the Moon, as used for the scheduler moon score */
+    struct MoonPosition
+    {
+        double ra, dec;             // Radians
+        double illumination;        // Illuminated fraction, 0 to 1
+    };
+
+    ConstraintSolver();
+
+    /**
+     * @brief setPeriod Set up the period to solve for
+     * @param start Local time at which the period starts
+     * @param latitude Geographic latitude, radians
+     * @param startLST Local sidereal time at start, radians
+     * @param dawn Day fraction of dawn
+     * @param dusk Day fraction of dusk
+     * @param earlyDawn Day fraction after which jobs may not start any more, before dawn
+     */
+    void setPeriod(const QDateTime &start, double latitude, double startLST, double dawn, double dusk, double earlyDawn);
+
+    /**
+     * @brief setMoonEphemeris Set the positions of the Moon over the period, sampled at a fixed interval from its start.
+     * An empty ephemeris disables the moon constraint.
+     */
+    void setMoonEphemeris(const QVector<MoonPosition> &positions, double interval);
+
+    /**
+     * @brief update Set up the period starting at the given local time for the current location, twilight and Moon.
+     * The Moon is sampled every half hour over the next 25 hours and then restored to the current time. Does nothing if
+     * the current setup is less than a few minutes old and the location and twilight did not change.
+     */
+    void update(const QDateTime &start, GeoLocation *geo, KSMoon *moon, double dawn, double dusk, double earlyDawn);
+
+    /** @return True if the given local time lies in the period, and the solver is set up */
+    bool covers(const QDateTime &when) const;
+
+    /** @return offset of the given local time from the start of the period, in seconds */
+    double offset(const QDateTime &when) const;
+
+    /** @return altitude of the target at the given offset, degrees */
+    double altitude(const Target &target, double t) const;
+
+    /**
+     * @brief moonPosition Interpolate the Moon ephemeris
+     * @param t offset in seconds
+     * @param position filled with the position of the Moon
+     * @param altitude filled with the altitude of the Moon, degrees
+     * @return False if there is no ephemeris at the given offset
+     */
+    bool moonPosition(double t, MoonPosition &position, double &altitude) const;
+
+    /** @return windows in [from, to] where the target is above its minimum altitude */
+    WindowList altitudeWindows(const Target &target, double from, double to) const;
+
+    /** @return windows in [from, to] that are night time, i.e. before dawn or after dusk */
+    WindowList nightWindows(double from, double to) const;
+
+    /** @return windows in [from, to] that are between early dawn and dawn */
+    WindowList preDawnWindows(double from, double to) const;
+
+    /** @return windows in [from, to] where the Moon is below the horizon or far enough from the target */
+    WindowList moonWindows(const Target &target, double from, double to) const;
+
+    /**
+     * @brief solve Find the first time in the 24 hours after the given time where the target is in the night, above
+     * its minimum altitude and far enough from the Moon.
+     * @return SOLVE_FOUND with that time, SOLVE_PRE_DAWN if the target is only visible too close to dawn first, or
+     * SOLVE_NOT_FOUND.
+     */
+    Result solve(const Target &target, const QDateTime &from) const;
+
+    /** @brief solve Solve all targets, concurrently */
+    QVector<Result> solve(const QVector<Target> &targets, const QDateTime &from) const;
+
+    static WindowList intersect(const WindowList &a, const WindowList &b);
+    static WindowList unite(const WindowList &a, const WindowList &b);
+
+private:
+    /** @return local sidereal time at the given offset, radians */
+    double lst(double t) const;
+
+    QDateTime m_start;
+    double m_startFraction;     // Day fraction of m_start
+    double m_latitude;
+    double m_startLST;
+    double m_dawn, m_dusk, m_earlyDawn;
+
+    QVector<MoonPosition> m_moon;
+    double m_moonInterval;
+
+    double m_longitude;         // Longitude used for the last update(), radians, for change detection only
+};
+
+}
+
+#endif // CONSTRAINTSOLVER_H
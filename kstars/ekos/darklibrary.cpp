@@ -166,8 +166,10 @@ bool DarkLibrary::subtract(FITSData *darkData, FITSView *lightImage, FITSScale f
 
    FITSData *lightData = lightImage->getImageData();
 
-   float *darkBuffer     = darkData->getImageBuffer();
-   float *lightBuffer    = lightData->getImageBuffer();
+   // The light frame keeps its native pixel type. Only the dark frame is converted to float,
+   // and the part of it that overlaps the light frame is subtracted from it.
+   QVector<float> darkBuffer(darkData->getSize());
+   darkData->getFloatBuffer(darkBuffer.data());
 
    int darkoffset   = offsetX + offsetY * darkData->getWidth();
    int darkW        = darkData->getWidth();
@@ -176,19 +178,18 @@ bool DarkLibrary::subtract(FITSData *darkData, FITSView *lightImage, FITSScale f
    int lightW       = lightData->getWidth();
    int lightH       = lightData->getHeight();
 
+   QVector<float> darkRegion(lightW * lightH);
+
    for (int i=0; i < lightH; i++)
    {
-       for (int j=0; j < lightW; j++)
-       {
-           lightBuffer[j+lightOffset] -= darkBuffer[j+darkoffset];
-           if (lightBuffer[j+lightOffset] < 0)
-               lightBuffer[j+lightOffset] = 0;
-       }
+       memcpy(darkRegion.data() + lightOffset, darkBuffer.constData() + darkoffset, lightW * sizeof(float));
 
        lightOffset += lightW;
        darkoffset  += darkW;
    }
 
+   lightData->subtract(darkRegion.data());
+
    lightData->applyFilter(filter);
    lightImage->rescale(ZOOM_KEEP_LEVEL);
    lightImage->updateFrame();
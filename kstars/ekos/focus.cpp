@@ -128,6 +128,7 @@ Focus::Focus()
     lastFocusDirection = FOCUS_NONE;
 
     focusType = FOCUS_MANUAL;
+    focusAlgorithm = FOCUS_ITERATIVE;
 
     profilePlot->setBackground(QBrush(Qt::black));
     profilePlot->xAxis->setBasePen(QPen(Qt::white, 1));
@@ -215,6 +216,8 @@ Focus::Focus()
     darkFrameCheck->setChecked(Options::useFocusDarkFrame());
     thresholdSpin->setValue(Options::focusThreshold());
     focusFramesSpin->setValue(Options::focusFrames());
+    focusAlgorithmCombo->setCurrentIndex(Options::focusAlgorithm());
+    curveSamplesSpin->setValue(Options::focusCurveSamples());
 
     connect(thresholdSpin, SIGNAL(valueChanged(double)), this, SLOT(setThreshold(double)));
     connect(focusFramesSpin, SIGNAL(valueChanged(int)), this, SLOT(setFrames(int)));
@@ -660,6 +663,15 @@ void Focus::start()
       }
     }
 
+    focusAlgorithm = static_cast<FocusAlgorithm>(focusAlgorithmCombo->currentIndex());
+
+    // The curve fit plans its samples around the current position
+    if ((canAbsMove || canRelMove) && focusAlgorithm == FOCUS_CURVE_FIT)
+    {
+        initialFocuserAbsPosition = currentPosition;
+        focusCurve.start(currentPosition, pulseDuration, curveSamplesSpin->value(), absMotionMin, absMotionMax, maxTravelIN->value(), toleranceIN->value());
+    }
+
     inAutoFocus = true;
     m_autoFocusSuccesful = false;
     frameNum=0;
@@ -692,10 +704,12 @@ void Focus::start()
     Options::setSuspendGuiding(suspendGuideCheck->isChecked());
     Options::setLockFocusFilter(lockFilterCheck->isChecked());
     Options::setUseFocusDarkFrame(darkFrameCheck->isChecked());
+    Options::setFocusAlgorithm(focusAlgorithmCombo->currentIndex());
+    Options::setFocusCurveSamples(curveSamplesSpin->value());
 
     if (Options::focusLogging())
         qDebug() << "Focus: Starting focus with box size: " << focusBoxSize->value() << " Step Size: " <<  stepIN->value() << " Threshold: " << thresholdSpin->value() << " Tolerance: "  << toleranceIN->value()
-                 << " Frames: " << focusFramesSpin->value() << " Maximum Travel: " << maxTravelIN->value();
+                 << " Frames: " << focusFramesSpin->value() << " Maximum Travel: " << maxTravelIN->value() << " Algorithm: " << focusAlgorithmCombo->currentText();
 
     if (kcfg_autoSelectStar->isChecked())
         appendLogText(i18n("Autofocus in progress..."));
@@ -1032,16 +1046,31 @@ void Focus::setCaptureComplete()
     // If we're not framing, let's try to detect stars
     if (inFocusLoop == false || (inFocusLoop && targetImage->isTrackingBoxEnabled()))
     {
+        // The focus curve is fitted to the HFR of all the stars in the frame
+        bool allStars = inAutoFocus && focusAlgorithm == FOCUS_CURVE_FIT;
+
         if (image_data->areStarsSearched() == false)
         {
-            if (targetImage->isTrackingBoxEnabled())
-                image_data->findStars(targetImage->getTrackingBox());
-            else
+            if (allStars)
                 image_data->findStars();
+
+            // Without stars in the whole frame, fall back to the selected star
+            if (allStars == false || image_data->getDetectedStars() == 0)
+            {
+                allStars = false;
+
+                if (targetImage->isTrackingBoxEnabled())
+                    image_data->findStars(targetImage->getTrackingBox(), true);
+                else
+                    image_data->findStars();
+            }
         }
 
         currentHFR= image_data->getHFR(HFR_MAX);
 
+        if (allStars && currentHFR > 0)
+            currentHFR = image_data->getHFR(HFR_AVERAGE);
+
         /*if (currentHFR == -1)
         {
             currentHFR = image_data->getHFR();
@@ -1292,7 +1321,12 @@ void Focus::setCaptureComplete()
     }
 
     if (canAbsMove || canRelMove)
-        autoFocusAbs();
+    {
+        if (focusAlgorithm == FOCUS_CURVE_FIT)
+            autoFocusCurve();
+        else
+            autoFocusAbs();
+    }
     else
         autoFocusRel();
 
@@ -1717,6 +1751,97 @@ void Focus::autoFocusAbs()
 
 }
 
+void Focus::autoFocusCurve()
+{
+    QString HFRText = QString("%1").arg(currentHFR, 0,'g', 3);
+
+    if (Options::focusLogging())
+        qDebug() << "Focus: Current HFR: " << currentHFR << " Current Position: " << currentPosition;
+
+    appendLogText(i18n("FITS received. HFR %1 @ %2.", HFRText, currentPosition));
+
+    if (++absIterations > MAXIMUM_ABS_ITERATIONS)
+    {
+        appendLogText(i18n("Autofocus failed to reach proper focus. Try increasing tolerance value."));
+        abort();
+        setAutoFocusResult(false);
+        return;
+    }
+
+    // No stars detected, try to capture again. If there are still none, the position is skipped.
+    if (currentHFR == -1)
+    {
+        if (noStarCount++ < MAX_RECAPTURE_RETRIES)
+        {
+            appendLogText(i18n("No stars detected, capturing again..."));
+            capture();
+            return;
+        }
+    }
+    else
+    {
+        if (hfr_position.empty())
+        {
+            maxPos=1;
+            minPos=1e6;
+        }
+
+        if (currentPosition > maxPos)
+            maxPos = currentPosition;
+        if (currentPosition < minPos)
+            minPos = currentPosition;
+
+        hfr_position.append(currentPosition);
+        hfr_value.append(currentHFR);
+
+        drawHFRPlot();
+    }
+
+    noStarCount = 0;
+
+    FocusCurve::Status status = focusCurve.addSample(currentPosition, currentHFR);
+    const FocusCurve::Fit &fit = focusCurve.fit();
+
+    if (Options::focusLogging() && fit.valid)
+        qDebug() << "Focus: Curve minimum HFR " << fit.HFR << " @ position " << fit.position << " Slope " << fit.slope << " Residual " << fit.residual;
+
+    switch (status)
+    {
+        case FocusCurve::CURVE_COMPLETE:
+            appendLogText(i18n("Autofocus complete."));
+            abort();
+            emit suspendGuiding(false);
+            setAutoFocusResult(true);
+            return;
+
+        case FocusCurve::CURVE_NO_MINIMUM:
+            appendLogText(i18n("Autofocus failed to find the minimum of the focus curve. Try increasing the step size."));
+            abort();
+            setAutoFocusResult(false);
+            return;
+
+        case FocusCurve::CURVE_TRAVEL_LIMIT:
+            appendLogText(i18n("Maximum travel limit reached. Autofocus aborted."));
+            abort();
+            setAutoFocusResult(false);
+            return;
+
+        case FocusCurve::CURVE_NEXT:
+            break;
+    }
+
+    // Get delta for next move
+    double delta = focusCurve.nextPosition() - currentPosition;
+
+    if (Options::focusLogging())
+        qDebug() << "Focus: Curve target position " << focusCurve.nextPosition() << " delta " << delta;
+
+    if (delta > 0)
+        FocusOut(qRound(delta));
+    else
+        FocusIn(qRound(fabs(delta)));
+}
+
 void Focus::autoFocusRel()
 {
     static int noStarCount=0;
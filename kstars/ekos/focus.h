@@ -14,6 +14,7 @@
 
 #include "focus.h"
 #include "capture.h"
+#include "focuscurve.h"
 
 #include "ui_focus.h"
 
@@ -48,6 +49,7 @@ public:
 
     typedef enum { FOCUS_NONE, FOCUS_IN, FOCUS_OUT } FocusDirection;
     typedef enum { FOCUS_MANUAL, FOCUS_AUTO, FOCUS_LOOP } FocusType;
+    typedef enum { FOCUS_ITERATIVE, FOCUS_CURVE_FIT } FocusAlgorithm;
 
     /** @defgroup FocusDBusInterface Ekos DBus Interface - Focus Module
      * Ekos::Focus interface provides advanced scripting capabilities to perform manual and automatic focusing operations.
@@ -340,6 +342,7 @@ private:
     void drawProfilePlot();
     void getAbsFocusPosition();
     void autoFocusAbs();
+    void autoFocusCurve();
     void autoFocusRel();
     void resetButtons();
 
@@ -365,6 +368,10 @@ private:
     FocusDirection lastFocusDirection;
     // What type of focusing are we doing right now?
     FocusType focusType;
+    // Which algorithm drives an absolute or relative focuser during autofocus
+    FocusAlgorithm focusAlgorithm;
+    // Samples and fit of the curve fitting algorithm
+    FocusCurve focusCurve;
 
     /*********************
     * HFR Club variables
@@ -0,0 +1,320 @@
+/*  Ekos Focus curve fitting
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "focuscurve.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtGlobal>
+
+// A hyperbola has three parameters, one more sample checks the fit
+#define MINIMUM_SAMPLES         4
+#define MINIMUM_SAMPLE_COUNT    5
+
+// Reweighting of the fit: Huber weights first, which never reject a
+// sample, then Tukey biweights, which do
+#define FIT_ITERATIONS          12
+#define HUBER_ITERATIONS        3
+#define HUBER_K                 1.345
+#define TUKEY_C                 4.685
+#define MAD_TO_SIGMA            1.4826
+
+// Residuals below this many pixels are noise of the HFR measurement itself
+#define MINIMUM_SIGMA           0.01
+
+#define MAXIMUM_EXTENSIONS      6
+#define MAXIMUM_VERIFICATIONS   2
+
+namespace Ekos
+{
+
+FocusCurve::FocusCurve()
+{
+    m_fit.valid     = false;
+    m_fit.position  = m_fit.HFR = m_fit.slope = m_fit.residual = 0;
+    m_fit.below     = m_fit.above = 0;
+    m_start         = 0;
+    m_step          = 1;
+    m_jump          = 1;
+    m_minPosition   = 0;
+    m_maxPosition   = 0;
+    m_maxTravel     = 0;
+    m_tolerance     = 0;
+    m_next          = 0;
+    m_bestHFR       = 0;
+    m_extensions    = 0;
+    m_verifications = 0;
+    m_verifying     = false;
+}
+
+void FocusCurve::start(double position, double step, int sampleCount, double minPosition, double maxPosition, double maxTravel, double tolerance)
+{
+    m_samples.clear();
+    m_plan.clear();
+    m_fit.valid     = false;
+
+    m_start         = position;
+    m_step          = qMax(1.0, step);
+    m_minPosition   = minPosition;
+    m_maxPosition   = maxPosition;
+    m_maxTravel     = maxTravel;
+    m_tolerance     = tolerance / 100.0;
+    m_next          = position;
+    m_bestHFR       = 0;
+    m_extensions    = 0;
+    m_verifications = 0;
+    m_verifying     = false;
+
+    // The first sample is taken where the focuser is. The others are taken from
+    // the outermost position inwards, so that the focuser always moves the same way.
+    const int half = qMax(MINIMUM_SAMPLE_COUNT, sampleCount) / 2;
+    m_jump = half * m_step;
+    for (int k=half; k >= -half; k--)
+    {
+        const double target = position + k * m_step;
+        if (k != 0 && reachable(target))
+            m_plan.append(target);
+    }
+}
+
+FocusCurve::Status FocusCurve::addSample(double position, double HFR)
+{
+    if (HFR > 0)
+    {
+        Sample sample = { position, HFR };
+        m_samples.append(sample);
+    }
+
+    if (m_verifying)
+    {
+        m_verifying = false;
+
+        // Close enough to the curve, or to the best sample
+        if (HFR > 0 && (HFR <= m_fit.HFR * (1 + m_tolerance) + 2 * m_fit.residual || HFR <= m_bestHFR * (1 + m_tolerance)))
+            return CURVE_COMPLETE;
+
+        if (++m_verifications >= MAXIMUM_VERIFICATIONS)
+            return CURVE_NO_MINIMUM;
+
+        return planNext(position);
+    }
+
+    if (m_plan.isEmpty() == false)
+    {
+        m_next = m_plan.takeFirst();
+        return CURVE_NEXT;
+    }
+
+    return planNext(position);
+}
+
+FocusCurve::Status FocusCurve::planNext(double position)
+{
+    if (m_samples.count() < MINIMUM_SAMPLES)
+        return CURVE_NO_MINIMUM;
+
+    m_fit = fitHyperbola(m_samples, m_step / 2);
+
+    QVector<double> positions;
+    const Sample *lowest = &m_samples.first(), *highest = &m_samples.first();
+    m_bestHFR = m_samples.first().HFR;
+    foreach (const Sample &sample, m_samples)
+    {
+        positions.append(sample.position);
+        m_bestHFR = qMin(m_bestHFR, sample.HFR);
+        if (sample.position < lowest->position)
+            lowest = &sample;
+        if (sample.position > highest->position)
+            highest = &sample;
+    }
+    std::sort(positions.begin(), positions.end());
+
+    // The minimum needs samples on both of its sides to be trusted. Rejected samples, and samples
+    // that are too close to the minimum to show the curve rising, do not count: an outlier at the
+    // end of one branch of the curve would otherwise look like its minimum.
+    if (m_fit.valid && m_fit.below >= 2 && m_fit.above >= 2)
+    {
+        const double target = qRound(m_fit.position);
+
+        // Already there, this sample was the verification
+        if (fabs(target - position) < 1)
+        {
+            const Sample &last = m_samples.last();
+            if (last.position == position && last.HFR <= m_fit.HFR * (1 + m_tolerance) + 2 * m_fit.residual)
+                return CURVE_COMPLETE;
+            return CURVE_NO_MINIMUM;
+        }
+
+        m_next      = target;
+        m_verifying = true;
+        return CURVE_NEXT;
+    }
+
+    if (++m_extensions > MAXIMUM_EXTENSIONS)
+        return CURVE_NO_MINIMUM;
+
+    // Extend the sampled range past the minimum, or one step towards the lower HFR
+    // if there is none. The fitted minimum is only an estimate this far out, so the
+    // range grows by at most half of the initial range at once.
+    double target;
+    if (m_fit.valid && m_fit.position > (positions.first() + positions.last()) / 2)
+        target = positions.last() + qBound(m_step, qRound(m_fit.position) + m_step - positions.last(), m_jump);
+    else if (m_fit.valid)
+        target = positions.first() - qBound(m_step, positions.first() - qRound(m_fit.position) + m_step, m_jump);
+    else if (highest->HFR < lowest->HFR)
+        target = positions.last() + m_step;
+    else
+        target = positions.first() - m_step;
+
+    if (reachable(target) == false)
+        return CURVE_TRAVEL_LIMIT;
+
+    m_next = target;
+    return CURVE_NEXT;
+}
+
+bool FocusCurve::reachable(double position) const
+{
+    return position >= m_minPosition && position <= m_maxPosition && fabs(position - m_start) <= m_maxTravel;
+}
+
+FocusCurve::Fit FocusCurve::fitHyperbola(const QVector<Sample> &samples, double margin)
+{
+    Fit fit;
+    fit.valid    = false;
+    fit.position = fit.HFR = fit.slope = fit.residual = 0;
+    fit.below    = fit.above = 0;
+
+    QVector<double> positions;
+    foreach (const Sample &sample, samples)
+        if (sample.HFR > 0)
+            positions.append(sample.position);
+
+    std::sort(positions.begin(), positions.end());
+
+    // Positions are scaled to [-1, 1] to keep the normal equations well conditioned
+    const int n = positions.count();
+    const double center = n ? (positions.first() + positions.last()) / 2 : 0;
+    const double scale  = n ? (positions.last() - positions.first()) / 2 : 0;
+
+    if (std::unique(positions.begin(), positions.end()) - positions.begin() < MINIMUM_SAMPLES)
+        return fit;
+
+    QVector<double> u(n), y(n), h(n), base(n), weight(n, 1.0), residual(n);
+    int i=0;
+    foreach (const Sample &sample, samples)
+    {
+        if (sample.HFR <= 0)
+            continue;
+
+        u[i]    = (sample.position - center) / scale;
+        h[i]    = sample.HFR;
+        y[i]    = sample.HFR * sample.HFR;
+        // An error e in the HFR is an error of about 2 HFR e in its square
+        base[i] = 1 / (4 * y[i]);
+        i++;
+    }
+
+    double A=0, B=0, C=0;
+
+    for (int iteration=0; iteration < FIT_ITERATIONS; iteration++)
+    {
+        // Weighted least squares of y = A u^2 + B u + C
+        double s[5] = { 0, 0, 0, 0, 0 }, t[3] = { 0, 0, 0 };
+        for (int k=0; k < n; k++)
+        {
+            const double w = weight[k] * base[k];
+            double p = w;
+            for (int j=0; j < 5; j++)
+            {
+                s[j] += p;
+                if (j < 3)
+                    t[j] += p * y[k];
+                p *= u[k];
+            }
+        }
+
+        const double det = s[4] * (s[2] * s[0] - s[1] * s[1]) - s[3] * (s[3] * s[0] - s[1] * s[2]) + s[2] * (s[3] * s[1] - s[2] * s[2]);
+        if (fabs(det) < 1e-12 * s[0] * s[0] * s[0])
+            return fit;
+
+        A = (t[2] * (s[2] * s[0] - s[1] * s[1]) - s[3] * (t[1] * s[0] - s[1] * t[0]) + s[2] * (t[1] * s[1] - s[2] * t[0])) / det;
+        B = (s[4] * (t[1] * s[0] - s[1] * t[0]) - t[2] * (s[3] * s[0] - s[1] * s[2]) + s[2] * (s[3] * t[0] - t[1] * s[2])) / det;
+        C = (s[4] * (s[2] * t[0] - t[1] * s[1]) - s[3] * (s[3] * t[0] - t[1] * s[2]) + t[2] * (s[3] * s[1] - s[2] * s[2])) / det;
+
+        // Robust scale of the HFR residuals, from their median absolute deviation
+        QVector<double> deviations(n);
+        for (int k=0; k < n; k++)
+        {
+            residual[k]   = h[k] - sqrt(qMax(0.0, A * u[k] * u[k] + B * u[k] + C));
+            deviations[k] = fabs(residual[k]);
+        }
+        std::nth_element(deviations.begin(), deviations.begin() + n / 2, deviations.end());
+        const double sigma = qMax(MINIMUM_SIGMA, MAD_TO_SIGMA * deviations[n / 2]);
+
+        double change = 0;
+        for (int k=0; k < n; k++)
+        {
+            double w;
+            if (iteration < HUBER_ITERATIONS)
+            {
+                const double z = fabs(residual[k]) / (HUBER_K * sigma);
+                w = z <= 1 ? 1 : 1 / z;
+            }
+            else
+            {
+                const double z = residual[k] / (TUKEY_C * sigma);
+                w = fabs(z) < 1 ? (1 - z * z) * (1 - z * z) : 0;
+            }
+
+            change = qMax(change, fabs(w - weight[k]));
+            weight[k] = w;
+        }
+
+        if (iteration >= HUBER_ITERATIONS && change < 1e-4)
+            break;
+    }
+
+    // A parabola that opens downwards, or a curve fitted to too few samples, has no minimum
+    int kept=0;
+    double squares=0, weights=0;
+    for (int k=0; k < n; k++)
+    {
+        if (weight[k] > 0)
+            kept++;
+        squares += weight[k] * residual[k] * residual[k];
+        weights += weight[k];
+    }
+
+    if (A <= 0 || kept < MINIMUM_SAMPLES)
+        return fit;
+
+    const double minimum = -B / (2 * A);
+
+    fit.valid    = true;
+    fit.position = center + minimum * scale;
+    fit.HFR      = sqrt(qMax(0.0, C - A * minimum * minimum));
+    fit.slope    = sqrt(A) / scale;
+    fit.residual = weights > 0 ? sqrt(squares / weights) : 0;
+
+    for (int k=0; k < n; k++)
+    {
+        if (weight[k] <= 0)
+            continue;
+        if (u[k] <= minimum - margin / scale)
+            fit.below++;
+        if (u[k] >= minimum + margin / scale)
+            fit.above++;
+    }
+
+    return fit;
+}
+
+}
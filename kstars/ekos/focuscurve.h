@@ -0,0 +1,120 @@
+/*  Ekos Focus curve fitting
+    Copyright (C) 2026 KStars developers <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef FOCUSCURVE_H
+#define FOCUSCURVE_H
+
+#include <QList>
+#include <QVector>
+
+namespace Ekos
+{
+
+/**
+ * @brief The FocusCurve class finds the best focus position by fitting a curve to the HFR measured at a few positions.
+ *
+ * Instead of stepping towards focus and comparing each HFR with the previous one, FocusCurve samples a fixed set of
+ * positions around the starting position, from the outermost to the innermost one. The HFR of a defocused star grows
+ * like a hyperbola with the distance from focus, HFR = sqrt(a^2 + s^2 (x - c)^2), so the square of the HFR is a parabola
+ * in the position. The parabola is fitted with iteratively reweighted least squares, where samples that do not follow
+ * the curve lose their weight, and the focuser moves straight to its minimum c for a last verification exposure.
+ *
+ * If the minimum is not surrounded by samples, the sampled range is extended towards it, by at most half of the initial
+ * range per sample. Positions are in focuser ticks.
+ * @author KStars developers
+ */
+class FocusCurve
+{
+public:
+    /** @brief What the caller should do after addSample() */
+    typedef enum { CURVE_NEXT, CURVE_COMPLETE, CURVE_NO_MINIMUM, CURVE_TRAVEL_LIMIT } Status;
+
+    /** @brief An HFR measured at a focuser position */
+    struct Sample
+    {
+        double position;
+        double HFR;
+    };
+
+    /** @brief A hyperbola fitted to samples */
+    struct Fit
+    {
+        bool valid;                 // False if the samples do not have a minimum
+        double position;            // Position of the minimum, c
+        double HFR;                 // HFR at the minimum, a
+        double slope;               // Growth of the HFR far from focus, s, in pixels per tick
+        double residual;            // RMS of the HFR residuals of the samples that keep their weight, pixels
+        int below, above;           // Samples that keep their weight on either side of the minimum, past the margin
+    };
+
+    FocusCurve();
+
+    /**
+     * @brief start Plan the samples of a new autofocus run. The first sample is expected at the starting position.
+     * @param position Current position of the focuser
+     * @param step Distance between two samples, ticks
+     * @param sampleCount Number of samples before the first fit, at least 5. Even counts are rounded up.
+     * @param minPosition Lowest position of the focuser
+     * @param maxPosition Highest position of the focuser
+     * @param maxTravel Largest distance from the starting position, ticks
+     * @param tolerance Relative HFR tolerance of the verification exposure, percent
+     */
+    void start(double position, double step, int sampleCount, double minPosition, double maxPosition, double maxTravel, double tolerance);
+
+    /**
+     * @brief addSample Record the HFR measured at a position and decide what to do next
+     * @param HFR Measured HFR, or -1 if no star was detected, in which case the sample is skipped
+     * @return CURVE_NEXT to measure again at nextPosition(), CURVE_COMPLETE if the position of the sample is at focus,
+     * CURVE_NO_MINIMUM or CURVE_TRAVEL_LIMIT if the run failed.
+     */
+    Status addSample(double position, double HFR);
+
+    /** @return the position where the next sample should be measured */
+    double nextPosition() const { return m_next; }
+
+    /** @return the samples measured so far, in order */
+    const QVector<Sample> &samples() const { return m_samples; }
+
+    /** @return the last fit of the samples */
+    const Fit &fit() const { return m_fit; }
+
+    /**
+     * @brief fitHyperbola Fit HFR = sqrt(a^2 + s^2 (x - c)^2) to samples with robust least squares
+     * @param margin Samples closer than this to the minimum are not counted on either of its sides, ticks
+     * @return the fit, not valid if there are fewer than four distinct positions or the samples have no minimum
+     */
+    static Fit fitHyperbola(const QVector<Sample> &samples, double margin = 0);
+
+private:
+    /** @return Fit the samples and either plan the verification at the minimum, or extend the sampled range */
+    Status planNext(double position);
+
+    /** @return True if the focuser may move to the given position */
+    bool reachable(double position) const;
+
+    QVector<Sample> m_samples;
+    QList<double> m_plan;       // Positions still to sample
+    Fit m_fit;
+
+    double m_start;
+    double m_step;
+    double m_jump;              // Largest extension of the sampled range at once
+    double m_minPosition, m_maxPosition;
+    double m_maxTravel;
+    double m_tolerance;
+    double m_next;
+    double m_bestHFR;           // Lowest HFR sampled before the verification
+    int m_extensions;
+    int m_verifications;
+    bool m_verifying;
+};
+
+}
+
+#endif // FOCUSCURVE_H
@@ -475,6 +475,8 @@ void Guide::newFITS(IBLOB *bp)
 {
     INDI_UNUSED(bp);
 
+    frameTimer.start();
+
     //FITSViewer *fv = currentCCD->getViewer();
 
     disconnect(currentCCD, SIGNAL(BLOBUpdated(IBLOB*)), this, SLOT(newFITS(IBLOB*)));
@@ -654,6 +656,14 @@ bool Guide::sendPulse( GuideDirection dir, int msecs )
 
 }
 
+double Guide::getFrameLatency() const
+{
+    if (frameTimer.isValid() == false)
+        return -1;
+
+    return frameTimer.nsecsElapsed() / 1e6;
+}
+
 QStringList Guide::getST4Devices()
 {
     QStringList devices;
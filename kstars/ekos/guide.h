@@ -11,6 +11,7 @@
 #define guide_H
 
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QtDBus/QtDBus>
 
 #include "indi/indistd.h"
@@ -205,6 +206,9 @@ public:
 
     QVector3D getStarPosition() { return starCenter; }
 
+    // Time elapsed since the last guide frame was received, in milliseconds, or -1 if none was received
+    double getFrameLatency() const;
+
     // Tracking Box
     void setTrackingBoxSize(int index) { boxSizeCombo->setCurrentIndex(index); }
     int getTrackingBoxSize() { return boxSizeCombo->currentText().toInt(); }
@@ -334,6 +338,9 @@ private:
 
     QVector3D starCenter;
 
+    // Started when a guide frame is received, to measure the latency of the guide loop
+    QElapsedTimer frameTimer;
+
     QStringList logText;
 
     double ccd_hor_pixel, ccd_ver_pixel, focal_length, aperture, guideDeviationRA, guideDeviationDEC;
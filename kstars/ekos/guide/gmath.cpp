@@ -16,6 +16,8 @@
 #include <math.h>
 #include <string.h>
 
+#include <QElapsedTimer>
+
 #include "vect.h"
 #include "matr.h"
 
@@ -59,6 +61,7 @@ cgmath::cgmath() : QObject()
     preview_mode = true;
     suspended	 = false;
     lost_star    = false;
+    centroidTime = 0;
     useRapidGuide = false;
     dec_swap = false;
 
@@ -129,7 +132,10 @@ void cgmath::setImageView(FITSView *image)
     if (guideView)
     {
         FITSData *image_data = guideView->getImageData();
-        setDataBuffer(image_data->getImageBuffer());
+        // The guide algorithms work on float pixels, convert the frame once here
+        imageBuffer.resize(image_data->getSize());
+        image_data->getFloatBuffer(imageBuffer.data());
+        setDataBuffer(imageBuffer.data());
         setVideoParameters(image_data->getWidth(), image_data->getHeight());
     }
 }
@@ -595,10 +601,142 @@ void cgmath::setLostStar(bool is_lost)
     lost_star = is_lost;
 }
 
-Vector cgmath::findLocalStarPosition( void ) const
+// Weights of the rings of the 9x9 template of the CENTROID_THRESHOLD algorithm, from the
+// center outwards. Ring 8 is everything in the 9x9 window that is in none of the other rings.
+static const double TEMPLATE_WEIGHT[9] = { 0.906, 0.584, 0.365, 0.117, 0.049, -0.05, -0.064, -0.074, -0.094 };
+
+// Number of pixels the template assumes in each ring, and in the whole window, when it
+// subtracts the average of the window from the ring sums
+static const double TEMPLATE_RING_SIZE[9] = { 1, 4, 4, 4, 8, 4, 4, 8, 48 };
+#define TEMPLATE_WINDOW_SIZE 85.0
+
+// Minimum template response of a star
+#define TEMPLATE_MIN_FIT 50
+
+Vector cgmath::findTemplateStarPosition( const float *image, int width, int height, const QRect &trackingBox )
 {
-    static double P0 = 0.906, P1 = 0.584, P2 = 0.365, P3 = 0.117, P4 = 0.049, P5 = -0.05, P6 = -0.064, P7 = -0.074, P8 = -0.094;
+    // The template response at a pixel is
+    //   sum_k P_k * ( ring_k - n_k * window / 85 )
+    // Ring 8 is the window minus the inner rings, so this is also
+    //   sum_(k<8) ( P_k - P_8 ) * ring_k + ( P_8 - sum_k P_k * n_k / 85 ) * window
+    // The window sums come from a summed-area table at a constant cost per pixel, so only the
+    // 35 pixels of the inner rings are read for each position, instead of the 81 of the window.
+    // The inner rings are summed for a whole row of positions at once, which vectorizes.
+
+    // Window centers for which the 9x9 window lies in the image
+    int x0 = qMax( trackingBox.x(), 4 );
+    int x1 = qMin( trackingBox.x() + trackingBox.width(), width - 4 );
+    int y0 = qMax( trackingBox.y(), 4 );
+    int y1 = qMin( trackingBox.y() + trackingBox.height(), height - 4 );
+    if ( image == NULL || x1 <= x0 || y1 <= y0 )
+        return Vector(-1,-1,-1);
+
+    const int cols = x1 - x0;
+
+    // Summed-area table of the pixels covered by all the windows, with a leading row and column of zeros
+    const int satWidth  = cols + 9;
+    const int satHeight = y1 - y0 + 9;
+    QVector<double> sat( satWidth * satHeight, 0.0 );
+    for ( int j = 1; j < satHeight; j++ )
+    {
+        const float *row = image + ( y0 - 5 + j ) * width + x0 - 4;
+        const double *above = sat.constData() + ( j - 1 ) * satWidth;
+        double *sum = sat.data() + j * satWidth;
+        double rowSum = 0;
+        for ( int i = 1; i < satWidth; i++ )
+        {
+            rowSum += row[i - 1];
+            sum[i] = above[i] + rowSum;
+        }
+    }
+
+    double normalization = 0;
+    for ( int k = 0; k < 9; k++ )
+        normalization += TEMPLATE_WEIGHT[k] * TEMPLATE_RING_SIZE[k];
+    const double windowWeight = TEMPLATE_WEIGHT[8] - normalization / TEMPLATE_WINDOW_SIZE;
+
+    float w[8];
+    for ( int k = 0; k < 8; k++ )
+        w[k] = TEMPLATE_WEIGHT[k] - TEMPLATE_WEIGHT[8];
+
+    QVector<float> fitRow( cols );
+    float *fit = fitRow.data();
+    double bestFit = 0;
+    int ix = 0, iy = 0;
+
+    for ( int y = y0; y < y1; y++ )
+    {
+        const double *top    = sat.constData() + ( y - y0 ) * satWidth;
+        const double *bottom = top + 9 * satWidth;
+        for ( int i = 0; i < cols; i++ )
+            fit[i] = windowWeight * ( bottom[i + 9] - bottom[i] - top[i + 9] + top[i] );
+
+        // Rows y-3 ... y+3 of the window, starting at the first window center
+        const float *r0 = image + ( y - 3 ) * width + x0;
+        const float *r1 = r0 + width, *r2 = r1 + width, *r3 = r2 + width;
+        const float *r4 = r3 + width, *r5 = r4 + width, *r6 = r5 + width;
+
+        for ( int i = 0; i < cols; i++ )
+        {
+            float s0 = r3[i];
+            float s1 = r3[i-1] + r3[i+1] + r2[i] + r4[i];
+            float s2 = r2[i-1] + r2[i+1] + r4[i-1] + r4[i+1];
+            float s3 = r3[i-2] + r3[i+2] + r1[i] + r5[i];
+            float s4 = r1[i-1] + r1[i+1] + r5[i-1] + r5[i+1] + r2[i-2] + r2[i+2] + r4[i-2] + r4[i+2];
+            float s5 = r1[i-2] + r1[i+2] + r5[i-2] + r5[i+2];
+            float s6 = r3[i-3] + r3[i+3] + r0[i] + r6[i];
+            // Ring 7 is not symmetric in the original template, keep it that way
+            float s7 = r0[i-1] + r0[i+1] + r6[i-1] + r6[i+1] + r2[i-3] + r4[i-3];
+            fit[i] += w[0]*s0 + w[1]*s1 + w[2]*s2 + w[3]*s3 + w[4]*s4 + w[5]*s5 + w[6]*s6 + w[7]*s7;
+        }
+
+        for ( int i = 0; i < cols; i++ )
+        {
+            if ( bestFit < fit[i] )
+            {
+                bestFit = fit[i];
+                ix = x0 + i;
+                iy = y;
+            }
+        }
+    }
+
+    if ( bestFit <= TEMPLATE_MIN_FIT )
+        return Vector(-1,-1,-1);
+
+    // Sub-pixel position: centroid of the window around the best match, after subtracting
+    // the background, estimated from the border of the window
+    double background = 0;
+    for ( int d = -4; d < 4; d++ )
+    {
+        background += image[ ( iy - 4 ) * width + ix + d ] + image[ ( iy + 4 ) * width + ix - d ];
+        background += image[ ( iy - d ) * width + ix - 4 ] + image[ ( iy + d ) * width + ix + 4 ];
+    }
+    background /= 32.0;
+
+    double sumX = 0, sumY = 0, total = 0;
+    for ( int y = iy - 4; y <= iy + 4; y++ )
+    {
+        const float *p = image + y * width + ix - 4;
+        for ( int x = ix - 4; x <= ix + 4; x++ )
+        {
+            double value = *p++ - background;
+            if ( value <= 0 )
+                continue;
+            sumX  += x * value;
+            sumY  += y * value;
+            total += value;
+        }
+    }
 
+    if ( total > 0 )
+        return Vector( sumX / total, sumY / total, 0 );
+
+    return Vector( ix, iy, 0 );
+}
+
+Vector cgmath::findLocalStarPosition( void ) const
+{
     Vector ret;
     int i, j;
     double resx, resy, mass, threshold, pval;
@@ -629,66 +767,8 @@ Vector cgmath::findLocalStarPosition( void ) const
     switch( square_alg_idx )
     {
     case CENTROID_THRESHOLD:
-    {
-        int width = trackingBox.width();
-        int height = trackingBox.width();
-        float i0, i1, i2, i3, i4, i5, i6, i7, i8;
-        int ix = 0, iy = 0;
-        int xM4;
-        float *p;
-        double average, fit, bestFit = 0;
-        int minx = 0;
-        int maxx = width;
-        int miny = 0;
-        int maxy = height;
-        for (int x = minx; x < maxx; x++)
-            for (int y = miny; y < maxy; y++)
-            {
-                i0 = i1 = i2 = i3 = i4 = i5 = i6 = i7 = i8 = 0;
-                xM4 = x - 4;
-                p = psrc + (y - 4) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y - 3) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i7 += *p++; i6 += *p++; i7 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y - 2) * video_width + xM4; i8 += *p++; i8 += *p++; i5 += *p++; i4 += *p++; i3 += *p++; i4 += *p++; i5 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y - 1) * video_width + xM4; i8 += *p++; i7 += *p++; i4 += *p++; i2 += *p++; i1 += *p++; i2 += *p++; i4 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y + 0) * video_width + xM4; i8 += *p++; i6 += *p++; i3 += *p++; i1 += *p++; i0 += *p++; i1 += *p++; i3 += *p++; i6 += *p++; i8 += *p++;
-                p = psrc + (y + 1) * video_width + xM4; i8 += *p++; i7 += *p++; i4 += *p++; i2 += *p++; i1 += *p++; i2 += *p++; i4 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y + 2) * video_width + xM4; i8 += *p++; i8 += *p++; i5 += *p++; i4 += *p++; i3 += *p++; i4 += *p++; i5 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y + 3) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i7 += *p++; i6 += *p++; i7 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
-                p = psrc + (y + 4) * video_width + xM4; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++; i8 += *p++;
-                average = (i0 + i1 + i2 + i3 + i4 + i5 + i6 + i7 + i8) / 85.0;
-                fit = P0 * (i0 - average) + P1 * (i1 - 4 * average) + P2 * (i2 - 4 * average) + P3 * (i3 - 4 * average) + P4 * (i4 - 8 * average) + P5 * (i5 - 4 * average) + P6 * (i6 - 4 * average) + P7 * (i7 - 8 * average) + P8 * (i8 - 48 * average);
-                if (bestFit < fit)
-                {
-                    bestFit = fit;
-                    ix = x;
-                    iy = y;
-                }
-            }
-
-        if (bestFit > 50)
-        {
-            double sumX = 0;
-            double sumY = 0;
-            double total = 0;
-            for (int y = iy - 4; y <= iy + 4; y++) {
-                p = psrc + y * width + ix - 4;
-                for (int x = ix - 4; x <= ix + 4; x++) {
-                    double w = *p++;
-                    sumX += x * w;
-                    sumY += y * w;
-                    total += w;
-                }
-            }
-            if (total > 0)
-            {
-                ret = (Vector(trackingBox.x(), trackingBox.y(), 0) + Vector(sumX/total , sumY/total, 0));
-                return ret;
-            }
-        }
+        return findTemplateStarPosition( pdata, video_width, video_height, trackingBox );
 
-       return Vector(-1,-1,-1);
-    }
-        break;
         // Alexander's Stepanenko smart threshold algorithm
     case SMART_THRESHOLD:
     {
@@ -926,7 +1006,8 @@ void cgmath::process_axes( void  )
 
     QTextStream out(logFile);
     out << ticks << "," << logTime.elapsed() << "," << out_params.delta[0] << "," << out_params.pulse_length[0] << "," << get_direction_string(out_params.pulse_dir[0])
-            << "," << out_params.delta[1] << "," << out_params.pulse_length[1] << "," << get_direction_string(out_params.pulse_dir[1]) << endl;
+            << "," << out_params.delta[1] << "," << out_params.pulse_length[1] << "," << get_direction_string(out_params.pulse_dir[1])
+            << "," << centroidTime << endl;
 
 }
 
@@ -940,7 +1021,10 @@ void cgmath::performProcessing( void )
         return;
 
     // find guiding star location in
+    QElapsedTimer centroidTimer;
+    centroidTimer.start();
     scr_star_pos = star_pos = findLocalStarPosition();
+    centroidTime = centroidTimer.nsecsElapsed() / 1e6;
 
     if (star_pos.x == -1 || star_pos.y == -1)
     {
@@ -18,6 +18,7 @@
 #include <QObject>
 #include <QTime>
 #include <QPointer>
+#include <QVector>
 
 #include "fitsviewer/fitsview.h"
 
@@ -155,6 +156,13 @@ public:
     Vector findLocalStarPosition( void ) const;
     bool isStarLost(void) const;
     void setLostStar(bool is_lost);
+    // Time taken by findLocalStarPosition() in the last call to performProcessing(), in milliseconds
+    double getCentroidTime( void ) const { return centroidTime; }
+
+    // Find the star that best matches the 9x9 ring template of the CENTROID_THRESHOLD algorithm
+    // in the tracking box, and return its sub-pixel position in image coordinates, or (-1,-1,-1)
+    // if no star is found. Template windows that would cross the edges of the image are skipped.
+    static Vector findTemplateStarPosition( const float *image, int width, int height, const QRect &trackingBox );
 
     // Main processing function
     void performProcessing( void );
@@ -179,11 +187,13 @@ private:
     // sys...
     uint32_t ticks;		// global channel ticker
     float *pdata;		// pointer to data buffer
+    QVector<float> imageBuffer;	// guide frame converted to float
     QPointer<FITSView> guideView;   // pointer to image
     int video_width, video_height;	// video frame dimensions
     double ccd_pixel_width, ccd_pixel_height, aperture, focal;
     Matrix	ROT_Z;
     bool preview_mode, suspended, lost_star, dec_swap;
+    double centroidTime;
 
     // square variables
     int squareSize;	// size of analysing square
@@ -52,6 +52,9 @@ internalGuider::internalGuider(cgmath *mathObject, Ekos::Guide *parent)
 
     m_lostStarTries=0;
 
+    latencyCount = 0;
+    latencySum = latencyMax = 0;
+
     ui.comboBox_ThresholdAlg->clear();
     for( i = 0;guide_square_alg[i].idx != -1;++i )
         ui.comboBox_ThresholdAlg->addItem( QString( guide_square_alg[i].name ) );
@@ -206,6 +209,8 @@ void internalGuider::setInterface( void )
     ui.l_ErrRA->setText( QString().setNum(out_params->sigma[GUIDE_RA], 'g', 3) );
     ui.l_ErrDEC->setText( QString().setNum(out_params->sigma[GUIDE_DEC], 'g' , 3) );
 
+    ui.l_Latency->setText("--");
+
 }
 
 
@@ -401,9 +406,11 @@ bool internalGuider::start()
     out << "Aperture,mm: " << ui.l_Aperture->text() << endl;
     out << "F/D: " << ui.l_FbyD->text() << endl;
     out << "FOV: " << ui.l_FOV->text() << endl;
-    out << "Frame #, Time Elapsed (ms), RA Error (arcsec), RA Correction (ms), RA Correction Direction, DEC Error (arcsec), DEC Correction (ms), DEC Correction Direction"  << endl;
+    out << "Frame #, Time Elapsed (ms), RA Error (arcsec), RA Correction (ms), RA Correction Direction, DEC Error (arcsec), DEC Correction (ms), DEC Correction Direction, Centroid Time (ms)"  << endl;
 
     drift_graph->reset_data();
+    latencyCount = 0;
+    latencySum = latencyMax = 0;
     ui.pushButton_StartStop->setText( i18n("Stop") );
     guideModule->appendLogText(i18n("Autoguiding started."));
     pmath->start();
@@ -448,6 +455,9 @@ bool internalGuider::stop()
         connect(guideFrame, SIGNAL(trackingStarSelected(int,int)), this, SLOT(trackingStarSelected(int,int)), Qt::UniqueConnection);
     ui.pushButton_StartStop->setText( i18n("Start Autoguide") );
     guideModule->appendLogText(i18n("Autoguiding stopped."));
+    if (latencyCount > 0)
+        guideModule->appendLogText(i18n("Guide loop latency over %1 frames: average %2 ms, maximum %3 ms.", latencyCount,
+                                        QString::number(latencySum / latencyCount, 'f', 1), QString::number(latencyMax, 'f', 1)));
     pmath->stop();
 
     first_frame = false;
@@ -628,6 +638,8 @@ void internalGuider::guide( void )
 
     guideModule->sendPulse( out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA], out->pulse_dir[GUIDE_DEC], out->pulse_length[GUIDE_DEC] );
 
+    updateLatency();
+
     if (m_isDithering)
         return;
 
@@ -662,6 +674,26 @@ void internalGuider::guide( void )
     emit newProfilePixmap(profilePixmap);
 }
 
+void internalGuider::updateLatency()
+{
+    double centroid = pmath->getCentroidTime();
+    double total = guideModule->getFrameLatency();
+
+    // No frames are received with rapid guiding
+    if (m_useRapidGuide || total < 0)
+        return;
+
+    latencyCount++;
+    latencySum += total;
+    if (total > latencyMax)
+        latencyMax = total;
+
+    ui.l_Latency->setText(QString("%1 / %2").arg(centroid, 0, 'f', 1).arg(total, 0, 'f', 1));
+
+    if (Options::guideLogging())
+        qDebug() << "Guide: Latency, frame received to pulse issued: " << total << " ms, centroid: " << centroid << " ms";
+}
+
 void internalGuider::setImageView(FITSView *image)
 {
     guideFrame = image;
@@ -114,6 +114,11 @@ private:
     QFile logFile;
     QPixmap profilePixmap;
 
+    // Guide loop latency statistics since guiding started
+    void updateLatency();
+    int latencyCount;
+    double latencySum, latencyMax;
+
 private:
     Ui::guiderClass ui;
 };
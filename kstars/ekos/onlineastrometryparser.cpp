@@ -115,7 +115,6 @@ bool OnlineAstrometryParser::startSovler(const QString &in_filename, const QStri
                 display_image->setColor(i, qRgb(i,i,i));
 
             image_data->getMinMax(&min, &max);
-            float *image_buffer = image_data->getImageBuffer();
 
             bscale = 255. / (max - min);
             bzero  = (-min) * (255. / (max - min));
@@ -127,7 +126,7 @@ bool OnlineAstrometryParser::startSovler(const QString &in_filename, const QStri
             for (int j = 0; j < h; j++)
                 for (int i = 0; i < w; i++)
                 {
-                    val = image_buffer[j * w + i];
+                    val = image_data->getValue(j * w + i);
                     display_image->setPixel(i, j, ((int) (val * bscale + bzero)));
                 }
 
@@ -29,6 +29,7 @@
 #include "skymapcomposite.h"
 #include "kstarsdata.h"
 #include "ksmoon.h"
+#include "constraintsolver.h"
 #include "ksalmanac.h"
 #include "ksutils.h"
 #include "mosaic.h"
@@ -1012,6 +1013,8 @@ void Scheduler::pause()
 
 void Scheduler::evaluateJobs()
 {
+    solveAltitudeTimes();
+
     foreach(SchedulerJob *job, jobs)
     {
         if (job->getState() > SchedulerJob::JOB_SCHEDULED)
@@ -1469,53 +1472,76 @@ double Scheduler::findAltitude(const SkyPoint & target, const QDateTime when)
     return p.alt().Degrees();
 }
 
-bool Scheduler::calculateAltitudeTime(SchedulerJob *job, double minAltitude, double minMoonAngle)
+ConstraintSolver::Target Scheduler::getSolverTarget(SchedulerJob *job, double minAltitude, double minMoonAngle)
+{
+    ConstraintSolver::Target target;
+    target.ra                = job->getTargetCoords().ra().radians();
+    target.dec               = job->getTargetCoords().dec().radians();
+    target.minAltitude       = minAltitude;
+    target.minMoonSeparation = minMoonAngle;
+    return target;
+}
+
+void Scheduler::solveAltitudeTimes()
 {
     // We wouldn't stat observation 30 mins (default) before dawn.
     double earlyDawn = Dawn - Options::preDawnTime()/(60.0 * 24.0);
-    double altitude=0;
-    QDateTime lt( KStarsData::Instance()->lt().date(), QTime() );
-    KStarsDateTime ut = geo->LTtoUT( lt );
+    QDateTime now = KStarsData::Instance()->lt();
 
-    SkyPoint target = job->getTargetCoords();
-
-    QTime now = KStarsData::Instance()->lt().time();
-    double fraction = now.hour() + now.minute()/60.0 + now.second()/3600;
-    double rawFrac  = 0;
+    constraintSolver.update(now, geo, moon, Dawn, Dusk, earlyDawn);
 
-    for (double hour=fraction; hour < (fraction+24); hour+= 1.0/60.0)
+    // Solve all jobs that may need calculateAltitudeTime() at once, in parallel
+    QList<SchedulerJob *> asapJobs;
+    QVector<ConstraintSolver::Target> targets;
+    foreach(SchedulerJob *job, jobs)
     {
-        KStarsDateTime myUT = ut.addSecs(hour * 3600.0);
-
-        rawFrac = (hour > 24 ? (hour - 24) : hour) / 24.0;
+        if (job->getState() > SchedulerJob::JOB_SCHEDULED || job->getStartupCondition() != SchedulerJob::START_ASAP)
+            continue;
 
-        if (rawFrac < Dawn || rawFrac > Dusk)
-        {
-            CachingDms LST = geo->GSTtoLST( myUT.gst() );
-            target.EquatorialToHorizontal( &LST, geo->lat() );
-            altitude =  target.alt().Degrees();
+        asapJobs.append(job);
+        targets.append(getSolverTarget(job, job->getMinAltitude() > 0 ? job->getMinAltitude() : 0, job->getMinMoonSeparation()));
+    }
 
-            if (altitude > minAltitude)
-            {
-                QDateTime startTime = geo->UTtoLT(myUT);
+    QVector<ConstraintSolver::Result> results = constraintSolver.solve(targets, now);
 
-                if (rawFrac > earlyDawn && rawFrac < Dawn)
-                {
-                    appendLogText(i18n("%1 reaches an altitude of %2 degrees at %3 but will not be scheduled due to close proximity to astronomical twilight rise.", job->getName(), QString::number(minAltitude,'g', 3), startTime.toString()));
-                    return false;
-                }
+    altitudeTimes.clear();
+    for (int i=0; i < asapJobs.count(); i++)
+        altitudeTimes[asapJobs[i]] = qMakePair(targets[i], results[i]);
+}
 
-                if (minMoonAngle > 0 && getMoonSeparationScore(job, startTime) < 0)
-                    continue;
+bool Scheduler::calculateAltitudeTime(SchedulerJob *job, double minAltitude, double minMoonAngle)
+{
+    ConstraintSolver::Target target = getSolverTarget(job, minAltitude, minMoonAngle);
+    ConstraintSolver::Result result;
+
+    // Use the result of solveAltitudeTimes() if it was for the same constraints
+    QPair<ConstraintSolver::Target, ConstraintSolver::Result> solved;
+    if (altitudeTimes.contains(job))
+        solved = altitudeTimes.value(job);
+    if (altitudeTimes.contains(job) && solved.first.ra == target.ra && solved.first.dec == target.dec &&
+            solved.first.minAltitude == target.minAltitude && solved.first.minMoonSeparation == target.minMoonSeparation)
+        result = solved.second;
+    else
+    {
+        double earlyDawn = Dawn - Options::preDawnTime()/(60.0 * 24.0);
+        constraintSolver.update(KStarsData::Instance()->lt(), geo, moon, Dawn, Dusk, earlyDawn);
+        result = constraintSolver.solve(target, KStarsData::Instance()->lt());
+    }
 
-                job->setStartupTime(startTime);
-                job->setStartupCondition(SchedulerJob::START_AT);
-                appendLogText(i18n("%1 is scheduled to start at %2 where its altitude is %3 degrees.", job->getName(), startTime.toString(), QString::number(altitude,'g', 3)));
-                return true;
-            }
+    switch (result.status)
+    {
+        case ConstraintSolver::SOLVE_FOUND:
+            job->setStartupTime(result.time);
+            job->setStartupCondition(SchedulerJob::START_AT);
+            appendLogText(i18n("%1 is scheduled to start at %2 where its altitude is %3 degrees.", job->getName(), result.time.toString(), QString::number(result.altitude,'g', 3)));
+            return true;
 
-        }
+        case ConstraintSolver::SOLVE_PRE_DAWN:
+            appendLogText(i18n("%1 reaches an altitude of %2 degrees at %3 but will not be scheduled due to close proximity to astronomical twilight rise.", job->getName(), QString::number(minAltitude,'g', 3), result.time.toString()));
+            return false;
 
+        case ConstraintSolver::SOLVE_NOT_FOUND:
+            break;
     }
 
     if (minMoonAngle == -1)
@@ -1788,19 +1814,32 @@ int16_t Scheduler::getMoonSeparationScore(SchedulerJob *job, QDateTime when)
     p.EquatorialToHorizontal( &LST, geo->lat() );
     double currentAlt = p.alt().Degrees();
 
-    // Update moon
-    ut = geo->LTtoUT(when);
-    KSNumbers ksnum(ut.djd());
-    LST = geo->GSTtoLST( ut.gst() );
-    moon->updateCoords(&ksnum, true, geo->lat(), &LST, true);
+    double moonAltitude, illum, separation;
+    ConstraintSolver::MoonPosition moonPosition;
 
-    double moonAltitude = moon->alt().Degrees();
+    // Use the Moon ephemeris of the constraint solver if it covers the time, and only compute the Moon otherwise
+    if (constraintSolver.covers(when) && constraintSolver.moonPosition(constraintSolver.offset(when), moonPosition, moonAltitude))
+    {
+        illum = moonPosition.illumination * 100.0;
+        SkyPoint moonPoint(dms(moonPosition.ra * 180.0 / dms::PI), dms(moonPosition.dec * 180.0 / dms::PI));
+        separation = moonPoint.angularDistanceTo(&p).Degrees();
+    }
+    else
+    {
+        // Update moon
+        ut = geo->LTtoUT(when);
+        KSNumbers ksnum(ut.djd());
+        LST = geo->GSTtoLST( ut.gst() );
+        moon->updateCoords(&ksnum, true, geo->lat(), &LST, true);
 
-    // Lunar illumination %
-    double illum = moon->illum() * 100.0;
+        moonAltitude = moon->alt().Degrees();
 
-    // Moon/Sky separation p
-    double separation = moon->angularDistanceTo(&p).Degrees();
+        // Lunar illumination %
+        illum = moon->illum() * 100.0;
+
+        // Moon/Sky separation p
+        separation = moon->angularDistanceTo(&p).Degrees();
+    }
 
     // Zenith distance of the moon
     double zMoon = (90 - moonAltitude);
@@ -20,6 +20,7 @@
 #include "ui_scheduler.h"
 #include "scheduler.h"
 #include "schedulerjob.h"
+#include "constraintsolver.h"
 #include "QProgressIndicator.h"
 #include "align.h"
 
@@ -342,6 +343,17 @@ private:
          */
         bool    calculateAltitudeTime(SchedulerJob *job, double minAltitude, double minMoonAngle=-1);
 
+        /**
+         * @brief solveAltitudeTimes Solve the altitude and moon constraints of all jobs that start as soon as possible, in
+         * parallel, so that calculateAltitudeTime() does not have to solve them one by one.
+         */
+        void    solveAltitudeTimes();
+
+        /**
+         * @brief getSolverTarget Get the target and constraints of a job as used by the constraint solver
+         */
+        ConstraintSolver::Target getSolverTarget(SchedulerJob *job, double minAltitude, double minMoonAngle);
+
         /**
          * @brief calculateCulmination find culmination time adjust for the job offset
          * @param job Active job
@@ -531,6 +543,8 @@ private:
     QProcess scriptProcess;         // Startup and Shutdown scripts process
 
     double Dawn, Dusk;              // Store day fraction of dawn and dusk to calculate dark skies range
+    ConstraintSolver constraintSolver;  // Altitude, twilight and moon constraint windows for the next 24 hours
+    QHash<SchedulerJob *, QPair<ConstraintSolver::Target, ConstraintSolver::Result> > altitudeTimes; // Results of solveAltitudeTimes()
     QDateTime preDawnDateTime;      // Pre-dawn is where we stop all jobs, it is a user-configurable value before Dawn.
     QDateTime duskDateTime;         // Dusk date time
     bool mDirty;                    // Was job modified and needs saving?
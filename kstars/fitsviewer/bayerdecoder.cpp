@@ -0,0 +1,896 @@
+/***************************************************************************
+                  bayerdecoder.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "bayerdecoder.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <QPair>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+// The bilinear interpolation and the VNG gradients are computed VF_WIDTH
+// samples at a time, in float lanes, using AVX2 when KStars is compiled
+// for it, and SSE2 otherwise. Integer samples of up to 16 bits and their
+// sums are exact in a float. The remaining samples, and all samples on
+// other architectures, go through the scalar loops.
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VF_WIDTH 8
+#define vf_load    _mm256_loadu_ps
+#define vf_store   _mm256_storeu_ps
+#define vf_set1    _mm256_set1_ps
+#define vf_zero    _mm256_setzero_ps
+#define vf_add     _mm256_add_ps
+#define vf_mul     _mm256_mul_ps
+#define vf_min     _mm256_min_ps
+#define vf_max     _mm256_max_ps
+#define vf_and     _mm256_and_ps
+#define vf_andnot  _mm256_andnot_ps
+#define vf_or      _mm256_or_ps
+#define vf_cmple( a, b ) _mm256_cmp_ps( a, b, _CMP_LE_OQ )
+#define vf_movemask _mm256_movemask_ps
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VF_WIDTH 4
+#define vf_load    _mm_loadu_ps
+#define vf_store   _mm_storeu_ps
+#define vf_set1    _mm_set1_ps
+#define vf_zero    _mm_setzero_ps
+#define vf_add     _mm_add_ps
+#define vf_mul     _mm_mul_ps
+#define vf_min     _mm_min_ps
+#define vf_max     _mm_max_ps
+#define vf_and     _mm_and_ps
+#define vf_andnot  _mm_andnot_ps
+#define vf_or      _mm_or_ps
+#define vf_cmple   _mm_cmple_ps
+#define vf_movemask _mm_movemask_ps
+#endif
+
+// Below this many rows per tile, the cost of handing work to the
+// thread pool exceeds the cost of decoding the rows.
+#define MIN_ROWS_PER_TILE   16
+
+// Number of tiles per worker thread
+#define TILES_PER_THREAD    4
+
+// Number of gradient directions of the VNG method
+#define VNG_DIRECTIONS      8
+
+// Number of terms of the VNG gradients
+#define VNG_TERMS           64
+
+enum { RED = 0, GREEN = 1, BLUE = 2 };
+
+namespace
+{
+
+// The arithmetic of the interpolation. Integer samples are interpolated in
+// an integer wide enough for the sums, with the rounding of bayer.c.
+template <typename T> struct BayerTraits { typedef int Acc; };
+template <> struct BayerTraits<int32_t> { typedef qint64 Acc; };
+template <> struct BayerTraits<float> { typedef float Acc; };
+
+template <typename A> inline A average2(A sum) { return (sum + 1) / 2; }
+inline float average2(float sum) { return sum * 0.5f; }
+
+template <typename A> inline A average4(A sum) { return (sum + 2) / 4; }
+inline float average4(float sum) { return sum * 0.25f; }
+
+template <typename A> inline A half(A value) { return value / 2; }
+inline float half(float value) { return value * 0.5f; }
+
+// One eighth of the Malvar-He-Cutler filter, given twice its sum. The
+// rounding bias of bayer.c is applied to twice the sum, before halving.
+template <typename A> inline A highQuality(A twice, int bias) { return ((twice + bias) / 2 + 4) >> 3; }
+inline float highQuality(float twice, int) { return twice / 16.0f; }
+
+// The difference of two samples of a VNG gradient term, doubled for the terms of weight 1
+template <typename A> inline A gradient(A a, A b, int weight) { return std::abs(a - b) << weight; }
+inline float gradient(float a, float b, int weight) { return std::fabs(a - b) * (weight ? 2.0f : 1.0f); }
+
+// Convert an interpolated value to the sample type T, clamping it to the range of integer types
+template <typename T, typename A>
+inline T toSample(A value)
+{
+    if (std::numeric_limits<T>::is_integer)
+        return static_cast<T>(qBound(static_cast<A>(std::numeric_limits<T>::min()), value, static_cast<A>(std::numeric_limits<T>::max())));
+
+    return static_cast<T>(value);
+}
+
+// The mosaic after the bayer offsets. The layers have its stride and the
+// full height of the image.
+template <typename T>
+struct Mosaic
+{
+    const T *samples;   // First sample after the offsets
+    int stride;         // Samples per row of the mosaic and of the layers
+    int columns;        // Columns and rows of the mosaic after the offsets
+    int rows;
+    int height;         // Rows of the layers
+    int redX, redY;     // Position of the red sample in the 2x2 pattern
+
+    inline const T *row(int y) const { return samples + static_cast<size_t>(y) * stride; }
+
+    // Color of the sample at (x, y)
+    inline int color(int x, int y) const
+    {
+        const int dx = (x ^ redX) & 1, dy = (y ^ redY) & 1;
+        return dx != dy ? GREEN : (dx ? BLUE : RED);
+    }
+
+    // Color of the samples of row y that are not green
+    inline int rowColor(int y) const { return ((y ^ redY) & 1) ? BLUE : RED; }
+
+    // Parity of the columns of row y that are not green
+    inline int rowPhase(int y) const { return (redX ^ redY ^ y) & 1; }
+};
+
+template <typename T>
+inline void clearRow(T *const *out, int begin, int end)
+{
+    for (int c=0; c < 3; c++)
+        for (int x=begin; x < end; x++)
+            out[c][x] = 0;
+}
+
+template <typename T>
+inline void copyRow(const T *const *in, T *const *out, int begin, int end)
+{
+    for (int c=0; c < 3; c++)
+        memcpy(out[c] + begin, in[c] + begin, (end - begin) * sizeof(T));
+}
+
+#ifdef VF_WIDTH
+// Conversion of VF_WIDTH samples from and to float lanes. Integer
+// samples are truncated toward zero, as the integer division of bayer.c.
+inline vfloat loadSamples(const float *p) { return vf_load(p); }
+inline void storeSamples(float *p, vfloat v) { vf_store(p, v); }
+
+#if VF_WIDTH == 8
+inline vfloat loadSamples(const uint8_t *p)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+}
+
+inline vfloat loadSamples(const int16_t *p)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+}
+
+inline vfloat loadSamples(const uint16_t *p)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+}
+
+inline vfloat loadSamples(const int32_t *p)
+{
+    return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+}
+
+inline void storeSamples(int32_t *p, vfloat v)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm256_cvttps_epi32(v));
+}
+
+inline void storeSamples(int16_t *p, vfloat v)
+{
+    __m256i i = _mm256_cvttps_epi32(v);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+}
+
+inline void storeSamples(uint16_t *p, vfloat v)
+{
+    __m256i i = _mm256_cvttps_epi32(v);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+}
+
+inline void storeSamples(uint8_t *p, vfloat v)
+{
+    __m256i i = _mm256_cvttps_epi32(v);
+    __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packus_epi16(words, words));
+}
+#else
+inline vfloat loadSamples(const uint8_t *p)
+{
+    int32_t bytes;
+    memcpy(&bytes, p, sizeof(bytes));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero));
+}
+
+inline vfloat loadSamples(const int16_t *p)
+{
+    __m128i words = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16));
+}
+
+inline vfloat loadSamples(const uint16_t *p)
+{
+    __m128i words = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, _mm_setzero_si128()));
+}
+
+inline vfloat loadSamples(const int32_t *p)
+{
+    return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+inline void storeSamples(int32_t *p, vfloat v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvttps_epi32(v));
+}
+
+inline void storeSamples(int16_t *p, vfloat v)
+{
+    __m128i i = _mm_cvttps_epi32(v);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(i, i));
+}
+
+inline void storeSamples(uint16_t *p, vfloat v)
+{
+    // SSE2 has no unsigned pack of 32 bit integers: pack around 32768
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+    __m128i i = _mm_sub_epi32(_mm_cvttps_epi32(v), bias32);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_xor_si128(_mm_packs_epi32(i, i), bias16));
+}
+
+inline void storeSamples(uint8_t *p, vfloat v)
+{
+    __m128i i = _mm_cvttps_epi32(v);
+    __m128i words = _mm_packs_epi32(i, i);
+    int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    memcpy(p, &bytes, sizeof(bytes));
+}
+#endif
+
+// All bits set in every other lane, starting with lane start
+inline vfloat alternateLanes(int start)
+{
+    uint32_t bits[VF_WIDTH];
+    float lanes[VF_WIDTH];
+    for (int i=0; i < VF_WIDTH; i++)
+        bits[i] = (i & 1) == start ? 0xFFFFFFFFu : 0;
+    memcpy(lanes, bits, sizeof(lanes));
+    return vf_load(lanes);
+}
+
+// The lanes of a where mask is set, and of b elsewhere
+inline vfloat select(vfloat mask, vfloat a, vfloat b)
+{
+    return vf_or(vf_and(mask, a), vf_andnot(mask, b));
+}
+
+// Bilinear interpolation of the samples x ... end - 1 of a row, VF_WIDTH
+// at a time. Both kinds of samples are interpolated in every lane, and
+// the lanes of the green samples are taken from the ones and the lanes of
+// the other samples from the others. Returns the first sample left.
+template <typename T>
+int bilinearVectors(const T *up, const T *mid, const T *down, T *own, T *green, T *other, int x, int end, int phase)
+{
+    const float bias = std::numeric_limits<T>::is_integer ? 1.0f : 0.0f;
+    const vfloat bias2 = vf_set1(bias), bias4 = vf_set1(2.0f * bias);
+    const vfloat halves = vf_set1(0.5f), quarters = vf_set1(0.25f);
+    const vfloat colored = alternateLanes((x ^ phase) & 1);
+
+    for (; x + VF_WIDTH <= end; x += VF_WIDTH)
+    {
+        const vfloat c = loadSamples(mid + x);
+        const vfloat h = vf_add(loadSamples(mid + x - 1), loadSamples(mid + x + 1));
+        const vfloat v = vf_add(loadSamples(up + x), loadSamples(down + x));
+        const vfloat d = vf_add(vf_add(loadSamples(up + x - 1), loadSamples(up + x + 1)),
+                                vf_add(loadSamples(down + x - 1), loadSamples(down + x + 1)));
+
+        const vfloat horizontal = vf_mul(vf_add(h, bias2), halves);
+        const vfloat vertical   = vf_mul(vf_add(v, bias2), halves);
+        const vfloat cross      = vf_mul(vf_add(vf_add(h, v), bias4), quarters);
+        const vfloat diagonal   = vf_mul(vf_add(d, bias4), quarters);
+
+        storeSamples(own + x, select(colored, c, horizontal));
+        storeSamples(green + x, select(colored, cross, c));
+        storeSamples(other + x, select(colored, diagonal, vertical));
+    }
+
+    return x;
+}
+#endif
+
+// Each color takes the sample of its color in the 2x2 block at (x, y). The
+// green sample is the lower right one if the upper left one is green.
+template <typename T>
+void nearestRow(const Mosaic<T> &m, int y, T *const *out)
+{
+    int x = 0;
+
+    if (y < m.rows - 1)
+    {
+        const T *top = m.row(y), *bottom = m.row(y + 1);
+        const int n = m.rowColor(y), phase = m.rowPhase(y);
+
+        for (; x < m.columns - 1; x++)
+        {
+            if ((x ^ phase) & 1)
+            {
+                out[GREEN][x] = bottom[x + 1];
+                out[n][x]     = top[x + 1];
+                out[2 - n][x] = bottom[x];
+            }
+            else
+            {
+                out[n][x]     = top[x];
+                out[GREEN][x] = top[x + 1];
+                out[2 - n][x] = bottom[x + 1];
+            }
+        }
+    }
+
+    clearRow(out, x, m.stride);
+}
+
+// As nearestRow(), with the mean of the two green samples of the block
+template <typename T>
+void simpleRow(const Mosaic<T> &m, int y, T *const *out)
+{
+    typedef typename BayerTraits<T>::Acc Acc;
+    int x = 0;
+
+    if (y < m.rows - 1)
+    {
+        const T *top = m.row(y), *bottom = m.row(y + 1);
+        const int n = m.rowColor(y), phase = m.rowPhase(y);
+
+        for (; x < m.columns - 1; x++)
+        {
+            if ((x ^ phase) & 1)
+            {
+                out[GREEN][x] = toSample<T>(half(static_cast<Acc>(top[x]) + bottom[x + 1]));
+                out[n][x]     = top[x + 1];
+                out[2 - n][x] = bottom[x];
+            }
+            else
+            {
+                out[n][x]     = top[x];
+                out[GREEN][x] = toSample<T>(half(static_cast<Acc>(top[x + 1]) + bottom[x]));
+                out[2 - n][x] = bottom[x + 1];
+            }
+        }
+    }
+
+    clearRow(out, x, m.stride);
+}
+
+// The missing colors are the mean of the nearest samples of their color
+template <typename T>
+void bilinearRow(const Mosaic<T> &m, int y, T *const *out)
+{
+    typedef typename BayerTraits<T>::Acc Acc;
+    int x = 0;
+
+    if (y >= 1 && y < m.rows - 1 && m.columns > 2)
+    {
+        const T *up = m.row(y - 1), *mid = m.row(y), *down = m.row(y + 1);
+        const int n = m.rowColor(y), phase = m.rowPhase(y);
+        T *own = out[n], *green = out[GREEN], *other = out[2 - n];
+
+        own[0] = green[0] = other[0] = 0;
+        x = 1;
+
+#ifdef VF_WIDTH
+        x = bilinearVectors(up, mid, down, own, green, other, x, m.columns - 1, phase);
+#endif
+
+        for (; x < m.columns - 1; x++)
+        {
+            const Acc h = static_cast<Acc>(mid[x - 1]) + mid[x + 1];
+            const Acc v = static_cast<Acc>(up[x]) + down[x];
+
+            if ((x ^ phase) & 1)
+            {
+                own[x]   = static_cast<T>(average2(h));
+                green[x] = mid[x];
+                other[x] = static_cast<T>(average2(v));
+            }
+            else
+            {
+                const Acc d = (static_cast<Acc>(up[x - 1]) + up[x + 1]) + (static_cast<Acc>(down[x - 1]) + down[x + 1]);
+                own[x]   = mid[x];
+                green[x] = static_cast<T>(average4(h + v));
+                other[x] = static_cast<T>(average4(d));
+            }
+        }
+    }
+
+    clearRow(out, x, m.stride);
+}
+
+// High-Quality Linear Interpolation For Demosaicing Of Bayer-Patterned
+// Color Images, by Henrique S. Malvar, Li-wei He, and Ross Cutler
+template <typename T>
+void highQualityRow(const Mosaic<T> &m, int y, T *const *out)
+{
+    typedef typename BayerTraits<T>::Acc Acc;
+    int x = 0;
+
+    if (y >= 2 && y < m.rows - 2 && m.columns > 4)
+    {
+        const T *up2 = m.row(y - 2), *up = m.row(y - 1), *mid = m.row(y), *down = m.row(y + 1), *down2 = m.row(y + 2);
+        const int n = m.rowColor(y), phase = m.rowPhase(y);
+        T *own = out[n], *green = out[GREEN], *other = out[2 - n];
+
+        own[0] = green[0] = other[0] = 0;
+        own[1] = green[1] = other[1] = 0;
+
+        for (x = 2; x < m.columns - 2; x++)
+        {
+            const Acc c = mid[x];
+            const Acc n1 = up[x], s1 = down[x], w1 = mid[x - 1], e1 = mid[x + 1];
+            const Acc n2 = up2[x], s2 = down2[x], w2 = mid[x - 2], e2 = mid[x + 2];
+            const Acc d = static_cast<Acc>(up[x - 1]) + up[x + 1] + down[x - 1] + down[x + 1];
+
+            if ((x ^ phase) & 1)
+            {
+                own[x]   = toSample<T>(highQuality(2 * (5 * c + 4 * (w1 + e1) - w2 - e2 - d) + n2 + s2, 1));
+                green[x] = mid[x];
+                other[x] = toSample<T>(highQuality(2 * (5 * c + 4 * (n1 + s1) - n2 - s2 - d) + w2 + e2, 1));
+            }
+            else
+            {
+                const Acc axial = n2 + s2 + w2 + e2;
+                own[x]   = mid[x];
+                green[x] = toSample<T>(highQuality(2 * (2 * (n1 + s1 + w1 + e1) - axial + 4 * c), 0));
+                other[x] = toSample<T>(highQuality(4 * d - 3 * axial + 12 * c, -1));
+            }
+        }
+    }
+
+    clearRow(out, x, m.stride);
+}
+
+// Variable Number of Gradients, from dcraw, as in bayer.c. Gradients are
+// numbered clockwise from NW=0 to W=7.
+const short vngTerms[VNG_TERMS * 6] =
+{
+    -2, -2, +0, -1, 0, 0x01, -2, -2, +0, +0, 1, 0x01, -2, -1, -1, +0, 0, 0x01,
+    -2, -1, +0, -1, 0, 0x02, -2, -1, +0, +0, 0, 0x03, -2, -1, +0, +1, 1, 0x01,
+    -2, +0, +0, -1, 0, 0x06, -2, +0, +0, +0, 1, 0x02, -2, +0, +0, +1, 0, 0x03,
+    -2, +1, -1, +0, 0, 0x04, -2, +1, +0, -1, 1, 0x04, -2, +1, +0, +0, 0, 0x06,
+    -2, +1, +0, +1, 0, 0x02, -2, +2, +0, +0, 1, 0x04, -2, +2, +0, +1, 0, 0x04,
+    -1, -2, -1, +0, 0, 0x80, -1, -2, +0, -1, 0, 0x01, -1, -2, +1, -1, 0, 0x01,
+    -1, -2, +1, +0, 1, 0x01, -1, -1, -1, +1, 0, 0x88, -1, -1, +1, -2, 0, 0x40,
+    -1, -1, +1, -1, 0, 0x22, -1, -1, +1, +0, 0, 0x33, -1, -1, +1, +1, 1, 0x11,
+    -1, +0, -1, +2, 0, 0x08, -1, +0, +0, -1, 0, 0x44, -1, +0, +0, +1, 0, 0x11,
+    -1, +0, +1, -2, 1, 0x40, -1, +0, +1, -1, 0, 0x66, -1, +0, +1, +0, 1, 0x22,
+    -1, +0, +1, +1, 0, 0x33, -1, +0, +1, +2, 1, 0x10, -1, +1, +1, -1, 1, 0x44,
+    -1, +1, +1, +0, 0, 0x66, -1, +1, +1, +1, 0, 0x22, -1, +1, +1, +2, 0, 0x10,
+    -1, +2, +0, +1, 0, 0x04, -1, +2, +1, +0, 1, 0x04, -1, +2, +1, +1, 0, 0x04,
+    +0, -2, +0, +0, 1, 0x80, +0, -1, +0, +1, 1, 0x88, +0, -1, +1, -2, 0, 0x40,
+    +0, -1, +1, +0, 0, 0x11, +0, -1, +2, -2, 0, 0x40, +0, -1, +2, -1, 0, 0x20,
+    +0, -1, +2, +0, 0, 0x30, +0, -1, +2, +1, 1, 0x10, +0, +0, +0, +2, 1, 0x08,
+    +0, +0, +2, -2, 1, 0x40, +0, +0, +2, -1, 0, 0x60, +0, +0, +2, +0, 1, 0x20,
+    +0, +0, +2, +1, 0, 0x30, +0, +0, +2, +2, 1, 0x10, +0, +1, +1, +0, 0, 0x44,
+    +0, +1, +1, +2, 0, 0x10, +0, +1, +2, -1, 1, 0x40, +0, +1, +2, +0, 0, 0x60,
+    +0, +1, +2, +1, 0, 0x20, +0, +1, +2, +2, 0, 0x10, +1, -2, +1, +0, 0, 0x80,
+    +1, -1, +1, +1, 0, 0x88, +1, +0, +1, +2, 0, 0x08, +1, +0, +2, -1, 0, 0x40,
+    +1, +0, +2, +1, 0, 0x10
+};
+
+const short vngNeighbors[VNG_DIRECTIONS * 2] = { -1, -1, -1, 0, -1, +1, 0, +1, +1, +1, +1, 0, +1, -1, 0, -1 };
+
+// The gradient terms and neighbors of the samples of one position in the
+// 2x2 pattern. The bilinear layers of a tile are layerSize samples apart,
+// and the offsets are from the sample in the first layer to the sample
+// in the layer of their color.
+struct VNGCode
+{
+    struct Term
+    {
+        int offset1, offset2;
+        int weight;
+        int directionCount;
+        int directions[4];      // The gradients the term adds to
+    };
+
+    int color;                  // Color of the sample
+    int layerSize;
+    int termCount;
+    Term terms[VNG_TERMS];
+
+    // Each direction adds its neighbor, in the first layer, to the sums
+    // of the colors. For the color of the sample, it adds the mean of the
+    // samples at first and second instead. They are the neighbor, unless
+    // there is a sample of its color beyond the neighbor.
+    int neighbor[VNG_DIRECTIONS];
+    int first[VNG_DIRECTIONS];
+    int second[VNG_DIRECTIONS];
+
+#ifdef VF_WIDTH
+    vfloat masks[VNG_TERMS][VNG_DIRECTIONS / VF_WIDTH]; // All bits set in the lanes of the directions of a term
+#endif
+};
+
+template <typename T>
+void buildVNGCode(const Mosaic<T> &m, int col, int row, int layerSize, VNGCode &code)
+{
+    const short *cp = vngTerms;
+
+    code.color     = m.color(col, row);
+    code.layerSize = layerSize;
+    code.termCount = 0;
+
+    for (int t=0; t < VNG_TERMS; t++, cp += 6)
+    {
+        const int y1 = cp[0], x1 = cp[1], y2 = cp[2], x2 = cp[3];
+        const int color = m.color(col + x1, row + y1);
+
+        if (m.color(col + x2, row + y2) != color)
+            continue;
+
+        const int diag = (m.color(col + 1, row) == color && m.color(col, row + 1) == color) ? 2 : 1;
+        if (abs(y1 - y2) == diag && abs(x1 - x2) == diag)
+            continue;
+
+        VNGCode::Term &term = code.terms[code.termCount];
+        term.offset1 = color * layerSize + y1 * m.stride + x1;
+        term.offset2 = color * layerSize + y2 * m.stride + x2;
+        term.weight  = cp[4];
+        term.directionCount = 0;
+        for (int g=0; g < VNG_DIRECTIONS; g++)
+            if (cp[5] & (1 << g))
+                term.directions[term.directionCount++] = g;
+
+#ifdef VF_WIDTH
+        for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+        {
+            uint32_t bits[VF_WIDTH];
+            float lanes[VF_WIDTH];
+            for (int i=0; i < VF_WIDTH; i++)
+                bits[i] = (cp[5] & (1 << (k * VF_WIDTH + i))) ? 0xFFFFFFFFu : 0;
+            memcpy(lanes, bits, sizeof(lanes));
+            code.masks[code.termCount][k] = vf_load(lanes);
+        }
+#endif
+        code.termCount++;
+    }
+
+    for (int g=0; g < VNG_DIRECTIONS; g++)
+    {
+        const int y = vngNeighbors[2 * g], x = vngNeighbors[2 * g + 1];
+        const int layer = code.color * layerSize;
+
+        code.neighbor[g] = y * m.stride + x;
+        if (m.color(col + x, row + y) != code.color && m.color(col + 2 * x, row + 2 * y) == code.color)
+        {
+            code.first[g]  = layer;
+            code.second[g] = layer + 2 * code.neighbor[g];
+        }
+        else
+        {
+            code.first[g] = code.second[g] = layer + code.neighbor[g];
+        }
+    }
+}
+
+// VNG interpolation of the sample at pix, in the first bilinear layer, into out
+template <typename T>
+inline void vngSample(const VNGCode &code, const T *pix, T *const *out, int x)
+{
+    typedef typename BayerTraits<T>::Acc Acc;
+    Acc gmin, gmax;
+    int selected = 0;
+
+#ifdef VF_WIDTH
+    // Every term adds its difference to the lanes of its directions. The
+    // even and odd terms are summed apart, to halve the chain of additions.
+    vfloat gval[VNG_DIRECTIONS / VF_WIDTH], odd[VNG_DIRECTIONS / VF_WIDTH];
+    for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+        gval[k] = odd[k] = vf_zero();
+
+    int t = 0;
+    for (; t + 1 < code.termCount; t += 2)
+    {
+        const VNGCode::Term &term0 = code.terms[t], &term1 = code.terms[t + 1];
+        const vfloat diff0 = vf_set1(static_cast<float>(gradient(static_cast<Acc>(pix[term0.offset1]), static_cast<Acc>(pix[term0.offset2]), term0.weight)));
+        const vfloat diff1 = vf_set1(static_cast<float>(gradient(static_cast<Acc>(pix[term1.offset1]), static_cast<Acc>(pix[term1.offset2]), term1.weight)));
+        for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+        {
+            gval[k] = vf_add(gval[k], vf_and(diff0, code.masks[t][k]));
+            odd[k]  = vf_add(odd[k], vf_and(diff1, code.masks[t + 1][k]));
+        }
+    }
+    if (t < code.termCount)
+    {
+        const VNGCode::Term &term = code.terms[t];
+        const vfloat diff = vf_set1(static_cast<float>(gradient(static_cast<Acc>(pix[term.offset1]), static_cast<Acc>(pix[term.offset2]), term.weight)));
+        for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+            gval[k] = vf_add(gval[k], vf_and(diff, code.masks[t][k]));
+    }
+    for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+        gval[k] = vf_add(gval[k], odd[k]);
+
+    vfloat low = gval[0], high = gval[0];
+    for (int k=1; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+    {
+        low  = vf_min(low, gval[k]);
+        high = vf_max(high, gval[k]);
+    }
+
+    float lows[VF_WIDTH], highs[VF_WIDTH];
+    vf_store(lows, low);
+    vf_store(highs, high);
+    float lowest = lows[0], highest = highs[0];
+    for (int i=1; i < VF_WIDTH; i++)
+    {
+        lowest  = qMin(lowest, lows[i]);
+        highest = qMax(highest, highs[i]);
+    }
+    gmin = static_cast<Acc>(lowest);
+    gmax = static_cast<Acc>(highest);
+#else
+    Acc gval[VNG_DIRECTIONS] = { 0 };
+
+    for (int t=0; t < code.termCount; t++)
+    {
+        const VNGCode::Term &term = code.terms[t];
+        const Acc diff = gradient(static_cast<Acc>(pix[term.offset1]), static_cast<Acc>(pix[term.offset2]), term.weight);
+        for (int i=0; i < term.directionCount; i++)
+            gval[term.directions[i]] += diff;
+    }
+
+    gmin = gmax = gval[0];
+    for (int g=1; g < VNG_DIRECTIONS; g++)
+    {
+        gmin = qMin(gmin, gval[g]);
+        gmax = qMax(gmax, gval[g]);
+    }
+#endif
+
+    if (gmax == 0)
+    {
+        for (int c=0; c < 3; c++)
+            out[c][x] = pix[c * code.layerSize];
+        return;
+    }
+
+    // Average the neighbors in the directions of the smallest gradients
+    const Acc threshold = gmin + half(gmax);
+
+#ifdef VF_WIDTH
+    const vfloat limit = vf_set1(static_cast<float>(threshold));
+    for (int k=0; k < VNG_DIRECTIONS / VF_WIDTH; k++)
+        selected |= vf_movemask(vf_cmple(gval[k], limit)) << (k * VF_WIDTH);
+#else
+    for (int g=0; g < VNG_DIRECTIONS; g++)
+        if (gval[g] <= threshold)
+            selected |= 1 << g;
+#endif
+
+    // Without branches: the directions are selected at random in noise
+    const T *layer1 = pix + code.layerSize, *layer2 = layer1 + code.layerSize;
+    Acc sum[3] = { 0, 0, 0 }, own = 0;
+    int num = 0;
+    for (int g=0; g < VNG_DIRECTIONS; g++)
+    {
+        const int on = (selected >> g) & 1;
+        const int n  = code.neighbor[g];
+        sum[0] += on * static_cast<Acc>(pix[n]);
+        sum[1] += on * static_cast<Acc>(layer1[n]);
+        sum[2] += on * static_cast<Acc>(layer2[n]);
+        own    += on * half(static_cast<Acc>(pix[code.first[g]]) + pix[code.second[g]]);
+        num    += on;
+    }
+
+    const int color = code.color;
+    const Acc center = pix[color * code.layerSize];
+    sum[color] = own;
+    for (int c=0; c < 3; c++)
+    {
+        Acc t = center;
+        if (c != color)
+            t += (sum[c] - sum[color]) / num;
+        out[c][x] = toSample<T>(t);
+    }
+}
+
+// VNG interpolation of rows begin ... end - 1. The rows are first
+// interpolated bilinearly, with two more rows on each side, into layers
+// of layerRows rows for the tile.
+template <typename T>
+void vngRows(const Mosaic<T> &m, const VNGCode (*codes)[2], int layerRows, int begin, int end, T *const *layers)
+{
+    const int first = qMax(0, begin - 2);
+    const int last  = qMin(m.height, end + 2);
+    const size_t layerSize = static_cast<size_t>(layerRows) * m.stride;
+
+    QVector<T> band(3 * layerSize);
+    T *bilinear[3] = { band.data(), band.data() + layerSize, band.data() + 2 * layerSize };
+
+    for (int y=first; y < last; y++)
+    {
+        T *out[3];
+        for (int c=0; c < 3; c++)
+            out[c] = bilinear[c] + static_cast<size_t>(y - first) * m.stride;
+        bilinearRow(m, y, out);
+    }
+
+    for (int y=begin; y < end; y++)
+    {
+        const T *in[3];
+        T *out[3];
+        for (int c=0; c < 3; c++)
+        {
+            in[c]  = bilinear[c] + static_cast<size_t>(y - first) * m.stride;
+            out[c] = layers[c] + static_cast<size_t>(y) * m.stride;
+        }
+
+        if (y < 2 || y >= m.rows - 2 || m.columns < 5)
+        {
+            copyRow(in, out, 0, m.stride);
+            continue;
+        }
+
+        copyRow(in, out, 0, 2);
+        copyRow(in, out, m.columns - 2, m.stride);
+
+        const VNGCode *row = codes[y & 1];
+        for (int x=2; x < m.columns - 2; x++)
+            vngSample(row[x & 1], in[0] + x, out, x);
+    }
+}
+
+// Split rows 0 ... rows - 1 into tiles of consecutive rows, one per task
+QVector< QPair<int, int> > rowTiles(int rows)
+{
+    QVector< QPair<int, int> > tiles;
+
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    int tileRows = rows;
+    if (nThreads > 1 && rows >= 2 * MIN_ROWS_PER_TILE)
+        tileRows = qMax(MIN_ROWS_PER_TILE, (rows + nThreads * TILES_PER_THREAD - 1) / (nThreads * TILES_PER_THREAD));
+
+    for (int begin=0; begin < rows; begin += tileRows)
+        tiles.append(qMakePair(begin, qMin(begin + tileRows, rows)));
+
+    return tiles;
+}
+
+template <typename Kernel>
+void runTiles(QVector< QPair<int, int> > &tiles, Kernel kernel)
+{
+    if (tiles.size() == 1)
+        kernel(tiles[0]);
+    else if (tiles.size() > 1)
+        QtConcurrent::blockingMap(tiles, kernel);
+}
+
+// Decode the rows of each tile with one of the row functions
+template <typename T>
+void decodeRows(const Mosaic<T> &m, QVector< QPair<int, int> > &tiles, T *const *layers, void (*decodeRow)(const Mosaic<T> &, int, T *const *))
+{
+    auto kernel = [&m, layers, decodeRow](QPair<int, int> &tile)
+    {
+        for (int y=tile.first; y < tile.second; y++)
+        {
+            T *out[3];
+            for (int c=0; c < 3; c++)
+                out[c] = layers[c] + static_cast<size_t>(y) * m.stride;
+            decodeRow(m, y, out);
+        }
+    };
+
+    runTiles(tiles, kernel);
+}
+
+}
+
+template <typename T>
+dc1394error_t BayerDecoder::decode(const T *bayer, T *planes, uint32_t width, uint32_t height, const BayerParams &params)
+{
+    Mosaic<T> m;
+
+    switch (params.filter)
+    {
+    case DC1394_COLOR_FILTER_RGGB:
+        m.redX = 0;
+        m.redY = 0;
+        break;
+    case DC1394_COLOR_FILTER_GBRG:
+        m.redX = 0;
+        m.redY = 1;
+        break;
+    case DC1394_COLOR_FILTER_GRBG:
+        m.redX = 1;
+        m.redY = 0;
+        break;
+    case DC1394_COLOR_FILTER_BGGR:
+        m.redX = 1;
+        m.redY = 1;
+        break;
+    default:
+        return DC1394_INVALID_COLOR_FILTER;
+    }
+
+    if (params.method < DC1394_BAYER_METHOD_NEAREST || params.method > DC1394_BAYER_METHOD_VNG)
+        return DC1394_INVALID_BAYER_METHOD;
+
+    // As in bayer.c, only an offset of 1 shifts the pattern
+    const int offsetX = params.offsetX == 1 ? 1 : 0;
+    const int offsetY = params.offsetY == 1 ? 1 : 0;
+
+    m.stride  = width;
+    m.height  = height;
+    m.columns = qMax(0, static_cast<int>(width) - offsetX);
+    m.rows    = qMax(0, static_cast<int>(height) - offsetY);
+    m.samples = bayer + static_cast<size_t>(offsetY) * width + offsetX;
+
+    const size_t size = static_cast<size_t>(width) * height;
+    T *layers[3] = { planes, planes + size, planes + 2 * size };
+
+    QVector< QPair<int, int> > tiles = rowTiles(height);
+
+    switch (params.method)
+    {
+    case DC1394_BAYER_METHOD_NEAREST:
+        decodeRows(m, tiles, layers, nearestRow<T>);
+        break;
+    case DC1394_BAYER_METHOD_SIMPLE:
+        decodeRows(m, tiles, layers, simpleRow<T>);
+        break;
+    case DC1394_BAYER_METHOD_BILINEAR:
+        decodeRows(m, tiles, layers, bilinearRow<T>);
+        break;
+    case DC1394_BAYER_METHOD_HQLINEAR:
+        decodeRows(m, tiles, layers, highQualityRow<T>);
+        break;
+    case DC1394_BAYER_METHOD_VNG:
+    {
+        // The bilinear layers of every tile hold its rows and two more on each side
+        int layerRows = 0;
+        for (int i=0; i < tiles.size(); i++)
+            layerRows = qMax(layerRows, qMin(m.height, tiles[i].second + 2) - qMax(0, tiles[i].first - 2));
+
+        VNGCode codes[2][2];
+        for (int row=0; row < 2; row++)
+            for (int col=0; col < 2; col++)
+                buildVNGCode(m, col, row, layerRows * m.stride, codes[row][col]);
+
+        auto kernel = [&m, &codes, layerRows, &layers](QPair<int, int> &tile)
+        {
+            vngRows(m, codes, layerRows, tile.first, tile.second, layers);
+        };
+        runTiles(tiles, kernel);
+        break;
+    }
+    }
+
+    return DC1394_SUCCESS;
+}
+
+template dc1394error_t BayerDecoder::decode<uint8_t>(const uint8_t *, uint8_t *, uint32_t, uint32_t, const BayerParams &);
+template dc1394error_t BayerDecoder::decode<int16_t>(const int16_t *, int16_t *, uint32_t, uint32_t, const BayerParams &);
+template dc1394error_t BayerDecoder::decode<uint16_t>(const uint16_t *, uint16_t *, uint32_t, uint32_t, const BayerParams &);
+template dc1394error_t BayerDecoder::decode<int32_t>(const int32_t *, int32_t *, uint32_t, uint32_t, const BayerParams &);
+template dc1394error_t BayerDecoder::decode<float>(const float *, float *, uint32_t, uint32_t, const BayerParams &);
@@ -0,0 +1,71 @@
+/***************************************************************************
+                   bayerdecoder.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BAYERDECODER_H
+#define BAYERDECODER_H
+
+#include "bayer.h"
+
+/**
+ *@class BayerDecoder
+ *@short Decodes a bayer mosaic into three planar color layers, on all cores
+ *
+ *BayerDecoder implements the methods of dc1394_bayer_decoding_float() on
+ *the native pixel type of a FITS image. It reads the mosaic as it is and
+ *writes the red, green and blue layers of the result where FITSData keeps
+ *them, one after the other, without the float copy of the mosaic and the
+ *interleaved RGB image that the dc1394 functions need.
+ *
+ *The rows of the image are split into tiles that are decoded concurrently
+ *on the global thread pool. The bilinear method, and the bilinear first
+ *pass and the gradients of the VNG method, use SSE2 or AVX2 instructions
+ *when KStars is compiled for them.
+ *
+ *For unsigned 8 and 16 bit images the result is the same as the one of
+ *dc1394_bayer_decoding_float(), clamped to the range of the pixel type,
+ *except in the following cases where the dc1394 functions read outside of
+ *the mosaic or leave samples uninitialized:
+ *@li Samples that are not interpolated, at the borders of the image, are
+ *zero.
+ *@li The offsets of the bayer pattern apply to all methods. The simple
+ *method of dc1394 ignores them.
+ *@li With an X offset, the last column is not interpolated from the first
+ *samples of the next row.
+ *
+ *Float images are interpolated without rounding the results to integers.
+ *@author KStars developers
+ */
+class BayerDecoder
+{
+public:
+    /**
+     *@short Decode a bayer mosaic into three color layers
+     *@param bayer The mosaic, width x height samples
+     *@param planes Receives the red, green and blue layers of width x height
+     *       samples each, one after the other. Must not overlap bayer.
+     *@param width Number of columns of the mosaic
+     *@param height Number of rows of the mosaic
+     *@param params Method, pattern and offsets of the mosaic. The pattern
+     *       is the one of the sample at (offsetX, offsetY).
+     *@return DC1394_SUCCESS, or the error of an invalid method or pattern
+     *@note T is one of uint8_t, int16_t, uint16_t, int32_t and float.
+     */
+    template <typename T>
+    static dc1394error_t decode(const T *bayer, T *planes, uint32_t width, uint32_t height, const BayerParams &params);
+};
+
+#endif
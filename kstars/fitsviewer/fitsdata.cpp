@@ -23,11 +23,15 @@
 #include <cmath>
 #include <cstdlib>
 #include <climits>
+#include <limits>
 
 #include <QApplication>
 #include <QLocale>
 #include <QFile>
 #include <QProgressDialog>
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
 
 #ifndef KSTARS_LITE
 #include <KMessageBox>
@@ -42,6 +46,8 @@
 
 #include "ksutils.h"
 #include "Options.h"
+#include "bayerdecoder.h"
+#include "fitskernels.h"
 
 #define ZOOM_DEFAULT	100.0
 #define ZOOM_MIN	10
@@ -59,6 +65,353 @@ const int MINIMUM_ROWS_PER_CENTER=3;
 #define MINIMUM_EDGE_LIMIT  2
 #define SMALL_SCALE_SQUARE  256
 
+// Convert a value to the pixel type T, clamping it to the range of integer types
+template <typename T>
+static inline T toPixel(double value)
+{
+    if (std::numeric_limits<T>::is_integer)
+        return static_cast<T>(qBound(static_cast<double>(std::numeric_limits<T>::min()), value, static_cast<double>(std::numeric_limits<T>::max())));
+
+    return static_cast<T>(value);
+}
+
+// Below this many rows per tile, the cost of handing work to the
+// thread pool exceeds the cost of filtering the rows.
+#define MIN_ROWS_PER_TILE   16
+
+// Number of tiles per worker thread. A few tiles per thread even out
+// the load when some threads are slower to start than others.
+#define TILES_PER_THREAD    4
+
+// Split rows 0 ... rows - 1 into tiles of consecutive rows, one per task
+static QVector< QPair<int, int> > rowTiles(int rows)
+{
+    QVector< QPair<int, int> > tiles;
+
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    int tileRows = rows;
+    if (nThreads > 1 && rows >= 2 * MIN_ROWS_PER_TILE)
+        tileRows = qMax(MIN_ROWS_PER_TILE, (rows + nThreads * TILES_PER_THREAD - 1) / (nThreads * TILES_PER_THREAD));
+
+    for (int begin=0; begin < rows; begin += tileRows)
+        tiles.append(qMakePair(begin, qMin(begin + tileRows, rows)));
+
+    return tiles;
+}
+
+// Run kernel(in, out, count) on the samples of the given rows, one tile
+// of rows per task
+template <typename T, typename Kernel>
+static void forEachTile(const T *source, T *target, int width, int rows, Kernel kernel)
+{
+    QVector< QPair<int, int> > tiles = rowTiles(rows);
+
+    auto task = [source, target, width, kernel](QPair<int, int> &tile)
+    {
+        const size_t first = static_cast<size_t>(tile.first) * width;
+        kernel(source + first, target + first, static_cast<size_t>(tile.second - tile.first) * width);
+    };
+
+    if (tiles.size() == 1)
+        task(tiles[0]);
+    else
+        QtConcurrent::blockingMap(tiles, task);
+}
+
+// Store op(source[i]) in target[i] for every sample of the given rows
+template <typename T, typename Op>
+static void mapSamples(const T *source, T *target, int width, int rows, Op op)
+{
+    forEachTile(source, target, width, rows, [op](const T *in, T *out, size_t count)
+    {
+        for (size_t i=0; i < count; i++)
+            out[i] = op(in[i]);
+    });
+}
+
+// Clamp every sample of the given rows to [min, max], with the vector
+// kernel of the pixel type if it has one. Integer samples are clamped to
+// the converted bounds, which gives the same pixels as converting the
+// clamped value.
+template <typename T>
+static void clampSamples(const T *source, T *target, int width, int rows, float min, float max)
+{
+    const T lo = toPixel<T>(min);
+    const T hi = toPixel<T>(max);
+
+    forEachTile(source, target, width, rows, [min, max, lo, hi](const T *in, T *out, size_t count)
+    {
+        size_t i = FITSKernels::clamp(in, out, count, lo, hi);
+        for (; i < count; i++)
+            out[i] = toPixel<T>(qBound(min, static_cast<float>(in[i]), max));
+    });
+}
+
+// Median of nine values with the 19 exchange sorting network of
+// Paeth / Devillard (opt_med9). The values are reordered in place.
+template <typename T>
+static inline T median9(T *p)
+{
+#define SORT_PAIR(a,b) { const T lo = qMin(p[a], p[b]); p[b] = qMax(p[a], p[b]); p[a] = lo; }
+    SORT_PAIR(1, 2); SORT_PAIR(4, 5); SORT_PAIR(7, 8);
+    SORT_PAIR(0, 1); SORT_PAIR(3, 4); SORT_PAIR(6, 7);
+    SORT_PAIR(1, 2); SORT_PAIR(4, 5); SORT_PAIR(7, 8);
+    SORT_PAIR(0, 3); SORT_PAIR(5, 8); SORT_PAIR(4, 7);
+    SORT_PAIR(3, 6); SORT_PAIR(1, 4); SORT_PAIR(2, 5);
+    SORT_PAIR(4, 7); SORT_PAIR(4, 2); SORT_PAIR(6, 4);
+    SORT_PAIR(4, 2);
+#undef SORT_PAIR
+    return p[4];
+}
+
+// 3x3 median of pixel x of a row given the original rows above and below it. Edge pixels are replicated.
+template <typename T>
+static inline T medianAt(const T *above, const T *row, const T *below, int x, int width)
+{
+    int left  = qMax(x - 1, 0);
+    int right = qMin(x + 1, width - 1);
+
+    T window[9] = { above[left], above[x], above[right],
+                    row[left],   row[x],   row[right],
+                    below[left], below[x], below[right] };
+
+    return median9(window);
+}
+
+// 3x3 median of one row. The vector kernel, if the pixel type has one,
+// covers the pixels that have both neighbours.
+template <typename T>
+static void medianRow(const T *above, const T *row, const T *below, T *out, int width)
+{
+    int x = 0;
+    if (width > 2)
+    {
+        out[0] = medianAt(above, row, below, 0, width);
+        x = FITSKernels::median9(above, row, below, out, 1, width - 1);
+    }
+
+    for (; x < width; x++)
+        out[x] = medianAt(above, row, below, x, width);
+}
+
+template <typename T>
+struct MedianTile
+{
+    int begin, end;
+    QVector<T> above, below;   // Original rows just outside the tile
+};
+
+// 3x3 median filter of one channel, in place, one tile of rows per task.
+// Every task keeps a rolling window of the three original rows around
+// the row it writes, so no padded copy of the image is needed. Only the
+// rows bordering the tiles are saved up front, since a neighbouring
+// task may overwrite them at any time.
+template <typename T>
+static void medianFilter(T *plane, int width, int height)
+{
+    QVector< QPair<int, int> > ranges = rowTiles(height);
+    QVector< MedianTile<T> > tiles(ranges.size());
+
+    for (int i=0; i < ranges.size(); i++)
+    {
+        MedianTile<T> &tile = tiles[i];
+        tile.begin = ranges[i].first;
+        tile.end   = ranges[i].second;
+
+        // At the top and bottom of the image the edge row is replicated
+        const T *above = plane + static_cast<size_t>(qMax(tile.begin - 1, 0)) * width;
+        const T *below = plane + static_cast<size_t>(qMin(tile.end, height - 1)) * width;
+        tile.above = QVector<T>(width);
+        tile.below = QVector<T>(width);
+        memcpy(tile.above.data(), above, width * sizeof(T));
+        memcpy(tile.below.data(), below, width * sizeof(T));
+    }
+
+    auto kernel = [plane, width](MedianTile<T> &tile)
+    {
+        QVector<T> above = tile.above, row(width), below(width);
+        memcpy(row.data(), plane + static_cast<size_t>(tile.begin) * width, width * sizeof(T));
+
+        for (int y=tile.begin; y < tile.end; y++)
+        {
+            if (y + 1 < tile.end)
+                memcpy(below.data(), plane + static_cast<size_t>(y + 1) * width, width * sizeof(T));
+            else
+                below = tile.below;
+
+            medianRow(above.constData(), row.constData(), below.constData(), plane + static_cast<size_t>(y) * width, width);
+
+            // Slide the window down one row, reusing the buffer of the top row
+            above.swap(row);
+            row.swap(below);
+        }
+    };
+
+    if (tiles.size() == 1)
+        kernel(tiles[0]);
+    else
+        QtConcurrent::blockingMap(tiles, kernel);
+}
+
+// Minimum number of samples of a statistics tile
+#define MIN_SAMPLES_PER_TILE    65536
+
+// Samples summed relative to the same shift before their moments are
+// merged. Small enough for the exact integer sums of 16 bit samples.
+#define STATS_CHUNK             4096
+
+// How the statistics kernel sums samples of type T. Sums of 8 and 16 bit
+// samples are exact in 64 bit integers, and the compiler vectorizes them.
+// These types also have few enough values to count each of them.
+template <typename T>
+struct StatsTraits
+{
+    typedef double Sum;
+    enum { valueCount = 0, valueOffset = 0 };
+};
+
+template <>
+struct StatsTraits<uint8_t>
+{
+    typedef int64_t Sum;
+    enum { valueCount = 256, valueOffset = 0 };
+};
+
+template <>
+struct StatsTraits<int16_t>
+{
+    typedef int64_t Sum;
+    enum { valueCount = 65536, valueOffset = 32768 };
+};
+
+template <>
+struct StatsTraits<uint16_t>
+{
+    typedef int64_t Sum;
+    enum { valueCount = 65536, valueOffset = 0 };
+};
+
+// Statistics of a range of samples of one channel
+template <typename T>
+struct StatsTile
+{
+    const T *samples;
+    size_t count;
+    int channel;
+    T min, max;
+    double n, mean, m2;                 // Count, mean and sum of squared deviations
+    QVector<uint32_t> values;           // Count of every value, if StatsTraits<T>::valueCount
+    QVector<uint32_t> bins;             // Histogram counts, when binning the samples
+};
+
+// Merge the count, mean and sum of squared deviations of set b into those
+// of set a, with the pairwise formula of Chan, Golub and LeVeque.
+static inline void mergeMoments(double &n, double &mean, double &m2, double nb, double meanb, double m2b)
+{
+    if (nb == 0)
+        return;
+
+    const double total = n + nb;
+    const double delta = meanb - mean;
+    mean += delta * nb / total;
+    m2   += m2b + delta * delta * n * nb / total;
+    n     = total;
+}
+
+// Bin of a value at position (value - min) / binWidth in a histogram of
+// binCount bins, that is round(position) clamped to the bins. NaN goes to bin 0.
+static inline int histogramBin(double position, int binCount)
+{
+    const double x = position + 0.5;
+    if (!(x >= 1))
+        return 0;
+    if (x >= binCount)
+        return binCount - 1;
+    return static_cast<int>(x);
+}
+
+// Split every channel in tiles, about one per worker thread in all
+template <typename T>
+static QVector< StatsTile<T> > statsTiles(const T *buffer, int channels, uint32_t samples)
+{
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    size_t perChannel = qBound<size_t>(1, qMax(1, nThreads / channels), qMax<size_t>(1, samples / MIN_SAMPLES_PER_TILE));
+    size_t tileSize = (samples + perChannel - 1) / perChannel;
+
+    QVector< StatsTile<T> > tiles;
+    for (int ch=0; ch < channels; ch++)
+    {
+        for (size_t begin=0; begin < samples; begin += tileSize)
+        {
+            StatsTile<T> tile;
+            tile.samples = buffer + static_cast<size_t>(ch) * samples + begin;
+            tile.count   = qMin<size_t>(tileSize, samples - begin);
+            tile.channel = ch;
+            tiles.append(tile);
+        }
+    }
+
+    return tiles;
+}
+
+template <typename T, typename Kernel>
+static void runTiles(QVector< StatsTile<T> > &tiles, Kernel kernel)
+{
+    if (tiles.size() == 1)
+        kernel(tiles[0]);
+    else
+        QtConcurrent::blockingMap(tiles, kernel);
+}
+
+// Min, max, moments and value counts of one tile, in a single pass over
+// its samples. Each chunk of samples is first reduced by a loop without
+// branches that the compiler can vectorize, then counted while it is
+// still in cache. The moments of the chunks are merged pairwise, so no
+// loop carries the division of a running mean.
+template <typename T>
+static void accumulateStats(StatsTile<T> &tile)
+{
+    typedef StatsTraits<T> Traits;
+    typedef typename Traits::Sum Sum;
+
+    T min = tile.samples[0], max = tile.samples[0];
+    tile.n = tile.mean = tile.m2 = 0;
+    if (Traits::valueCount)
+        tile.values.fill(0, Traits::valueCount);
+
+    for (size_t start=0; start < tile.count; start += STATS_CHUNK)
+    {
+        const T *chunk   = tile.samples + start;
+        const size_t n   = qMin<size_t>(STATS_CHUNK, tile.count - start);
+        const Sum shift  = static_cast<Sum>(chunk[0]);
+        Sum sum = 0, sumSquares = 0;
+
+        for (size_t i=0; i < n; i++)
+        {
+            const T value = chunk[i];
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+            const Sum d = static_cast<Sum>(value) - shift;
+            sum        += d;
+            sumSquares += d * d;
+        }
+
+        if (Traits::valueCount)
+        {
+            uint32_t *values = tile.values.data();
+            for (size_t i=0; i < n; i++)
+                values[static_cast<int>(chunk[i]) + Traits::valueOffset]++;
+        }
+
+        const double dsum = static_cast<double>(sum);
+        mergeMoments(tile.n, tile.mean, tile.m2, n, static_cast<double>(shift) + dsum / n,
+                     static_cast<double>(sumSquares) - dsum * dsum / n);
+    }
+
+    tile.min = min;
+    tile.max = max;
+}
+
 bool greaterThan(Edge *s1, Edge *s2)
 {
     //return s1->width > s2->width;
@@ -70,8 +423,11 @@ FITSData::FITSData(FITSMode fitsMode)
     channels = 0;
     image_buffer = NULL;
     bayer_buffer = NULL;
-    wcs_coord    = NULL;
+    wcs          = NULL;
+    nwcs         = 0;
     fptr = NULL;
+    memPointer = NULL;
+    memSize = 0;
     maxHFRStar = NULL;
     darkFrame = NULL;
     tempFile  = false;
@@ -79,6 +435,7 @@ FITSData::FITSData(FITSMode fitsMode)
     HasWCS = false;
     HasDebayer=false;
     mode = fitsMode;
+    histogramCache.valid = false;
 
     debayerParams.method  = DC1394_BAYER_METHOD_NEAREST;
     debayerParams.filter  = DC1394_COLOR_FILTER_RGGB;
@@ -94,7 +451,10 @@ FITSData::~FITSData()
     if (starCenters.count() > 0)
         qDeleteAll(starCenters);
 
-    delete[] wcs_coord;
+#ifdef HAVE_WCSLIB
+    if (wcs)
+        wcsvfree(&nwcs, &wcs);
+#endif
 
     if (fptr)
     {
@@ -106,7 +466,7 @@ FITSData::~FITSData()
     }
 }
 
-bool FITSData::loadFITS (const QString &inFilename, bool silent)
+bool FITSData::loadFITS (const QString &inFilename, bool silent, const QByteArray &buffer)
 {
     int status=0, anynull=0;
     long naxes[3];
@@ -126,12 +486,30 @@ bool FITSData::loadFITS (const QString &inFilename, bool silent)
 
     filename = inFilename;
 
-    if (filename.startsWith("/tmp/") || filename.contains("/Temp"))
-        tempFile = true;
+    if (buffer.isEmpty())
+    {
+        memBuffer.clear();
+
+        if (filename.startsWith("/tmp/") || filename.contains("/Temp"))
+            tempFile = true;
+        else
+            tempFile = false;
+
+        fits_open_image(&fptr, filename.toLatin1(), READONLY, &status);
+    }
     else
-        tempFile = false;
+    {
+        // Read the image straight from the buffer. The buffer is shared, not copied, and CFITSIO does not
+        // write to a READONLY memory file, so the data stays valid until the next load or until we're destroyed.
+        memBuffer  = buffer;
+        memPointer = const_cast<char *>(memBuffer.constData());
+        memSize    = memBuffer.size();
+        tempFile   = false;
+
+        fits_open_memfile(&fptr, filename.toLatin1(), READONLY, &memPointer, &memSize, 0, NULL, &status);
+    }
 
-    if (fits_open_image(&fptr, filename.toLatin1(), READONLY, &status))
+    if (status)
     {
         fits_report_error(stderr, status);
         fits_get_errstatus(status, error_status);
@@ -168,22 +546,12 @@ bool FITSData::loadFITS (const QString &inFilename, bool silent)
     switch (stats.bitpix)
     {
     case 8:
-        data_type = TBYTE;
-        break;
     case 16:
-        data_type = TUSHORT;
-        break;
     case 32:
-        data_type = TINT;
-        break;
     case -32:
-        data_type = TFLOAT;
-        break;
     case 64:
-        data_type = TLONGLONG;
-        break;
     case -64:
-        data_type = TDOUBLE;
+        break;
     default:
         errMessage = i18n("Bit depth %1 is not supported.", stats.bitpix);
         if (silent == false)
@@ -194,6 +562,34 @@ bool FITSData::loadFITS (const QString &inFilename, bool silent)
         break;
     }
 
+    // Keep the pixels in their native type. 64 bit data, and integer data scaled by BSCALE/BZERO other
+    // than for the usual unsigned conventions, is converted to float.
+    int equivType = FLOAT_IMG;
+    if (fits_get_img_equivtype(fptr, &equivType, &status))
+    {
+        status = 0;
+        equivType = FLOAT_IMG;
+    }
+
+    switch (equivType)
+    {
+    case BYTE_IMG:
+        data_type = TBYTE;
+        break;
+    case SHORT_IMG:
+        data_type = TSHORT;
+        break;
+    case USHORT_IMG:
+        data_type = TUSHORT;
+        break;
+    case LONG_IMG:
+        data_type = TINT;
+        break;
+    default:
+        data_type = TFLOAT;
+        break;
+    }
+
     if (stats.ndim < 3)
         naxes[2] = 1;
 
@@ -215,10 +611,10 @@ bool FITSData::loadFITS (const QString &inFilename, bool silent)
 
     channels = naxes[2];
 
-    image_buffer = new float[stats.samples_per_channel * channels];
+    image_buffer = new uint8_t[stats.samples_per_channel * channels * getBytesPerPixel()];
     if (image_buffer == NULL)
     {
-        qDebug() << "FITSData: Not enough memory for image_buffer channel. Requested: " << stats.samples_per_channel * channels * sizeof(float) << " bytes.";
+        qDebug() << "FITSData: Not enough memory for image_buffer channel. Requested: " << stats.samples_per_channel * channels * getBytesPerPixel() << " bytes.";
         clearImageBuffers();
         return false;
     }
@@ -228,7 +624,7 @@ bool FITSData::loadFITS (const QString &inFilename, bool silent)
     flipVCounter=0;
     long nelements = stats.samples_per_channel * channels;
 
-    if (fits_read_img(fptr, TFLOAT, 1, nelements, 0, image_buffer, &anynull, &status))
+    if (fits_read_img(fptr, data_type, 1, nelements, 0, image_buffer, &anynull, &status))
     {
         char errmsg[512];
         fits_get_errstatus(status, errmsg);
@@ -303,6 +699,7 @@ int FITSData::saveFITS( const QString &newFilename )
         filename = newFilename;
 
         fptr = new_fptr;
+        memBuffer.clear();
 
         return 0;
     }
@@ -325,6 +722,7 @@ int FITSData::saveFITS( const QString &newFilename )
     filename = newFilename;
 
     fptr = new_fptr;
+    memBuffer.clear();
 
     if (fits_movabs_hdu(fptr, 1, &exttype, &status))
     {
@@ -333,7 +731,7 @@ int FITSData::saveFITS( const QString &newFilename )
     }
 
     /* Write Data */
-    if (fits_write_img(fptr, TFLOAT, 1, nelements, image_buffer, &status))
+    if (fits_write_img(fptr, data_type, 1, nelements, image_buffer, &status))
     {
         fits_report_error(stderr, status);
         return status;
@@ -410,113 +808,293 @@ void FITSData::clearImageBuffers()
     bayer_buffer=NULL;
 }
 
-int FITSData::calculateMinMax(bool refresh)
+bool FITSData::readMinMaxKeys()
 {
-    int status, nfound=0;
+    int status=0;
+    double min=0, max=0;
 
-    status = 0;
+    if (fptr == NULL)
+        return false;
 
-    if (refresh == false)
-    {
-        if (fits_read_key_dbl(fptr, "DATAMIN", &(stats.min[0]), NULL, &status) ==0)
-            nfound++;
+    if (fits_read_key_dbl(fptr, "DATAMIN", &min, NULL, &status) || fits_read_key_dbl(fptr, "DATAMAX", &max, NULL, &status))
+        return false;
+
+    // Both zeros mean the keywords were not filled in
+    if (min == 0 && max == 0)
+        return false;
+
+    stats.min[0] = min;
+    stats.max[0] = max;
+    return true;
+}
 
-        if (fits_read_key_dbl(fptr, "DATAMAX", &(stats.max[0]), NULL, &status) == 0)
-            nfound++;
+void FITSData::calculateStats(bool refresh)
+{
+    // Min, max, mean, standard deviation, median and histogram of every channel in one pass
+    computeStats(true, refresh);
 
-        // If we found both keywords, no need to calculate them, unless they are both zeros
-        if (nfound == 2 && !(stats.min[0] == 0 && stats.max[0] ==0))
-            return 0;
+    stats.SNR = stats.mean[0] / stats.stddev[0];
+
+    if (refresh && markStars)
+        // Let's try to find star positions again after transformation
+        starsSearched = false;
+
+}
+
+void FITSData::runningAverageStdDev()
+{
+    // The same pass, keeping the range set by the caller
+    computeStats(false, true);
+}
+
+void FITSData::computeStats(bool updateRange, bool refresh)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        computeStats<uint8_t>(updateRange, refresh);
+        break;
+    case TSHORT:
+        computeStats<int16_t>(updateRange, refresh);
+        break;
+    case TUSHORT:
+        computeStats<uint16_t>(updateRange, refresh);
+        break;
+    case TINT:
+        computeStats<int32_t>(updateRange, refresh);
+        break;
+    default:
+        computeStats<float>(updateRange, refresh);
+        break;
     }
+}
 
-    stats.min[0]= 1.0E30;
-    stats.max[0]= -1.0E30;
+template <typename T>
+void FITSData::computeStats(bool updateRange, bool refresh)
+{
+    typedef StatsTraits<T> Traits;
 
-    stats.min[1]= 1.0E30;
-    stats.max[1]= -1.0E30;
+    const T *buffer = reinterpret_cast<const T *>(image_buffer);
+    const uint32_t samples = stats.samples_per_channel;
+    const int nChannels = qMin(channels, 3);
+    if (buffer == NULL || samples == 0 || nChannels < 1)
+        return;
 
-    stats.min[2]= 1.0E30;
-    stats.max[2]= -1.0E30;
+    QVector< StatsTile<T> > tiles = statsTiles(buffer, nChannels, samples);
+    runTiles(tiles, accumulateStats<T>);
 
-    if (channels == 1)
+    // Merge the tiles of every channel
+    QVector<uint32_t> values[3];
+    for (int ch=0; ch < nChannels; ch++)
     {
-        for (unsigned int i=0; i < stats.samples_per_channel; i++)
+        double n=0, mean=0, m2=0;
+        T min=0, max=0;
+        bool first = true;
+
+        for (int i=0; i < tiles.size(); i++)
+        {
+            const StatsTile<T> &tile = tiles.at(i);
+            if (tile.channel != ch)
+                continue;
+
+            mergeMoments(n, mean, m2, tile.n, tile.mean, tile.m2);
+            min = (first || tile.min < min) ? tile.min : min;
+            max = (first || tile.max > max) ? tile.max : max;
+            first = false;
+
+            if (Traits::valueCount)
+            {
+                if (values[ch].isEmpty())
+                    values[ch] = tile.values;
+                else
+                {
+                    uint32_t *sum = values[ch].data();
+                    const uint32_t *counts = tile.values.constData();
+                    for (int v=0; v < Traits::valueCount; v++)
+                        sum[v] += counts[v];
+                }
+            }
+        }
+
+        if (updateRange)
         {
-            if (image_buffer[i] < stats.min[0]) stats.min[0] = image_buffer[i];
-            else if (image_buffer[i] > stats.max[0]) stats.max[0] = image_buffer[i];
+            stats.min[ch] = min;
+            stats.max[ch] = max;
         }
+        stats.mean[ch]   = mean;
+        stats.stddev[ch] = n > 1 ? sqrt(m2 / (n - 1)) : 0;
     }
-    else
+
+    // DATAMIN and DATAMAX of the header take precedence for channel 0
+    if (updateRange && refresh == false)
+        readMinMaxKeys();
+
+    const uint32_t half = (samples + 1) / 2;
+
+    if (Traits::valueCount)
     {
-        int g_offset = stats.samples_per_channel;
-        int b_offset = stats.samples_per_channel*2;
+        // Bin the counts of every value instead of the samples, and find the exact median
+        resetHistogram();
+        const double binWidth = histogramCache.binWidth;
+        for (int ch=0; ch < nChannels; ch++)
+        {
+            double *frequency = histogramCache.frequency[ch].data();
+            const uint32_t *counts = values[ch].constData();
+            uint32_t cumulative = 0;
+            bool medianFound = false;
 
-        for (unsigned int i=0; i < stats.samples_per_channel; i++)
+            for (int v=0; v < Traits::valueCount; v++)
+            {
+                if (counts[v] == 0)
+                    continue;
+                const int value = v - Traits::valueOffset;
+                const double position = binWidth > 0 ? (value - histogramCache.min) / binWidth : 0;
+                frequency[histogramBin(position, histogramCache.binCount)] += counts[v];
+
+                cumulative += counts[v];
+                if (!medianFound && cumulative >= half)
+                {
+                    stats.median[ch] = value;
+                    medianFound = true;
+                }
+            }
+        }
+        histogramCache.valid = true;
+    }
+    else
+    {
+        // Bin the samples in a second pass, now that the range is known, and estimate the median from the bins
+        binHistogram(tiles);
+        for (int ch=0; ch < nChannels; ch++)
         {
-            if (image_buffer[i] < stats.min[0])
-                stats.min[0] = image_buffer[i];
-            else if (image_buffer[i] > stats.max[0])
-                stats.max[0] = image_buffer[i];
-
-            if (image_buffer[i+g_offset] < stats.min[1])
-                stats.min[1] = image_buffer[i+g_offset];
-            else if (image_buffer[i+g_offset] > stats.max[1])
-                stats.max[1] = image_buffer[i+g_offset];
-
-            if (image_buffer[i+b_offset] < stats.min[2])
-                stats.min[2] = image_buffer[i+b_offset];
-            else if (image_buffer[i+b_offset] > stats.max[2])
-                stats.max[2] = image_buffer[i+b_offset];
+            const QVector<double> &frequency = histogramCache.frequency[ch];
+            double cumulative = 0;
+            for (int i=0; i < frequency.size(); i++)
+            {
+                cumulative += frequency[i];
+                if (cumulative >= half)
+                {
+                    stats.median[ch] = histogramCache.min + i * histogramCache.binWidth;
+                    break;
+                }
+            }
         }
     }
-
-    //qDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
-    return 0;
 }
 
+void FITSData::resetHistogram()
+{
+    const int nChannels = qMin(channels, 3);
 
-void FITSData::calculateStats(bool refresh)
+    histogramCache.binCount = qMax(2, static_cast<int>(sqrt(static_cast<double>(stats.samples_per_channel))));
+    histogramCache.min      = stats.min[0];
+    histogramCache.binWidth = (stats.max[0] - stats.min[0]) / (histogramCache.binCount - 1);
+
+    for (int ch=0; ch < 3; ch++)
+    {
+        if (ch < nChannels)
+            histogramCache.frequency[ch].fill(0, histogramCache.binCount);
+        else
+            histogramCache.frequency[ch].clear();
+    }
+}
+
+template <typename T>
+void FITSData::binHistogram(QVector< StatsTile<T> > &tiles)
 {
-    // Calculate min max
-    calculateMinMax(refresh);
+    resetHistogram();
 
-    // Get standard deviation and mean in one run
-    runningAverageStdDev();
+    const double min         = histogramCache.min;
+    const double invBinWidth = histogramCache.binWidth > 0 ? 1.0 / histogramCache.binWidth : 0;
+    const int binCount       = histogramCache.binCount;
 
-    stats.SNR = stats.mean[0] / stats.stddev[0];
+    runTiles(tiles, [min, invBinWidth, binCount](StatsTile<T> &tile)
+    {
+        tile.bins.fill(0, binCount);
+        uint32_t *bins = tile.bins.data();
+        for (size_t i=0; i < tile.count; i++)
+            bins[histogramBin((tile.samples[i] - min) * invBinWidth, binCount)]++;
+    });
 
-    if (refresh && markStars)
-        // Let's try to find star positions again after transformation
-        starsSearched = false;
+    for (int i=0; i < tiles.size(); i++)
+    {
+        double *frequency = histogramCache.frequency[tiles[i].channel].data();
+        const uint32_t *bins = tiles[i].bins.constData();
+        for (int j=0; j < binCount; j++)
+            frequency[j] += bins[j];
+        tiles[i].bins.clear();
+    }
 
+    histogramCache.valid = true;
 }
 
-void FITSData::runningAverageStdDev()
+template <typename T>
+void FITSData::binHistogram()
 {
-    int m_n = 2;
-    double m_oldM=0, m_newM=0, m_oldS=0, m_newS=0;
-    m_oldM = m_newM = image_buffer[0];
-
-    for (unsigned int i=1; i < stats.samples_per_channel; i++)
+    const T *buffer = reinterpret_cast<const T *>(image_buffer);
+    const int nChannels = qMin(channels, 3);
+    if (buffer == NULL || stats.samples_per_channel == 0 || nChannels < 1)
     {
-        m_newM = m_oldM + (image_buffer[i] - m_oldM)/m_n;
-        m_newS = m_oldS + (image_buffer[i] - m_oldM) * (image_buffer[i] - m_newM);
+        resetHistogram();
+        histogramCache.valid = true;
+        return;
+    }
+
+    QVector< StatsTile<T> > tiles = statsTiles(buffer, nChannels, stats.samples_per_channel);
+    binHistogram(tiles);
+}
+
+void FITSData::updateHistogram()
+{
+    if (histogramCache.valid)
+        return;
 
-        m_oldM = m_newM;
-        m_oldS = m_newS;
-        m_n++;
+    switch (data_type)
+    {
+    case TBYTE:
+        binHistogram<uint8_t>();
+        break;
+    case TSHORT:
+        binHistogram<int16_t>();
+        break;
+    case TUSHORT:
+        binHistogram<uint16_t>();
+        break;
+    case TINT:
+        binHistogram<int32_t>();
+        break;
+    default:
+        binHistogram<float>();
+        break;
     }
+}
 
-    double variance = m_newS / (m_n -2);
+const QVector<double> & FITSData::getHistogramFrequency(uint8_t channel)
+{
+    updateHistogram();
+    return histogramCache.frequency[qMin<int>(channel, 2)];
+}
 
-    stats.mean[0] = m_newM;
-    stats.stddev[0]  = sqrt(variance);
+double FITSData::getHistogramBinWidth()
+{
+    updateHistogram();
+    return histogramCache.binWidth;
+}
+
+int FITSData::getHistogramBinCount()
+{
+    updateHistogram();
+    return histogramCache.binCount;
 }
 
 void FITSData::setMinMax(double newMin,  double newMax, uint8_t channel)
 {
     stats.min[channel] = newMin;
     stats.max[channel] = newMax;
+
+    // The histogram is binned over the range of channel 0
+    if (channel == 0)
+        histogramCache.valid = false;
 }
 
 int FITSData::getFITSRecord(QString &recordList, int &nkeys)
@@ -558,6 +1136,26 @@ bool FITSData::checkCollision(Edge* s1, Edge*s2)
 
 int FITSData::findOneStar(const QRectF &boundary)
 {
+    switch (data_type)
+    {
+    case TBYTE:
+        return findOneStar<uint8_t>(boundary);
+    case TSHORT:
+        return findOneStar<int16_t>(boundary);
+    case TUSHORT:
+        return findOneStar<uint16_t>(boundary);
+    case TINT:
+        return findOneStar<int32_t>(boundary);
+    default:
+        return findOneStar<float>(boundary);
+    }
+}
+
+template <typename T>
+int FITSData::findOneStar(const QRectF &boundary)
+{
+    T *buffer = reinterpret_cast<T *>(image_buffer);
+
     int subX = boundary.x();
     int subY = boundary.y();
     int subW = subX + boundary.width();
@@ -572,7 +1170,7 @@ int FITSData::findOneStar(const QRectF &boundary)
     {
         for (int x=subX; x < subW; x++)
         {
-            float pixel = image_buffer[x+y*stats.width];
+            float pixel = buffer[x+y*stats.width];
             if (pixel > threshold)
             {
                 //pixel     *= pow(1000, pixel/stats.max[0]);
@@ -613,7 +1211,7 @@ int FITSData::findOneStar(const QRectF &boundary)
                 if (testX < subX || testX > subW || testY < subY || testY > subH)
                     break;
 
-                if (image_buffer[testX + testY * stats.width] > running_threshold)
+                if (buffer[testX + testY * stats.width] > running_threshold)
                     pass++;
             }
 
@@ -655,8 +1253,8 @@ int FITSData::findOneStar(const QRectF &boundary)
 
     for (double x=leftEdge; x <= rightEdge; x += resolution)
     {
-        //subPixels[x] = resolution * (image_buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
-        double slice = resolution * (image_buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
+        //subPixels[x] = resolution * (buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
+        double slice = resolution * (buffer[static_cast<int>(floor(x)) + cen_y * stats.width] - min);
         FSum += slice;
         subPixels.append(slice);
     }
@@ -698,9 +1296,34 @@ int FITSData::findOneStar(const QRectF &boundary)
 
 }
 
-/*** Find center of stars and calculate Half Flux Radius */
+/*** Find center of stars and calculate Half Flux Radius */
+void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeWidth)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        findCentroid<uint8_t>(boundary, initStdDev, minEdgeWidth);
+        break;
+    case TSHORT:
+        findCentroid<int16_t>(boundary, initStdDev, minEdgeWidth);
+        break;
+    case TUSHORT:
+        findCentroid<uint16_t>(boundary, initStdDev, minEdgeWidth);
+        break;
+    case TINT:
+        findCentroid<int32_t>(boundary, initStdDev, minEdgeWidth);
+        break;
+    default:
+        findCentroid<float>(boundary, initStdDev, minEdgeWidth);
+        break;
+    }
+}
+
+template <typename T>
 void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeWidth)
 {
+    T *buffer = reinterpret_cast<T *>(image_buffer);
+
     double threshold=0,sum=0,avg=0,min=0;
     int starDiameter=0;
     int pixVal=0;
@@ -782,7 +1405,7 @@ void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeW
         else
         {
             // Only find a single star within the boundary
-            findOneStar(boundary);
+            findOneStar<T>(boundary);
             return;
 
             subX = boundary.x();
@@ -798,7 +1421,7 @@ void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeW
 
             for(int j=subX; j < subW; j++)
             {
-                pixVal = image_buffer[j+(i*stats.width)] - min;
+                pixVal = buffer[j+(i*stats.width)] - min;
 
                 // If pixel value > threshold, let's get its weighted average
                 if ( pixVal >= threshold )
@@ -819,13 +1442,13 @@ void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeW
                             int i_center = floor(center);
 
                             // Check if center is 10% or more brighter than edge, if not skip
-                            if ( ((image_buffer[i_center+(i*stats.width)]-min) / (image_buffer[i_center+(i*stats.width)-starDiameter/2]-min) >= dispersion_ratio) &&
-                                 ((image_buffer[i_center+(i*stats.width)]-min) / (image_buffer[i_center+(i*stats.width)+starDiameter/2]-min) >= dispersion_ratio))
+                            if ( ((buffer[i_center+(i*stats.width)]-min) / (buffer[i_center+(i*stats.width)-starDiameter/2]-min) >= dispersion_ratio) &&
+                                 ((buffer[i_center+(i*stats.width)]-min) / (buffer[i_center+(i*stats.width)+starDiameter/2]-min) >= dispersion_ratio))
                             {
                                 if (Options::fITSLogging())
                                 {
-                                    qDebug() << "Edge center is " << image_buffer[i_center+(i*stats.width)]-min << " Edge is " << image_buffer[i_center+(i*stats.width)-starDiameter/2]-min
-                                             << " and ratio is " << ((image_buffer[i_center+(i*stats.width)]-min) / (image_buffer[i_center+(i*stats.width)-starDiameter/2]-min))
+                                    qDebug() << "Edge center is " << buffer[i_center+(i*stats.width)]-min << " Edge is " << buffer[i_center+(i*stats.width)-starDiameter/2]-min
+                                             << " and ratio is " << ((buffer[i_center+(i*stats.width)]-min) / (buffer[i_center+(i*stats.width)-starDiameter/2]-min))
                                              << " located at X: " << center << " Y: " << i+0.5;
                                 }
 
@@ -834,7 +1457,7 @@ void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeW
                                 newEdge->x          = center;
                                 newEdge->y          = i + 0.5;
                                 newEdge->scanned    = 0;
-                                newEdge->val        = image_buffer[i_center+(i*stats.width)] - min;
+                                newEdge->val        = buffer[i_center+(i*stats.width)] - min;
                                 newEdge->width      = starDiameter;
                                 newEdge->HFR        = 0;
                                 newEdge->sum        = sum;
@@ -977,60 +1600,68 @@ void FITSData::findCentroid(const QRectF &boundary, int initStdDev, int minEdgeW
             if (Options::fITSLogging())
                 qDebug() << "Found a real center with number with (" << rCenter->x << "," << rCenter->y << ")";
 
-            // Calculate Total Flux From Center, Half Flux, Full Summation
-            double TF=0;
-            double HF=0;
-            double FSum=0;
-
             cen_x = (int) floor(rCenter->x);
             cen_y = (int) floor(rCenter->y);
 
             if (cen_x < 0 || cen_x > stats.width || cen_y < 0 || cen_y > stats.height)
                 continue;
 
+            starCenters.append(rCenter);
+        }
+    }
 
-            // Complete sum along the radius
-            //for (int k=0; k < rCenter->width; k++)
-            for (int k=rCenter->width/2; k >= -(rCenter->width/2) ; k--)
-            {
-                FSum += image_buffer[cen_x-k+(cen_y*stats.width)] - min;
-                //qDebug() << image_buffer[cen_x-k+(cen_y*stats.width)] - min;
-            }
-
-            // Half flux
-            HF = FSum / 2.0;
+    // The half flux radius of each star only depends on the image, so all
+    // stars are measured concurrently
+    const int width = stats.width;
+    auto measureHFR = [buffer, width, min](Edge *rCenter)
+    {
+        // Calculate Total Flux From Center, Half Flux, Full Summation
+        double TF=0;
+        double HF=0;
+        double FSum=0;
 
-            // Total flux starting from center
-            TF = image_buffer[cen_y * stats.width + cen_x] - min;
+        int cen_x = (int) floor(rCenter->x);
+        int cen_y = (int) floor(rCenter->y);
 
-            int pixelCounter = 1;
+        // Complete sum along the radius
+        for (int k=rCenter->width/2; k >= -(rCenter->width/2) ; k--)
+            FSum += buffer[cen_x-k+(cen_y*width)] - min;
 
-            // Integrate flux along radius axis until we reach half flux
-            for (int k=1; k < rCenter->width/2; k++)
-            {
-                if (TF >= HF)
-                {
-                    if (Options::fITSLogging())
-                        qDebug() << "Stopping at TF " << TF << " after #" << k << " pixels.";
-                    break;
-                }
+        // Half flux
+        HF = FSum / 2.0;
 
-                TF += image_buffer[cen_y * stats.width + cen_x + k] - min;
-                TF += image_buffer[cen_y * stats.width + cen_x - k] - min;
+        // Total flux starting from center
+        TF = buffer[cen_y * width + cen_x] - min;
 
-                pixelCounter++;
-            }
+        int pixelCounter = 1;
 
-            // Calculate weighted Half Flux Radius
-            rCenter->HFR = pixelCounter * (HF / TF);
-            // Store full flux
-            rCenter->val = FSum;
+        // Integrate flux along radius axis until we reach half flux
+        for (int k=1; k < rCenter->width/2; k++)
+        {
+            if (TF >= HF)
+                break;
 
-            if (Options::fITSLogging())
-                qDebug() << "HFR for this center is " << rCenter->HFR << " pixels and the total flux is " << FSum;
+            TF += buffer[cen_y * width + cen_x + k] - min;
+            TF += buffer[cen_y * width + cen_x - k] - min;
 
-            starCenters.append(rCenter);
+            pixelCounter++;
         }
+
+        // Calculate weighted Half Flux Radius
+        rCenter->HFR = pixelCounter * (HF / TF);
+        // Store full flux
+        rCenter->val = FSum;
+    };
+
+    if (starCenters.count() > 1)
+        QtConcurrent::blockingMap(starCenters, measureHFR);
+    else if (starCenters.count() == 1)
+        measureHFR(starCenters.first());
+
+    if (Options::fITSLogging())
+    {
+        foreach(Edge *center, starCenters)
+            qDebug() << "HFR for center (" << center->x << "," << center->y << ") is " << center->HFR << " pixels and the total flux is " << center->val;
     }
 
     if (starCenters.count() > 1 && mode != FITS_FOCUS)
@@ -1124,19 +1755,72 @@ double FITSData::getHFR(int x, int y)
     return -1;
 }
 
-void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
+void FITSData::applyFilter(FITSScale type, uint8_t *image, float min, float max)
 {
-    if (type == FITS_NONE /* || histogram == NULL*/)
+    switch (type)
+    {
+    case FITS_NONE:
+    case FITS_CUSTOM:
         return;
 
-    double coeff=0;
-    float val=0,bufferVal =0;
-    int offset=0, row=0;
+    case FITS_ROTATE_CW:
+        rotFITS(90, 0);
+        rotCounter++;
+        return;
+
+    case FITS_ROTATE_CCW:
+        rotFITS(270, 0);
+        rotCounter--;
+        return;
+
+    case FITS_FLIP_H:
+        rotFITS(0, 1);
+        flipHCounter++;
+        return;
+
+    case FITS_FLIP_V:
+        rotFITS(0, 2);
+        flipVCounter++;
+        return;
 
+    default:
+        break;
+    }
 
     if (image == NULL)
         image = image_buffer;
 
+    // Filters that compute the statistics again also bin the histogram again
+    histogramCache.valid = false;
+
+    switch (data_type)
+    {
+    case TBYTE:
+        applyFilter<uint8_t>(type, image, min, max);
+        break;
+    case TSHORT:
+        applyFilter<int16_t>(type, image, min, max);
+        break;
+    case TUSHORT:
+        applyFilter<uint16_t>(type, image, min, max);
+        break;
+    case TINT:
+        applyFilter<int32_t>(type, image, min, max);
+        break;
+    default:
+        applyFilter<float>(type, image, min, max);
+        break;
+    }
+}
+
+template <typename T>
+void FITSData::applyFilter(FITSScale type, uint8_t *image, float min, float max)
+{
+    T *source = reinterpret_cast<T *>(image);
+    T *buffer = reinterpret_cast<T *>(image_buffer);
+
+    double coeff=0;
+
     int width = stats.width;
     int height = stats.height;
 
@@ -1146,34 +1830,21 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
         max = stats.max[0];
 
     int size = stats.samples_per_channel;
-    int index=0;
+
+    // All filters but the median are point operations, so the channels
+    // are simply treated as consecutive rows of the same image.
+    int rows = channels * height;
 
     switch (type)
     {
     case FITS_AUTO:
     case FITS_LINEAR:
     {
-
-        for (int i=0; i < channels; i++)
-        {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    bufferVal = image[index];
-                    if (bufferVal < min) bufferVal = min;
-                    else if (bufferVal > max) bufferVal = max;
-                    image_buffer[index] = bufferVal;
-                }
-            }
-        }
+        clampSamples(source, buffer, width, rows, min, max);
 
         stats.min[0] = min;
         stats.max[0] = max;
-        //runningAverageStdDev();
+        runningAverageStdDev();
     }
         break;
 
@@ -1181,24 +1852,11 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
     {
         coeff = max / log(1 + max);
 
-        for (int i=0; i < channels; i++)
+        mapSamples(source, buffer, width, rows, [min, max, coeff](T value)
         {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    bufferVal = image[index];
-                    if (bufferVal < min) bufferVal = min;
-                    else if (bufferVal > max) bufferVal = max;
-                    val = (coeff * log(1 + qBound(min, image[index], max)));
-                    image_buffer[index] = qBound(min, val, max);
-                }
-            }
-
-        }
+            float val = (coeff * log(1 + qBound(min, static_cast<float>(value), max)));
+            return toPixel<T>(qBound(min, val, max));
+        });
 
         stats.min[0] = min;
         stats.max[0] = max;
@@ -1210,20 +1868,10 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
     {
         coeff = max / sqrt(max);
 
-        for (int i=0; i < channels; i++)
+        mapSamples(source, buffer, width, rows, [min, max, coeff](T value)
         {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    val = (int) (coeff * sqrt(qBound(min, image[index], max)));
-                    image_buffer[index] = val;
-                }
-            }
-        }
+            return toPixel<T>(static_cast<int>(coeff * sqrt(qBound(min, static_cast<float>(value), max))));
+        });
 
         stats.min[0] = min;
         stats.max[0] = max;
@@ -1236,19 +1884,7 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
         min = stats.mean[0] - stats.stddev[0];
         max = stats.mean[0] + stats.stddev[0] * 3;
 
-        for (int i=0; i < channels; i++)
-        {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    image_buffer[index] = qBound(min, image[index], max);
-                }
-            }
-        }
+        clampSamples(source, buffer, width, rows, min, max);
 
         stats.min[0] = min;
         stats.max[0] = max;
@@ -1263,19 +1899,8 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
             min =0;
         max = stats.mean[0] + stats.stddev[0] * 3;
 
-        for (int i=0; i < channels; i++)
-        {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    image_buffer[index] = qBound(min, image[index], max);
-                }
-            }
-        }
+        clampSamples(source, buffer, width, rows, min, max);
+
         stats.min[0] = min;
         stats.max[0] = max;
         runningAverageStdDev();
@@ -1287,28 +1912,19 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
         if (histogram == NULL)
             return;
         QVector<double> cumulativeFreq = histogram->getCumulativeFrequency();
+        if (cumulativeFreq.isEmpty())
+            return;
         coeff = 255.0 / (height * width);
 
-        for (int i=0; i < channels; i++)
-        {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    bufferVal = (int) (image[index] - min) / histogram->getBinWidth();
-
-                    if (bufferVal >= cumulativeFreq.size())
-                        bufferVal = cumulativeFreq.size()-1;
+        const double *freq = cumulativeFreq.constData();
+        const int lastBin = cumulativeFreq.size()-1;
+        const double binWidth = histogram->getBinWidth();
 
-                    val = (int) (coeff * cumulativeFreq[bufferVal]);
-
-                    image_buffer[index] = val;
-                }
-            }
-        }
+        mapSamples(source, buffer, width, rows, [min, coeff, freq, lastBin, binWidth](T value)
+        {
+            int bin = qBound(0, static_cast<int>(static_cast<int>(value - min) / binWidth), lastBin);
+            return toPixel<T>(static_cast<int>(coeff * freq[bin]));
+        });
     }
         calculateStats(true);
         break;
@@ -1316,19 +1932,8 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
     case FITS_HIGH_PASS:
     {
         min = stats.mean[0];
-        for (int i=0; i < channels; i++)
-        {
-            offset = i*size;
-            for (int j=0; j < height; j++)
-            {
-                row = offset + j * width;
-                for (int k=0; k < width; k++)
-                {
-                    index=k + row;
-                    image_buffer[index] = qBound(min, image[index], max);
-                }
-            }
-        }
+
+        clampSamples(source, buffer, width, rows, min, max);
 
         stats.min[0] = min;
         stats.max[0] = max;
@@ -1336,106 +1941,58 @@ void FITSData::applyFilter(FITSScale type, float *image, float min, float max)
     }
         break;
 
-    // Based on http://www.librow.com/articles/article-1
     case FITS_MEDIAN:
     {
-        float* extension = new float[(width + 2) * (height + 2)];
-        //   Check memory allocation
-        if (!extension)
-            return;
-        //   Create image extension
         for (int ch=0; ch < channels; ch++)
-        {
-            offset = ch*size;
-            int N=width,M=height;
-
-            for (int i = 0; i < M; ++i)
-            {
-                memcpy(extension + (N + 2) * (i + 1) + 1, image_buffer + N * i + offset, N * sizeof(float));
-                extension[(N + 2) * (i + 1)] = image_buffer[N * i + offset];
-                extension[(N + 2) * (i + 2) - 1] = image_buffer[N * (i + 1) - 1 + offset];
-            }
-            //   Fill first line of image extension
-            memcpy(extension, extension + N + 2, (N + 2) * sizeof(float));
-            //   Fill last line of image extension
-            memcpy(extension + (N + 2) * (M + 1), extension + (N + 2) * M, (N + 2) * sizeof(float));
-            //   Call median filter implementation
-
-            N=width+2;
-            M=height+2;
-            //   Move window through all elements of the image
-            for (int m = 1; m < M - 1; ++m)
-                for (int n = 1; n < N - 1; ++n)
-                {
-                    //   Pick up window elements
-                    int k = 0;
-                    float window[9];
-                    for (int j = m - 1; j < m + 2; ++j)
-                        for (int i = n - 1; i < n + 2; ++i)
-                            window[k++] = extension[j * N + i];
-                    //   Order elements (only half of them)
-                    for (int j = 0; j < 5; ++j)
-                    {
-                        //   Find position of minimum element
-                        int mine = j;
-                        for (int l = j + 1; l < 9; ++l)
-                            if (window[l] < window[mine])
-                                mine = l;
-                        //   Put found minimum element in its place
-                        const float temp = window[j];
-                        window[j] = window[mine];
-                        window[mine] = temp;
-                    }
-                    //   Get result - the middle element
-                    image_buffer[(m - 1) * (N - 2) + n - 1 + offset] = window[4];
-                }
-        }
+            medianFilter(buffer + ch*size, width, height);
 
-        //   Free memory
-        delete[] extension;
         runningAverageStdDev();
     }
         break;
 
 
-    case FITS_ROTATE_CW:
-        rotFITS(90, 0);
-        rotCounter++;
+    case FITS_CUSTOM:
+    default:
+        return;
         break;
+    }
 
-    case FITS_ROTATE_CCW:
-        rotFITS(270, 0);
-        rotCounter--;
-        break;
+}
 
-    case FITS_FLIP_H:
-        rotFITS(0, 1);
-        flipHCounter++;
+void FITSData::subtract(float *dark_buffer)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        subtract<uint8_t>(dark_buffer);
         break;
-
-    case FITS_FLIP_V:
-        rotFITS(0, 2);
-        flipVCounter++;
+    case TSHORT:
+        subtract<int16_t>(dark_buffer);
+        break;
+    case TUSHORT:
+        subtract<uint16_t>(dark_buffer);
+        break;
+    case TINT:
+        subtract<int32_t>(dark_buffer);
         break;
-
-    case FITS_CUSTOM:
     default:
-        return;
+        subtract<float>(dark_buffer);
         break;
     }
 
+    calculateStats(true);
 }
 
+template <typename T>
 void FITSData::subtract(float *dark_buffer)
 {
+    T *buffer = reinterpret_cast<T *>(image_buffer);
+
     for (int i=0; i < stats.width*stats.height; i++)
     {
-        image_buffer[i] -= dark_buffer[i];
-        if (image_buffer[i] < 0)
-            image_buffer[i] = 0;
+        float value = buffer[i] - dark_buffer[i];
+        buffer[i] = toPixel<T>(value < 0 ? 0 : value);
     }
-
-    calculateStats(true);
 }
 
 int FITSData::findStars(const QRectF &boundary, bool force)
@@ -1485,11 +2042,11 @@ void FITSData::checkWCS()
 
     int status=0;
     char *header;
-    int nkeyrec, nreject, nwcs, stat[2];
-    double imgcrd[2], phi, pixcrd[2], theta, world[2];
-    struct wcsprm *wcs=0;
-    int width=getWidth();
-    int height=getHeight();
+    int nkeyrec, nreject;
+
+    if (wcs)
+        wcsvfree(&nwcs, &wcs);
+    HasWCS = false;
 
     if (fits_hdr2str(fptr, 1, NULL, 0, &header, &nkeyrec, &status))
     {
@@ -1500,6 +2057,9 @@ void FITSData::checkWCS()
     if ((status = wcspih(header, nkeyrec, WCSHDR_all, -3, &nreject, &nwcs, &wcs)))
     {
         fprintf(stderr, "wcspih ERROR %d: %s.\n", status, wcshdr_errmsg[status]);
+        free(header);
+        wcs = NULL;
+        nwcs = 0;
         return;
     }
 
@@ -1513,46 +2073,57 @@ void FITSData::checkWCS()
 
     // FIXME: Call above goes through EVEN if no WCS is present, so we're adding this to return for now.
     if (wcs->crpix[0] == 0)
+    {
+        wcsvfree(&nwcs, &wcs);
         return;
-
-    HasWCS = true;
+    }
 
     if ((status = wcsset(wcs)))
     {
         fprintf(stderr, "wcsset ERROR %d: %s.\n", status, wcs_errmsg[status]);
+        wcsvfree(&nwcs, &wcs);
         return;
     }
 
-    delete[] wcs_coord;
+    // Sky coordinates are computed on demand by getWCSCoord(), so nothing depends on the image size here
+    HasWCS = true;
+#endif
+
+}
 
-    wcs_coord = new wcs_point[width*height];
+bool FITSData::getWCSCoord(double x, double y, wcs_point *coord)
+{
+#ifdef HAVE_WCSLIB
+    int status=0, stat[2];
+    double imgcrd[2], phi, pixcrd[2], theta, world[2];
 
-    wcs_point *p = wcs_coord;
+    if (HasWCS == false || wcs == NULL)
+        return false;
 
-    for (int i=0; i < height; i++)
-    {
-        for (int j=0; j < width; j++)
-        {
-            pixcrd[0]=j;
-            pixcrd[1]=i;
+    if (x < 0 || y < 0 || x >= stats.width || y >= stats.height)
+        return false;
 
-            if ((status = wcsp2s(wcs, 1, 2, &pixcrd[0], &imgcrd[0], &phi, &theta, &world[0], &stat[0])))
-            {
-                fprintf(stderr, "wcsp2s ERROR %d: %s.\n", status,
-                        wcs_errmsg[status]);
-            }
-            else
-            {
-                p->ra  = world[0];
-                p->dec = world[1];
+    pixcrd[0]=x;
+    pixcrd[1]=y;
 
-                p++;
-            }
-        }
+    if ((status = wcsp2s(wcs, 1, 2, &pixcrd[0], &imgcrd[0], &phi, &theta, &world[0], &stat[0])))
+    {
+        fprintf(stderr, "wcsp2s ERROR %d: %s.\n", status, wcs_errmsg[status]);
+        return false;
     }
-#endif
 
+    coord->ra  = world[0];
+    coord->dec = world[1];
+
+    return true;
+#else
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+    Q_UNUSED(coord);
+    return false;
+#endif
 }
+
 float *FITSData::getDarkFrame() const
 {
     return darkFrame;
@@ -1600,10 +2171,28 @@ void FITSData::setRotCounter(int value)
  * return NULL if successful or rotated image.
  */
 bool FITSData::rotFITS (int rotate, int mirror)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        return rotFITS<uint8_t>(rotate, mirror);
+    case TSHORT:
+        return rotFITS<int16_t>(rotate, mirror);
+    case TUSHORT:
+        return rotFITS<uint16_t>(rotate, mirror);
+    case TINT:
+        return rotFITS<int32_t>(rotate, mirror);
+    default:
+        return rotFITS<float>(rotate, mirror);
+    }
+}
+
+template <typename T>
+bool FITSData::rotFITS (int rotate, int mirror)
 {
     int ny, nx;
     int x1, y1, x2, y2;
-    float *rotimage = NULL;
+    uint8_t *rotimage = NULL;
     int offset=0;
 
     if (rotate == 1)
@@ -1619,13 +2208,16 @@ bool FITSData::rotFITS (int rotate, int mirror)
     ny = stats.height;
 
     /* Allocate buffer for rotated image */
-    rotimage = new float[stats.samples_per_channel*channels];
+    rotimage = new uint8_t[stats.samples_per_channel*channels*sizeof(T)];
     if (rotimage == NULL)
     {
         qWarning() << "Unable to allocate memory for rotated image buffer!";
         return false;
     }
 
+    T *buffer = reinterpret_cast<T *>(image_buffer);
+    T *rotBuffer = reinterpret_cast<T *>(rotimage);
+
     /* Mirror image without rotation */
     if (rotate < 45 && rotate > -45)
     {
@@ -1638,7 +2230,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 {
                     x2 = nx - x1 - 1;
                     for (y1 = 0; y1 < ny; y1++)
-                        rotimage[(y1*nx) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y1*nx) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
 
@@ -1652,7 +2244,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 {
                     y2 = ny - y1 - 1;
                     for (x1 = 0; x1 < nx; x1++)
-                        rotimage[(y2*nx) + x1 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*nx) + x1 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
 
@@ -1665,7 +2257,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 for (y1 = 0; y1 < ny; y1++)
                 {
                     for (x1 = 0; x1 < nx; x1++)
-                        rotimage[(y1*nx) + x1 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y1*nx) + x1 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
 
@@ -1686,7 +2278,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                     for (x1 = 0; x1 < nx; x1++)
                     {
                         y2 = nx - x1 - 1;
-                        rotimage[(y2*ny) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*ny) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                     }
                 }
             }
@@ -1700,7 +2292,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 for (y1 = 0; y1 < ny; y1++)
                 {
                     for (x1 = 0; x1 < nx; x1++)
-                        rotimage[(x1*ny) + y1 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(x1*ny) + y1 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
 
@@ -1716,7 +2308,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                     for (x1 = 0; x1 < nx; x1++)
                     {
                         y2 = x1;
-                        rotimage[(y2*ny) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*ny) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                     }
                 }
             }
@@ -1739,7 +2331,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 {
                     y2 = ny - y1 - 1;
                     for (x1 = 0; x1 < nx; x1++)
-                        rotimage[(y2*nx) + x1 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*nx) + x1 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
 
@@ -1753,7 +2345,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 {
                     x2 = nx - x1 - 1;
                     for (y1 = 0; y1 < ny; y1++)
-                        rotimage[(y1*nx) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y1*nx) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
         }
@@ -1768,7 +2360,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                     for (x1 = 0; x1 < nx; x1++)
                     {
                         x2 = nx - x1 - 1;
-                        rotimage[(y2*nx) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*nx) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                     }
                 }
             }
@@ -1786,7 +2378,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 for (y1 = 0; y1 < ny; y1++)
                 {
                     for (x1 = 0; x1 < nx; x1++)
-                        rotimage[(x1*ny) + y1 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(x1*ny) + y1 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
         }
@@ -1801,7 +2393,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                     for (x1 = 0; x1 < nx; x1++)
                     {
                         y2 = nx - x1 - 1;
-                        rotimage[(y2*ny) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*ny) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                     }
                 }
             }
@@ -1817,7 +2409,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                     for (x1 = 0; x1 < nx; x1++)
                     {
                         y2 = nx - x1 - 1;
-                        rotimage[(y2*ny) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                        rotBuffer[(y2*ny) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                     }
                 }
             }
@@ -1839,7 +2431,7 @@ bool FITSData::rotFITS (int rotate, int mirror)
                 {
                     x2 = y1;
                     y2 = x1;
-                    rotimage[(y2*ny) + x2 + offset] = image_buffer[(y1*nx) + x1 + offset];
+                    rotBuffer[(y2*ny) + x2 + offset] = buffer[(y1*nx) + x1 + offset];
                 }
             }
         }
@@ -2135,15 +2727,81 @@ void FITSData::rotWCSFITS (int angle, int mirror)
     return;
 }
 
-float * FITSData::getImageBuffer()
+uint8_t * FITSData::getImageBuffer()
 {
     return image_buffer;
 }
 
-void FITSData::setImageBuffer(float *buffer)
+void FITSData::setImageBuffer(uint8_t *buffer)
 {
     delete[] image_buffer;
     image_buffer = buffer;
+    histogramCache.valid = false;
+}
+
+int FITSData::getBytesPerPixel()
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        return sizeof(uint8_t);
+    case TSHORT:
+        return sizeof(int16_t);
+    case TUSHORT:
+        return sizeof(uint16_t);
+    case TINT:
+        return sizeof(int32_t);
+    default:
+        return sizeof(float);
+    }
+}
+
+double FITSData::getValue(uint32_t index)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        return image_buffer[index];
+    case TSHORT:
+        return reinterpret_cast<int16_t *>(image_buffer)[index];
+    case TUSHORT:
+        return reinterpret_cast<uint16_t *>(image_buffer)[index];
+    case TINT:
+        return reinterpret_cast<int32_t *>(image_buffer)[index];
+    default:
+        return reinterpret_cast<float *>(image_buffer)[index];
+    }
+}
+
+void FITSData::getFloatBuffer(float *buffer, uint8_t channel)
+{
+    switch (data_type)
+    {
+    case TBYTE:
+        getFloatBuffer<uint8_t>(buffer, channel);
+        break;
+    case TSHORT:
+        getFloatBuffer<int16_t>(buffer, channel);
+        break;
+    case TUSHORT:
+        getFloatBuffer<uint16_t>(buffer, channel);
+        break;
+    case TINT:
+        getFloatBuffer<int32_t>(buffer, channel);
+        break;
+    default:
+        getFloatBuffer<float>(buffer, channel);
+        break;
+    }
+}
+
+template <typename T>
+void FITSData::getFloatBuffer(float *buffer, uint8_t channel)
+{
+    const T *source = reinterpret_cast<T *>(image_buffer) + stats.samples_per_channel * channel;
+
+    for (uint32_t i=0; i < stats.samples_per_channel; i++)
+        buffer[i] = source[i];
 }
 
 bool FITSData::checkDebayer()
@@ -2180,13 +2838,13 @@ bool FITSData::checkDebayer()
     fits_read_key(fptr, TINT, "YBAYROFF", &debayerParams.offsetY, NULL, &status);
 
     delete[] bayer_buffer;
-    bayer_buffer = new float[stats.samples_per_channel * channels];
+    bayer_buffer = new uint8_t[stats.samples_per_channel * channels * getBytesPerPixel()];
     if (bayer_buffer == NULL)
     {
         KMessageBox::error(NULL, i18n("Unable to allocate memory for bayer buffer."), i18n("Open FITS"));
         return false;
     }
-    memcpy(bayer_buffer, image_buffer, stats.samples_per_channel * channels * sizeof(float));
+    memcpy(bayer_buffer, image_buffer, stats.samples_per_channel * channels * getBytesPerPixel());
 
     HasDebayer = true;
 
@@ -2212,59 +2870,66 @@ void FITSData::setBayerParams(BayerParams *param)
 
 bool FITSData::debayer()
 {
-    dc1394error_t error_code;
+    bool rc;
 
-    int rgb_size = stats.samples_per_channel*3;
-    float * dst = new float[rgb_size];
-    if (dst == NULL)
+    switch (data_type)
     {
-        KMessageBox::error(NULL, i18n("Unable to allocate memory for temporary bayer buffer."), i18n("Debayer Error"));
-        return false;
+    case TBYTE:
+        rc = debayer<uint8_t>();
+        break;
+    case TSHORT:
+        rc = debayer<int16_t>();
+        break;
+    case TUSHORT:
+        rc = debayer<uint16_t>();
+        break;
+    case TINT:
+        rc = debayer<int32_t>();
+        break;
+    default:
+        rc = debayer<float>();
+        break;
     }
 
-    if ( (error_code = dc1394_bayer_decoding_float(bayer_buffer, dst, stats.width, stats.height, debayerParams.offsetX, debayerParams.offsetY,
-                                                   debayerParams.filter, debayerParams.method)) != DC1394_SUCCESS)
-    {
-        KMessageBox::error(NULL, i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
-        channels=1;
-        delete[] dst;
-        //Restore buffer
-        delete[] image_buffer;
-        image_buffer = new float[stats.samples_per_channel];
-        memcpy(image_buffer, bayer_buffer, stats.samples_per_channel * sizeof(float));
-        return false;
-    }
+    // The three channels are new, so are their statistics
+    if (rc)
+        calculateStats(true);
+
+    return rc;
+}
+
+template <typename T>
+bool FITSData::debayer()
+{
+    dc1394error_t error_code;
 
+    // The layers are decoded straight from the bayer pattern, in the pixel type of the image
     if (channels == 1)
     {
         delete[] image_buffer;
-        image_buffer = new float[rgb_size];
+        image_buffer = new uint8_t[stats.samples_per_channel * 3 * sizeof(T)];
 
         if (image_buffer == NULL)
         {
-            delete[] dst;
             KMessageBox::error(NULL, i18n("Unable to allocate memory for debayerd buffer."), i18n("Debayer Error"));
             return false;
         }
     }
 
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-    float * rBuff = image_buffer;
-    float * gBuff = image_buffer + (stats.width * stats.height);
-    float * bBuff = image_buffer + (stats.width * stats.height * 2);
-
-    int imax = stats.samples_per_channel*3 - 3;
-    for (int i=0; i <= imax; i += 3)
+    if ( (error_code = BayerDecoder::decode(reinterpret_cast<const T *>(bayer_buffer), reinterpret_cast<T *>(image_buffer),
+                                            stats.width, stats.height, debayerParams)) != DC1394_SUCCESS)
     {
-        *rBuff++ = dst[i];
-        *gBuff++ = dst[i+1];
-        *bBuff++ = dst[i+2];
+        KMessageBox::error(NULL, i18n("Debayer failed (%1)", error_code), i18n("Debayer error"));
+        channels=1;
+        //Restore buffer
+        delete[] image_buffer;
+        image_buffer = new uint8_t[stats.samples_per_channel * sizeof(T)];
+        memcpy(image_buffer, bayer_buffer, stats.samples_per_channel * sizeof(T));
+        return false;
     }
 
     channels=3;
-    delete[] dst;
     return true;
-
 }
 
 double FITSData::getADU()
@@ -53,6 +53,8 @@
 #define MINIMUM_STDVAR  5
 
 class QProgressDialog;
+struct wcsprm;
+template <typename T> struct StatsTile;
 
 typedef struct
 {
@@ -81,27 +83,33 @@ public:
     FITSData(FITSMode mode=FITS_NORMAL);
     ~FITSData();
 
-    /* Loads FITS image, scales it, and displays it in the GUI */
-    bool  loadFITS(const QString &filename, bool silent=true);
+    /* Loads FITS image, scales it, and displays it in the GUI. If buffer is not empty, the image is read
+       from the buffer in memory and filename is only used as the name of the image */
+    bool  loadFITS(const QString &filename, bool silent=true, const QByteArray &buffer=QByteArray());
     /* Save FITS */
     int saveFITS(const QString &filename);
     /* Rescale image lineary from image_buffer, fit to window if desired */
     int rescale(FITSZoom type);
-    /* Calculate stats */
+    /* Calculate min, max, mean, standard deviation, median and histogram of every channel in one pass.
+       Unless refresh is true, DATAMIN and DATAMAX of the header are used as the range of channel 0 */
     void calculateStats(bool refresh=false);
-    /* Calculate running average & standard deviation using Welford’s method for computing variance */
+    /* Same as calculateStats, but keeps the current min and max */
     void runningAverageStdDev();
 
     // Access functions
-    //double getValue(float *buffer, int i);
-    //void setValue(float *buffer, int i, double value);
-    //double getValue(int i);
-    //void setValue(int i, float value);
     void clearImageBuffers();
-    void setImageBuffer(float *buffer);
-    float * getImageBuffer();
+    // The image buffer holds the pixels in their native type, see getDataType()
+    void setImageBuffer(uint8_t *buffer);
+    uint8_t * getImageBuffer();
+    // Size of one pixel of the image buffer in bytes
+    int getBytesPerPixel();
+    // Value of the pixel at index in the image buffer
+    double getValue(uint32_t index);
+    // Copy one channel of the image to buffer, converted to float. Buffer must hold getSize() elements.
+    void getFloatBuffer(float *buffer, uint8_t channel=0);
 
     // Stats
+    // Pixel type of the image buffer: TBYTE, TSHORT, TUSHORT, TINT or TFLOAT
     int getDataType() { return data_type; }
     unsigned int getSize() { return stats.samples_per_channel; }
     void getDimensions(double *w, double *h) { *w = stats.width; *h = stats.height; }
@@ -148,7 +156,8 @@ public:
 
     // WCS
     bool hasWCS() { return HasWCS; }
-    wcs_point *getWCSCoord()  { return wcs_coord; }
+    // Sky coordinates of the pixel at (x,y), computed on demand. Returns false if there is no WCS or the pixel is out of the image.
+    bool getWCSCoord(double x, double y, wcs_point *coord);
 
     // Debayer
     bool hasDebayer() { return HasDebayer; }
@@ -161,9 +170,14 @@ public:
 
     // Histogram
     void setHistogram(FITSHistogram *inHistogram) { histogram = inHistogram; }
+    // Frequencies of every channel, binned over the range of channel 0. Computed with the statistics,
+    // or again if the image or its range changed since.
+    const QVector<double> & getHistogramFrequency(uint8_t channel=0);
+    double getHistogramBinWidth();
+    int getHistogramBinCount();
 
     // Filter
-    void applyFilter(FITSScale type, float *image=NULL, float min=-1, float max=-1);
+    void applyFilter(FITSScale type, uint8_t *image=NULL, float min=-1, float max=-1);
 
     // Rotation counter. We keep count to rotate WCS keywords on save
     int getRotCounter() const;
@@ -203,9 +217,23 @@ public:
 private:
 
     bool rotFITS (int rotate, int mirror);
+    // Kernels over the native pixel type T of the image buffer, dispatched by data_type
+    template <typename T> bool rotFITS (int rotate, int mirror);
+    template <typename T> void computeStats(bool updateRange, bool refresh);
+    template <typename T> void binHistogram(QVector< StatsTile<T> > &tiles);
+    template <typename T> void binHistogram();
+    template <typename T> int findOneStar(const QRectF &boundary);
+    template <typename T> void findCentroid(const QRectF &boundary, int initStdDev, int minEdgeWidth);
+    template <typename T> void applyFilter(FITSScale type, uint8_t *image, float min, float max);
+    template <typename T> void subtract(float *darkFrame);
+    template <typename T> bool debayer();
+    template <typename T> void getFloatBuffer(float *buffer, uint8_t channel);
     void rotWCSFITS (int angle, int mirror);
     bool checkCollision(Edge* s1, Edge*s2);
-    int calculateMinMax(bool refresh=false);
+    void computeStats(bool updateRange, bool refresh);
+    bool readMinMaxKeys();
+    void resetHistogram();
+    void updateHistogram();
     void checkWCS();
     bool checkDebayer();
     void readWCSKeys();
@@ -213,9 +241,9 @@ private:
     FITSHistogram *histogram;           // Pointer to the FITS data histogram
     fitsfile* fptr;                     // Pointer to CFITSIO FITS file struct
 
-    int data_type;                      // FITS image data type    
+    int data_type;                      // Pixel type of image_buffer (TBYTE, TSHORT, TUSHORT, TINT or TFLOAT)
     int channels;                       // Number of channels    
-    float *image_buffer;         		// Current image buffer
+    uint8_t *image_buffer;         		// Current image buffer, in the native pixel type
     float *darkFrame;                    // Optional dark frame pointer
 
 
@@ -226,19 +254,33 @@ private:
     bool HasDebayer;                    // Is the image debayarable?
 
     QString filename;                   // Our very own file name
+    QByteArray memBuffer;               // FITS file contents when the image is loaded from memory
+    void *memPointer;                   // CFITSIO in-memory file pointer, must stay valid while fptr is open
+    size_t memSize;                     // CFITSIO in-memory file size
     FITSMode mode;                      // FITS Mode (Normal, WCS, Guide, Focus..etc)
 
     int rotCounter;                     // How many times the image was rotated? Useful for WCS keywords rotation on save.
     int flipHCounter;                   // How many times the image was flipped horizontally?
     int flipVCounter;                   // How many times the image was flipped vertically?
 
-    wcs_point *wcs_coord;               // Pointer to WCS coordinate data, if any.
+    struct wcsprm *wcs;                 // WCS transformation parsed from the header, if any.
+    int nwcs;                           // Number of WCS transformations in wcs.
     QList<Edge*> starCenters;           // All the stars we detected, if any.
     Edge* maxHFRStar;                   // The biggest fattest star in the image.
 
-    float *bayer_buffer;                // Bayer buffer
+    uint8_t *bayer_buffer;              // Bayer buffer, in the native pixel type
     BayerParams debayerParams;          // Bayer parameters
 
+    /* Histogram of the image, binned over the range of channel 0 */
+    struct
+    {
+        bool valid;                     // False if the image or its range changed since it was binned
+        int binCount;
+        double min;
+        double binWidth;
+        QVector<double> frequency[3];
+    } histogramCache;
+
 };
 
 #endif
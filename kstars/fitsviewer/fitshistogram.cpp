@@ -100,68 +100,38 @@ FITSHistogram::~FITSHistogram()
 
 void FITSHistogram::constructHistogram()
 {    
-    double fits_w=0, fits_h=0;
-
     FITSData *image_data = tab->getView()->getImageData();
-    float *buffer = image_data->getImageBuffer();
 
-    image_data->getDimensions(&fits_w, &fits_h);
     image_data->getMinMax(&fits_min, &fits_max);
 
-    uint32_t samples = fits_w*fits_h;
-
-    binCount = sqrt(samples);
-
-    intensity.fill(0, binCount);
-    r_frequency.fill(0, binCount);
-    cumulativeFrequency.fill(0, binCount);
-
-    double pixel_range = fits_max - fits_min;
-    binWidth = pixel_range / (binCount - 1);
+    // The frequencies are binned by FITSData along with the statistics
+    binCount = image_data->getHistogramBinCount();
+    binWidth = image_data->getHistogramBinWidth();
 
     if (Options::fITSLogging())
-        qDebug() << "fits MIN: " << fits_min << " - fits MAX: " << fits_max << " - pixel range: " << pixel_range << " - bin width " << binWidth << " bin count " << binCount;
+        qDebug() << "fits MIN: " << fits_min << " - fits MAX: " << fits_max << " - pixel range: " << fits_max - fits_min << " - bin width " << binWidth << " bin count " << binCount;
 
+    intensity.resize(binCount);
     for (int i=0; i < binCount; i++)
         intensity[i] = fits_min + (binWidth * i);
 
-    uint16_t r_id=0, g_id=0, b_id=0;
-
-    if (image_data->getNumOfChannels() == 1)
+    r_frequency = image_data->getHistogramFrequency(0);
+    if (image_data->getNumOfChannels() > 1)
     {
-        for (uint32_t i=0; i < samples ; i++)
-        {
-            r_id = round((buffer[i] - fits_min) / binWidth);
-            r_frequency[r_id >= binCount ? binCount - 1 : r_id]++;
-        }
+        g_frequency = image_data->getHistogramFrequency(1);
+        b_frequency = image_data->getHistogramFrequency(2);
     }
-    else
-    {
-        g_frequency.fill(0, binCount);
-        b_frequency.fill(0, binCount);
-
-        int g_offset = samples;
-        int b_offset = samples*2;
-        for (uint32_t i=0; i < samples ; i++)
-        {
-            r_id = round((buffer[i] - fits_min) / binWidth);
-            r_frequency[r_id >= binCount ? binCount - 1 : r_id]++;
-
-            g_id = round((buffer[i+g_offset] - fits_min) / binWidth);
-            g_frequency[g_id >= binCount ? binCount - 1 : g_id]++;
-
-            b_id = round((buffer[i+b_offset] - fits_min) / binWidth);
-            b_frequency[b_id >= binCount ? binCount - 1 : b_id]++;
-        }
-    }
-
 
     // Cumuliative Frequency
+    cumulativeFrequency.resize(binCount);
+    double cumulative = 0;
     for (int i=0; i < binCount; i++)
-        for (int j=0; j <= i; j++)
-            cumulativeFrequency[i] += r_frequency[j];
+    {
+        cumulative += r_frequency[i];
+        cumulativeFrequency[i] = cumulative;
+    }
 
-    int maxFrequency=0;
+    double maxFrequency=0;
     if (image_data->getNumOfChannels() == 1)
     {
         for (int i=0; i < binCount; i++)
@@ -183,24 +153,13 @@ void FITSHistogram::constructHistogram()
         }
     }
 
-    double median=0;
-    int halfCumulative = cumulativeFrequency[binCount - 1]/2;
-    for (int i=0; i < binCount; i++)
-    {
-        if (cumulativeFrequency[i] >= halfCumulative)
-        {
-            median = i * binWidth + fits_min;
-            break;
-        }
-    }
+    double median = image_data->getMedian();
 
     // Custom index to indicate the overall constrast of the image
     JMIndex = cumulativeFrequency[binCount/8]/cumulativeFrequency[binCount/4];
     if (Options::fITSLogging())
         qDebug() << "FITHistogram: JMIndex " << JMIndex;
 
-    image_data->setMedian(median);
-
     ui->meanEdit->setText(QString::number(image_data->getMean()));
     ui->medianEdit->setText(QString::number(median));
 
@@ -361,9 +320,9 @@ bool FITSHistogramCommand::calculateDelta(unsigned char *buffer)
 {
     FITSData *image_data = tab->getView()->getImageData();
 
-    unsigned char *image_buffer = (unsigned char *) image_data->getImageBuffer();
+    unsigned char *image_buffer = image_data->getImageBuffer();
     int totalPixels = image_data->getSize() * image_data->getNumOfChannels();
-    unsigned long totalBytes = totalPixels * sizeof(float);
+    unsigned long totalBytes = totalPixels * image_data->getBytesPerPixel();
     //qDebug() << "raw total bytes " << totalBytes << " bytes" << endl;
 
     unsigned char *raw_delta = new unsigned char[totalBytes];
@@ -406,13 +365,13 @@ bool FITSHistogramCommand::reverseDelta()
 {
     FITSView *image = tab->getView();
     FITSData *image_data = image->getImageData();
-    unsigned char *image_buffer = (unsigned char *) (image_data->getImageBuffer());
+    unsigned char *image_buffer = image_data->getImageBuffer();
 
     unsigned int size = image_data->getSize();
     int channels = image_data->getNumOfChannels();
 
     int totalPixels = size * channels;
-    unsigned long totalBytes = totalPixels * sizeof(float);
+    unsigned long totalBytes = totalPixels * image_data->getBytesPerPixel();
 
     unsigned char *output_image = new unsigned char[totalBytes];
     if (output_image == NULL)
@@ -440,7 +399,7 @@ bool FITSHistogramCommand::reverseDelta()
     for (unsigned int i=0; i < totalBytes; i++)
         output_image[i] = raw_delta[i] ^ image_buffer[i];
 
-    image_data->setImageBuffer((float *)output_image);
+    image_data->setImageBuffer(output_image);
 
     delete(raw_delta);
 
@@ -452,7 +411,7 @@ void FITSHistogramCommand::redo()
     FITSView *image = tab->getView();
     FITSData *image_data = image->getImageData();
 
-    float *image_buffer = image_data->getImageBuffer();    
+    uint8_t *image_buffer = image_data->getImageBuffer();
     unsigned int size = image_data->getSize();
     int channels = image_data->getNumOfChannels();   
 
@@ -485,7 +444,7 @@ void FITSHistogramCommand::redo()
         }
         else
         {
-            float *buffer = new float[size * channels];
+            uint8_t *buffer = new uint8_t[size * channels * image_data->getBytesPerPixel()];
             if (buffer == NULL)
             {
                 qWarning() << "Error! not enough memory to create image buffer in redo()" << endl;
@@ -493,7 +452,7 @@ void FITSHistogramCommand::redo()
                 return;
             }
 
-            memcpy(buffer, image_buffer, size * channels * sizeof(float));
+            memcpy(buffer, image_buffer, size * channels * image_data->getBytesPerPixel());
 
             switch (type)
             {
@@ -515,8 +474,8 @@ void FITSHistogramCommand::redo()
                break;
             }
 
-            calculateDelta( (unsigned char *) buffer);
-            delete (buffer);
+            calculateDelta(buffer);
+            delete[] buffer;
         }
     }
 
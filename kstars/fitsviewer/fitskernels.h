@@ -0,0 +1,293 @@
+/***************************************************************************
+                     fitskernels.h  -  FITS Image
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FITSKERNELS_H
+#define FITSKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <QtGlobal>
+
+// Vector kernels of the FITS filters and of the display stretch. Each
+// kernel handles as many samples as it can from the start of its range
+// and returns where it stopped; the caller finishes the rest with its
+// scalar loop, which is also the only loop for the other pixel types and
+// on other architectures. Floats use AVX when KStars is compiled for it
+// (e.g. with -march=native), and SSE otherwise, which every x86-64
+// processor has. 16 bit samples always use SSE2, as AVX has no 256 bit
+// integer instructions.
+#if defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VF_WIDTH 8
+#define vf_load    _mm256_loadu_ps
+#define vf_store   _mm256_storeu_ps
+#define vf_set1    _mm256_set1_ps
+#define vf_min     _mm256_min_ps
+#define vf_max     _mm256_max_ps
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VF_WIDTH 4
+#define vf_load    _mm_loadu_ps
+#define vf_store   _mm_storeu_ps
+#define vf_set1    _mm_set1_ps
+#define vf_min     _mm_min_ps
+#define vf_max     _mm_max_ps
+#endif
+
+namespace FITSKernels
+{
+
+/**
+ * Set out[i] to in[i] clamped to [lo, hi], for the first samples of
+ * 0 <= i < count.
+ * @return the number of samples done
+ */
+template <typename T>
+inline size_t clamp(const T *, T *, size_t, T, T)
+{
+    return 0;
+}
+
+/**
+ * Set out[x] to the median of the 3x3 window around row[x], for the
+ * first pixels of begin <= x < end. Both neighbours of these pixels
+ * must be in the rows.
+ * @return the first pixel not done
+ */
+template <typename T>
+inline int median9(const T *, const T *, const T *, T *, int begin, int)
+{
+    return begin;
+}
+
+/**
+ * Set out[i] to in[i] clamped to [min, max], times scale plus zero and
+ * truncated to 8 bits, for the first samples of 0 <= i < count.
+ * @return the number of samples done
+ */
+template <typename T>
+inline int stretch(const T *, uchar *, int, float, float, float, float)
+{
+    return 0;
+}
+
+#ifdef VF_WIDTH
+
+// The 19 exchange sorting network of median9() in fitsdata.cpp, on vectors
+template <typename V, typename Min, typename Max>
+inline V medianNetwork(V *p, Min vmin, Max vmax)
+{
+#define SORT_PAIR(a,b) { const V lo = vmin(p[a], p[b]); p[b] = vmax(p[a], p[b]); p[a] = lo; }
+    SORT_PAIR(1, 2); SORT_PAIR(4, 5); SORT_PAIR(7, 8);
+    SORT_PAIR(0, 1); SORT_PAIR(3, 4); SORT_PAIR(6, 7);
+    SORT_PAIR(1, 2); SORT_PAIR(4, 5); SORT_PAIR(7, 8);
+    SORT_PAIR(0, 3); SORT_PAIR(5, 8); SORT_PAIR(4, 7);
+    SORT_PAIR(3, 6); SORT_PAIR(1, 4); SORT_PAIR(2, 5);
+    SORT_PAIR(4, 7); SORT_PAIR(4, 2); SORT_PAIR(6, 4);
+    SORT_PAIR(4, 2);
+#undef SORT_PAIR
+    return p[4];
+}
+
+// 16 bit samples are compared as signed integers, since SSE2 only has
+// signed minimum and maximum. Flipping the top bit maps unsigned samples
+// to signed ones in the same order.
+inline __m128i flipSign(__m128i v)
+{
+    return _mm_xor_si128(v, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+
+inline __m128i loadSigned(const int16_t *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+inline __m128i loadSigned(const uint16_t *p)
+{
+    return flipSign(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+inline void storeSigned(int16_t *p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+
+inline void storeSigned(uint16_t *p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), flipSign(v));
+}
+
+inline __m128i signedValue(int16_t v)
+{
+    return _mm_set1_epi16(v);
+}
+
+inline __m128i signedValue(uint16_t v)
+{
+    return _mm_set1_epi16(static_cast<short>(v ^ 0x8000));
+}
+
+template <typename T>
+inline size_t clamp16(const T *in, T *out, size_t count, T lo, T hi)
+{
+    const __m128i vlo = signedValue(lo), vhi = signedValue(hi);
+    size_t i = 0;
+    for( ; i + 8 <= count; i += 8 )
+        storeSigned(out + i, _mm_max_epi16(_mm_min_epi16(loadSigned(in + i), vhi), vlo));
+    return i;
+}
+
+template <>
+inline size_t clamp(const int16_t *in, int16_t *out, size_t count, int16_t lo, int16_t hi)
+{
+    return clamp16(in, out, count, lo, hi);
+}
+
+template <>
+inline size_t clamp(const uint16_t *in, uint16_t *out, size_t count, uint16_t lo, uint16_t hi)
+{
+    return clamp16(in, out, count, lo, hi);
+}
+
+// The operands are in the order of qBound(), so that NaN becomes lo as in the scalar loops
+template <>
+inline size_t clamp(const float *in, float *out, size_t count, float lo, float hi)
+{
+    const vfloat vlo = vf_set1(lo), vhi = vf_set1(hi);
+    size_t i = 0;
+    for( ; i + VF_WIDTH <= count; i += VF_WIDTH )
+        vf_store(out + i, vf_max(vf_min(vhi, vf_load(in + i)), vlo));
+    return i;
+}
+
+template <typename T>
+inline int median16(const T *above, const T *row, const T *below, T *out, int begin, int end)
+{
+    auto vmin = [](__m128i a, __m128i b) { return _mm_min_epi16(a, b); };
+    auto vmax = [](__m128i a, __m128i b) { return _mm_max_epi16(a, b); };
+    int x = begin;
+    for( ; x + 8 <= end; x += 8 ) {
+        __m128i p[9] = { loadSigned(above + x - 1), loadSigned(above + x), loadSigned(above + x + 1),
+                         loadSigned(row + x - 1),   loadSigned(row + x),   loadSigned(row + x + 1),
+                         loadSigned(below + x - 1), loadSigned(below + x), loadSigned(below + x + 1) };
+        storeSigned(out + x, medianNetwork(p, vmin, vmax));
+    }
+    return x;
+}
+
+template <>
+inline int median9(const int16_t *above, const int16_t *row, const int16_t *below, int16_t *out, int begin, int end)
+{
+    return median16(above, row, below, out, begin, end);
+}
+
+template <>
+inline int median9(const uint16_t *above, const uint16_t *row, const uint16_t *below, uint16_t *out, int begin, int end)
+{
+    return median16(above, row, below, out, begin, end);
+}
+
+template <>
+inline int median9(const float *above, const float *row, const float *below, float *out, int begin, int end)
+{
+    auto vmin = [](vfloat a, vfloat b) { return vf_min(a, b); };
+    auto vmax = [](vfloat a, vfloat b) { return vf_max(a, b); };
+    int x = begin;
+    for( ; x + VF_WIDTH <= end; x += VF_WIDTH ) {
+        vfloat p[9] = { vf_load(above + x - 1), vf_load(above + x), vf_load(above + x + 1),
+                        vf_load(row + x - 1),   vf_load(row + x),   vf_load(row + x + 1),
+                        vf_load(below + x - 1), vf_load(below + x), vf_load(below + x + 1) };
+        vf_store(out + x, medianNetwork(p, vmin, vmax));
+    }
+    return x;
+}
+
+// Clamp, scale and truncate 16 samples, and store them as bytes
+inline void stretch16(const __m128 v[4], uchar *out, __m128 vmin, __m128 vmax, __m128 vscale, __m128 vzero)
+{
+    __m128i w[4];
+    for( int k = 0; k < 4; ++k )
+        w[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_min_ps(vmax, v[k]), vmin), vscale), vzero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                     _mm_packus_epi16(_mm_packs_epi32(w[0], w[1]), _mm_packs_epi32(w[2], w[3])));
+}
+
+template <>
+inline int stretch(const float *in, uchar *out, int count, float min, float max, float scale, float zero)
+{
+    const __m128 vmin = _mm_set1_ps(min), vmax = _mm_set1_ps(max);
+    const __m128 vscale = _mm_set1_ps(scale), vzero = _mm_set1_ps(zero);
+    int i = 0;
+    for( ; i + 16 <= count; i += 16 ) {
+        const __m128 v[4] = { _mm_loadu_ps(in + i), _mm_loadu_ps(in + i + 4),
+                              _mm_loadu_ps(in + i + 8), _mm_loadu_ps(in + i + 12) };
+        stretch16(v, out + i, vmin, vmax, vscale, vzero);
+    }
+    return i;
+}
+
+template <>
+inline int stretch(const uint16_t *in, uchar *out, int count, float min, float max, float scale, float zero)
+{
+    const __m128 vmin = _mm_set1_ps(min), vmax = _mm_set1_ps(max);
+    const __m128 vscale = _mm_set1_ps(scale), vzero = _mm_set1_ps(zero);
+    const __m128i zeros = _mm_setzero_si128();
+    int i = 0;
+    for( ; i + 16 <= count; i += 16 ) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+        const __m128 v[4] = { _mm_cvtepi32_ps(_mm_unpacklo_epi16(a, zeros)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(a, zeros)),
+                              _mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zeros)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(b, zeros)) };
+        stretch16(v, out + i, vmin, vmax, vscale, vzero);
+    }
+    return i;
+}
+
+template <>
+inline int stretch(const int16_t *in, uchar *out, int count, float min, float max, float scale, float zero)
+{
+    const __m128 vmin = _mm_set1_ps(min), vmax = _mm_set1_ps(max);
+    const __m128 vscale = _mm_set1_ps(scale), vzero = _mm_set1_ps(zero);
+    int i = 0;
+    for( ; i + 16 <= count; i += 16 ) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+        // Sign extend by moving each sample to the top half of a lane and shifting it back
+        const __m128 v[4] = { _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16)),
+                              _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16)),
+                              _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16)),
+                              _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16)) };
+        stretch16(v, out + i, vmin, vmax, vscale, vzero);
+    }
+    return i;
+}
+
+#endif
+
+}
+
+#undef VF_WIDTH
+#undef vf_load
+#undef vf_store
+#undef vf_set1
+#undef vf_min
+#undef vf_max
+
+#endif
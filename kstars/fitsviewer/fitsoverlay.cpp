@@ -104,7 +104,6 @@ void FITSOverlay::openImage()
 
     int image_width, image_height;
     double min,max, bzero, bscale, val;
-    float *image_buffer;
 
     image_width   = newFO->image_data->getWidth();
     image_height  = newFO->image_data->getHeight();
@@ -113,8 +112,6 @@ void FITSOverlay::openImage()
 
     QImage image(image_width, image_height, QImage::Format_Indexed8);
 
-    image_buffer = newFO->image_data->getImageBuffer();
-
     bscale = 255. / (max - min);
     bzero  = (-min) * (255. / (max - min));
 
@@ -126,7 +123,7 @@ void FITSOverlay::openImage()
     for (int j = 0; j < image_height; j++)
         for (int i = 0; i < image_width; i++)
         {
-            val = image_buffer[j * image_width + i];
+            val = newFO->image_data->getValue(j * image_width + i);
             image.setPixel(i, j, ((int) (val * bscale + bzero)));
         }
 
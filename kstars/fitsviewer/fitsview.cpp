@@ -40,6 +40,7 @@
 #include <QFileDialog>
 #include <QWheelEvent>
 #include <QMenu>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <KActionCollection>
 #include <KMessageBox>
@@ -48,6 +49,7 @@
 #include "kstarsdata.h"
 #include "ksutils.h"
 #include "Options.h"
+#include "fitskernels.h"
 
 #ifdef HAVE_INDI
 #include "basedevice.h"
@@ -84,9 +86,7 @@ void FITSLabel::mouseMoveEvent(QMouseEvent *e)
     double x,y;
     FITSData *image_data = image->getImageData();
 
-    float *buffer = image_data->getImageBuffer();
-
-    if (buffer == NULL)
+    if (image_data->getImageBuffer() == NULL)
         return;
 
     x = round(e->x() / (image->getCurrentZoom() / ZOOM_DEFAULT));
@@ -102,24 +102,19 @@ void FITSLabel::mouseMoveEvent(QMouseEvent *e)
     y -= 1;
 
     if (image_data->getBPP() == -32 || image_data->getBPP() == 32)
-        emit newStatus(QLocale().toString(buffer[(int) (y * width + x)], 'f', 4), FITS_VALUE);
+        emit newStatus(QLocale().toString(image_data->getValue(y * width + x), 'f', 4), FITS_VALUE);
     else
-        emit newStatus(QLocale().toString(buffer[(int) (y * width + x)], 'f', 2), FITS_VALUE);
+        emit newStatus(QLocale().toString(image_data->getValue(y * width + x), 'f', 2), FITS_VALUE);
 
 
     if (image_data->hasWCS())
     {
-        int index = x + y * width;
-
-        wcs_point * wcs_coord = image_data->getWCSCoord();
+        wcs_point wcs_coord;
 
-        if (wcs_coord)
+        if (image_data->getWCSCoord(x, y, &wcs_coord))
         {
-            if (index > size)
-                return;
-
-            ra.setD(wcs_coord[index].ra);
-            dec.setD(wcs_coord[index].dec);
+            ra.setD(wcs_coord.ra);
+            dec.setD(wcs_coord.dec);
 
             emit newStatus(QString("%1 , %2").arg( ra.toHMSString()).arg(dec.toDMSString()), FITS_WCS);
         }
@@ -150,16 +145,11 @@ void FITSLabel::mousePressEvent(QMouseEvent *e)
 
       if (fitspopup.exec(e->globalPos()) == trackAction)
       {
-          int index = x + y * width;
+          wcs_point wcs_coord;
 
-          wcs_point * wcs_coord = image_data->getWCSCoord();
-
-          if (wcs_coord)
+          if (image_data->getWCSCoord(x, y, &wcs_coord))
           {
-              if (index > size)
-                  return;
-
-              centerTelescope(wcs_coord[index].ra/15.0, wcs_coord[index].dec);
+              centerTelescope(wcs_coord.ra/15.0, wcs_coord.dec);
 
               return;
           }
@@ -281,7 +271,7 @@ FITSView::~FITSView()
     delete(display_image);
 }
 
-bool FITSView::loadFITS (const QString &inFilename , bool silent)
+bool FITSView::loadFITS (const QString &inFilename , bool silent, const QByteArray &buffer)
 {
     QProgressDialog fitsProg(this);
 
@@ -311,7 +301,7 @@ bool FITSView::loadFITS (const QString &inFilename , bool silent)
         qApp->processEvents();
     }
 
-    if (image_data->loadFITS(inFilename, silent) == false)
+    if (image_data->loadFITS(inFilename, silent, buffer) == false)
         return false;
 
 
@@ -396,39 +386,13 @@ int FITSView::saveFITS( const QString &newFilename )
 
 int FITSView::rescale(FITSZoom type)
 {
-    double val=0;
-    double bscale, bzero;
     double min, max;
-    float *image_buffer = image_data->getImageBuffer();
-    float *display_buffer = image_buffer;
-    unsigned int size = image_data->getSize();
 
+    // Auto stretch is applied while filling the display image, the image data itself is left untouched
     if (Options::autoStretch() && filter == FITS_NONE)
     {
-        display_buffer = new float[image_data->getSize() * image_data->getNumOfChannels()];
-        memset(display_buffer, 0, image_data->getSize() * image_data->getNumOfChannels() * sizeof(float));
-
-        float data_min   = image_data->getMean(0) - image_data->getStdDev(0);
-        float data_max   = image_data->getMean(0) + image_data->getStdDev(0) * 3;
-        int   data_w     = image_data->getWidth();
-        int   data_h     = image_data->getHeight();
-
-        for (int i=0; i < image_data->getNumOfChannels(); i++)
-        {
-            int offset = i*size;
-            for (int j=0; j < data_h; j++)
-            {
-                int row = offset + j * data_w;
-                for (int k=0; k < data_w; k++)
-                {
-                    int index=k + row;
-                    display_buffer[index] = qBound(data_min, image_buffer[index], data_max);
-                }
-            }
-        }
-
-        min = data_min;
-        max = data_max;
+        min = image_data->getMean(0) - image_data->getStdDev(0);
+        max = image_data->getMean(0) + image_data->getStdDev(0) * 3;
     }
     else
         image_data->getMinMax(&min, &max);
@@ -440,9 +404,6 @@ int FITSView::rescale(FITSZoom type)
     }
     else
     {
-        bscale = 255. / (max - min);
-        bzero  = (-min) * (255. / (max - min));
-
         if (image_height != image_data->getHeight() || image_width != image_data->getWidth())
         {
             image_width  = image_data->getWidth();
@@ -458,50 +419,26 @@ int FITSView::rescale(FITSZoom type)
         currentWidth  = display_image->width();
         currentHeight = display_image->height();
 
-        if (image_data->getNumOfChannels() == 1)
+        switch (image_data->getDataType())
         {
-            /* Fill in pixel values using indexed map, linear scale */
-            for (int j = 0; j < image_height; j++)
-            {
-                unsigned char *scanLine = display_image->scanLine(j);
-
-                for (int i = 0; i < image_width; i++)
-                {
-                    val = display_buffer[j * image_width + i];
-                    scanLine[i]= (val * bscale + bzero);
-                }
-            }
-        }
-        else
-        {
-            double rval=0,gval=0,bval=0;
-            QRgb value;
-            /* Fill in pixel values using indexed map, linear scale */
-            for (int j = 0; j < image_height; j++)
-            {
-                QRgb *scanLine = reinterpret_cast<QRgb*>((display_image->scanLine(j)));
-
-                for (int i = 0; i < image_width; i++)
-                {
-                    rval = display_buffer[j * image_width + i];
-                    gval = display_buffer[j * image_width + i + size];
-                    bval = display_buffer[j * image_width + i + size * 2];
-
-                    value = qRgb(rval* bscale + bzero, gval* bscale + bzero, bval* bscale + bzero);
-
-                    //display_image->setPixel(i, j, value);
-                    scanLine[i] = value;
-
-                }
-            }
-
+        case TBYTE:
+            fillDisplayImage<uint8_t>(min, max);
+            break;
+        case TSHORT:
+            fillDisplayImage<int16_t>(min, max);
+            break;
+        case TUSHORT:
+            fillDisplayImage<uint16_t>(min, max);
+            break;
+        case TINT:
+            fillDisplayImage<int32_t>(min, max);
+            break;
+        default:
+            fillDisplayImage<float>(min, max);
+            break;
         }
-
     }
 
-    if (display_buffer != image_buffer)
-        delete [] display_buffer;
-
     switch (type)
     {
     case ZOOM_FIT_WINDOW:
@@ -554,6 +491,60 @@ int FITSView::rescale(FITSZoom type)
 
 }
 
+template <typename T>
+void FITSView::fillDisplayImage(double min, double max)
+{
+    const T *buffer = reinterpret_cast<const T *>(image_data->getImageBuffer());
+    const size_t size = image_data->getSize();
+    const int width = image_width;
+    const bool grayscale = (image_data->getNumOfChannels() == 1);
+
+    // Clamp, stretch and convert to 8 bits in a single pass. Single precision
+    // is plenty for 8 bit output, and grayscale rows of 16 bit and float
+    // samples go through the vector kernel of fitskernels.h.
+    const float fmin   = min;
+    const float fmax   = max;
+    const float bscale = 255. / (max - min);
+    const float bzero  = (-min) * (255. / (max - min));
+
+    // Get the pixel data once here on the GUI thread, so that the rows can
+    // be filled concurrently without the image detaching behind our back.
+    uchar *bits = display_image->bits();
+    const int bytesPerLine = display_image->bytesPerLine();
+
+    QVector<int> rows(image_height);
+    for (int j = 0; j < image_height; j++)
+        rows[j] = j;
+
+    QtConcurrent::blockingMap(rows, [=](int &j)
+    {
+        const T *source = buffer + static_cast<size_t>(j) * width;
+
+        if (grayscale)
+        {
+            /* Fill in pixel values using indexed map, linear scale */
+            unsigned char *scanLine = bits + static_cast<size_t>(j) * bytesPerLine;
+
+            int i = FITSKernels::stretch(source, scanLine, width, fmin, fmax, bscale, bzero);
+            for (; i < width; i++)
+                scanLine[i] = qBound(fmin, static_cast<float>(source[i]), fmax) * bscale + bzero;
+        }
+        else
+        {
+            QRgb *scanLine = reinterpret_cast<QRgb*>(bits + static_cast<size_t>(j) * bytesPerLine);
+
+            for (int i = 0; i < width; i++)
+            {
+                int rval = qBound(fmin, static_cast<float>(source[i]), fmax) * bscale + bzero;
+                int gval = qBound(fmin, static_cast<float>(source[i + size]), fmax) * bscale + bzero;
+                int bval = qBound(fmin, static_cast<float>(source[i + size * 2]), fmax) * bscale + bzero;
+
+                scanLine[i] = qRgb(rval, gval, bval);
+            }
+        }
+    });
+}
+
 void FITSView::ZoomIn()
 {
 
@@ -87,8 +87,8 @@ public:
     FITSView(QWidget *parent = 0, FITSMode mode=FITS_NORMAL, FITSScale filter=FITS_NONE);
     ~FITSView();
 
-    /* Loads FITS image, scales it, and displays it in the GUI */
-    bool  loadFITS(const QString &filename, bool silent=true);
+    /* Loads FITS image, scales it, and displays it in the GUI. If buffer is not empty, the image is read from memory */
+    bool  loadFITS(const QString &filename, bool silent=true, const QByteArray &buffer=QByteArray());
     /* Save FITS */
     int saveFITS(const QString &filename);
     /* Rescale image lineary from image_buffer, fit to window if desired */
@@ -141,6 +141,8 @@ private:
     double stddev();
     void calculateMaxPixel(double min, double max);
     void initDisplayImage();
+    // Scale the pixels of the native image buffer between min and max into display_image
+    template <typename T> void fillDisplayImage(double min, double max);
 
     FITSLabel *image_frame;
     FITSData *image_data;
@@ -262,14 +262,14 @@ void FITSViewer::showEvent(QShowEvent * /*event*/)
     }
 }
 
-int FITSViewer::addFITS(const QUrl *imageName, FITSMode mode, FITSScale filter, const QString &previewText, bool silent)
+int FITSViewer::addFITS(const QUrl *imageName, FITSMode mode, FITSScale filter, const QString &previewText, bool silent, const QByteArray &buffer)
 {
     FITSTab *tab = new FITSTab(this);
 
     led.setColor(Qt::yellow);
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    if (tab->loadFITS(imageName,mode, filter, silent) == false)
+    if (tab->loadFITS(imageName,mode, filter, silent, buffer) == false)
     {
         QApplication::restoreOverrideCursor();
         led.setColor(Qt::red);
@@ -284,7 +284,9 @@ int FITSViewer::addFITS(const QUrl *imageName, FITSMode mode, FITSScale filter,
         return -1;
     }
 
-    lastURL = QUrl(imageName->url(QUrl::RemoveFilename));
+    // Images loaded from memory have no URL
+    if (imageName->isEmpty() == false)
+        lastURL = QUrl(imageName->url(QUrl::RemoveFilename));
 
     QApplication::restoreOverrideCursor();
     tab->setPreviewText(previewText);
@@ -367,7 +369,7 @@ bool FITSViewer::removeFITS(int fitsUID)
 
 }
 
-bool FITSViewer::updateFITS(const QUrl *imageName, int fitsUID, FITSScale filter, bool silent)
+bool FITSViewer::updateFITS(const QUrl *imageName, int fitsUID, FITSScale filter, bool silent, const QByteArray &buffer)
 {
     FITSTab *tab = fitsMap.value(fitsUID);
 
@@ -384,7 +386,7 @@ bool FITSViewer::updateFITS(const QUrl *imageName, int fitsUID, FITSScale filter
 
     if (tab)
     {
-        rc = tab->loadFITS(imageName, tab->getView()->getMode(), filter, silent);
+        rc = tab->loadFITS(imageName, tab->getView()->getMode(), filter, silent, buffer);
 
         if (rc)
         {
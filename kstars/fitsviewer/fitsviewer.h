@@ -67,9 +67,9 @@ public:
     FITSViewer (QWidget *parent);
     ~FITSViewer();
 
-    int addFITS(const QUrl *imageName, FITSMode mode=FITS_NORMAL, FITSScale filter=FITS_NONE, const QString &previewText = QString(), bool silent=true);
+    int addFITS(const QUrl *imageName, FITSMode mode=FITS_NORMAL, FITSScale filter=FITS_NONE, const QString &previewText = QString(), bool silent=true, const QByteArray &buffer=QByteArray());
 
-    bool updateFITS(const QUrl *imageName, int fitsUID, FITSScale filter=FITS_NONE, bool silent=true);
+    bool updateFITS(const QUrl *imageName, int fitsUID, FITSScale filter=FITS_NONE, bool silent=true, const QByteArray &buffer=QByteArray());
     bool removeFITS(int fitsUID);
 
     void toggleMarkStars(bool enable) { markStars = enable; }
@@ -14,6 +14,9 @@
 #include <KMessageBox>
 #include <QStatusBar>
 #include <QImageReader>
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <KNotifications/KNotification>
 
 #include <basedevice.h>
@@ -1127,10 +1130,39 @@ void CCD::processBLOB(IBLOB* bp)
     if (filename.endsWith('/') == false)
         filename.append('/');
 
+    // FITS images that are only displayed and analyzed (focus and guide frames), and FITS images
+    // in a capture sequence, are loaded straight from memory instead of being read back from disk.
+    // Align, calibration and preview frames are loaded from their file as their consumers need one.
+    QByteArray fitsBuffer;
+    bool memoryOnly = false;
+#ifdef HAVE_CFITSIO
+    if (BType == BLOB_FITS)
+    {
+        memoryOnly = (targetChip->getCaptureMode() == FITS_FOCUS || targetChip->getCaptureMode() == FITS_GUIDE);
+
+        if (memoryOnly || (targetChip->isBatchMode() && targetChip->getCaptureMode() == FITS_NORMAL))
+        {
+            fitsBuffer = QByteArray(static_cast<char *> (bp->blob), bp->size);
+            addFITSKeywords(fitsBuffer);
+        }
+    }
+#endif
+
+    // Pending write of a sequence frame, reported back before the BLOB is announced
+    QFuture<bool> pendingWrite;
+    bool writePending = false;
+
+    // Focus and guide frames are not written to disk. The file is only created if it is asked for, see getMemoryFrameFile().
+    if (memoryOnly)
+    {
+        filename.clear();
+        memoryFrames[bp->name] = fitsBuffer;
+        memoryFrameFiles.remove(bp->name);
+    }
     // Create temporary name if ANY of the following conditions are met:
     // 1. file is preview or batch mode is not enabled
-    // 2. file type is not FITS_NORMAL (focus, guide..etc)
-    if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
+    // 2. file type is not FITS_NORMAL (calibration, align..etc)
+    else if (targetChip->isBatchMode() == false || targetChip->getCaptureMode() != FITS_NORMAL)
     {
 
         //tmpFile.setPrefix("fits");
@@ -1163,30 +1195,40 @@ void CCD::processBLOB(IBLOB* bp)
         else
             filename += seqPrefix + (seqPrefix.isEmpty() ? "" : "_") + QString("%1_%2.%3").arg(QString().sprintf("%03d", nextSequenceID)).arg(ts).arg(QString(fmt));
 
-        QFile fits_temp_file(filename);
-        if (!fits_temp_file.open(QIODevice::WriteOnly))
+        // The image is displayed from memory, so write it out on a worker thread
+        if (fitsBuffer.isEmpty() == false)
         {
-            qDebug() << "ISD:CCD Error: Unable to open " << fits_temp_file.fileName() << endl;
-            emit BLOBUpdated(NULL);
-            return;
+            pendingWrite = QtConcurrent::run(&CCD::writeBLOB, filename, fitsBuffer);
+            writePending = true;
         }
+        else
+        {
+            QFile fits_temp_file(filename);
+            if (!fits_temp_file.open(QIODevice::WriteOnly))
+            {
+                qDebug() << "ISD:CCD Error: Unable to open " << fits_temp_file.fileName() << endl;
+                emit BLOBUpdated(NULL);
+                return;
+            }
 
-        QDataStream out(&fits_temp_file);
+            QDataStream out(&fits_temp_file);
 
-        for (nr=0; nr < (int) bp->size; nr += n)
-            n = out.writeRawData( static_cast<char *> (bp->blob) + nr, bp->size - nr);
+            for (nr=0; nr < (int) bp->size; nr += n)
+                n = out.writeRawData( static_cast<char *> (bp->blob) + nr, bp->size - nr);
 
-        fits_temp_file.close();
+            fits_temp_file.close();
+        }
     }
 
-    if (BType == BLOB_FITS)
+    if (BType == BLOB_FITS && fitsBuffer.isEmpty())
         addFITSKeywords(filename);
 
-    // store file name
+    // store file name, empty for images kept in memory only
     strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
     bp->aux2 = BLOBFilename;
 
-    if (targetChip->getCaptureMode() == FITS_NORMAL && targetChip->isBatchMode() == true)
+    // A sequence frame written on a worker thread is announced once it is on disk, see below
+    if (targetChip->getCaptureMode() == FITS_NORMAL && targetChip->isBatchMode() == true && writePending == false)
         KStars::Instance()->statusBar()->showMessage( i18n("%1 file saved to %2", QString(fmt).toUpper(), filename ), 0);
 
     // FIXME: Why is this leaking memory in Valgrind??!
@@ -1271,11 +1313,11 @@ void CCD::processBLOB(IBLOB* bp)
         case FITS_NORMAL:
         {
             if (normalTabID == -1 || Options::singlePreviewFITS() == false)
-                tabRC = fv->addFITS(&fileURL, FITS_NORMAL, captureFilter, previewTitle);
-            else if (fv->updateFITS(&fileURL, normalTabID, captureFilter) == false)
+                tabRC = fv->addFITS(&fileURL, FITS_NORMAL, captureFilter, previewTitle, true, fitsBuffer);
+            else if (fv->updateFITS(&fileURL, normalTabID, captureFilter, true, fitsBuffer) == false)
             {
                 fv->removeFITS(normalTabID);
-                tabRC = fv->addFITS(&fileURL, FITS_NORMAL, captureFilter, previewTitle);
+                tabRC = fv->addFITS(&fileURL, FITS_NORMAL, captureFilter, previewTitle, true, fitsBuffer);
             }
             else
                 tabRC = normalTabID;
@@ -1298,11 +1340,11 @@ void CCD::processBLOB(IBLOB* bp)
 
         case FITS_FOCUS:
             if (focusTabID == -1)
-                tabRC = fv->addFITS(&fileURL, FITS_FOCUS, captureFilter);
-            else if (fv->updateFITS(&fileURL, focusTabID, captureFilter) == false)
+                tabRC = fv->addFITS(&fileURL, FITS_FOCUS, captureFilter, QString(), true, fitsBuffer);
+            else if (fv->updateFITS(&fileURL, focusTabID, captureFilter, true, fitsBuffer) == false)
             {
                 fv->removeFITS(focusTabID);
-                tabRC = fv->addFITS(&fileURL, FITS_FOCUS, captureFilter);
+                tabRC = fv->addFITS(&fileURL, FITS_FOCUS, captureFilter, QString(), true, fitsBuffer);
             }
             else
                 tabRC = focusTabID;
@@ -1324,11 +1366,11 @@ void CCD::processBLOB(IBLOB* bp)
 
         case FITS_GUIDE:
             if (guideTabID == -1)
-                tabRC = fv->addFITS(&fileURL, FITS_GUIDE, captureFilter);
-            else if (fv->updateFITS(&fileURL, guideTabID, captureFilter) == false)
+                tabRC = fv->addFITS(&fileURL, FITS_GUIDE, captureFilter, QString(), true, fitsBuffer);
+            else if (fv->updateFITS(&fileURL, guideTabID, captureFilter, true, fitsBuffer) == false)
             {
                 fv->removeFITS(guideTabID);
-                tabRC = fv->addFITS(&fileURL, FITS_GUIDE, captureFilter);
+                tabRC = fv->addFITS(&fileURL, FITS_GUIDE, captureFilter, QString(), true, fitsBuffer);
             }
             else
                 tabRC = guideTabID;
@@ -1404,6 +1446,45 @@ void CCD::processBLOB(IBLOB* bp)
     }
 #endif
 
+    if (writePending)
+    {
+        // Advance the sequence only once the frame is saved, like when it is written synchronously
+        QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+        QString upperFormat = QString(fmt).toUpper();
+
+        // The INDI client may reuse the BLOB once we return, so announce a copy of its names and format
+        QSharedPointer<BLOBCopy> copy(new BLOBCopy);
+        copy->blob = *bp;
+        copy->blob.blob = NULL;
+        if (bp->bvp)
+        {
+            copy->property = *bp->bvp;
+            copy->property.bp = &copy->blob;
+            copy->property.nbp = 1;
+            copy->blob.bvp = &copy->property;
+        }
+
+        connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, copy, filename, upperFormat]()
+        {
+            watcher->deleteLater();
+
+            if (watcher->result() == false)
+            {
+                KStars::Instance()->statusBar()->showMessage(i18n("Unable to save %1 file to %2", upperFormat, filename), 0);
+                emit BLOBUpdated(NULL);
+                return;
+            }
+
+            KStars::Instance()->statusBar()->showMessage( i18n("%1 file saved to %2", upperFormat, filename ), 0);
+
+            strncpy(BLOBFilename, filename.toLatin1(), MAXINDIFILENAME);
+            copy->blob.aux2 = BLOBFilename;
+            emit BLOBUpdated(&copy->blob);
+        });
+        watcher->setFuture(pendingWrite);
+        return;
+    }
+
     emit BLOBUpdated(bp);
 
 }
@@ -1439,6 +1520,120 @@ void CCD::addFITSKeywords(QString filename)
 #endif
 }
 
+void CCD::addFITSKeywords(QByteArray &buffer)
+{
+#ifdef HAVE_CFITSIO
+    int status=0;
+
+    if (filter.isEmpty() == false)
+    {
+        QString key_comment("Filter name");
+        filter.replace(" ", "_");
+
+        // Find the END card of the primary header
+        const int cardSize = 80, blockSize = 2880;
+        int endCard = -1;
+        for (int i=0; (i+1) * cardSize <= buffer.size(); i++)
+        {
+            if (strncmp(buffer.constData() + i * cardSize, "END     ", 8) == 0)
+            {
+                endCard = i;
+                break;
+            }
+        }
+
+        if (endCard < 0)
+        {
+            qDebug() << "ISD:CCD Error: No FITS header found in the image." << endl;
+            return;
+        }
+
+        // The header is edited in place. If its last block has no spare card for the keyword,
+        // a blank block is added to it, which moves the data once instead of copying the frame around.
+        int headerEnd = (endCard * cardSize / blockSize + 1) * blockSize;
+        if ((endCard + 1) * cardSize == headerEnd)
+            buffer.insert(headerEnd, QByteArray(blockSize, ' '));
+
+        // There is room for the keyword, so CFITSIO never has to grow the buffer
+        void *memPointer = buffer.data();
+        size_t memSize = buffer.size();
+
+        fitsfile* fptr=NULL;
+
+        if (fits_open_memfile(&fptr, "", READWRITE, &memPointer, &memSize, 0, NULL, &status))
+        {
+            fits_report_error(stderr, status);
+            return;
+        }
+
+        if (fits_update_key_str(fptr, "FILTER", filter.toLatin1().data(), key_comment.toLatin1().data(), &status))
+        {
+            fits_report_error(stderr, status);
+            status=0;
+            fits_close_file(fptr, &status);
+            return;
+        }
+
+        fits_close_file(fptr, &status);
+
+        filter = "";
+    }
+#else
+    Q_UNUSED(buffer);
+#endif
+}
+
+QString CCD::getMemoryFrameFile(const QString &blobName)
+{
+    if (memoryFrameFiles.contains(blobName))
+        return memoryFrameFiles.value(blobName);
+
+    QByteArray frame = memoryFrames.value(blobName);
+    if (frame.isEmpty())
+        return QString();
+
+    QTemporaryFile tmpFile(QDir::tempPath() + "/fitsXXXXXX");
+    tmpFile.setAutoRemove(false);
+    if (!tmpFile.open())
+    {
+        qDebug() << "ISD:CCD Error: Unable to open " << tmpFile.fileName() << endl;
+        return QString();
+    }
+    QString filename = tmpFile.fileName();
+    tmpFile.close();
+
+    if (writeBLOB(filename, frame) == false)
+        return QString();
+
+    memoryFrameFiles[blobName] = filename;
+    return filename;
+}
+
+bool CCD::writeBLOB(const QString &filename, const QByteArray &buffer)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "ISD:CCD Error: Unable to open " << filename << endl;
+        return false;
+    }
+
+    bool written = (file.write(buffer) == buffer.size());
+    if (written == false)
+        qDebug() << "ISD:CCD Error: Unable to write " << filename << endl;
+
+    file.close();
+
+    // Data that could not be flushed to a full disk only shows up on close
+    if (written && file.error() != QFileDevice::NoError)
+    {
+        qDebug() << "ISD:CCD Error: Unable to write " << filename << endl;
+        written = false;
+    }
+
+    return written;
+}
+
 void CCD::FITSViewerDestroyed()
 {
     fv = NULL;
@@ -15,6 +15,7 @@
 
 #include <QStringList>
 #include <QPointer>
+#include <QHash>
 
 #include <fitsviewer/fitsviewer.h>
 #include <fitsviewer/fitsdata.h>
@@ -163,6 +164,11 @@ public:
     bool setUploadMode(UploadMode mode);
 
     FITSViewer *getViewer() { return fv;}
+    /**
+     * @return the name of a file holding the last frame of BLOB blobName that was only kept in memory
+     * (a focus or guide frame). The file is written on the first request. Empty if there is no such frame.
+     */
+    QString getMemoryFrameFile(const QString &blobName);
     CCDChip * getChip(CCDChip::ChipType cType);
     void setFITSDir(const QString &dir) { fitsDir = dir;}
 
@@ -180,6 +186,10 @@ signals:
 
 private:
     void addFITSKeywords(QString filename);
+    // Same as above, for a FITS file held in memory, edited in place. The buffer grows by one header block if the header is full.
+    void addFITSKeywords(QByteArray &buffer);
+    // Write a BLOB to disk, safe to call from a worker thread. Returns false if the file could not be written.
+    static bool writeBLOB(const QString &filename, const QByteArray &buffer);
     QString filter;
 
     bool ISOMode;
@@ -189,6 +199,15 @@ private:
     QString		seqPrefix;
     QString     fitsDir;
     char BLOBFilename[MAXINDIFILENAME];
+    // A BLOB announced after processBLOB() returned, with its vector property
+    struct BLOBCopy
+    {
+        IBLOB blob;
+        IBLOBVectorProperty property;
+    };
+    // Last focus or guide frame of each BLOB, and the file it was written to on request
+    QHash<QString, QByteArray> memoryFrames;
+    QHash<QString, QString> memoryFrameFiles;
     int nextSequenceID;
     StreamWG *streamWindow;
     int streamW, streamH;
@@ -16,6 +16,7 @@
 #include "indi/clientmanager.h"
 #include "indi/indilistener.h"
 #include "indi/deviceinfo.h"
+#include "indi/indiccd.h"
 
 #include "nan.h"
 
@@ -614,6 +615,9 @@ QString INDIDBus::getBLOBFile(const QString &device, const QString &property, co
                 if (b)
                 {
                     filename = QString(((char *) b->aux2));
+                    // Focus and guide frames are kept in memory, their file is only written when asked for
+                    if (filename.isEmpty() && gd->getType() == KSTARS_CCD)
+                        filename = static_cast<ISD::CCD *>(gd)->getMemoryFrameFile(blobName);
                     size  = b->bloblen;
                     blobFormat = QString(b->format).trimmed();
 
@@ -380,6 +380,17 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE QString getObjectPositionInfo( const QString &objectName );
 
+    /** DBUS interface function.  Return XML listing the upcoming passes of an artificial satellite
+     * @param satelliteName name of the satellite.
+     * @param days number of days, starting from the current simulation time, to search for passes.
+     * At most 30 days are searched.
+     * @note If the satellite was not found, the XML is empty. Times are given in UT.
+     * @note The magnitude at culmination is a rough estimate: Satellite::magnitude() assumes
+     * the same intrinsic magnitude of 4.0 (at 1000 km and half phase) for every satellite.
+     * It is left empty if the satellite is in the shadow of the Earth.
+     */
+    Q_SCRIPTABLE QString getSatellitePasses( const QString &satelliteName, double days );
+
     /** DBUS interface function. Render eyepiece view and save it in the file(s) specified
      * @note See EyepieceField::renderEyepieceView() for more info. This is a DBus proxy that calls that method, and then writes the resulting image(s) to file(s).
      * @note Important: If imagePath is empty, but overlay is true, or destPathImage is supplied, this method will make a blocking DSS download.
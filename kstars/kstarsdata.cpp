@@ -35,6 +35,7 @@
 #include "ksfilereader.h"
 #include "ksnumbers.h"
 #include "auxiliary/kspaths.h"
+#include "auxiliary/startupgraph.h"
 #include "skyobjects/skyobject.h"
 #include "skycomponents/supernovaecomponent.h"
 #include "skycomponents/skymapcomposite.h"
@@ -88,6 +89,24 @@ namespace {
         #endif
         return true;
     }
+
+    // Read a data file once, so that it is in the page cache by the time the
+    // component that parses it opens it. A cold start is mostly disk bound,
+    // and the components that read these files are loaded on the main thread.
+    bool prefetchDataFile(const QString &fname) {
+        QString path = KSPaths::locate( QStandardPaths::GenericDataLocation, fname );
+        if ( path.isEmpty() )
+            return true;    // Optional catalogs may be missing
+
+        QFile file( path );
+        if ( !file.open( QIODevice::ReadOnly ) )
+            return true;
+
+        QByteArray buffer( 1 << 16, 0 );
+        while ( file.read( buffer.data(), buffer.size() ) > 0 )
+            ;
+        return true;
+    }
 }
 
 KStarsData* KStarsData::pinstance = 0;
@@ -149,60 +168,103 @@ KStarsData::~KStarsData() {
 }
 
 bool KStarsData::initialize() {
-    //Initialize CatalogDB//
-    catalogdb()->Initialize();
+    StartupGraph startup( "KStarsData::initialize()" );
+
+    //Read the large data files ahead of the components that parse them//
+    //deepstars.dat is read on demand, block by block, so it is left alone.
+    QStringList prefetchFiles;
+    prefetchFiles << "namedstars.dat" << "unnamedstars.dat" << "cbounds.dat";
+    foreach( const QString &file, prefetchFiles )
+        startup.addTask( "Prefetch " + file, StartupGraph::WorkerThread, [file]() { return prefetchDataFile( file ); } );
 
     //Load Time Zone Rules//
-    emit progressText( i18n("Reading time zone rules") );
-    if( !readTimeZoneRulebook( ) ) {
-        fatalErrorMessage( "TZrules.dat" );
-        return false;
-    }
+    int tzRules = startup.addTask( "Time zone rules", StartupGraph::WorkerThread,
+                                   [this]() { return readTimeZoneRulebook(); } );
 
     //Load Cities//
-    emit progressText( i18n("Loading city data") );
-    if ( !readCityData( ) ) {
-        fatalErrorMessage( "citydb.sqlite" );
-        return false;
-    }
+    int cities = startup.addTask( "City data", StartupGraph::WorkerThread,
+                                  [this]() { return readCityData(); }, QList<int>() << tzRules );
+
+    //Nothing else is loaded if the time zone rules are missing//
+    //Initialize CatalogDB//
+    int catalogDB = startup.addTask( "Catalog database", StartupGraph::MainThread,
+                                     [this]() { return catalogdb()->Initialize(); }, QList<int>() << tzRules );
+
+    //Load the custom locations once the built-in ones are in the list//
+    int userCities = startup.addTask( "User city data", StartupGraph::MainThread,
+                                      [this]() { return readUserCityData(); }, QList<int>() << cities );
 
     //Initialize User Database//
-    emit progressText( i18n("Loading User Information" ) );
-    m_ksuserdb.Initialize();
+    int userDB = startup.addTask( "User database", StartupGraph::MainThread, [this]() {
+        emit progressText( i18n("Loading User Information" ) );
+        m_ksuserdb.Initialize();
+        return true;
+    }, QList<int>() << tzRules );
 
     //Initialize SkyMapComposite//
-    emit progressText(i18n("Loading sky objects" ) );
-    m_SkyComposite = new SkyMapComposite(0);
+    int skyObjects = startup.addTask( "Sky objects", StartupGraph::MainThread, [this]() {
+        emit progressText(i18n("Loading sky objects" ) );
+        m_SkyComposite = new SkyMapComposite(0);
+        return true;
+    }, QList<int>() << catalogDB << userDB );
+
     //Load Image URLs//
 //#ifndef Q_OS_ANDROID
     //On Android these 2 calls produce segfault. FIX IT!
-    emit progressText( i18n("Loading Image URLs" ) );
-    if( !readURLData( "image_url.dat", 0 ) && !nonFatalErrorMessage( "image_url.dat" ) )
-        return false;
+    int imageURLs = startup.addTask( "Image URLs", StartupGraph::MainThread, [this]() {
+        emit progressText( i18n("Loading Image URLs" ) );
+        return readURLData( "image_url.dat", 0 ) || nonFatalErrorMessage( "image_url.dat" );
+    }, QList<int>() << skyObjects );
 
     //Load Information URLs//
-    emit progressText( i18n("Loading Information URLs" ) );
-    if( !readURLData( "info_url.dat", 1 ) && !nonFatalErrorMessage( "info_url.dat" ) )
-        return false;
+    int infoURLs = startup.addTask( "Information URLs", StartupGraph::MainThread, [this]() {
+        emit progressText( i18n("Loading Information URLs" ) );
+        return readURLData( "info_url.dat", 1 ) || nonFatalErrorMessage( "info_url.dat" );
+    }, QList<int>() << imageURLs );
 //#endif
-    emit progressText( i18n("Loading Variable Stars" ) );
 
-    //Update supernovae list if enabled
-    if( Options::updateSupernovaeOnStartup() ) {
-        emit progressText( i18n("Queueing update of list of supernovae from the internet") );
-        skyComposite()->supernovaeComponent()->slotTriggerDataFileUpdate();
-    }
+    int userLog = startup.addTask( "User log", StartupGraph::MainThread, [this]() {
+        emit progressText( i18n("Loading Variable Stars" ) );
+
+        //Update supernovae list if enabled
+        if( Options::updateSupernovaeOnStartup() ) {
+            emit progressText( i18n("Queueing update of list of supernovae from the internet") );
+            skyComposite()->supernovaeComponent()->slotTriggerDataFileUpdate();
+        }
 
 #ifndef KSTARS_LITE
-    //Initialize Observing List
-    m_ObservingList = new ObservingList();
+        //Initialize Observing List
+        m_ObservingList = new ObservingList();
 #endif
 
-    readUserLog();
+        // A missing user log is not an error
+        readUserLog();
+        return true;
+    }, QList<int>() << infoURLs );
 
 #ifndef KSTARS_LITE
-    readADVTreeData();
+    startup.addTask( "Online database structure", StartupGraph::MainThread,
+                     [this]() { readADVTreeData(); return true; }, QList<int>() << userLog );
+#else
+    Q_UNUSED( userLog );
 #endif
+
+    startup.run();
+    startup.report();
+
+    if ( !startup.succeeded( tzRules ) ) {
+        fatalErrorMessage( "TZrules.dat" );
+        return false;
+    }
+
+    if ( !startup.succeeded( cities ) || !startup.succeeded( userCities ) ) {
+        fatalErrorMessage( "citydb.sqlite" );
+        return false;
+    }
+
+    if ( !startup.succeeded( infoURLs ) )
+        return false;
+
     return true;
 }
 
@@ -364,45 +426,58 @@ SkyObject* KStarsData::objectNamed( const QString &name ) {
 
 bool KStarsData::readCityData()
 {
-    QSqlDatabase citydb = QSqlDatabase::addDatabase("QSQLITE", "citydb");
-    QString dbfile = KSPaths::locate(QStandardPaths::GenericDataLocation, "citydb.sqlite");
-    citydb.setDatabaseName(dbfile);
-    if (citydb.open() == false)
+    // This runs on a worker thread during startup. A database connection may
+    // only be used by the thread that created it, so this one is removed again
+    // before returning.
+    bool citiesFound = false;
     {
-        qWarning() << "Unable to open city database file " << dbfile << citydb.lastError().text() << endl;
-        return false;
+        QSqlDatabase citydb = QSqlDatabase::addDatabase("QSQLITE", "citydb");
+        QString dbfile = KSPaths::locate(QStandardPaths::GenericDataLocation, "citydb.sqlite");
+        citydb.setDatabaseName(dbfile);
+        if (citydb.open() == false)
+        {
+            qWarning() << "Unable to open city database file " << dbfile << citydb.lastError().text() << endl;
+        }
+        else
+        {
+            QSqlQuery get_query(citydb);
+
+            //get_query.prepare("SELECT * FROM city");
+            if (!get_query.exec("SELECT * FROM city"))
+            {
+                qDebug() << get_query.lastError();
+            }
+            else
+            {
+                // get_query.size() always returns -1 so we set citiesFound if at least one city is found
+                while (get_query.next())
+                {
+                    citiesFound          = true;
+                    QString name         = get_query.value(1).toString();
+                    QString province     = get_query.value(2).toString();
+                    QString country      = get_query.value(3).toString();
+                    dms lat              = dms(get_query.value(4).toString());
+                    dms lng              = dms(get_query.value(5).toString());
+                    double TZ            = get_query.value(6).toDouble();
+                    TimeZoneRule *TZrule = &( Rulebook[ get_query.value(7).toString() ] );
+
+                    // appends city names to list
+                    geoList.append ( new GeoLocation( lng, lat, name, province, country, TZ, TZrule, true));
+                }
+            }
+            citydb.close();
+        }
     }
+    QSqlDatabase::removeDatabase("citydb");
 
-     QSqlQuery get_query(citydb);
-
-     //get_query.prepare("SELECT * FROM city");
-     if (!get_query.exec("SELECT * FROM city"))
-     {
-         qDebug() << get_query.lastError();
-         return false;
-     }
-
-     bool citiesFound = false;
-     // get_query.size() always returns -1 so we set citiesFound if at least one city is found
-     while (get_query.next())
-     {
-         citiesFound          = true;
-         QString name         = get_query.value(1).toString();
-         QString province     = get_query.value(2).toString();
-         QString country      = get_query.value(3).toString();
-         dms lat              = dms(get_query.value(4).toString());
-         dms lng              = dms(get_query.value(5).toString());
-         double TZ            = get_query.value(6).toDouble();
-         TimeZoneRule *TZrule = &( Rulebook[ get_query.value(7).toString() ] );
-
-         // appends city names to list
-         geoList.append ( new GeoLocation( lng, lat, name, province, country, TZ, TZrule, true));
-     }
-    citydb.close();
+    return citiesFound;
+}
 
+bool KStarsData::readUserCityData()
+{
     // Reading local database
     QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
-    dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator()  +  "mycitydb.sqlite";
+    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator()  +  "mycitydb.sqlite";
 
     if (QFile::exists(dbfile))
     {
@@ -434,7 +509,7 @@ bool KStarsData::readCityData()
         }
     }
 
-    return citiesFound;
+    return true;
 }
 
 bool KStarsData::readTimeZoneRulebook() {
@@ -279,15 +279,22 @@ public slots:
     void setTimeDirection( float scale );
 
 private:
-    /**Populate list of geographic locations from "citydb.sqlite" database. Also check for custom
-     * locations file "mycitydb.sqlite" database, but don't require it.  Each line in the file
+    /**Populate list of geographic locations from "citydb.sqlite" database. Each line in the file
      * provides the information required to create one GeoLocation object.
-     * @short Fill list of geographic locations from file(s)
+     * @short Fill list of geographic locations from file
+     * @note Called on a worker thread during startup, after readTimeZoneRulebook().
      * @return true if at least one city read successfully.
      * @see KStarsData::processCity()
      */
     bool readCityData();
 
+    /**Append the custom locations of the "mycitydb.sqlite" database to the list of geographic
+     * locations, if the database exists. Must be called on the main thread, after readCityData(),
+     * because the "mycitydb" connection is used again by the location dialog.
+     * @return false if the database exists but could not be read.
+     */
+    bool readUserCityData();
+
     /**Read the data file that contains daylight savings time rules. */
     bool readTimeZoneRulebook();
 
@@ -26,6 +26,7 @@
 #include <QtPrintSupport/QPrintDialog>
 #include <QtSvg/QSvgGenerator>
 #include <QXmlStreamWriter>
+#include <QtNumeric>
 #include <QPushButton>
 #include <QDoubleSpinBox>
 #include <QLineEdit>
@@ -42,6 +43,8 @@
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/satellitescomponent.h"
+#include "skyobjects/satellite.h"
 #include "simclock.h"
 #include "Options.h"
 #include "imageexporter.h"
@@ -586,6 +589,51 @@ QString KStars::getObjectPositionInfo( const QString &objectName ) {
     return output;
 }
 
+QString KStars::getSatellitePasses( const QString &satelliteName, double days ) {
+    Q_ASSERT( data() );
+    const Satellite *sat = data()->skyComposite()->satellites()->findSatellite( satelliteName );
+    if ( !sat ) {
+        return QString( "<xml></xml>" );
+    }
+
+    // The search steps through the whole interval, and the orbital
+    // elements are of little use weeks away from their epoch anyway
+    if ( qIsNaN( days ) || days < 0.0 )
+        days = 0.0;
+    days = qMin( days, 30.0 );
+
+    const KStarsDateTime ut = data()->ut();
+    GeoLocation *geo = data()->geo();
+    QList<SatellitePass> passes = sat->passes( ut, KStarsDateTime( ut.djd() + days ), geo );
+
+    QString output;
+    QXmlStreamWriter stream( &output );
+    stream.setAutoFormatting( true );
+    stream.writeStartDocument();
+    stream.writeStartElement( "satellite" );
+    stream.writeTextElement( "Name", sat->name() );
+    foreach ( const SatellitePass &pass, passes ) {
+        stream.writeStartElement( "pass" );
+        stream.writeTextElement( "Rise_UT", pass.rise.toString( Qt::ISODate ) );
+        stream.writeTextElement( "Rise_JD", QString::number( pass.rise.djd(), 'f', 6 ) );
+        stream.writeTextElement( "Rise_Az_DMS", pass.riseAz.toDMSString( true, true ) );
+        stream.writeTextElement( "Culmination_UT", pass.culmination.toString( Qt::ISODate ) );
+        stream.writeTextElement( "Culmination_JD", QString::number( pass.culmination.djd(), 'f', 6 ) );
+        stream.writeTextElement( "Max_Alt_DMS", pass.maxAlt.toDMSString( true, true ) );
+        stream.writeTextElement( "Max_Alt_Degrees", QString::number( pass.maxAlt.Degrees() ) );
+        stream.writeTextElement( "Set_UT", pass.set.toString( Qt::ISODate ) );
+        stream.writeTextElement( "Set_JD", QString::number( pass.set.djd(), 'f', 6 ) );
+        stream.writeTextElement( "Set_Az_DMS", pass.setAz.toDMSString( true, true ) );
+        // No magnitude while the satellite is in the shadow of the Earth
+        stream.writeTextElement( "Magnitude", qIsNaN( pass.magnitude ) ? QString() : QString::number( pass.magnitude, 'f', 1 ) );
+        stream.writeTextElement( "Visible", pass.visible ? "true" : "false" );
+        stream.writeEndElement(); // pass
+    }
+    stream.writeEndElement(); // satellite
+    stream.writeEndDocument();
+    return output;
+}
+
 void KStars::renderEyepieceView( const QString &objectName, const QString &destPathChart, const double fovWidth, const double fovHeight, const double rotation, const double scale,
                                 const bool flip, const bool invert, QString imagePath, const QString &destPathImage, const bool overlay, const bool invertColors ) {
     const SkyObject *obj = data()->objectNamed( objectName );
@@ -23,6 +23,16 @@
 
 #include "azimuthalequidistantprojector.h"
 
+namespace {
+    struct AzimuthalEquidistantKernel {
+        inline double k( double x ) const {
+            double crad = acos(x);
+            return ( (crad != 0 ) ? crad/sin(crad) : 1 ); // This handles the 0/0 case. The limit of x / sin(x) is 1 as x -> 0.
+        }
+        inline double cosMaxFieldAngle() const { return 0; }
+    };
+}
+
 AzimuthalEquidistantProjector::AzimuthalEquidistantProjector(const ViewParams& p)
     : Projector(p)
 {
@@ -41,8 +51,7 @@ double AzimuthalEquidistantProjector::radius() const
 
 double AzimuthalEquidistantProjector::projectionK(double x) const
 {
-    double crad = acos(x);
-    return ( (crad != 0 ) ? crad/sin(crad) : 1 ); // This handles the 0/0 case. The limit of x / sin(x) is 1 as x -> 0.
+    return AzimuthalEquidistantKernel().k( x );
 }
 
 double AzimuthalEquidistantProjector::projectionL(double x) const
@@ -50,3 +59,8 @@ double AzimuthalEquidistantProjector::projectionL(double x) const
     return x;
 }
 
+void AzimuthalEquidistantProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                                    Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    projectBatch( AzimuthalEquidistantKernel(), count, lon, lat, alt, screen, flags, oRefract );
+}
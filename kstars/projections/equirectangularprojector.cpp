@@ -19,6 +19,8 @@
 
 #include "equirectangularprojector.h"
 
+#include <cstring>
+
 #include "ksutils.h"
 #include "kstarsdata.h"
 #include "skycomponents/skylabeler.h"
@@ -69,6 +71,46 @@ Vector2f EquirectangularProjector::toScreenVec(const SkyPoint* o, bool oRefract,
     return p;
 }
 
+void EquirectangularProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                               Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    memset( flags, 0, count );
+    checkVisibilityBatch( count, lon, lat, alt, flags );
+
+    //Same as toScreenVec(), which needs no trigonometry
+    double focusX, focusY;
+    oRefract &= m_vp.useRefraction;
+    if ( m_vp.useAltAz ) {
+        focusX = m_vp.focus->az().reduce().radians();
+        focusY = m_vp.focus->alt().radians();
+    } else {
+        focusX = m_vp.focus->ra().reduce().radians();
+        focusY = m_vp.focus->dec().radians();
+    }
+
+    for( int i = 0; i < count; ++i ) {
+        double Y, dX;
+        double X = KSUtils::reduceAngle( lon[i], 0.0, 2.0*dms::PI );
+        if ( m_vp.useAltAz ) {
+            if ( oRefract )
+                Y = SkyPoint::refract( lat[i]/dms::DegToRad )*dms::DegToRad; //account for atmospheric refraction
+            else
+                Y = lat[i];
+            dX = focusX - X;
+        } else {
+            dX = X - focusX;
+            Y = lat[i];
+        }
+
+        dX = KSUtils::reduceAngle(dX, -dms::PI, dms::PI);
+
+        screen[i] = Vector2f( 0.5*m_vp.width - m_vp.zoomFactor*dX,
+                              0.5*m_vp.height - m_vp.zoomFactor*(Y - focusY) );
+        if ( screen[i][0] > 0 && screen[i][0] < m_vp.width )
+            flags[i] |= OnVisibleHemisphere;
+    }
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF& p, dms* LST, const dms* lat) const
 {
     SkyPoint result;
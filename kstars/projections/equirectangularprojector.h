@@ -36,6 +36,8 @@ public:
     virtual double radius() const;
     virtual bool unusablePoint( const QPointF& p) const;
     virtual Vector2f toScreenVec(const SkyPoint* o, bool oRefract = true, bool* onVisibleHemisphere = 0) const;
+    virtual void toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                 Vector2f *screen, quint8 *flags, bool oRefract = true ) const;
     virtual SkyPoint fromScreen(const QPointF& p, dms* LST, const dms* lat) const;
     virtual QVector< Vector2f > groundPoly(SkyPoint* labelpoint = 0, bool* drawLabel = 0) const;
     virtual void updateClipPoly();
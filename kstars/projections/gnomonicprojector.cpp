@@ -19,6 +19,14 @@
 
 #include "gnomonicprojector.h"
 
+namespace {
+    struct GnomonicKernel {
+        inline double k( double x ) const { return 1.0/x; }
+        //Don't let things approach infty.
+        inline double cosMaxFieldAngle() const { return 0.02; }
+    };
+}
+
 GnomonicProjector::GnomonicProjector(const ViewParams& p)
     : Projector(p)
 {
@@ -37,7 +45,7 @@ double GnomonicProjector::radius() const
 
 double GnomonicProjector::projectionK(double x) const
 {
-    return 1.0/x;
+    return GnomonicKernel().k( x );
 }
 
 double GnomonicProjector::projectionL(double x) const
@@ -51,3 +59,8 @@ double GnomonicProjector::cosMaxFieldAngle() const
     return 0.02;
 }
 
+void GnomonicProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                        Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    projectBatch( GnomonicKernel(), count, lon, lat, alt, screen, flags, oRefract );
+}
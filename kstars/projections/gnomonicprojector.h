@@ -35,6 +35,8 @@ public:
     explicit GnomonicProjector(const ViewParams& p);
     virtual Projection type() const;
     virtual double radius() const;
+    virtual void toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                 Vector2f *screen, quint8 *flags, bool oRefract = true ) const;
     virtual double projectionK(double x) const;
     virtual double projectionL(double x) const;
     virtual double cosMaxFieldAngle() const;
@@ -19,6 +19,13 @@
 
 #include "lambertprojector.h"
 
+namespace {
+    struct LambertKernel {
+        inline double k( double x ) const { return sqrt( 2.0/( 1.0 + x ) ); }
+        inline double cosMaxFieldAngle() const { return 0; }
+    };
+}
+
 LambertProjector::LambertProjector(const ViewParams& p) : Projector(p)
 {
     updateClipPoly();
@@ -36,10 +43,16 @@ double LambertProjector::radius() const
 
 double LambertProjector::projectionK(double x) const
 {
-    return sqrt( 2.0/( 1.0 + x ) );
+    return LambertKernel().k( x );
 }
 
 double LambertProjector::projectionL(double x) const
 {
     return 2.0*asin(0.5*x);
 }
+
+void LambertProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                       Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    projectBatch( LambertKernel(), count, lon, lat, alt, screen, flags, oRefract );
+}
@@ -19,6 +19,13 @@
 
 #include "orthographicprojector.h"
 
+namespace {
+    struct OrthographicKernel {
+        inline double k( double ) const { return 1.0; }
+        inline double cosMaxFieldAngle() const { return 0; }
+    };
+}
+
 OrthographicProjector::OrthographicProjector(const ViewParams& p)
     : Projector(p)
 {
@@ -46,3 +53,8 @@ double OrthographicProjector::projectionL(double x) const
     return asin(x);
 }
 
+void OrthographicProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                            Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    projectBatch( OrthographicKernel(), count, lon, lat, alt, screen, flags, oRefract );
+}
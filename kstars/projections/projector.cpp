@@ -20,11 +20,55 @@
 #include "projector.h"
 
 #include <cmath>
+#include <cstring>
 
 #include "ksutils.h"
 #include "kstarsdata.h"
 #include "skycomponents/skylabeler.h"
 
+// The sines and cosines of toScreenArrays() are computed VD_WIDTH points
+// at a time using AVX when KStars is compiled for it, and SSE2 otherwise.
+// The remaining points, and all points on other architectures, go
+// through the scalar loop.
+#if defined(__AVX__)
+#include <immintrin.h>
+typedef __m256d vdouble;
+#define VD_WIDTH 4
+#define vd_load    _mm256_loadu_pd
+#define vd_store   _mm256_storeu_pd
+#define vd_set1    _mm256_set1_pd
+#define vd_add     _mm256_add_pd
+#define vd_sub     _mm256_sub_pd
+#define vd_mul     _mm256_mul_pd
+#define vd_and     _mm256_and_pd
+#define vd_andnot  _mm256_andnot_pd
+#define vd_or      _mm256_or_pd
+#define vd_xor     _mm256_xor_pd
+#define vd_cmpeq( a, b ) _mm256_cmp_pd( a, b, _CMP_EQ_OQ )
+#define vd_cmpge( a, b ) _mm256_cmp_pd( a, b, _CMP_GE_OQ )
+#define vd_cmpgt( a, b ) _mm256_cmp_pd( a, b, _CMP_GT_OQ )
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128d vdouble;
+#define VD_WIDTH 2
+#define vd_load    _mm_loadu_pd
+#define vd_store   _mm_storeu_pd
+#define vd_set1    _mm_set1_pd
+#define vd_add     _mm_add_pd
+#define vd_sub     _mm_sub_pd
+#define vd_mul     _mm_mul_pd
+#define vd_and     _mm_and_pd
+#define vd_andnot  _mm_andnot_pd
+#define vd_or      _mm_or_pd
+#define vd_xor     _mm_xor_pd
+#define vd_cmpeq   _mm_cmpeq_pd
+#define vd_cmpge   _mm_cmpge_pd
+#define vd_cmpgt   _mm_cmpgt_pd
+#endif
+
+// Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer
+#define ROUNDING_MAGIC 6755399441055744.0
+
 namespace {
     void toXYZ(const SkyPoint* p, double *x, double *y, double *z) {
         double sinRa, sinDec, cosRa, cosDec;
@@ -502,3 +546,138 @@ Vector2f Projector::toScreenVec(const SkyPoint* o, bool oRefract, bool* onVisibl
     return Vector2f( 0.5*m_vp.width  - m_vp.zoomFactor*k*cosY*sindX,
                      0.5*m_vp.height - m_vp.zoomFactor*k*( m_cosY0*sinY - m_sinY0*cosY*cosdX ) );
 }
+
+void Projector::sinCosBatch( const double *x, double *sinx, double *cosx, int count )
+{
+    int i = 0;
+#ifdef VD_WIDTH
+    // Reduce to r = x - q pi/2 with |r| <= pi/4, evaluate the minimax
+    // polynomials of the Cephes library on r and pick the results by
+    // the quadrant q mod 4. Only arithmetic and comparisons are used,
+    // which exist in SSE2 and AVX alike.
+    const vdouble magic = vd_set1( ROUNDING_MAGIC );
+    const vdouble twoOverPi = vd_set1( 0.63661977236758134308 );
+    const vdouble dp1 = vd_set1( 1.57079625129699707031 );
+    const vdouble dp2 = vd_set1( 7.54978941586159635335e-8 );
+    const vdouble dp3 = vd_set1( 5.39030285815821030977e-15 );
+    const vdouble one = vd_set1( 1.0 ), two = vd_set1( 2.0 ), three = vd_set1( 3.0 );
+    const vdouble quarter = vd_set1( 0.25 ), four = vd_set1( 4.0 ), half = vd_set1( 0.5 );
+    const vdouble signBit = vd_set1( -0.0 );
+    for( ; i + VD_WIDTH <= count; i += VD_WIDTH ) {
+        vdouble v = vd_load( x + i );
+        vdouble q = vd_sub( vd_add( vd_mul( v, twoOverPi ), magic ), magic );
+        vdouble r = vd_sub( vd_sub( vd_sub( v, vd_mul( q, dp1 ) ), vd_mul( q, dp2 ) ), vd_mul( q, dp3 ) );
+
+        // Quadrant q mod 4, in 0 ... 3
+        vdouble f = vd_sub( vd_add( vd_mul( q, quarter ), magic ), magic );
+        f = vd_sub( f, vd_and( vd_cmpgt( f, vd_mul( q, quarter ) ), one ) );
+        vdouble m = vd_sub( q, vd_mul( f, four ) );
+
+        vdouble z = vd_mul( r, r );
+        vdouble ps = vd_set1( 1.58962301576546568060e-10 );
+        ps = vd_add( vd_mul( ps, z ), vd_set1( -2.50507477628578072866e-8 ) );
+        ps = vd_add( vd_mul( ps, z ), vd_set1( 2.75573136213857245213e-6 ) );
+        ps = vd_add( vd_mul( ps, z ), vd_set1( -1.98412698295895385996e-4 ) );
+        ps = vd_add( vd_mul( ps, z ), vd_set1( 8.33333333332211858878e-3 ) );
+        ps = vd_add( vd_mul( ps, z ), vd_set1( -1.66666666666666307295e-1 ) );
+        vdouble s = vd_add( r, vd_mul( vd_mul( r, z ), ps ) );
+        vdouble pc = vd_set1( -1.13585365213876817300e-11 );
+        pc = vd_add( vd_mul( pc, z ), vd_set1( 2.08757008419747316778e-9 ) );
+        pc = vd_add( vd_mul( pc, z ), vd_set1( -2.75573141792967388112e-7 ) );
+        pc = vd_add( vd_mul( pc, z ), vd_set1( 2.48015872888517045348e-5 ) );
+        pc = vd_add( vd_mul( pc, z ), vd_set1( -1.38888888888730564116e-3 ) );
+        pc = vd_add( vd_mul( pc, z ), vd_set1( 4.16666666666665929218e-2 ) );
+        vdouble c = vd_add( vd_sub( one, vd_mul( half, z ) ), vd_mul( vd_mul( z, z ), pc ) );
+
+        // Odd quadrants swap sine and cosine, the sine is negative in
+        // quadrants 2 and 3 and the cosine in quadrants 1 and 2
+        vdouble swap = vd_or( vd_cmpeq( m, one ), vd_cmpeq( m, three ) );
+        vdouble sinNeg = vd_and( vd_cmpge( m, two ), signBit );
+        vdouble cosNeg = vd_and( vd_or( vd_cmpeq( m, one ), vd_cmpeq( m, two ) ), signBit );
+        vdouble sv = vd_or( vd_and( swap, c ), vd_andnot( swap, s ) );
+        vdouble cv = vd_or( vd_and( swap, s ), vd_andnot( swap, c ) );
+        vd_store( sinx + i, vd_xor( sv, sinNeg ) );
+        vd_store( cosx + i, vd_xor( cv, cosNeg ) );
+    }
+#endif
+    for( ; i < count; ++i ) {
+        sinx[i] = sin( x[i] );
+        cosx[i] = cos( x[i] );
+    }
+}
+
+void Projector::checkVisibilityBatch( int count, const double *lon, const double *lat, const double *alt,
+                                      quint8 *flags ) const
+{
+    // The same tests as checkVisibility(), in radians
+    const double *ground = ( alt || !m_vp.useAltAz ) ? alt : lat;
+    const double minGround = -1.0*dms::DegToRad;
+    const double fov = m_fov*dms::DegToRad, xrange = m_xrange*dms::DegToRad;
+    double focusLon, focusLat, margin;
+    if ( m_vp.useAltAz ) {
+        focusLon = m_vp.focus->az().radians();
+        focusLat = m_vp.focus->alt().radians();
+        margin = 2.0*dms::DegToRad;
+    } else {
+        focusLon = m_vp.focus->ra().radians();
+        focusLat = m_vp.focus->dec().radians();
+        margin = 0.0;
+    }
+    const double yScale = m_isPoleVisible ? 0.75 : 1.0;
+
+    for( int i = 0; i < count; ++i ) {
+        if( m_vp.fillGround && ground && ground[i] < minGround )
+            continue;
+        if( ( fabs( lat[i] - focusLat ) - margin )*yScale > fov )
+            continue;
+        if( !m_isPoleVisible ) {
+            double dX = fabs( lon[i] - focusLon );
+            if ( dX > dms::PI )
+                dX = 2.0*dms::PI - dX; // take shorter distance around sky
+            if( !( dX < xrange ) )
+                continue;
+        }
+        flags[i] |= InView;
+    }
+}
+
+void Projector::prepareBatch( int count, const double *lon, const double *lat, const double *alt,
+                              bool oRefract, BatchBuffer &b, quint8 *flags ) const
+{
+    memset( flags, 0, count );
+    checkVisibilityBatch( count, lon, lat, alt, flags );
+
+    oRefract &= m_vp.useRefraction;
+    const double twoPi = 2.0*dms::PI;
+    for( int i = 0; i < count; ++i ) {
+        double Y, dX;
+        if ( m_vp.useAltAz ) {
+            if ( oRefract )
+                Y = SkyPoint::refract( lat[i]/dms::DegToRad )*dms::DegToRad; //account for atmospheric refraction
+            else
+                Y = lat[i];
+            dX = m_vp.focus->az().radians() - lon[i];
+        } else {
+            dX = lon[i] - m_vp.focus->ra().radians();
+            Y = lat[i];
+        }
+
+        if( !( std::isfinite( Y ) && std::isfinite( dX ) ) ) {
+            flags[i] = InvalidPoint;
+            Y = dX = 0.0;
+        }
+
+        b.dX[i] = dX - twoPi*floor( ( dX + dms::PI )/twoPi );
+        b.Y[i] = Y;
+    }
+
+    sinCosBatch( b.dX, b.sindX, b.cosdX, count );
+    sinCosBatch( b.Y, b.sinY, b.cosY, count );
+}
+
+void Projector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    VirtualKernel kernel = { this };
+    projectBatch( kernel, count, lon, lat, alt, screen, flags, oRefract );
+}
@@ -125,6 +125,52 @@ public:
                       bool oRefract = true,
                       bool* onVisibleHemisphere = 0) const;
 
+    /** Flags returned by toScreenBatch() and toScreenArrays() for each point */
+    enum BatchFlag {
+        OnVisibleHemisphere = 1,    ///< Same as the onVisibleHemisphere result of toScreenVec()
+        InView = 2,                 ///< Same as the result of checkVisibility()
+        InvalidPoint = 0x80         ///< Used internally for points with non-finite coordinates
+    };
+
+    /** @short Project many points at once.
+     *
+     * This gives the same results as calling toScreenVec() and checkVisibility()
+     * for each point, but converts the points in blocks of contiguous coordinates,
+     * with one virtual call per block. The sines and cosines of all points of a
+     * block are computed with vector instructions.
+     *
+     * Points with non-finite coordinates are projected to (0, 0) with no flags set.
+     *
+     * @param points the points to project, SkyPoints or any of their subclasses.
+     *   Their horizontal coordinates must be up to date, as for checkVisibility().
+     * @param count number of points
+     * @param screen receives the screen coordinates of each point
+     * @param flags receives the BatchFlag values of each point
+     * @param oRefract same as in toScreenVec()
+     */
+    template <class Point>
+    void toScreenBatch( Point *const *points, int count,
+                        Vector2f *screen, quint8 *flags, bool oRefract = true ) const;
+
+    /** @short Project arrays of coordinates. This is what toScreenBatch() calls
+     * for every block of points.
+     * @param count number of points
+     * @param lon azimuths if usesAltAz(), right ascensions otherwise, in radians
+     * @param lat altitudes if usesAltAz(), declinations otherwise, in radians,
+     *   without refraction
+     * @param alt altitudes in radians, to hide points under the ground when it is
+     *   filled. Can be null if usesAltAz().
+     * @param screen receives the screen coordinates of each point
+     * @param flags receives the BatchFlag values of each point
+     * @param oRefract same as in toScreenVec()
+     */
+    virtual void toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                 Vector2f *screen, quint8 *flags, bool oRefract = true ) const;
+
+    /** @return true if the map is drawn in horizontal coordinates, which is what
+     * toScreenArrays() expects then */
+    inline bool usesAltAz() const { return m_vp.useAltAz; }
+
     /** @short Determine RA, Dec coordinates of the pixel at (dx, dy), which are the
      * screen pixel coordinate offsets from the center of the Sky pixmap.
      * @param the screen pixel position to convert
@@ -196,6 +242,14 @@ public:
      */
     bool checkVisibility( SkyPoint *p ) const;
 
+    /** @short checkVisibility() for arrays of coordinates.
+     * Sets the InView flag of each point that passes, and leaves the other
+     * flags alone.
+     * @see toScreenArrays() for the parameters
+     */
+    void checkVisibilityBatch( int count, const double *lon, const double *lat, const double *alt,
+                               quint8 *flags ) const;
+
     /** Determine the on-screen position angle of a SkyPont with recept with NCP.
      * This is the object's sky position angle (w.r.t. North).
      * of "North" at the position of the object (w.r.t. the screen Y-axis).
@@ -259,6 +313,41 @@ protected:
         @return the point with Alt = 0, az = @p az
         */
     static SkyPoint pointAt(double az);
+
+    /** Number of points that toScreenArrays() converts at a time */
+    static const int BATCH_SIZE = 256;
+
+    /** Intermediate values of a block of points in toScreenArrays() */
+    struct BatchBuffer {
+        double dX[BATCH_SIZE], Y[BATCH_SIZE];
+        double sindX[BATCH_SIZE], cosdX[BATCH_SIZE];
+        double sinY[BATCH_SIZE], cosY[BATCH_SIZE];
+    };
+
+    /** The projection functions of the generic toScreenArrays(), as virtual calls */
+    struct VirtualKernel {
+        const Projector *projector;
+        inline double k( double c ) const { return projector->projectionK( c ); }
+        inline double cosMaxFieldAngle() const { return projector->cosMaxFieldAngle(); }
+    };
+
+    /** @short Compute the offsets from the focus of up to BATCH_SIZE points and
+     * their sines and cosines, and set their InView and InvalidPoint flags.
+     */
+    void prepareBatch( int count, const double *lon, const double *lat, const double *alt,
+                       bool oRefract, BatchBuffer &buffer, quint8 *flags ) const;
+
+    /** @short The body of toScreenArrays() for the azimuthal projections.
+     * Kernel provides k() and cosMaxFieldAngle(), like projectionK() and
+     * cosMaxFieldAngle(). As a template parameter, they are inlined into the
+     * loop over the points, where virtual functions would be called per point.
+     */
+    template <class Kernel>
+    void projectBatch( const Kernel &kernel, int count, const double *lon, const double *lat,
+                       const double *alt, Vector2f *screen, quint8 *flags, bool oRefract ) const;
+
+    /** @short Compute sin and cos of count values, with vector instructions when available */
+    static void sinCosBatch( const double *x, double *sinx, double *cosx, int count );
     
     KStarsData *m_data;
     ViewParams m_vp;
@@ -273,4 +362,58 @@ private:
     bool m_isPoleVisible;
 };
 
+template <class Point>
+void Projector::toScreenBatch( Point *const *points, int count,
+                               Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    double lon[BATCH_SIZE], lat[BATCH_SIZE], alt[BATCH_SIZE];
+
+    for( int start = 0; start < count; start += BATCH_SIZE ) {
+        const int n = qMin( BATCH_SIZE, count - start );
+        for( int i = 0; i < n; ++i ) {
+            const SkyPoint *p = points[start + i];
+            if ( m_vp.useAltAz ) {
+                lon[i] = p->az().radians();
+                lat[i] = p->alt().radians();
+            } else {
+                lon[i] = p->ra().radians();
+                lat[i] = p->dec().radians();
+                alt[i] = p->alt().radians();
+            }
+        }
+        toScreenArrays( n, lon, lat, m_vp.useAltAz ? 0 : alt, screen + start, flags + start, oRefract );
+    }
+}
+
+template <class Kernel>
+void Projector::projectBatch( const Kernel &kernel, int count, const double *lon, const double *lat,
+                              const double *alt, Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    BatchBuffer b;
+    const double cosMax = kernel.cosMaxFieldAngle();
+    const double x0 = 0.5*m_vp.width, y0 = 0.5*m_vp.height, zoom = m_vp.zoomFactor;
+
+    for( int start = 0; start < count; start += BATCH_SIZE ) {
+        const int n = qMin( BATCH_SIZE, count - start );
+        quint8 *f = flags + start;
+        Vector2f *out = screen + start;
+        prepareBatch( n, lon + start, lat + start, alt ? alt + start : 0, oRefract, b, f );
+
+        for( int i = 0; i < n; ++i ) {
+            //c is the cosine of the angular distance from the center, see toScreenVec()
+            double c = m_sinY0*b.sinY[i] + m_cosY0*b.cosY[i]*b.cosdX[i];
+            double k = kernel.k( c );
+            if( f[i] & InvalidPoint ) {
+                out[i] = Vector2f( 0, 0 );
+                f[i] = 0;
+                continue;
+            }
+            if( c > cosMax )
+                f[i] |= OnVisibleHemisphere;
+            out[i] = Vector2f( x0 - zoom*k*b.cosY[i]*b.sindX[i],
+                               y0 - zoom*k*( m_cosY0*b.sinY[i] - m_sinY0*b.cosY[i]*b.cosdX[i] ) );
+        }
+    }
+}
+
 #endif // PROJECTOR_H
@@ -19,6 +19,13 @@
 
 #include "stereographicprojector.h"
 
+namespace {
+    struct StereographicKernel {
+        inline double k( double x ) const { return 2.0/(1.0 + x); }
+        inline double cosMaxFieldAngle() const { return 0; }
+    };
+}
+
 StereographicProjector::StereographicProjector(const ViewParams& p)
     : Projector(p)
 {
@@ -37,10 +44,16 @@ double StereographicProjector::radius() const
 
 double StereographicProjector::projectionK(double x) const
 {
-    return 2.0/(1.0 + x);
+    return StereographicKernel().k( x );
 }
 
 double StereographicProjector::projectionL(double x) const
 {
     return 2.0*atan2( x, 2.0 );
 }
+
+void StereographicProjector::toScreenArrays( int count, const double *lon, const double *lat, const double *alt,
+                                             Vector2f *screen, quint8 *flags, bool oRefract ) const
+{
+    projectBatch( StereographicKernel(), count, lon, lat, alt, screen, flags, oRefract );
+}
@@ -40,8 +40,54 @@
 #include "skyobjects/ksasteroid.h"
 #include "kstarsdata.h"
 #include "ksfilereader.h"
+#include "kscatalogcache.h"
 #include "auxiliary/kspaths.h"
 
+namespace {
+
+/** One line of asteroids.dat */
+struct AsteroidRow {
+    KSStreamParser::Field fullName;
+    int epochMJD;
+    double q, a, e, i, w, om, ma;
+    KSStreamParser::Field orbitID;
+    double H, G;
+    KSStreamParser::Field neo;
+    float diameter;
+    KSStreamParser::Field extent;
+    float albedo, rotPeriod, period;
+    double moid;
+    KSStreamParser::Field orbitClass;
+};
+
+const KSStreamParser::Column<AsteroidRow> asteroidColumns[] = {
+    KSStreamParser::column(&AsteroidRow::fullName),
+    KSStreamParser::column(&AsteroidRow::epochMJD),
+    KSStreamParser::column(&AsteroidRow::q),
+    KSStreamParser::column(&AsteroidRow::a),
+    KSStreamParser::column(&AsteroidRow::e),
+    KSStreamParser::column(&AsteroidRow::i),
+    KSStreamParser::column(&AsteroidRow::w),
+    KSStreamParser::column(&AsteroidRow::om),
+    KSStreamParser::column(&AsteroidRow::ma),
+    KSStreamParser::skip<AsteroidRow>(),        // tp_calc
+    KSStreamParser::column(&AsteroidRow::orbitID),
+    KSStreamParser::column(&AsteroidRow::H),
+    KSStreamParser::column(&AsteroidRow::G),
+    KSStreamParser::column(&AsteroidRow::neo),
+    KSStreamParser::skip<AsteroidRow>(),        // M1
+    KSStreamParser::skip<AsteroidRow>(),        // M2
+    KSStreamParser::column(&AsteroidRow::diameter),
+    KSStreamParser::column(&AsteroidRow::extent),
+    KSStreamParser::column(&AsteroidRow::albedo),
+    KSStreamParser::column(&AsteroidRow::rotPeriod),
+    KSStreamParser::column(&AsteroidRow::period),
+    KSStreamParser::column(&AsteroidRow::moid),
+    KSStreamParser::column(&AsteroidRow::orbitClass)
+};
+
+}
+
 AsteroidsComponent::AsteroidsComponent(SolarSystemComposite *parent) : SolarSystemListComponent(parent)
 {
     loadData();
@@ -99,39 +145,13 @@ void AsteroidsComponent::loadData()
     objectNames( SkyObject::ASTEROID ).clear();
     objectLists( SkyObject::ASTEROID ).clear();
 
-    QList< QPair<QString, KSParser::DataTypes> > sequence;
-    sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("epoch_mjd"), KSParser::D_INT));
-    sequence.append(qMakePair(QString("q"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("a"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("e"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("i"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("w"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("om"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("ma"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("orbit_id"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("H"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("G"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("neo"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("M2"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("diameter"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("extent"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("albedo"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("rot_period"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("per_y"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("moid"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("class"), KSParser::D_QSTRING));
-
     //QString file_name = KSPaths::locate( QStandardPaths::DataLocation,  );
     QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("asteroids.dat"));
-    KSParser asteroid_parser(file_name, '#', sequence);
+    KSCatalogCache asteroid_data(file_name, '#');
 
-    QHash<QString, QVariant> row_content;
-    while (asteroid_parser.HasNextRow()){
-        row_content = asteroid_parser.ReadNextRow();
-        full_name = row_content["full name"].toString();
+    const QVector<AsteroidRow> rows = asteroid_data.readAllCSV(asteroidColumns);
+    foreach (const AsteroidRow &row_content, rows) {
+        full_name = row_content.fullName.toString();
         full_name = full_name.trimmed();
         int catN  = full_name.section(' ', 0, 0).toInt();
 
@@ -141,25 +161,25 @@ void AsteroidsComponent::loadData()
         if (name == "Europa" || name == "Io" || name == "Asterope")
             name += i18n(" (Asteroid)");
 
-        mJD  = row_content["epoch_mjd"].toInt();
-        q    = row_content["q"].toDouble();
-        a    = row_content["a"].toDouble();
-        e    = row_content["e"].toDouble();
-        dble_i = row_content["i"].toDouble();
-        dble_w = row_content["w"].toDouble();
-        dble_N = row_content["om"].toDouble();
-        dble_M = row_content["ma"].toDouble();
-        orbit_id = row_content["orbit_id"].toString();
-        H   = row_content["H"].toDouble();
-        G   = row_content["G"].toDouble();
-        neo = row_content["neo"].toString() == "Y";
-        diameter = row_content["diameter"].toFloat();
-        dimensions = row_content["extent"].toString();
-        albedo  = row_content["albedo"].toFloat();
-        rot_period = row_content["rot_period"].toFloat();
-        period  = row_content["per_y"].toFloat();
-        earth_moid  = row_content["moid"].toDouble();
-        orbit_class = row_content["class"].toString();
+        mJD  = row_content.epochMJD;
+        q    = row_content.q;
+        a    = row_content.a;
+        e    = row_content.e;
+        dble_i = row_content.i;
+        dble_w = row_content.w;
+        dble_N = row_content.om;
+        dble_M = row_content.ma;
+        orbit_id = row_content.orbitID.toString();
+        H   = row_content.H;
+        G   = row_content.G;
+        neo = row_content.neo == "Y";
+        diameter = row_content.diameter;
+        dimensions = row_content.extent.toString();
+        albedo  = row_content.albedo;
+        rot_period = row_content.rotPeriod;
+        period  = row_content.period;
+        earth_moid  = row_content.moid;
+        orbit_class = row_content.orbitClass.toString();
 
         JD = static_cast<double>(mJD) + 2400000.5;
 
@@ -285,6 +305,9 @@ void AsteroidsComponent::downloadReady()
     file.write( data );
     file.close();
 
+    // Drop the cache of the old file, loadData() builds a new one
+    KSCatalogCache::remove( file.fileName() );
+
     // Reload asteroids
     loadData();
 #ifdef KSTARS_LITE
@@ -30,6 +30,7 @@
 #include "ksutils.h"
 #include "kstarsdata.h"
 #include "ksfilereader.h"
+#include "kscatalogcache.h"
 #include "auxiliary/kspaths.h"
 #ifndef KSTARS_LITE
 #include "skymap.h"
@@ -42,6 +43,49 @@
 #include "auxiliary/filedownloader.h"
 #include "kspaths.h"
 
+namespace {
+
+/** One line of comets.dat */
+struct CometRow {
+    KSStreamParser::Field fullName;
+    int epochMJD;
+    double q, e, i, w, om, tp;
+    KSStreamParser::Field orbitID;
+    KSStreamParser::Field neo;
+    float M1, M2, diameter;
+    KSStreamParser::Field extent;
+    float albedo, rotPeriod, period;
+    double moid;
+    KSStreamParser::Field orbitClass;
+    float K1, K2;
+};
+
+const KSStreamParser::Column<CometRow> cometColumns[] = {
+    KSStreamParser::column( &CometRow::fullName ),
+    KSStreamParser::column( &CometRow::epochMJD ),
+    KSStreamParser::column( &CometRow::q ),
+    KSStreamParser::column( &CometRow::e ),
+    KSStreamParser::column( &CometRow::i ),
+    KSStreamParser::column( &CometRow::w ),
+    KSStreamParser::column( &CometRow::om ),
+    KSStreamParser::column( &CometRow::tp ),
+    KSStreamParser::column( &CometRow::orbitID ),
+    KSStreamParser::column( &CometRow::neo ),
+    KSStreamParser::column( &CometRow::M1 ),
+    KSStreamParser::column( &CometRow::M2 ),
+    KSStreamParser::column( &CometRow::diameter ),
+    KSStreamParser::column( &CometRow::extent ),
+    KSStreamParser::column( &CometRow::albedo ),
+    KSStreamParser::column( &CometRow::rotPeriod ),
+    KSStreamParser::column( &CometRow::period ),
+    KSStreamParser::column( &CometRow::moid ),
+    KSStreamParser::column( &CometRow::orbitClass ),
+    KSStreamParser::column( &CometRow::K1 ),
+    KSStreamParser::column( &CometRow::K2 )
+};
+
+}
+
 CometsComponent::CometsComponent( SolarSystemComposite *parent )
         : SolarSystemListComponent( parent ) {
     loadData();
@@ -95,67 +139,43 @@ void CometsComponent::loadData() {
     objectNames(SkyObject::COMET).clear();
     objectLists(SkyObject::COMET).clear();
 
-    QList< QPair<QString, KSParser::DataTypes> > sequence;
-    sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("epoch_mjd"), KSParser::D_INT));
-    sequence.append(qMakePair(QString("q"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("e"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("i"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("w"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("om"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("orbit_id"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("neo"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("M1"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("M2"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("diameter"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("extent"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("albedo"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("rot_period"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("per_y"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("moid"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("class"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("H"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("G"), KSParser::D_SKIP));
-
     QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("comets.dat") );
-    KSParser cometParser(file_name, '#', sequence);
+    KSCatalogCache cometData(file_name, '#');
 
-    QHash<QString, QVariant> row_content;
-    while (cometParser.HasNextRow()){
+    const QVector<CometRow> rows = cometData.readAllCSV(cometColumns);
+    foreach (const CometRow &row_content, rows) {
         KSComet *com = 0;
-        row_content = cometParser.ReadNextRow();
-        name   = row_content["full name"].toString();
+        name   = row_content.fullName.toString();
         name   = name.trimmed();
-        mJD    = row_content["epoch_mjd"].toInt();
-        q    = row_content["q"].toDouble();
-        e    = row_content["e"].toDouble();
-        dble_i = row_content["i"].toDouble();
-        dble_w = row_content["w"].toDouble();
-        dble_N = row_content["om"].toDouble();
-        Tp     = row_content["tp_calc"].toDouble();
-        orbit_id = row_content["orbit_id"].toString();
-        neo = row_content["neo"] == "Y";
-
-        if(row_content["M1"].toFloat()==0.0)
+        mJD    = row_content.epochMJD;
+        q    = row_content.q;
+        e    = row_content.e;
+        dble_i = row_content.i;
+        dble_w = row_content.w;
+        dble_N = row_content.om;
+        Tp     = row_content.tp;
+        orbit_id = row_content.orbitID.toString();
+        neo = row_content.neo == "Y";
+
+        if(row_content.M1==0.0)
             M1 = 101.0;
         else
-            M1 = row_content["M1"].toFloat();
+            M1 = row_content.M1;
 
-        if(row_content["M2"].toFloat()==0.0)
+        if(row_content.M2==0.0)
             M2 = 101.0;
         else
-            M2 = row_content["M2"].toFloat();
-
-        diameter = row_content["diameter"].toFloat();
-        dimensions = row_content["extent"].toString();
-        albedo  = row_content["albedo"].toFloat();
-        rot_period = row_content["rot_period"].toFloat();
-        period  = row_content["per_y"].toFloat();
-        earth_moid  = row_content["moid"].toDouble();
-        orbit_class = row_content["class"].toString();
-        K1 = row_content["H"].toFloat();
-        K2 = row_content["G"].toFloat();
+            M2 = row_content.M2;
+
+        diameter = row_content.diameter;
+        dimensions = row_content.extent.toString();
+        albedo  = row_content.albedo;
+        rot_period = row_content.rotPeriod;
+        period  = row_content.period;
+        earth_moid  = row_content.moid;
+        orbit_class = row_content.orbitClass.toString();
+        K1 = row_content.K1;
+        K2 = row_content.K2;
 
         JD = static_cast<double>( mJD ) + 2400000.5;
 
@@ -245,6 +265,9 @@ void CometsComponent::downloadReady()
     file.write( data );
     file.close();
 
+    // Drop the cache of the old file, loadData() builds a new one
+    KSCatalogCache::remove( file.fileName() );
+
     // Reload asteroids
     loadData();
 
@@ -26,6 +26,7 @@
 #include "skyobjects/deepskyobject.h"
 #include "dms.h"
 #include "ksfilereader.h"
+#include "kscatalogcache.h"
 #include "kstarsdata.h"
 #include "auxiliary/kspaths.h"
 #ifndef KSTARS_LITE
@@ -39,6 +40,55 @@
 #include "projections/projector.h"
 #include "kspaths.h"
 
+namespace {
+
+/** One line of ngcic.dat */
+struct NGCICRow {
+    KSStreamParser::Field flag;
+    int id;
+    KSStreamParser::Field suffix;
+    int raH, raM;
+    float raS;
+    KSStreamParser::Field decSign;
+    int decD, decM, decS;
+    KSStreamParser::Field bMag;
+    int type;
+    float a, b;
+    KSStreamParser::Field pa;
+    int pgc;
+    KSStreamParser::Field otherCatalog, other1;
+    KSStreamParser::Field messier;
+    int messierNumber;
+    KSStreamParser::Field longName;
+};
+
+const KSStreamParser::Column<NGCICRow> ngcicColumns[] = {
+    KSStreamParser::column( &NGCICRow::flag, 1 ),
+    KSStreamParser::column( &NGCICRow::id, 4 ),
+    KSStreamParser::column( &NGCICRow::suffix, 1 ),
+    KSStreamParser::column( &NGCICRow::raH, 2 ),
+    KSStreamParser::column( &NGCICRow::raM, 2 ),
+    KSStreamParser::column( &NGCICRow::raS, 4 ),
+    KSStreamParser::column( &NGCICRow::decSign, 2 ),
+    KSStreamParser::column( &NGCICRow::decD, 2 ),
+    KSStreamParser::column( &NGCICRow::decM, 2 ),
+    KSStreamParser::column( &NGCICRow::decS, 2 ),
+    KSStreamParser::column( &NGCICRow::bMag, 6 ),
+    KSStreamParser::column( &NGCICRow::type, 2 ),
+    KSStreamParser::column( &NGCICRow::a, 6 ),
+    KSStreamParser::column( &NGCICRow::b, 6 ),
+    KSStreamParser::column( &NGCICRow::pa, 4 ),
+    KSStreamParser::column( &NGCICRow::pgc, 7 ),
+    KSStreamParser::column( &NGCICRow::otherCatalog, 4 ),
+    KSStreamParser::column( &NGCICRow::other1, 6 ),
+    KSStreamParser::skip<NGCICRow>( 6 ),   // other2
+    KSStreamParser::column( &NGCICRow::messier, 2 ),
+    KSStreamParser::column( &NGCICRow::messierNumber, 4 ),
+    KSStreamParser::column( &NGCICRow::longName )
+};
+
+}
+
 DeepSkyComponent::DeepSkyComponent( SkyComposite *parent ) :
     SkyComponent(parent)
 {
@@ -70,87 +120,16 @@ void DeepSkyComponent::loadData()
     //(i.e., if user has downloaded the Steinicke catalog)
     mergeSplitFiles();
 
-    QList< QPair<QString,KSParser::DataTypes> > sequence;
-    QList<int> widths;
-    sequence.append(qMakePair(QString("Flag"), KSParser::D_QSTRING));
-    widths.append(1);
-
-    sequence.append(qMakePair(QString("ID"), KSParser::D_INT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("suffix"), KSParser::D_QSTRING));
-    widths.append(1);
-
-    sequence.append(qMakePair(QString("RA_H"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("RA_M"),KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("RA_S"),KSParser::D_FLOAT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("D_Sign"),KSParser::D_QSTRING));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_d"),KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_m"),KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_s"),KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("BMag"),KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("type"),KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("a"),KSParser::D_FLOAT));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("b"),KSParser::D_FLOAT));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("pa"),KSParser::D_QSTRING));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("PGC"),KSParser::D_INT));
-    widths.append(7);
-
-    sequence.append(qMakePair(QString("other cat"),KSParser::D_QSTRING));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("other1"),KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("other2"),KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("Messr"),KSParser::D_QSTRING));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("MessrNum"),KSParser::D_INT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("Longname"),KSParser::D_QSTRING));
-    //No width to be appended for last sequence object
-
     QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("ngcic.dat") );
-    KSParser deep_sky_parser(file_name, '#', sequence, widths);
+    KSCatalogCache deep_sky_data(file_name, '#');
 
-    deep_sky_parser.SetProgress( i18n("Loading NGC/IC objects"), 13444, 10 );
+    emitProgressText( i18n("Loading NGC/IC objects") );
     qDebug() << "Loading NGC/IC objects";
 
-    QHash<QString,QVariant> row_content;
-    while (deep_sky_parser.HasNextRow()) {
-        row_content = deep_sky_parser.ReadNextRow();
+    const QVector<NGCICRow> rows = deep_sky_data.readAllFixedWidth(ngcicColumns);
+    foreach (const NGCICRow &row_content, rows) {
 
-        QString iflag;
         QString cat;
-        iflag = row_content["Flag"].toString().mid( 0, 1 ); //check for NGC/IC catalog flag
         /*
         Q_ASSERT(iflag == "I" || iflag == "N" || iflag == " ");
         // (spacetime): ^ Why an assert? Change in implementation of ksparser
@@ -161,28 +140,27 @@ void DeepSkyComponent::loadData()
         float mag(1000.0);
         int type, ingc, imess(-1), pa;
         int pgc, ugc;
-        QString ss, name, name2, longname;
+        QString name, name2, longname;
         QString cat2;
 
-        // Designation
-        if ( iflag == "I" ) cat = "IC";
-        else if ( iflag == "N" ) cat = "NGC";
+        // Designation (check for NGC/IC catalog flag)
+        if ( row_content.flag == "I" ) cat = "IC";
+        else if ( row_content.flag == "N" ) cat = "NGC";
 
-        ingc = row_content["ID"].toInt();  // NGC/IC catalog number
+        ingc = row_content.id;  // NGC/IC catalog number
         if ( ingc==0 ) cat.clear(); //object is not in NGC or IC catalogs
 
-        QString suffix = row_content["suffix"].toString(); // multipliticity suffixes, eg: the 'A' in NGC 4945A
+        QString suffix = row_content.suffix.toString(); // multipliticity suffixes, eg: the 'A' in NGC 4945A
 
         Q_ASSERT( suffix.isEmpty() || ( suffix.at( 0 ) >= QChar( 'A' ) && suffix.at( 0 ) <= QChar( 'Z' ) ) || (suffix.at( 0 ) >= QChar( 'a' ) && suffix.at( 0 ) <= QChar( 'z' ) ) );
 
         //coordinates
-        int rah = row_content["RA_H"].toInt();
-        int ram = row_content["RA_M"].toInt();
-        float ras = row_content["RA_S"].toFloat();
-        QString sgn = row_content["D_Sign"].toString();
-        int dd = row_content["Dec_d"].toInt();
-        int dm = row_content["Dec_m"].toInt();
-        int ds = row_content["Dec_s"].toInt();
+        int rah = row_content.raH;
+        int ram = row_content.raM;
+        float ras = row_content.raS;
+        int dd = row_content.decD;
+        int dm = row_content.decM;
+        int ds = row_content.decS;
 
         if ( !( (0.0 <= rah && rah < 24.0) ||
              (0.0 <= ram && ram < 60.0) ||
@@ -200,47 +178,45 @@ void DeepSkyComponent::loadData()
             continue;
 
         //B magnitude
-        ss = row_content["BMag"].toString();
-        if (ss == "") { mag = 99.9f; } else { mag = ss.toFloat(); }
+        if ( row_content.bMag.isEmpty() ) { mag = 99.9f; } else { mag = row_content.bMag.toFloat(); }
 
         //object type
-        type = row_content["type"].toInt();
+        type = row_content.type;
 
         //major and minor axes
-        float a = row_content["a"].toFloat();
-        float b = row_content["b"].toFloat();
+        float a = row_content.a;
+        float b = row_content.b;
 
         //position angle.  The catalog PA is zero when the Major axis
         //is horizontal.  But we want the angle measured from North, so
         //we set PA = 90 - pa.
-        ss = row_content["pa"].toString();
-        if (ss == "" ) { pa = 90; } else { pa = 90 - ss.toInt(); }
+        if ( row_content.pa.isEmpty() ) { pa = 90; } else { pa = 90 - row_content.pa.toInt(); }
 
         //PGC number
-        pgc = row_content["PGC"].toInt();
+        pgc = row_content.pgc;
 
         //UGC number
-        if (row_content["other cat"].toString().trimmed() == "UGC") {
-            ugc = row_content["other1"].toString().toInt();
+        if ( row_content.otherCatalog == "UGC" ) {
+            ugc = row_content.other1.toInt();
         } else {
             ugc = 0;
         }
 
         //Messier number
-        if ( row_content["Messr"].toString().trimmed() == "M" ) {
+        if ( row_content.messier == "M" ) {
             cat2 = cat;
             if ( ingc == 0 ) cat2.clear();
             cat = 'M';
-            imess = row_content["MessrNum"].toInt();
+            imess = row_content.messierNumber;
         }
 
-        longname = row_content["Longname"].toString();
+        longname = row_content.longName.toString();
 
         dms r;
         r.setH( rah, ram, int(ras) );
         dms d( dd, dm, ds );
 
-        if ( sgn == "-" ) { d.setD( -1.0*d.Degrees() ); }
+        if ( row_content.decSign == "-" ) { d.setD( -1.0*d.Degrees() ); }
 
         bool hasName = true;
         QString snum;
@@ -319,8 +295,6 @@ void DeepSkyComponent::loadData()
             objectNames(type).append( longname );
             objectLists(type).append( QPair<QString, SkyObject *>(longname, o));
         }
-
-        deep_sky_parser.ShowProgress();
     }
 
     foreach(QStringList list, objectNames())
@@ -23,6 +23,7 @@
 #include <QPixmap>
 #include <QRectF>
 #include <QFontMetricsF>
+#include <QElapsedTimer>
 
 //NOTE Added this for QT_FSEEK, should we be including another file?
 #include <qplatformdefs.h>
@@ -37,12 +38,18 @@
 #include "binfilehelper.h"
 #include "starblockfactory.h"
 #include "starcomponent.h"
+#include "starblockprefetcher.h"
+#include "starpack.h"
+#include "starupdater.h"
 #include "projections/projector.h"
 
 #include "skypainter.h"
 
 #include "byteorder.h"
 
+// Time, in milliseconds, that a frame may spend filling blocks ahead of the view
+#define PREFILL_BUDGET 4
+
 DeepStarComponent::DeepStarComponent( SkyComposite *parent, QString fileName, float trigMag, bool staticstars ) :
     ListComponent(parent),
     m_reindexNum( J2000 ),
@@ -52,6 +59,7 @@ DeepStarComponent::DeepStarComponent( SkyComposite *parent, QString fileName, fl
     dataFileName( fileName )
 {
     fileOpened = false;
+    m_prefetcher = 0;
     openDataFile();
     if( staticStars )
         loadStaticStars();
@@ -157,6 +165,7 @@ bool DeepStarComponent::loadStaticStars() {
 }
 
 DeepStarComponent::~DeepStarComponent() {
+  delete m_prefetcher;
   if( fileOpened )
     starReader.closeFile();
   fileOpened = false;
@@ -197,8 +206,6 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     StarObject::starsUpdated = 0;
 #endif
     SkyMap *map = SkyMap::Instance();
-    KStarsData* data = KStarsData::Instance();
-    UpdateID updateID = data->updateID();
 
     //FIXME_FOV -- maybe not clamp like that...
     float radius = map->projector()->fov();
@@ -239,14 +246,19 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     if( hideFaintStars && maglim > hideStarsMag )
         maglim = hideStarsMag;
 
+    if( m_prefetcher )
+        m_prefetcher->predict( focus, map->isSlewing() ? map->destination() : 0, radius + 1.0, maglim );
+
     StarBlockFactory *m_StarBlockFactory = StarBlockFactory::Instance();
     //    m_StarBlockFactory->drawID = m_skyMesh->drawID();
     //    qDebug() << "Mesh size = " << m_skyMesh->size() << "; drawID = " << m_skyMesh->drawID();
     QTime t;
+    QElapsedTimer fillTimer;
     int nTrixels = 0;
 
     t_dynamicLoad = 0;
     t_updateCache = 0;
+    t_updateStars = 0;
     t_drawUnnamed = 0;
 
     visibleStarCount = 0;
@@ -275,6 +287,11 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
         region.reset();
     }
 
+    // Load the stars we need and collect them for all visible
+    // trixels first, so that their coordinates can be brought up to
+    // date in one parallel pass before any of them is painted.
+    m_visibleStars.resize( 0 );
+    m_visiblePacks.resize( 0 );
     while ( region.hasNext() ) {
         ++nTrixels;
         Trixel currentRegion = region.next();
@@ -284,45 +301,82 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
         // TODO: Is there a better way? We may have to change the magnitude tolerance if the catalog changes
         // Static stars need not execute fillToMag
 
-	if( !staticStars && !m_starBlockList.at( currentRegion )->fillToMag( maglim ) && maglim <= m_FaintMagnitude * ( 1 - 1.5/16 ) ) {
+        StarBlockList *sbl = m_starBlockList.at( currentRegion );
+        unsigned long nStarsBefore = sbl->getStarCount();
+        fillTimer.start();
+	if( !staticStars && !sbl->fillToMag( maglim ) && maglim <= m_FaintMagnitude * ( 1 - 1.5/16 ) ) {
             qDebug() << "SBL::fillToMag( " << maglim << " ) failed for trixel "
                      << currentRegion << " !"<< endl;
 	}
+        if( m_prefetcher )
+            m_prefetcher->recordFill( currentRegion, nStarsBefore, sbl->getStarCount(), fillTimer.nsecsElapsed() );
 
         t_dynamicLoad += t.restart();
 
-        //        qDebug() << "Drawing SBL for trixel " << currentRegion << ", SBL has "
-        //                 <<  m_starBlockList[ currentRegion ]->getBlockCount() << " blocks" << endl;
-
         for( int i = 0; i < m_starBlockList.at( currentRegion )->getBlockCount(); ++i ) {
             StarBlock *block = m_starBlockList.at( currentRegion )->block( i );
-            //            qDebug() << "---> Drawing stars from block " << i << " of trixel " <<
-            //                currentRegion << ". SB has " << block->getStarCount() << " stars" << endl;
+            if( block->isPacked() ) {
+                m_visiblePacks.append( block->starPack() );
+                continue;
+            }
             for( int j = 0; j < block->getStarCount(); j++ ) {
-
                 StarObject *curStar = block->star( j );
-
-                //                qDebug() << "We claim that he's from trixel " << currentRegion
-                //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
-
-                if ( curStar->updateID != updateID )
-                    curStar->JITupdate();
-
-                float mag = curStar->mag();
-
-                if ( mag > maglim )
+                if ( curStar->mag() > maglim )
                     break;
-
-                if( skyp->drawPointSource(curStar, mag, curStar->spchar() ) )
-                    visibleStarCount++;
+                m_visibleStars.append( curStar );
             }
         }
 
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
         //        verifySBLIntegrity();
-        t_drawUnnamed += t.restart();
+    }
+
+    t.restart();
+    StarUpdater::update( m_visibleStars );
+    StarUpdater::update( m_visiblePacks );
+    t_updateStars = t.restart();
+
+    visibleStarCount += skyp->drawPointSources( m_visibleStars.constData(), m_visibleStars.size() );
+    for( int i = 0; i < m_visiblePacks.size(); ++i ) {
+        const StarPack *pack = m_visiblePacks.at( i );
+        for( int j = 0; j < pack->size(); ++j ) {
+            float mag = pack->mag( j );
+            if( mag > maglim )
+                break;
+            pack->position( j, &m_packedStarPoint );
+            if( skyp->drawPointSource( &m_packedStarPoint, mag, pack->spchar( j ) ) )
+                visibleStarCount++;
+        }
+    }
+    t_drawUnnamed = t.restart();
+
+    if( m_prefetcher ) {
+        // Fill the blocks of the trixels that the prefetcher has read
+        // ahead of the view, within a small time budget per frame, so
+        // that the draw loop finds them filled when they come into view
+        float prefillMag;
+        QVector<Trixel> ready = m_prefetcher->takeReady( &prefillMag );
+        QElapsedTimer budget;
+        budget.start();
+        for( int i = 0; i < ready.size() && budget.elapsed() < PREFILL_BUDGET; ++i ) {
+            StarBlockList *sbl = m_starBlockList.at( ready[i] );
+            unsigned long nStarsBefore = sbl->getStarCount();
+            sbl->fillToMag( prefillMag );
+            if( sbl->getStarCount() > nStarsBefore )
+                m_prefetcher->recordPrefill( ready[i] );
+        }
+    }
 
+    // While slewing, have the OS page in the stars of the trixels around
+    // the visible ones, so that they are resident by the time they scroll
+    // into view and fillToMag() does not block on disk reads.
+    if( !staticStars && starReader.isMapped() && map->isSlewing() ) {
+        m_skyMesh->aperture( focus, qMin( 2.0 * radius, 90.0 ) + 1.0, PREFETCH_BUF );
+        MeshIterator ring( m_skyMesh, PREFETCH_BUF );
+        while( ring.hasNext() )
+            m_starBlockList.at( ring.next() )->prefetch( maglim );
     }
+
     m_skyMesh->inDraw( false );
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
@@ -378,6 +432,10 @@ bool DeepStarComponent::openDataFile() {
         if( starReader.getByteSwap() )
             MSpT = bswap_16( MSpT );
         fileOpened = true;
+        if( !starReader.mapFile() )
+            qDebug() << "Could not map" << dataFileName << "into memory, reading it through the file handle instead";
+        else if( !staticStars && !m_prefetcher )
+            m_prefetcher = new StarBlockPrefetcher( &starReader, htm_level );
         qDebug() << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++) {
             StarBlockList *sbl = new StarBlockList( i, this );
@@ -419,10 +477,36 @@ SkyObject* DeepStarComponent::objectNearest( SkyPoint *p, double &maxrad )
 
     MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
 
+    double sinRA, cosRA, sinDec, cosDec;
+    p->ra().SinCos( sinRA, cosRA );
+    p->dec().SinCos( sinDec, cosDec );
+
     while ( region.hasNext() ) {
         Trixel currentRegion = region.next();
         for( int i = 0; i < m_starBlockList.at( currentRegion )->getBlockCount(); ++i ) {
             StarBlock *block = m_starBlockList.at( currentRegion )->block( i );
+#ifndef KSTARS_LITE
+            if( block->isPacked() ) {
+                // Compare unit vectors, and only create a StarObject for the best match
+                StarPack *pack = block->starPack();
+                pack->update();
+                int jBest = -1;
+                double cosMaxrad = cos( maxrad * dms::DegToRad );
+                for( int j = 0; j < pack->size(); ++j ) {
+                    if ( pack->mag( j ) > m_zoomMagLimit ) continue;
+                    double c = pack->cosDistance( j, cosDec * cosRA, cosDec * sinRA, sinDec );
+                    if( c > cosMaxrad ) {
+                        cosMaxrad = c;
+                        jBest = j;
+                    }
+                }
+                if( jBest >= 0 ) {
+                    oBest = block->star( jBest );
+                    maxrad = acos( qMin( cosMaxrad, 1.0 ) ) / dms::DegToRad;
+                }
+                continue;
+            }
+#endif
             for( int j = 0; j < block->getStarCount(); ++j ) {
 #ifdef KSTARS_LITE
                 StarObject* star =  &(block->star( j )->star);
@@ -474,6 +558,11 @@ bool DeepStarComponent::starsInAperture( QList<StarObject *> &list, const SkyPoi
     if( maglim < -28 )
         maglim = m_FaintMagnitude;
 
+    double sinRA, cosRA, sinDec, cosDec;
+    center.ra().SinCos( sinRA, cosRA );
+    center.dec().SinCos( sinDec, cosDec );
+    double cosRadius = cos( radius * dms::DegToRad );
+
     while ( region.hasNext() ) {
         Trixel currentRegion = region.next();
         // FIXME: Build a better way to iterate over all stars.
@@ -482,6 +571,20 @@ bool DeepStarComponent::starsInAperture( QList<StarObject *> &list, const SkyPoi
         sbl->fillToMag( maglim );
         for( int i = 0; i < sbl->getBlockCount(); ++i ) {
             StarBlock *block = sbl->block( i );
+#ifndef KSTARS_LITE
+            if( block->isPacked() ) {
+                // Only create StarObjects for the stars within the aperture
+                StarPack *pack = block->starPack();
+                pack->update();
+                for( int j = 0; j < pack->size(); ++j ) {
+                    if( pack->mag( j ) > maglim )
+                        break;
+                    if( pack->cosDistance( j, cosDec * cosRA, cosDec * sinRA, sinDec ) >= cosRadius )
+                        list.append( block->star( j ) );
+                }
+                continue;
+            }
+#endif
             for( int j = 0; j < block->getStarCount(); ++j ) {
 #ifdef KSTARS_LITE
                 StarObject *star = &(block->star( j )->star);
@@ -45,6 +45,8 @@ class SkyLabeler;
 class BinFileHelper;
 class StarBlockFactory;
 class StarBlockList;
+class StarPack;
+class StarBlockPrefetcher;
 
 class DeepStarComponent: public ListComponent
 {
@@ -95,6 +97,14 @@ public:
 
     inline BinFileHelper *getStarReader() { return &starReader; }
 
+    /**
+     *@return the prefetcher of this catalog, whose hit, miss and latency
+     *counters describe how well block loading keeps up with the view, or
+     *NULL if the catalog is static or could not be memory mapped. The
+     *counters add up until StarBlockPrefetcher::resetCounters() is called.
+     */
+    inline StarBlockPrefetcher *getPrefetcher() { return m_prefetcher; }
+
     bool verifySBLIntegrity();
 
     /**
@@ -139,8 +149,12 @@ private:
     long unsigned  t_dynamicLoad;
     long unsigned  t_drawUnnamed;
     long unsigned  t_updateCache;
+    long unsigned  t_updateStars;
 
     QVector< StarBlockList *> m_starBlockList;
+    QVector< StarObject *> m_visibleStars; // Stars to be drawn in the current frame
+    QVector< StarPack *> m_visiblePacks;   // Packed blocks to be drawn in the current frame
+    SkyPoint       m_packedStarPoint;      // Position of the packed star being drawn
     QHash<int, StarObject *> m_CatalogNumber;
 
     bool           staticStars;
@@ -149,6 +163,7 @@ private:
     deepStarData  deepstardata;
     starData      stardata;
     BinFileHelper starReader;
+    StarBlockPrefetcher *m_prefetcher;
     QString       dataFileName;
 
 };
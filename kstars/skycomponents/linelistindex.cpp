@@ -202,6 +202,9 @@ void LineListIndex::drawLines( SkyPainter *skyp )
     DrawID   drawID   = skyMesh()->drawID();
     UpdateID updateID = KStarsData::Instance()->updateID();
 
+    // All lines share the pen set in preDraw(), so their segments can be
+    // drawn together
+    skyp->beginLineBatch();
     foreach ( LineListList* lineListList, m_lineIndex->values() ) {
         for (int i = 0; i < lineListList->size(); i++) {
             LineList* lineList = lineListList->at( i );
@@ -216,6 +219,7 @@ void LineListIndex::drawLines( SkyPainter *skyp )
             skyp->drawSkyPolyline(lineList, skipList(lineList), label() );
         }
     }
+    skyp->endLineBatch();
 }
 
 void LineListIndex::drawFilled( SkyPainter *skyp )
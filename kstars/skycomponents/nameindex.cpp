@@ -0,0 +1,312 @@
+/***************************************************************************
+                    nameindex.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "nameindex.h"
+
+#include <algorithm>
+
+#include "skyobjects/skyobject.h"
+#include "skyobjects/starobject.h"
+
+namespace {
+
+    // Order in which SkyMapComposite::findByName() used to search the
+    // components. Objects of a lower rank win when names collide.
+    int typeRank( int type ) {
+        switch( type ) {
+        case SkyObject::PLANET:
+        case SkyObject::MOON:
+            return 0;
+        case SkyObject::ASTEROID:
+        case SkyObject::COMET:
+            return 1;
+        case SkyObject::CONSTELLATION:
+            return 3;
+        case SkyObject::STAR:
+            return 4;
+        case SkyObject::SUPERNOVA:
+            return 5;
+        case SkyObject::SATELLITE:
+            return 6;
+        default:
+            // Deep sky objects of all kinds, including custom catalogs
+            return 2;
+        }
+    }
+
+    bool isWordStart( const QString &name, int i ) {
+        return i == 0 || ( ! name.at( i - 1 ).isLetterOrNumber() && name.at( i ).isLetterOrNumber() );
+    }
+
+    // Words of a case-folded text, split at the characters that are neither letters nor numbers
+    QStringList words( const QString &folded ) {
+        QStringList result;
+        int start = -1;
+        for( int i = 0; i <= folded.size(); ++i ) {
+            bool inWord = i < folded.size() && folded.at( i ).isLetterOrNumber();
+            if( inWord && start < 0 )
+                start = i;
+            else if( ! inWord && start >= 0 ) {
+                result.append( folded.mid( start, i - start ) );
+                start = -1;
+            }
+        }
+        return result;
+    }
+
+    // Number of edits allowed between a word of the search text and a word of a name
+    int maxEdits( const QString &word ) {
+        if( word.size() <= 3 )
+            return 0;
+        return word.size() <= 7 ? 1 : 2;
+    }
+
+    // Edit distance between a and b, counting transpositions of adjacent
+    // characters as one edit, or bound + 1 if it is larger than bound
+    int editDistance( const QString &a, const QString &b, int bound ) {
+        const int n = a.size(), m = b.size();
+        if( qAbs( n - m ) > bound )
+            return bound + 1;
+
+        QVector<int> previous( m + 1 ), row( m + 1 ), current( m + 1 );
+        for( int j = 0; j <= m; ++j )
+            row[ j ] = j;
+
+        for( int i = 1; i <= n; ++i ) {
+            current[ 0 ] = i;
+            int best = i;
+            for( int j = 1; j <= m; ++j ) {
+                int cost = ( a.at( i - 1 ) == b.at( j - 1 ) ) ? 0 : 1;
+                int d = qMin( qMin( row[ j ] + 1, current[ j - 1 ] + 1 ), row[ j - 1 ] + cost );
+                if( i > 1 && j > 1 && a.at( i - 1 ) == b.at( j - 2 ) && a.at( i - 2 ) == b.at( j - 1 ) )
+                    d = qMin( d, previous[ j - 2 ] + 1 );
+                current[ j ] = d;
+                best = qMin( best, d );
+            }
+            // No alignment can get back under the bound
+            if( best > bound )
+                return bound + 1;
+            previous.swap( row );
+            row.swap( current );
+        }
+        return qMin( row[ m ], bound + 1 );
+    }
+
+}
+
+NameIndex::NameIndex()
+{
+}
+
+void NameIndex::clear()
+{
+    m_Names.clear();
+    m_Types.clear();
+    m_Folded.clear();
+    m_Words.clear();
+    m_Tokens.clear();
+    m_TokenNames.clear();
+    m_Exact.clear();
+}
+
+void NameIndex::build( const QHash<int, QVector<Entry> > &lists )
+{
+    clear();
+
+    // Visit the types in the order of their rank, so that the first
+    // object inserted under a name in m_Exact is the one to return.
+    QList<int> types = lists.keys();
+    std::stable_sort( types.begin(), types.end(), []( int a, int b ) {
+        return typeRank( a ) < typeRank( b );
+    } );
+
+    QHash<QString, int> tokens;
+    foreach( int type, types ) {
+        const QVector<Entry> &list = lists[ type ];
+        for( int i = 0; i < list.size(); ++i ) {
+            const Entry &entry = list.at( i );
+            if( entry.first.isEmpty() || ! entry.second )
+                continue;
+
+            QString folded = entry.first.toCaseFolded();
+            int name = m_Names.size();
+            m_Names.append( entry );
+            m_Types.append( type );
+            m_Folded.append( folded );
+
+            for( int j = 0; j < folded.size(); ++j ) {
+                if( isWordStart( folded, j ) ) {
+                    WordKey key = { name, j };
+                    m_Words.append( key );
+                }
+            }
+
+            foreach( const QString &word, words( folded ) ) {
+                int token = tokens.value( word, -1 );
+                if( token < 0 ) {
+                    token = m_Tokens.size();
+                    tokens.insert( word, token );
+                    m_Tokens.append( word );
+                    m_TokenNames.append( QVector<int>() );
+                }
+                QVector<int> &names = m_TokenNames[ token ];
+                if( names.isEmpty() || names.last() != name )
+                    names.append( name );
+            }
+
+            const SkyObject *o = entry.second;
+            QStringList aliases;
+            aliases << folded << o->name().toCaseFolded() << o->longname().toCaseFolded() << o->name2().toCaseFolded();
+            if( type == SkyObject::STAR )
+                aliases << static_cast<const StarObject *>( o )->gname( false ).toCaseFolded();
+            foreach( const QString &alias, aliases ) {
+                if( ! alias.isEmpty() && ! m_Exact.contains( alias ) )
+                    m_Exact.insert( alias, o );
+            }
+        }
+    }
+
+    const QVector<QString> &names = m_Folded;
+    std::sort( m_Words.begin(), m_Words.end(), [&names]( const WordKey &a, const WordKey &b ) {
+        return names.at( a.name ).midRef( a.offset ) < names.at( b.name ).midRef( b.offset );
+    } );
+}
+
+SkyObject *NameIndex::find( const QString &name ) const
+{
+    return const_cast<SkyObject *>( m_Exact.value( name.toCaseFolded() ) );
+}
+
+QPair<const NameIndex::WordKey *, const NameIndex::WordKey *> NameIndex::range( const QString &folded ) const
+{
+    const QVector<QString> &names = m_Folded;
+    const WordKey *begin = m_Words.constData();
+    const WordKey *end = begin + m_Words.size();
+
+    // All word starts that begin with the text sort right after the text
+    // itself, so the matches are one contiguous range.
+    begin = std::lower_bound( begin, end, folded, [&names]( const WordKey &key, const QString &text ) {
+        return names.at( key.name ).midRef( key.offset ) < QStringRef( &text );
+    } );
+    end = std::upper_bound( begin, end, folded, [&names]( const QString &text, const WordKey &key ) {
+        return QStringRef( &text ) < names.at( key.name ).midRef( key.offset, text.size() );
+    } );
+
+    return qMakePair( begin, end );
+}
+
+void NameIndex::collect( const WordKey *begin, const WordKey *end, bool prefixOnly, const QList<int> &types, QVector<Entry> &result ) const
+{
+    QVector<int> names;
+    for( const WordKey *key = begin; key != end; ++key ) {
+        if( prefixOnly && key->offset != 0 )
+            continue;
+        if( ! types.isEmpty() && ! types.contains( m_Types.at( key->name ) ) )
+            continue;
+        names.append( key->name );
+    }
+
+    // A name may match at several of its words
+    std::sort( names.begin(), names.end() );
+    names.erase( std::unique( names.begin(), names.end() ), names.end() );
+
+    result.reserve( result.size() + names.size() );
+    foreach( int name, names )
+        result.append( m_Names.at( name ) );
+}
+
+QVector<NameIndex::Entry> NameIndex::findPrefix( const QString &text, const QList<int> &types ) const
+{
+    QVector<Entry> result;
+    QPair<const WordKey *, const WordKey *> matches = range( text.toCaseFolded() );
+    collect( matches.first, matches.second, true, types, result );
+    return result;
+}
+
+QVector<NameIndex::Entry> NameIndex::findWords( const QString &text, const QList<int> &types ) const
+{
+    QVector<Entry> result;
+    QPair<const WordKey *, const WordKey *> matches = range( text.toCaseFolded() );
+    collect( matches.first, matches.second, false, types, result );
+    return result;
+}
+
+QVector<NameIndex::Entry> NameIndex::findFuzzy( const QString &text, const QList<int> &types ) const
+{
+    QVector<Entry> result;
+    QStringList queryWords = words( text.toCaseFolded() );
+    if( queryWords.isEmpty() )
+        return result;
+
+    // Total distance of each name that matched all words so far
+    QHash<int, int> distance;
+    for( int w = 0; w < queryWords.size(); ++w ) {
+        const QString &word = queryWords.at( w );
+        const int bound = maxEdits( word );
+
+        // Closest word of each name to this word of the text
+        QHash<int, int> closest;
+        for( int t = 0; t < m_Tokens.size(); ++t ) {
+            int d = editDistance( word, m_Tokens.at( t ), bound );
+            if( d > bound )
+                continue;
+            foreach( int name, m_TokenNames.at( t ) ) {
+                if( w > 0 && ! distance.contains( name ) )
+                    continue;
+                if( ! types.isEmpty() && ! types.contains( m_Types.at( name ) ) )
+                    continue;
+                QHash<int, int>::iterator it = closest.find( name );
+                if( it == closest.end() )
+                    closest.insert( name, d );
+                else if( d < it.value() )
+                    it.value() = d;
+            }
+        }
+
+        // Keep the names that also matched this word
+        QHash<int, int> matched;
+        for( QHash<int, int>::const_iterator it = closest.constBegin(); it != closest.constEnd(); ++it )
+            matched.insert( it.key(), distance.value( it.key(), 0 ) + it.value() );
+        distance.swap( matched );
+        if( distance.isEmpty() )
+            return result;
+    }
+
+    QVector< QPair<int, int> > ranked;
+    ranked.reserve( distance.size() );
+    for( QHash<int, int>::const_iterator it = distance.constBegin(); it != distance.constEnd(); ++it )
+        ranked.append( qMakePair( it.value(), it.key() ) );
+    std::sort( ranked.begin(), ranked.end() );
+
+    result.reserve( ranked.size() );
+    for( int i = 0; i < ranked.size(); ++i )
+        result.append( m_Names.at( ranked.at( i ).second ) );
+    return result;
+}
+
+QVector<NameIndex::Entry> NameIndex::entries( const QList<int> &types ) const
+{
+    if( types.isEmpty() )
+        return m_Names;
+
+    QVector<Entry> result;
+    for( int i = 0; i < m_Names.size(); ++i ) {
+        if( types.contains( m_Types.at( i ) ) )
+            result.append( m_Names.at( i ) );
+    }
+    return result;
+}
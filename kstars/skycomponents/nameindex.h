@@ -0,0 +1,132 @@
+/***************************************************************************
+                     nameindex.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class SkyObject;
+
+/**
+ *@class NameIndex
+ *@short Case-insensitive index of the names of all sky objects
+ *
+ *The index is built from the per-type name lists of SkyMapComposite
+ *(see SkyComponent::objectLists()). It answers four kinds of queries:
+ *
+ *@li find() looks up an object by its exact name, long name, secondary
+ *name or genetive name in a hash table of case-folded names.
+ *@li findPrefix() returns the names that begin with a given text.
+ *@li findWords() returns the names that have a word beginning with a
+ *given text, e.g. "galaxy" matches "Andromeda Galaxy" and "31" matches
+ *"M 31". This is what the Find dialog shows while typing.
+ *
+ *@li findFuzzy() returns the names whose words are all within a small
+ *edit distance of the words of a given text, e.g. "andromda" matches
+ *"Andromeda Galaxy". The Find dialog falls back to it when no name has
+ *a word beginning with the text.
+ *
+ *findPrefix() and findWords() are binary searches in a sorted array of
+ *the case-folded word starts of all names, so their cost depends on the
+ *number of matches and not on the number of objects. findFuzzy() scans
+ *the distinct words of all names once per word of the text, skipping
+ *words whose length alone puts them too far away.
+ */
+class NameIndex
+{
+public:
+    typedef QPair<QString, const SkyObject *> Entry;
+
+    /** @short Constructor. The index is empty until build() is called */
+    NameIndex();
+
+    /**
+     *@short Rebuild the index from the given name lists
+     *@param lists names and objects, keyed by object type
+     */
+    void build( const QHash<int, QVector<Entry> > &lists );
+
+    /** @short Remove all names from the index */
+    void clear();
+
+    /**
+     *@return the object whose name, long name, secondary name or genetive name
+     *matches the given name regardless of case, or NULL if there is none. If
+     *several objects match, solar system objects come first, then deep sky
+     *objects, constellations, stars, supernovae and satellites.
+     */
+    SkyObject *find( const QString &name ) const;
+
+    /**
+     *@return the names that begin with the given text, regardless of case
+     *@param types restrict the result to these object types; all types if empty
+     */
+    QVector<Entry> findPrefix( const QString &text, const QList<int> &types = QList<int>() ) const;
+
+    /**
+     *@return the names that have a word beginning with the given text, regardless of case
+     *@param types restrict the result to these object types; all types if empty
+     */
+    QVector<Entry> findWords( const QString &text, const QList<int> &types = QList<int>() ) const;
+
+    /**
+     *@return the names that have, for every word of the given text, a word
+     *within a bounded edit distance of it, regardless of case. Closer names
+     *come first.
+     *
+     *The edit distance counts insertions, deletions, substitutions and
+     *transpositions of adjacent characters. Words of up to 3 characters must
+     *match exactly, words of up to 7 characters may be 1 edit away and longer
+     *words 2 edits.
+     *@param types restrict the result to these object types; all types if empty
+     */
+    QVector<Entry> findFuzzy( const QString &text, const QList<int> &types = QList<int>() ) const;
+
+    /**
+     *@return all names of the given types
+     *@param types the object types; all types if empty
+     */
+    QVector<Entry> entries( const QList<int> &types = QList<int>() ) const;
+
+private:
+    /** A word start of a name: the case-folded name from the given offset on */
+    struct WordKey {
+        int name;
+        int offset;
+    };
+
+    /** Append the matches of the word starts from [begin, end) to result, at most once per name */
+    void collect( const WordKey *begin, const WordKey *end, bool prefixOnly, const QList<int> &types, QVector<Entry> &result ) const;
+
+    /** @return the range of word starts that begin with the case-folded text */
+    QPair<const WordKey *, const WordKey *> range( const QString &folded ) const;
+
+    QVector<Entry> m_Names;          // All names, as in the object lists
+    QVector<int> m_Types;            // Object type of each name
+    QVector<QString> m_Folded;       // Case-folded copy of each name
+    QVector<WordKey> m_Words;        // Word starts of all names, sorted
+    QVector<QString> m_Tokens;       // Distinct case-folded words of all names
+    QVector< QVector<int> > m_TokenNames;  // Names that contain each word
+    QHash<QString, const SkyObject *> m_Exact;  // Case-folded names to objects
+};
+
+#endif
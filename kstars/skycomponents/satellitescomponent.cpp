@@ -85,9 +85,26 @@ void SatellitesComponent::update( KSNumbers * )
     // Return if satellites must not be draw
     if( ! selected() )
         return;
-    
+
+    // Propagate the satellites of all groups as a single batch, so that
+    // the work is spread over all threads even with small groups
+    QVector<Satellite *> sats;
     foreach( SatelliteGroup *group, m_groups ) {
-        group->updateSatellitesPos();
+        sats += group->selectedSatellites();
+    }
+    if( sats.isEmpty() )
+        return;
+
+    KStarsData *data = KStarsData::Instance();
+    QVector<int> rc = Satellite::updatePositions( sats, Satellite::context( data->clock()->utc(), data->geo() ) );
+
+    // If position cannot be calculated, remove it from its group
+    for( int i = 0; i < sats.size(); ++i ) {
+        if( rc.at( i ) == 0 )
+            continue;
+        foreach( SatelliteGroup *group, m_groups ) {
+            group->removeOne( sats.at( i ) );
+        }
     }
 }
 
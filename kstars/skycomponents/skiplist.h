@@ -18,6 +18,7 @@
 #ifndef SKIPLIST_H
 #define SKIPLIST_H
 
+#include <QBitArray>
 #include <QHash>
 
 #include "linelist.h"
@@ -26,6 +27,9 @@
  * Extends LineList by adding the skip hash to allow the same the data in a
  * LineList to be drawn as a filled and an outlined polygon.
  *
+ * The skip flags are also kept in a bit array, which skip() tests while
+ * drawing, instead of looking up the hash for every segment.
+ *
  * NOTE: there is no skiplist.cpp file.  This is all there is.
  *
  * @author James B. Bowlin
@@ -43,15 +47,21 @@ public:
     /* @short instructs that the ith line segment should
      * be skipped when drawn (and hence when indexed too).
      */
-    void setSkip( int i ) { m_skip[ i ] = true; }
+    void setSkip( int i ) {
+        m_skip[ i ] = true;
+        if ( i >= m_skipBits.size() )
+            m_skipBits.resize( i + 1 );
+        m_skipBits.setBit( i );
+    }
 
     /* @short returns the skip flag for the i-th line
      * segment.
      */
-    bool skip( int i ) { return m_skip.contains( i );  }
+    bool skip( int i ) const { return i < m_skipBits.size() && m_skipBits.testBit( i ); }
 
 private:
     IndexHash m_skip;
+    QBitArray m_skipBits;
 
 };
 
@@ -19,6 +19,7 @@
 
 #include <QPolygonF>
 #include <QApplication>
+#include <QThread>
 
 #include "Options.h"
 #include "kstarsdata.h"
@@ -66,9 +67,12 @@
 #include "projections/projector.h"
 
 #include "typedef.h"
+#include "auxiliary/startupgraph.h"
+
+#include <QSharedPointer>
 
 SkyMapComposite::SkyMapComposite(SkyComposite *parent ) :
-    SkyComposite(parent), m_reindexNum( J2000 )
+    SkyComposite(parent), m_reindexNum( J2000 ), m_NameIndexDirty( true )
 {
     m_skyLabeler = SkyLabeler::Instance();
     m_skyMesh = SkyMesh::Create( 3 );  // level 5 mesh = 8192 trixels
@@ -130,44 +134,133 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent ) :
     addComponent( m_Supernovae       = new SupernovaeComponent( this ), 7 );
     SkyMapLite::Instance()->loadingFinished();
 #else
-    addComponent( m_MilkyWay       = new MilkyWay( this ), 50);
-    addComponent( m_Stars          = StarComponent::Create( this ), 10);
-    addComponent( m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid( this ));
-    addComponent( m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid( this ));
+    // Components whose loaders only read their own data files are built on
+    // worker threads. The names they register go to a per thread list (see
+    // getObjectNames()), and a main thread task merges them and adds the
+    // component, since the component tree itself is not thread-safe. The
+    // other loaders index into the shared sky mesh buffers, create meshes or
+    // use the catalog database and the painter, so they stay on the main
+    // thread, in the order given by their dependencies.
+    StartupGraph startup( "SkyMapComposite" );
+
+    // Loads a component with load() on a worker thread, then merges its
+    // names and runs add() on the main thread after the tasks in after.
+    auto addLoader = [this, &startup]( const QString &name, const std::function<void()> &load,
+                                       const std::function<void()> &add,
+                                       const QList<int> &dependencies, const QList<int> &after ) {
+        QSharedPointer<LoadedNames> loaded( new LoadedNames );
+        int loading = startup.addTask( name, StartupGraph::WorkerThread, [this, load, loaded]() {
+            load();
+            *loaded = takeLoadedNames();
+            return true;
+        }, dependencies );
+        return startup.addTask( name + " (registration)", StartupGraph::MainThread, [this, add, loaded]() {
+            mergeLoadedNames( *loaded );
+            add();
+            return true;
+        }, QList<int>() << loading << after );
+    };
+
+    int stars = startup.addTask( "Stars", StartupGraph::MainThread, [this]() {
+        addComponent( m_Stars          = StarComponent::Create( this ), 10);
+        return true;
+    } );
+    int cultures = startup.addTask( "Sky cultures", StartupGraph::WorkerThread, [this]() {
+        m_Cultures = new CultureList();
+        return true;
+    } );
+    addLoader( "Solar system", [this]() {
+        m_SolarSystem = new SolarSystemComposite( this );
+        m_SolarSystem->asteroidsComponent()->moveToThread( thread() );
+        m_SolarSystem->cometsComponent()->moveToThread( thread() );
+    }, [this]() {
+        addComponent( m_SolarSystem, 2);
+    }, QList<int>(), QList<int>() );
+    int satellites = addLoader( "Satellites", [this]() {
+        m_Satellites = new SatellitesComponent( this );
+    }, [this]() {
+        addComponent( m_Satellites, 7 );
+    }, QList<int>(), QList<int>() );
+    addLoader( "Supernovae", [this]() {
+        m_Supernovae = new SupernovaeComponent( this );
+        m_Supernovae->moveToThread( thread() );
+    }, [this]() {
+        addComponent( m_Supernovae, 7 );
+    }, QList<int>(), QList<int>() << satellites );
+    // The star catalogs add meshes to the table SkyMesh::Instance() reads
+    int deepSky = addLoader( "Deep sky objects", [this]() {
+        m_DeepSky = new DeepSkyComponent( this );
+    }, [this]() {
+        addComponent( m_DeepSky, 5);
+    }, QList<int>() << stars, QList<int>() );
+
+    startup.addTask( "Milky Way", StartupGraph::MainThread, [this]() {
+        addComponent( m_MilkyWay       = new MilkyWay( this ), 50);
+        return true;
+    } );
+    startup.addTask( "Coordinate grids", StartupGraph::MainThread, [this]() {
+        addComponent( m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid( this ));
+        addComponent( m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid( this ));
+        return true;
+    } );
 
     // Do add to components.
-    addComponent( m_CBoundLines = new ConstellationBoundaryLines( this ), 80);
-    m_Cultures = new CultureList();
-    addComponent( m_CLines     = new ConstellationLines( this, m_Cultures ), 85);
-    addComponent( m_CNames     = new ConstellationNamesComponent( this, m_Cultures ), 90);
-    addComponent( m_Equator    = new Equator( this ), 95);
-    addComponent( m_Ecliptic   = new Ecliptic( this ), 95);
-    addComponent( m_Horizon    = new HorizonComponent( this ), 100);
-    addComponent( m_DeepSky    = new DeepSkyComponent( this ), 5);
-    addComponent(m_ConstellationArt    = new ConstellationArtComponent( this, m_Cultures ), 100);
+    startup.addTask( "Constellation boundaries", StartupGraph::MainThread, [this]() {
+        addComponent( m_CBoundLines = new ConstellationBoundaryLines( this ), 80);
+        return true;
+    } );
+    //Stars must come before constellation lines
+    startup.addTask( "Constellation lines", StartupGraph::MainThread, [this]() {
+        addComponent( m_CLines     = new ConstellationLines( this, m_Cultures ), 85);
+        return true;
+    }, QList<int>() << stars << cultures );
+    startup.addTask( "Constellation names", StartupGraph::MainThread, [this]() {
+        addComponent( m_CNames     = new ConstellationNamesComponent( this, m_Cultures ), 90);
+        return true;
+    }, QList<int>() << cultures );
+    startup.addTask( "Equator, ecliptic and horizon", StartupGraph::MainThread, [this]() {
+        addComponent( m_Equator    = new Equator( this ), 95);
+        addComponent( m_Ecliptic   = new Ecliptic( this ), 95);
+        addComponent( m_Horizon    = new HorizonComponent( this ), 100);
+        return true;
+    } );
+    startup.addTask( "Constellation art", StartupGraph::MainThread, [this]() {
+        addComponent(m_ConstellationArt    = new ConstellationArtComponent( this, m_Cultures ), 100);
+        return true;
+    }, QList<int>() << cultures );
+
+    startup.addTask( "Artificial horizon", StartupGraph::MainThread, [this]() {
+        addComponent( m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
+        return true;
+    } );
+
+    // The NGC/IC names go before the names of the custom catalogs
+    startup.addTask( "Custom catalogs", StartupGraph::MainThread, [this]() {
+        m_internetResolvedCat = "_Internet_Resolved";
+        m_manualAdditionsCat = "_Manual_Additions";
+        addComponent( m_internetResolvedComponent = new SyncedCatalogComponent( this, m_internetResolvedCat, true, 0 ), 6 );
+        addComponent( m_manualAdditionsComponent = new SyncedCatalogComponent( this, m_manualAdditionsCat, true, 0 ), 6 );
+        m_CustomCatalogs = new SkyComposite( this );
+        QStringList allcatalogs = Options::showCatalogNames();
+        for ( int i=0; i < allcatalogs.size(); ++ i ) {
+            if( allcatalogs.at(i) == m_internetResolvedCat || allcatalogs.at(i) == m_manualAdditionsCat ) // This is a special catalog
+                continue;
+            m_CustomCatalogs->addComponent(new CatalogComponent( this, allcatalogs.at(i), false, i ), 6 ); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
+        }
+        return true;
+    }, QList<int>() << deepSky );
 
-    addComponent( m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
+    startup.addTask( "Flags and target lists", StartupGraph::MainThread, [this]() {
+        addComponent( m_Flags       = new FlagComponent( this ), 4);
 
-    m_internetResolvedCat = "_Internet_Resolved";
-    m_manualAdditionsCat = "_Manual_Additions";
-    addComponent( m_internetResolvedComponent = new SyncedCatalogComponent( this, m_internetResolvedCat, true, 0 ), 6 );
-    addComponent( m_manualAdditionsComponent = new SyncedCatalogComponent( this, m_manualAdditionsCat, true, 0 ), 6 );
-    m_CustomCatalogs = new SkyComposite( this );
-    QStringList allcatalogs = Options::showCatalogNames();
-    for ( int i=0; i < allcatalogs.size(); ++ i ) {
-        if( allcatalogs.at(i) == m_internetResolvedCat || allcatalogs.at(i) == m_manualAdditionsCat ) // This is a special catalog
-            continue;
-        m_CustomCatalogs->addComponent(new CatalogComponent( this, allcatalogs.at(i), false, i ), 6 ); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
-    }
+        addComponent( m_ObservingList = new TargetListComponent( this , 0, QPen(),
+                                                                 &Options::obsListSymbol, &Options::obsListText ), 120 );
+        addComponent( m_StarHopRouteList = new TargetListComponent( this , 0, QPen() ), 130 );
+        return true;
+    } );
 
-    addComponent( m_SolarSystem = new SolarSystemComposite( this ), 2);
-    addComponent( m_Flags       = new FlagComponent( this ), 4);
-
-    addComponent( m_ObservingList = new TargetListComponent( this , 0, QPen(),
-                                                             &Options::obsListSymbol, &Options::obsListText ), 120 );
-    addComponent( m_StarHopRouteList = new TargetListComponent( this , 0, QPen() ), 130 );
-    addComponent( m_Satellites       = new SatellitesComponent( this ), 7 );
-    addComponent( m_Supernovae       = new SupernovaeComponent( this ), 7 );
+    startup.run();
+    startup.report();
 #endif
     connect( this, SIGNAL( progressText( const QString & ) ),
              KStarsData::Instance(), SIGNAL( progressText( const QString & ) ) );
@@ -516,13 +609,45 @@ bool SkyMapComposite::removeNameLabel( SkyObject *o ) {
 }
 
 QHash<int, QStringList>& SkyMapComposite::getObjectNames() {
+    // Components loaded on a worker thread at startup must not touch the
+    // shared hashes; they get a list of their own, merged on the main thread.
+    if ( QThread::currentThread() != thread() )
+        return m_LoadedNames.localData().names;
     return m_ObjectNames;
 }
 
 QHash<int, QVector<QPair<QString, const SkyObject*>>>& SkyMapComposite::getObjectLists() {
+    if ( QThread::currentThread() != thread() )
+        return m_LoadedNames.localData().lists;
+    // The components change the lists through the reference we return,
+    // so assume they did and rebuild the name index on the next query.
+    m_NameIndexDirty = true;
     return m_ObjectLists;
 }
 
+SkyMapComposite::LoadedNames SkyMapComposite::takeLoadedNames() {
+    LoadedNames loaded = m_LoadedNames.localData();
+    // The thread goes back to the pool, so leave nothing behind for the next task
+    m_LoadedNames.setLocalData( LoadedNames() );
+    return loaded;
+}
+
+void SkyMapComposite::mergeLoadedNames( const LoadedNames &loaded ) {
+    for ( auto it = loaded.names.constBegin(); it != loaded.names.constEnd(); ++it )
+        m_ObjectNames[ it.key() ] += it.value();
+    for ( auto it = loaded.lists.constBegin(); it != loaded.lists.constEnd(); ++it )
+        m_ObjectLists[ it.key() ] += it.value();
+    m_NameIndexDirty = true;
+}
+
+const NameIndex& SkyMapComposite::nameIndex() {
+    if ( m_NameIndexDirty ) {
+        m_NameIndex.build( m_ObjectLists );
+        m_NameIndexDirty = false;
+    }
+    return m_NameIndex;
+}
+
 QList<SkyObject*> SkyMapComposite::findObjectsInArea( const SkyPoint& p1, const SkyPoint& p2 )
 {
     const SkyRegion& region = m_skyMesh->skyRegion( p1, p2 );
@@ -537,31 +662,11 @@ QList<SkyObject*> SkyMapComposite::findObjectsInArea( const SkyPoint& p1, const
 }
 
 SkyObject* SkyMapComposite::findByName( const QString &name ) {
-    //We search the children in an "intelligent" order (most-used
-    //object types first), in order to avoid wasting too much time
-    //looking for a match.  The most important part of this ordering
-    //is that stars should be last (because the stars list is so long)
-    SkyObject *o = 0;
-    o = m_SolarSystem->findByName( name );
-    if ( o ) return o;
-    o = m_DeepSky->findByName( name );
-    if ( o ) return o;
-    o = m_CustomCatalogs->findByName( name );
-    if ( o ) return o;
-    o = m_internetResolvedComponent->findByName( name );
-    if ( o ) return o;
-    o = m_manualAdditionsComponent->findByName( name );
-    if ( o ) return o;
-    o = m_CNames->findByName( name );
-    if ( o ) return o;
-    o = m_Stars->findByName( name );
-    if ( o ) return o;
-    o = m_Supernovae->findByName(name);
-    if ( o ) return o;
-    o = m_Satellites->findByName(name);
-    if ( o ) return o;
-
-    return 0;
+    //Every component lists the names of its objects in objectLists(),
+    //so a single lookup in the name index replaces searching the
+    //children one after the other. When names collide, the index
+    //returns the object of the component that used to be searched first.
+    return nameIndex().find( name );
 }
 
 
@@ -684,6 +789,9 @@ bool SkyMapComposite::isLocalCNames() {
 
 void SkyMapComposite::emitProgressText( const QString &message ) {
     emit progressText( message );
+    // Components loaded on a worker thread report progress too
+    if ( QThread::currentThread() != thread() )
+        return;
 #ifndef Q_OS_ANDROID
     //Can cause crashes on Android, investigate it
     qApp->processEvents();         // -jbb: this seemed to make it work.
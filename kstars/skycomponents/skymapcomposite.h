@@ -19,10 +19,12 @@
 #define SKYMAPCOMPOSITE_H
 
 #include <QList>
+#include <QThreadStorage>
 
 #include "skycomposite.h"
 #include "ksnumbers.h"
 #include "skyobject.h"
+#include "nameindex.h"
 
 class SkyMesh;
 class SkyLabeler;
@@ -143,8 +145,8 @@ public:
     	*
     	*The objects' primary, secondary and long-form names will 
     	*all be checked for a match.
-    	*@note Overloaded from SkyComposite.  In this version, we search 
-    	*the most likely object classes first to be more efficient.
+    	*@note Overloaded from SkyComposite.  In this version, the name
+    	*is looked up in nameIndex() instead of searching the children.
     	*@p name the name to be matched
     	*@return a pointer to the SkyObject whose name matches
     	*the argument, or a NULL pointer if no match was found.
@@ -158,6 +160,12 @@ public:
       */     
     QList<SkyObject*> findObjectsInArea( const SkyPoint& p1, const SkyPoint& p2 );
 
+    /**
+      *@return the index of the names in objectLists(). The index is rebuilt
+      *first if the lists may have changed since it was last built.
+      */
+    const NameIndex& nameIndex();
+
     void addCustomCatalog( const QString &filename, int index );
     void removeCustomCatalog( const QString &name );
 
@@ -232,8 +240,20 @@ signals:
     void progressText( const QString &message );
 
 private:
+    /** Object names registered by a component while it is loaded on a worker thread */
+    struct LoadedNames {
+        QHash<int, QStringList> names;
+        QHash<int, QVector<QPair<QString, const SkyObject*>>> lists;
+    };
+
     virtual QHash<int, QStringList>& getObjectNames();
     virtual QHash<int, QVector<QPair<QString, const SkyObject*>>>& getObjectLists();
+
+    /** @return the names registered on the calling worker thread since the last call */
+    LoadedNames takeLoadedNames();
+
+    /** Add names collected by takeLoadedNames() to m_ObjectNames and m_ObjectLists */
+    void mergeLoadedNames( const LoadedNames &loaded );
     
     CultureList                 *m_Cultures;
     ConstellationBoundaryLines  *m_CBoundLines;
@@ -269,6 +289,9 @@ private:
     QList<SkyObject*>       m_LabeledObjects;
     QHash<int, QStringList> m_ObjectNames;
     QHash<int, QVector<QPair<QString, const SkyObject*>>> m_ObjectLists;
+    NameIndex               m_NameIndex;
+    bool                    m_NameIndexDirty;   // m_ObjectLists was handed out since the last build
+    QThreadStorage<LoadedNames> m_LoadedNames;  // per worker thread, see getObjectNames()
     QHash<QString, QString> m_ConstellationNames;
     QString m_internetResolvedCat; // Holds the name of the internet resolved catalog
     QString m_manualAdditionsCat;
@@ -53,6 +53,7 @@ enum MeshBufNum_t {
     NO_PRECESS_BUF  = 1,
     OBJ_NEAREST_BUF = 2,
     IN_CONSTELL_BUF = 3,
+    PREFETCH_BUF    = 4,
     NUM_MESH_BUF
 };
 
@@ -16,6 +16,7 @@
  ***************************************************************************/
 
 #include "starblock.h"
+#include "starpack.h"
 #include "skyobjects/starobject.h"
 #include "starcomponent.h"
 #include "skyobjects/stardata.h"
@@ -41,7 +42,7 @@ StarNode::~StarNode() {
 }
 #endif
 
-StarBlock::StarBlock( int nstars ) :
+StarBlock::StarBlock( int nstars, bool packed ) :
     faintMag(-5),
     brightMag(35),
     parent(0),
@@ -49,12 +50,21 @@ StarBlock::StarBlock( int nstars ) :
     next(0),
     drawID(0),
     nStars(0),
+    capacity(nstars),
+    pack(0)
+{
 #ifdef KSTARS_LITE
-    stars(nstars,StarNode())
+    Q_UNUSED( packed );
+    stars.fill( StarNode(), nstars );
 #else
-    stars(nstars, StarObject())
+    if( packed ) {
+        pack = new StarPack( nstars );
+        initialized.resize( nstars );
+    }
+    else
+        stars.fill( StarObject(), nstars );
 #endif
-{ }
+}
 
 
 void StarBlock::reset()
@@ -65,12 +75,18 @@ void StarBlock::reset()
     faintMag = -5.0;
     brightMag = 35.0;
     nStars = 0;
+    if( pack ) {
+        pack->clear();
+        initialized.fill( false );
+    }
 }
 
 StarBlock::~StarBlock()
 {
     if( parent )
         parent -> releaseBlock( this );
+    qDeleteAll( materialized );
+    delete pack;
 }
 #ifdef KSTARS_LITE
 StarNode* StarBlock::addStar(const starData& data)
@@ -107,6 +123,16 @@ StarObject* StarBlock::addStar(const starData& data)
 {
     if(isFull())
         return 0;
+    if( pack ) {
+        pack->append( data );
+        ++nStars;
+        float mag = pack->mag( nStars - 1 );
+        if( mag > faintMag )
+            faintMag = mag;
+        if( mag < brightMag )
+            brightMag = mag;
+        return 0;
+    }
     StarObject& star = stars[nStars++];
     
     star.init(&data);
@@ -121,6 +147,16 @@ StarObject* StarBlock::addStar(const deepStarData& data)
 {
     if(isFull())
         return 0;
+    if( pack ) {
+        pack->append( data );
+        ++nStars;
+        float mag = pack->mag( nStars - 1 );
+        if( mag > faintMag )
+            faintMag = mag;
+        if( mag < brightMag )
+            brightMag = mag;
+        return 0;
+    }
     StarObject& star = stars[nStars++];
     
     star.init(&data);
@@ -131,3 +167,19 @@ StarObject* StarBlock::addStar(const deepStarData& data)
     return &star;
 }
 #endif
+
+#ifndef KSTARS_LITE
+StarObject *StarBlock::materialize( int i )
+{
+    StarObject *star = materialized.value( i );
+    if( !star ) {
+        star = new StarObject;
+        materialized.insert( i, star );
+    }
+    if( !initialized.testBit( i ) ) {
+        pack->materialize( i, star );
+        initialized.setBit( i );
+    }
+    return star;
+}
+#endif
@@ -21,9 +21,12 @@
 #include "typedef.h"
 #include "starblocklist.h"
 
+#include <QBitArray>
+#include <QHash>
 #include <QVector>
 
 class StarObject;
+class StarPack;
 class StarBlockList;
 class PointSourceNode;
 struct starData;
@@ -54,8 +57,10 @@ public:
     /** Constructor
      *  Initializes values of various parameters and creates nstars number of stars
      *  @param nstars   Number of stars to hold in this StarBlock
+     *  @param packed   If true, keep the stars in a StarPack instead of as StarObjects.
+     *                  Ignored in KStars Lite.
      */
-    explicit StarBlock( int nstars = 100 );
+    explicit StarBlock( int nstars = 100, bool packed = false );
 
     /**                                                                                 
      * Destructor                                                                       
@@ -70,7 +75,8 @@ public:
      *  have names. 
      *
      *@param  data    data to initialize star with.
-     *@return pointer to star initialized with data. NULL if block is full.
+     *@return pointer to star initialized with data. NULL if block is full,
+     *        and always NULL for packed blocks, where no StarObject is created.
      */
 #ifdef KSTARS_LITE
     StarNode* addStar(const starData& data);
@@ -96,7 +102,18 @@ public:
      *
      *@return The number of stars that this StarBlock can hold
      */
-    inline int size() const { return stars.size(); }
+    inline int size() const { return capacity; }
+
+    /**
+     *@return true if the stars of this block are kept in a StarPack
+     */
+    inline bool isPacked() const { return pack != 0; }
+
+    /**
+     *@return the StarPack holding the stars of this block, or NULL if
+     *the stars are held as StarObjects
+     */
+    inline StarPack *starPack() { return pack; }
 
     /**
      *@short  Return the i-th star in this StarBlock
@@ -107,7 +124,7 @@ public:
 #ifdef KSTARS_LITE
     inline StarNode *star( int i ) { return &stars[i]; }
 #else
-    inline StarObject *star( int i ) { return &stars[i]; }
+    inline StarObject *star( int i ) { return pack ? materialize( i ) : &stars[i]; }
 #endif
     // These methods are there because we might want to make faintMag and brightMag private at some point
     /**
@@ -147,8 +164,25 @@ public:
     StarBlock(const StarBlock&);
     StarBlock& operator = (const StarBlock&);
 
+#ifndef KSTARS_LITE
+    /** Create (once) and return a StarObject for the i-th star of a packed block,
+     *  initialized with the current data of that star */
+    StarObject *materialize( int i );
+#endif
+
     /** Number of initialized stars in StarBlock. */
     int nStars;
+    /** Number of stars this StarBlock can hold. */
+    int capacity;
+    /** Packed star data, if this is a packed block. */
+    StarPack *pack;
+    /** StarObjects created on demand for stars of a packed block. Like the
+     *  StarObjects of an unpacked block, they live as long as the block and
+     *  are reused in place when it is recycled, since callers may still hold
+     *  pointers to them (e.g. the object nearest to the cursor). */
+    QHash<int, StarObject *> materialized;
+    /** Bit i is set if the i-th materialized StarObject holds the current data of star i. */
+    QBitArray initialized;
     /** Array of stars. */
 #ifdef KSTARS_LITE
     QVector<StarNode> stars;
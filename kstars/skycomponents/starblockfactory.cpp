@@ -17,6 +17,8 @@
 
 #include "starblockfactory.h"
 
+#include "Options.h"
+
 // TODO: Remove later
 #include <cstdio>
 #include <QDebug>
@@ -48,8 +50,9 @@ StarBlockFactory::~StarBlockFactory() {
 
 StarBlock *StarBlockFactory::getBlock() {
     StarBlock *freeBlock = NULL;
+    bool packed = Options::packedStarBlocks();
     if( nBlocks < nCache ) {
-        freeBlock = new StarBlock;
+        freeBlock = new StarBlock( 100, packed );
         if( freeBlock ) {
             ++nBlocks;
             return freeBlock;
@@ -70,7 +73,7 @@ StarBlock *StarBlockFactory::getBlock() {
         freeBlock->next = NULL;
         return freeBlock;
     }
-    freeBlock = new StarBlock;
+    freeBlock = new StarBlock( 100, packed );
     if( freeBlock )
         ++nBlocks;
     return freeBlock;
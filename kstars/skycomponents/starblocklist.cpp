@@ -16,8 +16,12 @@
  ***************************************************************************/
 
 #include "starblocklist.h"
+
+#include <cstring>
+
 #include "binfilehelper.h"
 #include "starblockfactory.h"
+#include "starblockprefetcher.h"
 #include "skyobjects/stardata.h"
 #include "skyobjects/deepstardata.h"
 #include "starcomponent.h"
@@ -63,6 +67,8 @@ int StarBlockList::releaseBlock( StarBlock *block ) {
         nStars -= block->getStarCount();
 
         readOffset -= parent->getStarReader()->guessRecordSize() * block->getStarCount();
+        if( parent->getPrefetcher() )
+            parent->getPrefetcher()->expire( trixel );
         if( nBlocks <= 0 )
           faintMag = -5.0;
         else
@@ -104,7 +110,12 @@ bool StarBlockList::fillToMag( float maglim ) {
 
     Q_ASSERT( nBlocks == (unsigned int) blocks.size() );
 
-    BinFileHelper::unsigned_KDE_fseek( dataFile, readOffset, SEEK_SET );
+    // If the catalog is mapped into memory, copy the records straight out
+    // of the mapping instead of seeking and reading through the file handle
+    const char *records = dSReader->getRecords( trixelId );
+    const int recordSize = dSReader->guessRecordSize();
+    if( !records )
+        BinFileHelper::unsigned_KDE_fseek( dataFile, readOffset, SEEK_SET );
     
     /*
     qDebug() << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
@@ -131,15 +142,21 @@ bool StarBlockList::fillToMag( float maglim ) {
             ++nBlocks;
         }
 	// TODO: Make this more general
-	if( dSReader->guessRecordSize() == 32 ) {
-            fread( &stardata, sizeof( starData ), 1, dataFile );
+	if( recordSize == 32 ) {
+            if( records )
+                memcpy( &stardata, records + nStars * sizeof( starData ), sizeof( starData ) );
+            else
+                fread( &stardata, sizeof( starData ), 1, dataFile );
             if( dSReader->getByteSwap() )
                 DeepStarComponent::byteSwap( &stardata );
             readOffset += sizeof( starData );
             blocks[nBlocks - 1]->addStar(stardata);
 	}
 	else {
-            fread( &deepstardata, sizeof( deepStarData ), 1, dataFile );
+            if( records )
+                memcpy( &deepstardata, records + nStars * sizeof( deepStarData ), sizeof( deepStarData ) );
+            else
+                fread( &deepstardata, sizeof( deepStarData ), 1, dataFile );
             if( dSReader->getByteSwap() )
                 DeepStarComponent::byteSwap( &deepstardata );
             readOffset += sizeof( deepStarData );
@@ -159,6 +176,14 @@ bool StarBlockList::fillToMag( float maglim ) {
     return ( ( maglim < faintMag ) ? true : false );
 }
 
+void StarBlockList::prefetch( float maglim ) {
+    if( staticStars || faintMag >= maglim )
+        return;
+    BinFileHelper *dSReader = parent->getStarReader();
+    if( nStars < dSReader->getRecordCount( trixel ) )
+        dSReader->prefetch( trixel, nStars );
+}
+
 void StarBlockList::setStaticBlock( StarBlock *block ) {
     if( !block )
         return;
@@ -61,6 +61,15 @@ class StarBlockList {
      */
     bool fillToMag( float maglim );
 
+    /**
+     *@short Hints the operating system to page in the stars that
+     *fillToMag( maglim ) would still have to load
+     *
+     *Does nothing unless the catalog file is memory mapped.
+     *@param Magnitude limit to prefetch stars upto
+     */
+    void prefetch( float maglim );
+
     /**
      *@short Sets the first StarBlock in the list to point to the given StarBlock
      *
@@ -0,0 +1,268 @@
+/***************************************************************************
+                starblockprefetcher.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "starblockprefetcher.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "binfilehelper.h"
+#include "byteorder.h"
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "htmesh/HTMesh.h"
+#include "htmesh/MeshIterator.h"
+#include "skyobjects/skypoint.h"
+#include "skyobjects/stardata.h"
+#include "skyobjects/deepstardata.h"
+
+// How far ahead, in seconds, to extrapolate the motion of the view
+#define LOOKAHEAD 0.5
+
+// Upper bound on the extrapolation factor, so that a single slow frame
+// does not send the prediction to the other side of the sky
+#define MAX_EXTRAPOLATION 8.0
+
+// Upper bound on how much fainter than the current limit to prefetch
+#define MAX_MAG_AHEAD 2.0
+
+namespace {
+
+// Magnitude of a raw catalog record, computed as in StarObject::init()
+float recordMag( const char *record, int recordSize, bool byteswap )
+{
+    if( recordSize == 32 ) {
+        qint16 mag;
+        memcpy( &mag, record + offsetof( starData, mag ), sizeof( mag ) );
+        if( byteswap )
+            mag = bswap_16( mag );
+        return mag / 100.0;
+    }
+
+    qint16 B, V;
+    memcpy( &B, record + offsetof( deepStarData, B ), sizeof( B ) );
+    memcpy( &V, record + offsetof( deepStarData, V ), sizeof( V ) );
+    if( byteswap ) {
+        B = bswap_16( B );
+        V = bswap_16( V );
+    }
+    if( V == 30000 && B != 30000 )
+        return ( B - 1600 ) / 1000.0;
+    return V / 1000.0;
+}
+
+}
+
+StarBlockPrefetcher::StarBlockPrefetcher( const BinFileHelper *reader, int htmLevel ) :
+    m_reader( reader ),
+    m_mesh( new HTMesh( htmLevel, htmLevel, 1 ) ),
+    m_prefetched( m_mesh->size(), 0 ),
+    m_readyMaglim( 0 ),
+    m_havePrevious( false ),
+    m_prevX( 0 ), m_prevY( 0 ), m_prevZ( 0 ),
+    m_prevRadius( 0 ),
+    m_prevMaglim( 0 )
+{
+    m_pool.setMaxThreadCount( 1 );
+    resetCounters();
+}
+
+StarBlockPrefetcher::~StarBlockPrefetcher()
+{
+    m_future.waitForFinished();
+    delete m_mesh;
+}
+
+void StarBlockPrefetcher::predict( const SkyPoint *focus, const SkyPoint *destination, double radius, float maglim )
+{
+    double sinRA, cosRA, sinDec, cosDec;
+    focus->ra().SinCos( sinRA, cosRA );
+    focus->dec().SinCos( sinDec, cosDec );
+    double x = cosDec * cosRA, y = cosDec * sinRA, z = sinDec;
+
+    double dt = m_timer.isValid() ? m_timer.restart() / 1000.0 : 0.0;
+    if( !m_timer.isValid() )
+        m_timer.start();
+
+    if( !m_havePrevious || dt <= 0.0 ) {
+        m_havePrevious = true;
+        m_prevX = x; m_prevY = y; m_prevZ = z;
+        m_prevRadius = radius;
+        m_prevMaglim = maglim;
+        return;
+    }
+
+    // Extrapolate the focus, the field of view and the magnitude limit
+    // linearly from their change since the previous frame
+    double k = qMin( LOOKAHEAD / dt, MAX_EXTRAPOLATION );
+    double px = x + ( x - m_prevX ) * k;
+    double py = y + ( y - m_prevY ) * k;
+    double pz = z + ( z - m_prevZ ) * k;
+    double norm = sqrt( px * px + py * py + pz * pz );
+
+    double predictedRadius = radius;
+    if( m_prevRadius > 0.0 )
+        predictedRadius = qBound( 0.25 * radius, radius * pow( radius / m_prevRadius, k ), 90.0 );
+    float predictedMaglim = maglim + qBound( 0.0, ( maglim - m_prevMaglim ) * k, MAX_MAG_AHEAD );
+
+    m_prevX = x; m_prevY = y; m_prevZ = z;
+    m_prevRadius = radius;
+    m_prevMaglim = maglim;
+
+    if( !m_future.isFinished() || norm <= 0.0 )
+        return;
+
+    // The catalog is indexed by J2000.0 coordinates; see SkyMesh::aperture()
+    long double now = KStarsData::Instance()->updateNum()->julianDay();
+    QVector<Aperture> apertures;
+
+    double ra = atan2( py, px ) / dms::DegToRad;
+    if( ra < 0.0 )
+        ra += 360.0;
+    SkyPoint predicted( dms( ra ), dms( asin( qBound( -1.0, pz / norm, 1.0 ) ) / dms::DegToRad ) );
+    predicted.apparentCoord( now, J2000 );
+    Aperture a = { predicted.ra().Degrees(), predicted.dec().Degrees(), qMax( radius, predictedRadius ) };
+    apertures.append( a );
+
+    if( destination && focus->angularDistanceTo( destination ).Degrees() > radius ) {
+        SkyPoint target( destination->ra(), destination->dec() );
+        target.apparentCoord( now, J2000 );
+        Aperture b = { target.ra().Degrees(), target.dec().Degrees(), radius };
+        apertures.append( b );
+    }
+
+    m_future = QtConcurrent::run( &m_pool, [this, apertures, predictedMaglim]() {
+        prefetch( apertures, predictedMaglim );
+    } );
+}
+
+void StarBlockPrefetcher::prefetch( const QVector<Aperture> &apertures, float maglim )
+{
+    QVector<Trixel> ready;
+    for( int i = 0; i < apertures.size(); ++i ) {
+        m_mesh->intersect( apertures[i].ra, apertures[i].dec, apertures[i].radius );
+        MeshIterator region( m_mesh );
+        while( region.hasNext() ) {
+            Trixel trixel = region.next();
+            unsigned int n = readTrixel( trixel, maglim );
+            ready.append( trixel );
+            QMutexLocker locker( &m_prefetchedMutex );
+            if( n > m_prefetched.at( trixel ) )
+                m_prefetched[ trixel ] = n;
+        }
+    }
+
+    QMutexLocker locker( &m_prefetchedMutex );
+    m_ready = ready;
+    m_readyMaglim = maglim;
+}
+
+QVector<Trixel> StarBlockPrefetcher::takeReady( float *maglim )
+{
+    QVector<Trixel> ready;
+    if( !m_future.isFinished() )
+        return ready;
+    QMutexLocker locker( &m_prefetchedMutex );
+    ready.swap( m_ready );
+    *maglim = m_readyMaglim;
+    return ready;
+}
+
+void StarBlockPrefetcher::recordPrefill( Trixel trixel )
+{
+    m_prefilled.insert( trixel );
+}
+
+void StarBlockPrefetcher::expire( Trixel trixel )
+{
+    m_prefilled.remove( trixel );
+    QMutexLocker locker( &m_prefetchedMutex );
+    if( (int) trixel < m_prefetched.size() )
+        m_prefetched[ trixel ] = 0;
+}
+
+unsigned int StarBlockPrefetcher::readTrixel( Trixel trixel, float maglim ) const
+{
+    const char *records = m_reader->getRecords( trixel );
+    if( !records )
+        return 0;
+
+    unsigned int n;
+    {
+        QMutexLocker locker( &m_prefetchedMutex );
+        n = m_prefetched.at( trixel );
+    }
+
+    const int recordSize = m_reader->guessRecordSize();
+    const bool byteswap = m_reader->getByteSwap();
+    const unsigned int count = m_reader->getRecordCount( trixel );
+
+    // Records are sorted by magnitude within a trixel. Reading their
+    // magnitudes pulls them into memory; stop after the first star that
+    // is fainter than the limit, just like StarBlockList::fillToMag().
+    if( n > 0 && recordMag( records + ( n - 1 ) * recordSize, recordSize, byteswap ) > maglim )
+        return n;
+    while( n < count ) {
+        float mag = recordMag( records + n * recordSize, recordSize, byteswap );
+        ++n;
+        if( mag > maglim )
+            break;
+    }
+    return n;
+}
+
+void StarBlockPrefetcher::recordFill( Trixel trixel, unsigned long nStarsBefore, unsigned long nStarsAfter, qint64 nsecs )
+{
+    // Blocks filled ahead of the view count once, when they come into view
+    if( m_prefilled.remove( trixel ) && nStarsAfter == nStarsBefore ) {
+        ++m_prefilledHits;
+        return;
+    }
+    if( nStarsAfter == nStarsBefore )
+        return;
+
+    bool hit;
+    {
+        QMutexLocker locker( &m_prefetchedMutex );
+        hit = ( (int) trixel < m_prefetched.size() && nStarsAfter <= m_prefetched.at( trixel ) );
+    }
+    if( hit )
+        ++m_hits;
+    else
+        ++m_misses;
+    m_totalLatency += nsecs;
+    if( nsecs > m_maxLatency )
+        m_maxLatency = nsecs;
+}
+
+double StarBlockPrefetcher::averageLatency() const
+{
+    quint64 fills = m_hits + m_misses;
+    return fills ? m_totalLatency / 1.0e6 / fills : 0.0;
+}
+
+void StarBlockPrefetcher::resetCounters()
+{
+    m_prefilledHits = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_totalLatency = 0;
+    m_maxLatency = 0;
+}
@@ -0,0 +1,172 @@
+/***************************************************************************
+                 starblockprefetcher.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STARBLOCKPREFETCHER_H
+#define STARBLOCKPREFETCHER_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+#include "typedef.h"
+
+class BinFileHelper;
+class HTMesh;
+class SkyPoint;
+
+/**
+ *@class StarBlockPrefetcher
+ *@short Pages in the deep stars that are about to scroll into view
+ *
+ *DeepStarComponent calls predict() once per frame with the current
+ *focus, field of view and magnitude limit. From the change since the
+ *previous frame, the prefetcher extrapolates where the view will be a
+ *little later (and, during a GOTO slew, also looks at the destination),
+ *and in a background thread reads the catalog records that
+ *StarBlockList::fillToMag() will need there. When the draw loop then
+ *reaches those trixels, filling their StarBlocks is a copy from memory
+ *instead of a wait for the disk.
+ *
+ *The prefetcher only reads the memory mapped catalog file (see
+ *BinFileHelper::mapFile()). StarBlocks can only be created and filled
+ *on the GUI thread, so that StarBlockFactory and StarBlockList need no
+ *locking: once a prefetch has finished, takeReady() hands its trixels
+ *to DeepStarComponent, which fills their StarBlocks after drawing the
+ *frame. Without a mapping, the prefetcher does nothing.
+ *
+ *The records of a trixel count as prefetched until one of its blocks
+ *is recycled by the StarBlockFactory (see expire()), since by then the
+ *pages they were read from are likely to have been evicted as well.
+ *
+ *Every trixel in the draw loop is reported with recordFill(). A trixel
+ *whose blocks were already filled ahead of the view counts as prefilled.
+ *A fill in the draw loop counts as a hit if the prefetcher had already
+ *read the records involved, or as a miss otherwise, together with the
+ *time the fill took.
+ */
+class StarBlockPrefetcher
+{
+public:
+    /**
+     *@short Constructor
+     *@param reader the reader of the deep star catalog, which must stay
+     *open and mapped for the lifetime of the prefetcher
+     *@param htmLevel the HTM level of the catalog
+     */
+    StarBlockPrefetcher( const BinFileHelper *reader, int htmLevel );
+
+    /** @short Destructor. Waits for a running prefetch to finish. */
+    ~StarBlockPrefetcher();
+
+    /**
+     *@short Predict the next aperture from the motion of the view, and
+     *start reading it in the background
+     *@param focus the current focus of the sky map
+     *@param destination the destination of the current GOTO slew, or NULL
+     *@param radius the radius of the current aperture in degrees
+     *@param maglim the current magnitude limit
+     *@note If the previous prefetch is still running, this frame only
+     *updates the motion estimate.
+     */
+    void predict( const SkyPoint *focus, const SkyPoint *destination, double radius, float maglim );
+
+    /**
+     *@short Take the trixels read by the last prefetch, once it has finished
+     *@param maglim set to the magnitude limit they were read to
+     *@return the trixels, empty if the prefetch is still running or
+     *they were already taken
+     */
+    QVector<Trixel> takeReady( float *maglim );
+
+    /** @short Account for StarBlocks of the trixel filled ahead of the view */
+    void recordPrefill( Trixel trixel );
+
+    /**
+     *@short Forget what was prefetched and prefilled for the trixel,
+     *called when one of its StarBlocks is recycled
+     */
+    void expire( Trixel trixel );
+
+    /**
+     *@short Account for a StarBlockList of the draw loop
+     *@param trixel the trixel in view
+     *@param nStarsBefore the number of stars in the trixel before the fill
+     *@param nStarsAfter the number of stars in the trixel after the fill
+     *@param nsecs the time the fill took, in nanoseconds
+     */
+    void recordFill( Trixel trixel, unsigned long nStarsBefore, unsigned long nStarsAfter, qint64 nsecs );
+
+    /** @return the number of trixels whose blocks were filled before they came into view */
+    inline quint64 prefilled() const { return m_prefilledHits; }
+
+    /** @return the number of fills whose records had been prefetched */
+    inline quint64 hits() const { return m_hits; }
+
+    /** @return the number of fills that had to wait for records that were not prefetched */
+    inline quint64 misses() const { return m_misses; }
+
+    /** @return the average time a fill took, in milliseconds */
+    double averageLatency() const;
+
+    /** @return the longest time a fill took, in milliseconds */
+    inline double maxLatency() const { return m_maxLatency / 1.0e6; }
+
+    /** @short Reset the hit, miss and latency counters */
+    void resetCounters();
+
+private:
+    /** An aperture to prefetch, in J2000.0 degrees */
+    struct Aperture {
+        double ra, dec, radius;
+    };
+
+    /** Read the records brighter than maglim in all trixels of the apertures, and list them as
+     *  ready. Runs in the background. */
+    void prefetch( const QVector<Aperture> &apertures, float maglim );
+
+    /** @return the number of records of the trixel up to and including the first one fainter than maglim */
+    unsigned int readTrixel( Trixel trixel, float maglim ) const;
+
+    const BinFileHelper *m_reader;
+    HTMesh *m_mesh;                     // Used only by the background thread
+    QThreadPool m_pool;                 // Single thread, so that prefetching never competes with StarUpdater
+    QFuture<void> m_future;
+
+    mutable QMutex m_prefetchedMutex;
+    QVector<unsigned int> m_prefetched; // Number of records read per trixel
+    QVector<Trixel> m_ready;            // Trixels read by the last prefetch, not yet taken
+    float m_readyMaglim;
+    QSet<Trixel> m_prefilled;           // Trixels filled ahead of the view, GUI thread only
+
+    // Motion estimate from the previous frame
+    QElapsedTimer m_timer;
+    bool m_havePrevious;
+    double m_prevX, m_prevY, m_prevZ;
+    double m_prevRadius;
+    float m_prevMaglim;
+
+    quint64 m_prefilledHits;
+    quint64 m_hits;
+    quint64 m_misses;
+    qint64 m_totalLatency;
+    qint64 m_maxLatency;
+};
+
+#endif
@@ -38,6 +38,7 @@
 
 #include "binfilehelper.h"
 #include "starblockfactory.h"
+#include "starupdater.h"
 
 #include "projections/projector.h"
 
@@ -294,6 +295,10 @@ void StarComponent::draw( SkyPainter *skyp )
 
     int nTrixels = 0;
 
+    // First collect the stars to draw from all visible trixels, so
+    // that their coordinates can be brought up to date in one
+    // parallel pass before any of them is painted.
+    m_visibleStars.resize( 0 );
     while( region.hasNext() ) {
         ++nTrixels;
         Trixel currentRegion = region.next();
@@ -304,21 +309,26 @@ void StarComponent::draw( SkyPainter *skyp )
             if( !curStar )
                 continue;
 
-            float mag = curStar->mag();
-
             // break loop if maglim is reached
-            if ( mag > maglim )
+            if ( curStar->mag() > maglim )
                 break;
 
-            if ( curStar->updateID != updateID )
-                curStar->JITupdate();
+            m_visibleStars.append( curStar );
+        }
+    }
+
+    StarUpdater::update( m_visibleStars );
 
-            bool drawn = skyp->drawPointSource( curStar, mag, curStar->spchar() );
+    // Project and draw all the stars in one batch
+    m_visibleDrawn.resize( m_visibleStars.size() );
+    skyp->drawPointSources( m_visibleStars.constData(), m_visibleStars.size(), m_visibleDrawn.data() );
 
-            //FIXME_SKYPAINTER: find a better way to do this.
-            if ( drawn && !(m_hideLabels || mag > labelMagLim) )
-                addLabel( proj->toScreen(curStar), curStar );
-        }
+    for( int i = 0; i < m_visibleStars.size(); ++i ) {
+        StarObject *curStar = m_visibleStars.at( i );
+
+        //FIXME_SKYPAINTER: find a better way to do this.
+        if ( m_visibleDrawn.at( i ) && !(m_hideLabels || curStar->mag() > labelMagLim) )
+            addLabel( proj->toScreen(curStar), curStar );
     }
 
     // Draw focusStar if not null
@@ -198,6 +198,8 @@ private:
     QHash<QString, SkyObject*> m_genName;
     QHash<int, StarObject*> m_HDHash;
     QVector<DeepStarComponent*> m_DeepStarComponents;
+    QVector<StarObject*> m_visibleStars; // Stars to be drawn in the current frame
+    QVector<bool> m_visibleDrawn;         // Whether each of m_visibleStars was drawn
 
     /**
      *@short adds a label to the lists of labels to be drawn prioritized
@@ -0,0 +1,405 @@
+/***************************************************************************
+                    starpack.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "starpack.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "Options.h"
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "skyobjects/starobject.h"
+#include "skyobjects/stardata.h"
+#include "skyobjects/deepstardata.h"
+
+// The kernels below process VF_WIDTH stars at a time using AVX when
+// KStars is compiled for it (e.g. with -march=native), and SSE
+// otherwise, which every x86-64 processor has. The remaining stars,
+// and all stars on other architectures, go through the scalar loops.
+#if defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VF_WIDTH 8
+#define vf_load    _mm256_loadu_ps
+#define vf_store   _mm256_storeu_ps
+#define vf_set1    _mm256_set1_ps
+#define vf_add     _mm256_add_ps
+#define vf_sub     _mm256_sub_ps
+#define vf_mul     _mm256_mul_ps
+#define vf_div     _mm256_div_ps
+#define vf_sqrt    _mm256_sqrt_ps
+#define vf_max     _mm256_max_ps
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VF_WIDTH 4
+#define vf_load    _mm_loadu_ps
+#define vf_store   _mm_storeu_ps
+#define vf_set1    _mm_set1_ps
+#define vf_add     _mm_add_ps
+#define vf_sub     _mm_sub_ps
+#define vf_mul     _mm_mul_ps
+#define vf_div     _mm_div_ps
+#define vf_sqrt    _mm_sqrt_ps
+#define vf_max     _mm_max_ps
+#endif
+
+// Guards the divisions by the distance from the pole in aberrate()
+#define MIN_RHO_SQUARED 1.0e-12f
+
+namespace {
+
+/**
+ * Multiply each vector (x[i], y[i], z[i]) by the row-major 3x3 matrix
+ * M and store the result in (ox[i], oy[i], oz[i]), for begin <= i < end.
+ * The output may be the same as the input.
+ */
+void transform( const float M[9], float *x, float *y, float *z, float *ox, float *oy, float *oz, int begin, int end )
+{
+    int i = begin;
+#ifdef VF_WIDTH
+    const vfloat m0 = vf_set1( M[0] ), m1 = vf_set1( M[1] ), m2 = vf_set1( M[2] );
+    const vfloat m3 = vf_set1( M[3] ), m4 = vf_set1( M[4] ), m5 = vf_set1( M[5] );
+    const vfloat m6 = vf_set1( M[6] ), m7 = vf_set1( M[7] ), m8 = vf_set1( M[8] );
+    for( ; i + VF_WIDTH <= end; i += VF_WIDTH ) {
+        vfloat vx = vf_load( x + i ), vy = vf_load( y + i ), vz = vf_load( z + i );
+        vf_store( ox + i, vf_add( vf_add( vf_mul( m0, vx ), vf_mul( m1, vy ) ), vf_mul( m2, vz ) ) );
+        vf_store( oy + i, vf_add( vf_add( vf_mul( m3, vx ), vf_mul( m4, vy ) ), vf_mul( m5, vz ) ) );
+        vf_store( oz + i, vf_add( vf_add( vf_mul( m6, vx ), vf_mul( m7, vy ) ), vf_mul( m8, vz ) ) );
+    }
+#endif
+    for( ; i < end; ++i ) {
+        float vx = x[i], vy = y[i], vz = z[i];
+        ox[i] = M[0] * vx + M[1] * vy + M[2] * vz;
+        oy[i] = M[3] * vx + M[4] * vy + M[5] * vz;
+        oz[i] = M[6] * vx + M[7] * vy + M[8] * vz;
+    }
+}
+
+/**
+ * Set (ox[i], oy[i], oz[i]) to the unit vector along (x0[i], y0[i],
+ * z0[i]) + t * (vx[i], vy[i], vz[i]), i.e. move the catalog positions
+ * by the proper motion accumulated over t Julian millenia.
+ */
+void properMotion( const float *x0, const float *y0, const float *z0,
+                   const float *vx, const float *vy, const float *vz, float t,
+                   float *ox, float *oy, float *oz, int begin, int end )
+{
+    int i = begin;
+#ifdef VF_WIDTH
+    const vfloat T = vf_set1( t ), one = vf_set1( 1.0f );
+    for( ; i + VF_WIDTH <= end; i += VF_WIDTH ) {
+        vfloat x = vf_add( vf_load( x0 + i ), vf_mul( T, vf_load( vx + i ) ) );
+        vfloat y = vf_add( vf_load( y0 + i ), vf_mul( T, vf_load( vy + i ) ) );
+        vfloat z = vf_add( vf_load( z0 + i ), vf_mul( T, vf_load( vz + i ) ) );
+        vfloat inv = vf_div( one, vf_sqrt( vf_add( vf_add( vf_mul( x, x ), vf_mul( y, y ) ), vf_mul( z, z ) ) ) );
+        vf_store( ox + i, vf_mul( x, inv ) );
+        vf_store( oy + i, vf_mul( y, inv ) );
+        vf_store( oz + i, vf_mul( z, inv ) );
+    }
+#endif
+    for( ; i < end; ++i ) {
+        float x = x0[i] + t * vx[i], y = y0[i] + t * vy[i], z = z0[i] + t * vz[i];
+        float inv = 1.0f / std::sqrt( x * x + y * y + z * z );
+        ox[i] = x * inv;
+        oy[i] = y * inv;
+        oz[i] = z * inv;
+    }
+}
+
+/**
+ * Apply the annual aberration to the unit vectors (x[i], y[i], z[i]) in
+ * place. This uses the same first order expressions for the shifts in
+ * RA and Dec as SkyPoint::aberrate(), written in terms of the cartesian
+ * components so that no trigonometric functions are needed:
+ *   dRA  = c1 cos(eps) cos(RA) / cos(Dec)
+ *   dDec = c1 sin(RA) ( sin(eps) cos(Dec) - cos(eps) sin(Dec) ) + c2 cos(RA) sin(Dec)
+ * with c1 = K ( e cos(P) - cos(L) ), c2 = K ( e sin(P) - sin(L) ).
+ */
+void aberrate( float c1, float c2, float cosOb, float sinOb, float *x, float *y, float *z, int begin, int end )
+{
+    int i = begin;
+#ifdef VF_WIDTH
+    const vfloat C1cosOb = vf_set1( c1 * cosOb ), C1sinOb = vf_set1( c1 * sinOb ), C2 = vf_set1( c2 );
+    const vfloat minRho2 = vf_set1( MIN_RHO_SQUARED );
+    for( ; i + VF_WIDTH <= end; i += VF_WIDTH ) {
+        vfloat vx = vf_load( x + i ), vy = vf_load( y + i ), vz = vf_load( z + i );
+        vfloat rho2 = vf_max( vf_add( vf_mul( vx, vx ), vf_mul( vy, vy ) ), minRho2 );
+        vfloat rho = vf_sqrt( rho2 );
+        vfloat dRA = vf_div( vf_mul( C1cosOb, vx ), rho2 );
+        vfloat dDec = vf_add( vf_mul( C1sinOb, vy ),
+                              vf_div( vf_mul( vz, vf_sub( vf_mul( C2, vx ), vf_mul( C1cosOb, vy ) ) ), rho ) );
+        vfloat zd = vf_div( vf_mul( vz, dDec ), rho );
+        vf_store( x + i, vf_sub( vf_sub( vx, vf_mul( vy, dRA ) ), vf_mul( vx, zd ) ) );
+        vf_store( y + i, vf_sub( vf_add( vy, vf_mul( vx, dRA ) ), vf_mul( vy, zd ) ) );
+        vf_store( z + i, vf_add( vz, vf_mul( rho, dDec ) ) );
+    }
+#endif
+    for( ; i < end; ++i ) {
+        float vx = x[i], vy = y[i], vz = z[i];
+        float rho2 = vx * vx + vy * vy;
+        if( rho2 < MIN_RHO_SQUARED )
+            rho2 = MIN_RHO_SQUARED;
+        float rho = std::sqrt( rho2 );
+        float dRA = c1 * cosOb * vx / rho2;
+        float dDec = c1 * sinOb * vy + vz * ( c2 * vx - c1 * cosOb * vy ) / rho;
+        float zd = vz * dDec / rho;
+        x[i] = vx - vy * dRA - vx * zd;
+        y[i] = vy + vx * dRA - vy * zd;
+        z[i] = vz + rho * dDec;
+    }
+}
+
+}
+
+StarPack::StarPack( int capacity ) :
+    m_recordSize( 0 ),
+    m_validEquatorial( 0 ),
+    m_validHorizontal( 0 ),
+    m_updateID( 0 ),
+    m_updateNumID( 0 ),
+    m_lastPrecessJD( J2000 )
+{
+    m_records.reserve( capacity * sizeof( starData ) );
+    m_mag.reserve( capacity );
+    m_spType.reserve( capacity );
+    m_x0.reserve( capacity );
+    m_y0.reserve( capacity );
+    m_z0.reserve( capacity );
+    m_vx.reserve( capacity );
+    m_vy.reserve( capacity );
+    m_vz.reserve( capacity );
+    m_ex.reserve( capacity );
+    m_ey.reserve( capacity );
+    m_ez.reserve( capacity );
+    m_hu.reserve( capacity );
+    m_hn.reserve( capacity );
+    m_he.reserve( capacity );
+}
+
+void StarPack::clear()
+{
+    // NOTE: resize() keeps the allocated memory, which is what we
+    // want for blocks that get recycled by the StarBlockFactory
+    m_records.resize( 0 );
+    m_mag.resize( 0 );
+    m_spType.resize( 0 );
+    m_x0.resize( 0 );
+    m_y0.resize( 0 );
+    m_z0.resize( 0 );
+    m_vx.resize( 0 );
+    m_vy.resize( 0 );
+    m_vz.resize( 0 );
+    m_ex.resize( 0 );
+    m_ey.resize( 0 );
+    m_ez.resize( 0 );
+    m_hu.resize( 0 );
+    m_hn.resize( 0 );
+    m_he.resize( 0 );
+    m_validEquatorial = m_validHorizontal = 0;
+}
+
+void StarPack::appendPosition( double ra, double dec, double pmRA, double pmDec )
+{
+    double sinRA, cosRA, sinDec, cosDec;
+    ra *= 15.0 * dms::DegToRad;
+    dec *= dms::DegToRad;
+    sinRA = sin( ra ); cosRA = cos( ra );
+    sinDec = sin( dec ); cosDec = cos( dec );
+
+    m_x0.append( cosDec * cosRA );
+    m_y0.append( cosDec * sinRA );
+    m_z0.append( sinDec );
+
+    // Same convention as StarObject::getIndexCoords(): the star moves
+    // along a great circle with bearing atan2( pmRA, pmDec ), by
+    // pmMagnitude() milliarcseconds per year, i.e. arcseconds per
+    // Julian millenium.
+    double vx = 0, vy = 0, vz = 0;
+    double norm = sqrt( pmRA * pmRA + pmDec * pmDec );
+    if( norm > 0 ) {
+        double pm = sqrt( cosDec * cosDec * pmRA * pmRA + pmDec * pmDec ) * dms::DegToRad / 3600.0;
+        double east = pm * pmRA / norm, north = pm * pmDec / norm;
+        vx = -east * sinRA - north * sinDec * cosRA;
+        vy =  east * cosRA - north * sinDec * sinRA;
+        vz =  north * cosDec;
+    }
+    m_vx.append( vx );
+    m_vy.append( vy );
+    m_vz.append( vz );
+
+    m_ex.append( 0 );
+    m_ey.append( 0 );
+    m_ez.append( 0 );
+    m_hu.append( 0 );
+    m_hn.append( 0 );
+    m_he.append( 0 );
+}
+
+void StarPack::append( const starData &data )
+{
+    m_recordSize = sizeof( starData );
+    m_records.append( reinterpret_cast<const char *>( &data ), sizeof( starData ) );
+    m_mag.append( data.mag / 100.0 );
+    m_spType.append( data.spec_type[0] );
+    appendPosition( data.RA / 1000000.0, data.Dec / 100000.0, data.dRA / 10.0, data.dDec / 10.0 );
+}
+
+void StarPack::append( const deepStarData &data )
+{
+    m_recordSize = sizeof( deepStarData );
+    m_records.append( reinterpret_cast<const char *>( &data ), sizeof( deepStarData ) );
+
+    // NOTE: This must agree with StarObject::init( const deepStarData * )
+    if( data.V == 30000 && data.B != 30000 )
+        m_mag.append( ( data.B - 1600 ) / 1000.0 );
+    else
+        m_mag.append( data.V / 1000.0 );
+
+    char sp = 'B';
+    if( data.B == 30000 || data.V == 30000 )
+        sp = '?';
+    else {
+        double BV_Index = ( data.B - data.V ) / 1000.0;
+        ( BV_Index > 0.0 ) && ( sp = 'A' );
+        ( BV_Index > 0.325 ) && ( sp = 'F' );
+        ( BV_Index > 0.575 ) && ( sp = 'G' );
+        ( BV_Index > 0.975 ) && ( sp = 'K' );
+        ( BV_Index > 1.6 ) && ( sp = 'M' );
+    }
+    m_spType.append( sp );
+
+    appendPosition( data.RA / 1000000.0, data.Dec / 100000.0, data.dRA / 100.0, data.dDec / 100.0 );
+}
+
+void StarPack::update()
+{
+    KStarsData *data = KStarsData::Instance();
+    const int n = size();
+
+    // NOTE: The same short-circuiting as in StarObject::JITupdate()
+    if( m_updateNumID != data->updateNumID() ) {
+        if( Options::alwaysRecomputeCoordinates() ||
+            fabs( m_lastPrecessJD - data->updateNum()->getJD() ) >= 0.00069444 ) {
+            m_validEquatorial = 0;
+            m_lastPrecessJD = data->updateNum()->getJD();
+        }
+        m_updateNumID = data->updateNumID();
+    }
+    if( m_updateID != data->updateID() ) {
+        m_validHorizontal = 0;
+        m_updateID = data->updateID();
+    }
+
+    // Stars appended since the last update need to be computed in any case
+    if( m_validEquatorial < n ) {
+        updateEquatorial( data->updateNum(), m_validEquatorial, n );
+        if( m_validHorizontal > m_validEquatorial )
+            m_validHorizontal = m_validEquatorial;
+        m_validEquatorial = n;
+    }
+    if( m_validHorizontal < n ) {
+        updateHorizontal( data->lst(), data->geo()->lat(), m_validHorizontal, n );
+        m_validHorizontal = n;
+    }
+}
+
+void StarPack::updateEquatorial( const KSNumbers *num, int begin, int end )
+{
+    float *x = m_ex.data(), *y = m_ey.data(), *z = m_ez.data();
+
+    properMotion( m_x0.constData(), m_y0.constData(), m_z0.constData(),
+                  m_vx.constData(), m_vy.constData(), m_vz.constData(), num->julianMillenia(),
+                  x, y, z, begin, end );
+
+    // Precession, followed by the first order nutation of
+    // SkyPoint::nutate(), which is an infinitesimal rotation about
+    // ( dObliq, -dEcLong * sin( eps ), dEcLong * cos( eps ) )
+    double sinOb, cosOb;
+    num->obliquity()->SinCos( sinOb, cosOb );
+    double wx = num->dObliq() * dms::DegToRad;
+    double wy = -num->dEcLong() * dms::DegToRad * sinOb;
+    double wz = num->dEcLong() * dms::DegToRad * cosOb;
+    Eigen::Matrix3d N;
+    N <<  1.0, -wz,  wy,
+           wz, 1.0, -wx,
+          -wy,  wx, 1.0;
+    Eigen::Matrix3d P = N * num->p2();
+    float M[9];
+    for( int r = 0; r < 3; ++r )
+        for( int c = 0; c < 3; ++c )
+            M[ 3 * r + c ] = P( r, c );
+    transform( M, x, y, z, x, y, z, begin, end );
+
+    double sinL, cosL, sinP, cosP;
+    num->sunTrueLongitude().SinCos( sinL, cosL );
+    num->earthPerihelionLongitude().SinCos( sinP, cosP );
+    double K = num->constAberr().radians();
+    double e = num->earthEccentricity();
+    aberrate( K * ( e * cosP - cosL ), K * ( e * sinP - sinL ), cosOb, sinOb, x, y, z, begin, end );
+}
+
+void StarPack::updateHorizontal( const CachingDms *LST, const CachingDms *lat, int begin, int end )
+{
+    // Rotate into the frame of the local horizon; the components are
+    // sin( Alt ), cos( Alt ) cos( Az ) and cos( Alt ) sin( Az ), with
+    // the azimuth measured from north through east, as in
+    // SkyPoint::EquatorialToHorizontal()
+    double sinLST, cosLST, sinLat, cosLat;
+    LST->SinCos( sinLST, cosLST );
+    lat->SinCos( sinLat, cosLat );
+    const float M[9] = {
+        float( cosLat * cosLST ),  float( cosLat * sinLST ),  float( sinLat ),
+        float( -sinLat * cosLST ), float( -sinLat * sinLST ), float( cosLat ),
+        float( -sinLST ),          float( cosLST ),           0.0f
+    };
+    transform( M, m_ex.data(), m_ey.data(), m_ez.data(), m_hu.data(), m_hn.data(), m_he.data(), begin, end );
+}
+
+void StarPack::position( int i, SkyPoint *p ) const
+{
+    CachingDms ra, dec;
+    ra.setUsing_atan2( m_ey.at( i ), m_ex.at( i ) );
+    ra.reduceToRange( dms::ZERO_TO_2PI );
+    dec.setUsing_asin( qBound( -1.0f, m_ez.at( i ), 1.0f ) );
+    p->setRA( ra );
+    p->setDec( dec );
+
+    dms alt, az;
+    alt.setRadians( asin( qBound( -1.0f, m_hu.at( i ), 1.0f ) ) );
+    az.setRadians( atan2( m_he.at( i ), m_hn.at( i ) ) );
+    az.reduceToRange( dms::ZERO_TO_2PI );
+    p->setAlt( alt );
+    p->setAz( az );
+}
+
+void StarPack::materialize( int i, StarObject *star ) const
+{
+    const char *record = m_records.constData() + i * m_recordSize;
+    if( m_recordSize == sizeof( starData ) ) {
+        starData data;
+        memcpy( &data, record, sizeof( starData ) );
+        star->init( &data );
+    }
+    else {
+        deepStarData data;
+        memcpy( &data, record, sizeof( deepStarData ) );
+        star->init( &data );
+    }
+    star->JITupdate();
+}
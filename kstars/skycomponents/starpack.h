@@ -0,0 +1,152 @@
+/***************************************************************************
+                     starpack.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STARPACK_H
+#define STARPACK_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "typedef.h"
+
+class SkyPoint;
+class StarObject;
+class KSNumbers;
+class CachingDms;
+struct starData;
+struct deepStarData;
+
+/**
+ *@class StarPack
+ *@short Structure-of-arrays storage for the stars of a StarBlock
+ *
+ *A StarPack keeps the stars of one StarBlock as packed arrays instead
+ *of as full StarObjects: the raw catalog record, the magnitude and
+ *spectral class, the catalog position and the proper motion as
+ *cartesian unit vectors, and the current equatorial and horizontal
+ *positions, also as unit vectors. This takes a fraction of the memory
+ *of a StarObject, and lets update() bring all the stars of the block
+ *to the current epoch and horizon with SIMD kernels: precession,
+ *nutation and the horizontal conversion are 3x3 matrix products, and
+ *aberration is a short, branch-free sequence of arithmetic.
+ *
+ *Positions are kept in single precision, which is good to a few
+ *hundredths of an arcsecond and plenty for drawing. When a real
+ *StarObject is needed (e.g. for the details dialog), materialize() sets
+ *one up from the raw catalog record, so that it is identical to what
+ *StarObject::init() would have produced.
+ *
+ *@note Gravitational light bending near the Sun (see
+ *SkyPoint::bendlight()) is not applied to packed stars.
+ */
+class StarPack
+{
+public:
+    /**
+     *@short Constructor
+     *@param capacity Number of stars to reserve space for
+     */
+    explicit StarPack( int capacity = 100 );
+
+    /** @short Remove all stars, keeping the allocated space */
+    void clear();
+
+    /** @return the number of stars in the pack */
+    inline int size() const { return m_mag.size(); }
+
+    /** @short Append a star from a 32-byte catalog record */
+    void append( const starData &data );
+
+    /** @short Append a star from a 16-byte catalog record */
+    void append( const deepStarData &data );
+
+    /** @return the magnitude of the i-th star */
+    inline float mag( int i ) const { return m_mag.at( i ); }
+
+    /** @return the first character of the spectral type of the i-th star */
+    inline char spchar( int i ) const { return m_spType.at( i ); }
+
+    /**
+     *@short Bring the current positions of all stars up to date
+     *
+     *The equatorial positions are recomputed from the catalog data
+     *when the update number of KStarsData changed and the time moved
+     *by more than a minute (or if Options::alwaysRecomputeCoordinates()
+     *is set), exactly like StarObject::JITupdate() would do. The
+     *horizontal positions are recomputed whenever the update ID changed.
+     *
+     *This method only touches this pack and may be called concurrently
+     *on different packs.
+     */
+    void update();
+
+    /**
+     *@short Set RA, Dec, Alt and Az of the given point to the current
+     *position of the i-th star, as computed by the last update()
+     */
+    void position( int i, SkyPoint *p ) const;
+
+    /**
+     *@return the cosine of the angle between the current position of
+     *the i-th star and the unit vector (x, y, z) in the current
+     *equatorial frame
+     */
+    inline double cosDistance( int i, double x, double y, double z ) const
+    {
+        return x * m_ex.at( i ) + y * m_ey.at( i ) + z * m_ez.at( i );
+    }
+
+    /**
+     *@short Initialize the given star from the raw catalog record of the
+     *i-th star and set its current coordinates
+     */
+    void materialize( int i, StarObject *star ) const;
+
+private:
+    /** Append the catalog position, proper motion and derived data common to both record types */
+    void appendPosition( double ra, double dec, double pmRA, double pmDec );
+
+    /** Recompute the current equatorial positions of stars begin ... end - 1 from the catalog data */
+    void updateEquatorial( const KSNumbers *num, int begin, int end );
+
+    /** Recompute the horizontal positions of stars begin ... end - 1 from the current equatorial ones */
+    void updateHorizontal( const CachingDms *LST, const CachingDms *lat, int begin, int end );
+
+    int m_recordSize;       // Size of the raw catalog records, 16 or 32 bytes
+    QByteArray m_records;   // Raw catalog records, for materialize()
+
+    QVector<float> m_mag;
+    QVector<char> m_spType;
+
+    // Catalog position and proper motion (radian per Julian millenium) as cartesian vectors
+    QVector<float> m_x0, m_y0, m_z0;
+    QVector<float> m_vx, m_vy, m_vz;
+
+    // Current equatorial position
+    QVector<float> m_ex, m_ey, m_ez;
+
+    // Current horizontal position (up, north, east components)
+    QVector<float> m_hu, m_hn, m_he;
+
+    int m_validEquatorial;  // Number of stars whose equatorial position is up to date
+    int m_validHorizontal;  // Number of stars whose horizontal position is up to date
+    UpdateID m_updateID;
+    UpdateID m_updateNumID;
+    long double m_lastPrecessJD;
+};
+
+#endif
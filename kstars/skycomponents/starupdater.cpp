@@ -0,0 +1,95 @@
+/***************************************************************************
+                    starupdater.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "starupdater.h"
+
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include "Options.h"
+#include "kstarsdata.h"
+#include "skyobjects/starobject.h"
+#include "starpack.h"
+
+// Below this many stars per chunk, the cost of handing work to the
+// thread pool exceeds the cost of the updates themselves.
+#define MIN_STARS_PER_CHUNK 256
+
+// Number of chunks per worker thread. Having a few chunks per thread
+// evens out the load when some stars need a full recomputation of
+// their coordinates and others do not.
+#define CHUNKS_PER_THREAD 4
+
+void StarUpdater::updateRange( const QVector<StarObject *> &stars, int begin, int end )
+{
+    UpdateID updateID = KStarsData::Instance()->updateID();
+    for( int i = begin; i < end; ++i ) {
+        StarObject *star = stars.at( i );
+        if( star && star->updateID != updateID )
+            star->JITupdate();
+    }
+}
+
+void StarUpdater::update( const QVector<StarObject *> &stars )
+{
+    const int count = stars.size();
+    if( count == 0 )
+        return;
+
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    if( nThreads <= 1 || count < 2 * MIN_STARS_PER_CHUNK ) {
+        updateRange( stars, 0, count );
+        return;
+    }
+
+    // SkyPoint::checkBendLight() looks up the Sun lazily and caches it
+    // in a static member. Make sure that happens here, on the calling
+    // thread, and not concurrently from the workers.
+    if( Options::useRelativistic() && stars.first() )
+        stars.first()->checkBendLight();
+
+    int chunkSize = ( count + nThreads * CHUNKS_PER_THREAD - 1 ) / ( nThreads * CHUNKS_PER_THREAD );
+    if( chunkSize < MIN_STARS_PER_CHUNK )
+        chunkSize = MIN_STARS_PER_CHUNK;
+
+    QVector< QPair<int, int> > chunks;
+    chunks.reserve( count / chunkSize + 1 );
+    for( int begin = 0; begin < count; begin += chunkSize )
+        chunks.append( qMakePair( begin, qMin( begin + chunkSize, count ) ) );
+
+    QtConcurrent::blockingMap( chunks, [&stars]( QPair<int, int> &chunk ) {
+        updateRange( stars, chunk.first, chunk.second );
+    } );
+}
+
+void StarUpdater::update( const QVector<StarPack *> &packs )
+{
+    if( packs.isEmpty() )
+        return;
+
+    if( QThreadPool::globalInstance()->maxThreadCount() <= 1 || packs.size() == 1 ) {
+        for( int i = 0; i < packs.size(); ++i )
+            packs.at( i )->update();
+        return;
+    }
+
+    QVector<StarPack *> work( packs );
+    QtConcurrent::blockingMap( work, []( StarPack *&pack ) {
+        pack->update();
+    } );
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+                    starupdater.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STARUPDATER_H
+#define STARUPDATER_H
+
+#include <QVector>
+
+class StarObject;
+class StarPack;
+
+/**
+ *@class StarUpdater
+ *@short Brings a batch of stars up to date on a pool of worker threads
+ *
+ *The star draw loops collect the stars of all visible trixels that
+ *are brighter than the limiting magnitude into a flat list, hand the
+ *list to update(), and then paint it on the GUI thread. update()
+ *splits the list into chunks and runs StarObject::JITupdate() on
+ *every chunk concurrently, so that precession, nutation, aberration
+ *and the horizontal coordinate conversion scale with the number of
+ *cores instead of running one star at a time.
+ *
+ *@note StarObject::JITupdate() only touches the star it is called
+ *on, and the shared KSNumbers / KStarsData state it reads is not
+ *modified while a draw is in progress, so stars may be updated in
+ *any order.
+ */
+class StarUpdater
+{
+public:
+    /**
+     *@short Run StarObject::JITupdate() on every star in the list
+     *whose updateID is stale. Returns once all stars are updated.
+     *@param stars the stars to update. NULL entries are skipped.
+     */
+    static void update( const QVector<StarObject *> &stars );
+
+    /**
+     *@short Run StarPack::update() on every pack in the list, one pack
+     *per task. Returns once all packs are updated.
+     */
+    static void update( const QVector<StarPack *> &packs );
+
+private:
+    /** Update stars[ begin ] ... stars[ end - 1 ] on the calling thread */
+    static void updateRange( const QVector<StarObject *> &stars, int begin, int end );
+};
+
+#endif
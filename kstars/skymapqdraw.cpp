@@ -23,6 +23,7 @@
 
 SkyMapQDraw::SkyMapQDraw( SkyMap *sm ) : QWidget( sm ), SkyMapDrawAbstract( sm ) {
     m_SkyPixmap = new QPixmap( width(), height() );
+    m_LastDrawCalls = 0;
 }
 
 SkyMapQDraw::~SkyMapQDraw() {
@@ -64,7 +65,7 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     // Not elegant at all. Should find better option
     m_SkyMap->showFocusCoords();
     m_SkyMap->setupProjector();
-    
+
     SkyQPainter psky(this, m_SkyPixmap); 
     //FIXME: we may want to move this into the components.
     psky.begin();
@@ -81,6 +82,7 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     m_KStarsData->skyComposite()->draw( &psky );
     //Finish up
     psky.end();
+    m_LastDrawCalls = psky.drawCallCount();
     
     QPainter psky2;
     psky2.begin( this );
@@ -44,6 +44,12 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract {
      */
     ~SkyMapQDraw();
 
+    /**
+     *@return the number of QPainter drawing calls issued for the
+     * last computed sky map
+     */
+    inline int lastDrawCallCount() const { return m_LastDrawCalls; }
+
  protected:
 
     virtual void paintEvent( QPaintEvent *e );
@@ -51,7 +57,10 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract {
     virtual void resizeEvent( QResizeEvent *e );
 
     QPixmap *m_SkyPixmap;
-    
+
+ private:
+    int m_LastDrawCalls;        // QPainter calls of the last computed sky map
+
 };
 
 #endif
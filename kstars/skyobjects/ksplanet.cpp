@@ -20,106 +20,279 @@
 #include <typeinfo>
 
 #include <cmath>
+#include <cstring>
+#include <cctype>
 
 #include <QFile>
-#include <QTextStream>
+#include <QMutexLocker>
 
 #include <QDebug>
 
+#include "Options.h"
 #include "ksnumbers.h"
 #include "ksutils.h"
-#include "ksfilereader.h"
 
 KSPlanet::OrbitDataManager KSPlanet::odm;
 
-KSPlanet::OrbitDataColl::OrbitDataColl() {
+// Coefficients of the Taylor series of cos(r), highest power of r*r first
+static const double COS_TAYLOR[15] = {
+     3.2798892370698385e-30, -2.4795962632247976e-27,  1.6117375710961184e-24,
+    -8.8967913924505740e-22,  4.1103176233121648e-19, -1.5619206968586225e-16,
+     4.7794773323873853e-14, -1.1470745597729725e-11,  2.0876756987868100e-09,
+    -2.7557319223985888e-07,  2.4801587301587302e-05, -1.3888888888888889e-03,
+     4.1666666666666664e-02, -0.5, 1.0
+};
+
+// Number of terms evaluated per pass of the SIMD loop in sumSeries()
+#define TERMS_PER_BLOCK 64
+
+// The ephemeris cache of a planet is flushed when it grows beyond this
+// many segments, e.g. after a long time-lapse animation
+#define MAX_EPHEMERIS_SEGMENTS 4096
+
+// Positions within this many Julian millenia of the first one in a segment
+// are taken as the same epoch. This is longer than the light time to Neptune,
+// so the iterations of the light time correction don't count as reuse.
+#define SAME_EPOCH_MILLENIA ( 0.25 / 365250.0 )
+
+/* Cosine for the terms of the VSOP87 sums. Unlike cos() from the C library,
+ * this is plain arithmetic without calls or branches, which lets the compiler
+ * vectorize the loop in sumSeries(). The argument is reduced to [-PI, PI]
+ * by subtracting the nearest multiple of 2*PI (the rounding uses the 1.5*2^52
+ * trick, and 2*PI is split in two parts so that the product is exact), and
+ * the Taylor series to r^28 is then good to 1e-15 over the whole interval.
+ */
+static inline double seriesCos( double x )
+{
+    const double ROUND = 6755399441055744.0;
+    double k = ( x * 0.15915494309189535 + ROUND ) - ROUND;
+    double r = ( x - k * 6.283185303211212 ) - k * 3.968374318722162e-09;
+    double y = r * r;
+    double p = COS_TAYLOR[0];
+    for( int i = 1; i < 15; ++i )
+        p = p * y + COS_TAYLOR[i];
+    return p;
 }
 
-KSPlanet::OrbitDataManager::OrbitDataManager() {
-    //EMPTY
+// Sum of A[j] * cos( B[j] + C[j] * Tau ) for j = begin ... end - 1
+static double sumSeries( const double *A, const double *B, const double *C, int begin, int end, double Tau )
+{
+    double terms[ TERMS_PER_BLOCK ];
+    double sum = 0.0;
+    for( int j = begin; j < end; j += TERMS_PER_BLOCK ) {
+        const int n = qMin( TERMS_PER_BLOCK, end - j );
+        const double *a = A + j, *b = B + j, *c = C + j;
+        for( int k = 0; k < n; ++k )
+            terms[k] = a[k] * seriesCos( b[k] + c[k] * Tau );
+        for( int k = 0; k < n; ++k )
+            sum += terms[k];
+    }
+    return sum;
 }
 
-bool KSPlanet::OrbitDataManager::readOrbitData(const QString &fname,
-        QVector<OrbitData> *vector)
-{
+KSPlanet::OrbitDataColl::OrbitDataColl() : segmentSpan( 0.0 ), fitCount( 0 ) {
+    memset( start, 0, sizeof( start ) );
+}
+
+bool KSPlanet::OrbitDataColl::readOrbitData( const QString &fname ) {
     QFile f;
 
-    if ( KSUtils::openDataFile( f, fname ) ) {
-        KSFileReader fileReader( f ); // close file is included
-        QStringList  fields;
-        while ( fileReader.hasMoreLines() ) {
-            fields = fileReader.readLine().split( ' ', QString::SkipEmptyParts );
-
-            if ( fields.size() == 3 ) {
-                double A = fields[0].toDouble();
-                double B = fields[1].toDouble();
-                double C = fields[2].toDouble();
-                vector->append( OrbitData(A, B, C) );
-            }
-        }
-    } else {
+    if ( ! KSUtils::openDataFile( f, fname ) )
         return false;
+
+    // Parse the whole file in one go. Every line holds the three numbers
+    // A, B and C of a term; anything else is skipped.
+    QByteArray data = f.readAll();
+    f.close();
+
+    const char *p = data.constData();
+    const char *end = p + data.size();
+    while ( p < end ) {
+        const char *eol = static_cast<const char *>( memchr( p, '\n', end - p ) );
+        if ( ! eol )
+            eol = end;
+        const char *c = p;
+        double value[3];
+        int nValues = 0;
+        bool ok = true;
+        while ( ok ) {
+            while ( c < eol && isspace( static_cast<unsigned char>( *c ) ) )
+                ++c;
+            if ( c == eol )
+                break;
+            const char *token = c;
+            while ( c < eol && ! isspace( static_cast<unsigned char>( *c ) ) )
+                ++c;
+            if ( nValues == 3 )
+                ok = false;
+            else // QByteArray::toDouble() does not depend on the locale, unlike strtod()
+                value[ nValues++ ] = QByteArray::fromRawData( token, c - token ).toDouble( &ok );
+        }
+        if ( ok && nValues == 3 ) {
+            A.append( value[0] );
+            B.append( value[1] );
+            C.append( value[2] );
+        }
+        p = eol + 1;
     }
     return true;
 }
 
-bool KSPlanet::OrbitDataManager::loadData( KSPlanet::OrbitDataColl &odc, const QString &n ) {
-    QString fname, snum, line;
-    QFile f;
+bool KSPlanet::OrbitDataColl::read( const QString &name ) {
+    static const char coordChar[3] = { 'L', 'B', 'R' };
     int nCount = 0;
-    QString nl = n.toLower();
 
-    if ( hash.contains( nl ) ) {
-        odc = hash[nl];
-        return true;  //orbit data already loaded
+    for ( int c = 0; c < 3; ++c ) {
+        for ( int i = 0; i < 6; ++i ) {
+            start[c][i] = A.size();
+            if ( readOrbitData( name + '.' + coordChar[c] + QString::number( i ) + ".vsop" ) )
+                nCount++;
+        }
+        start[c][6] = A.size();
     }
 
-    //Create a new OrbitDataColl
-    OrbitDataColl ret;
+    A.squeeze();
+    B.squeeze();
+    C.squeeze();
+    return nCount > 0;
+}
+
+double KSPlanet::OrbitDataColl::evaluate( Coordinate coord, double Tau ) const {
+    const int *s = start[coord];
+    double sum = 0.0;
+
+    // Horner scheme over the powers of Tau
+    for ( int i = 5; i >= 0; --i )
+        sum = sum * Tau + sumSeries( A.constData(), B.constData(), C.constData(), s[i], s[i+1], Tau );
+    return sum;
+}
 
-    //Ecliptic Longitude
-    for (int i=0; i<6; ++i) {
-        snum.setNum( i );
-        fname = nl + ".L" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Lon[i] ) )
-            nCount++;
+void KSPlanet::OrbitDataColl::fitSegment( qint64 index, double span, Segment &seg ) const {
+    // Sample the expansion at the Chebyshev nodes of the segment and
+    // project the samples on the Chebyshev polynomials
+    double cosNode[ CHEBYSHEV_TERMS ];
+    double value[3][ CHEBYSHEV_TERMS ];
+    for ( int j = 0; j < CHEBYSHEV_TERMS; ++j ) {
+        cosNode[j] = cos( dms::PI * ( j + 0.5 ) / CHEBYSHEV_TERMS );
+        double Tau = ( index + 0.5 * ( cosNode[j] + 1.0 ) ) * span / 365250.0;
+        for ( int c = 0; c < 3; ++c )
+            value[c][j] = evaluate( Coordinate( c ), Tau );
     }
 
-    if ( nCount==0 ) return false;
+    for ( int k = 0; k < CHEBYSHEV_TERMS; ++k ) {
+        double sum[3] = { 0.0, 0.0, 0.0 };
+        for ( int j = 0; j < CHEBYSHEV_TERMS; ++j ) {
+            double Tk = cos( k * dms::PI * ( j + 0.5 ) / CHEBYSHEV_TERMS );
+            for ( int c = 0; c < 3; ++c )
+                sum[c] += value[c][j] * Tk;
+        }
+        for ( int c = 0; c < 3; ++c )
+            seg.coeff[c][k] = 2.0 * sum[c] / CHEBYSHEV_TERMS;
+    }
+}
 
-    //Ecliptic Latitude
-    for (int i=0; i<6; ++i) {
-        snum.setNum( i );
-        fname = nl + ".B" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Lat[i] ) )
-            nCount++;
+void KSPlanet::OrbitDataColl::position( double Tau, double lbr[3] ) const {
+    const double span = Options::planetEphemerisSpan();
+    if ( span <= 0.0 ) {
+        for ( int c = 0; c < 3; ++c )
+            lbr[c] = evaluate( Coordinate( c ), Tau );
+        return;
     }
 
-    if ( nCount==0 ) return false;
+    // Time since J2000 in units of the segment span
+    const double t = Tau * 365250.0 / span;
+    const qint64 index = qint64( floor( t ) );
+    Segment seg;
+    bool cached = false, fit = false;
+    {
+        QMutexLocker locker( &mutex );
+        if ( span != segmentSpan || segments.size() > MAX_EPHEMERIS_SEGMENTS || touched.size() > MAX_EPHEMERIS_SEGMENTS ) {
+            segments.clear();
+            touched.clear();
+            segmentSpan = span;
+        }
+        QHash<qint64, Segment>::const_iterator it = segments.constFind( index );
+        if ( it != segments.constEnd() ) {
+            seg = it.value();
+            cached = true;
+        } else {
+            QHash<qint64, double>::const_iterator first = touched.constFind( index );
+            if ( first == touched.constEnd() )
+                touched.insert( index, Tau );
+            else if ( fabs( Tau - first.value() ) > SAME_EPOCH_MILLENIA )
+                fit = true;
+        }
+    }
+
+    // A fit costs as much as a dozen evaluations of the full expansion, so
+    // a segment is only fitted when it is used again at another epoch, as
+    // when the clock runs. A jump to an arbitrary date, with the repeated
+    // positions of the light time correction, computes them directly.
+    if ( ! cached && ! fit ) {
+        for ( int c = 0; c < 3; ++c )
+            lbr[c] = evaluate( Coordinate( c ), Tau );
+        return;
+    }
+    if ( fit ) {
+        fitSegment( index, span, seg );
+        QMutexLocker locker( &mutex );
+        ++fitCount;
+        if ( span == segmentSpan ) {
+            segments.insert( index, seg );
+            touched.remove( index );
+        }
+    }
 
-    //Heliocentric Distance
-    for (int i=0; i<6; ++i) {
-        snum.setNum( i );
-        fname = nl + ".R" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Dst[i] ) )
-            nCount++;
+    // Clenshaw recurrence, with x in [-1, 1] across the segment
+    const double x = 2.0 * ( t - index ) - 1.0;
+    for ( int c = 0; c < 3; ++c ) {
+        const double *coeff = seg.coeff[c];
+        double b1 = 0.0, b2 = 0.0;
+        for ( int k = CHEBYSHEV_TERMS - 1; k > 0; --k ) {
+            double b0 = 2.0 * x * b1 - b2 + coeff[k];
+            b2 = b1;
+            b1 = b0;
+        }
+        lbr[c] = x * b1 - b2 + 0.5 * coeff[0];
     }
+}
+
+KSPlanet::OrbitDataManager::OrbitDataManager() {
+    //EMPTY
+}
 
-    if ( nCount==0 ) return false;
+KSPlanet::OrbitDataManager::~OrbitDataManager() {
+    qDeleteAll( hash );
+}
+
+const KSPlanet::OrbitDataColl *KSPlanet::OrbitDataManager::loadData( const QString &n ) {
+    QString nl = n.toLower();
+    QMutexLocker locker( &mutex );
 
-    hash[nl] = ret;
-    odc = hash[nl];
+    OrbitDataColl *odc = hash.value( nl );
+    if ( odc )
+        return odc;  //orbit data already loaded
 
-    return true;
+    odc = new OrbitDataColl;
+    if ( ! odc->read( nl ) ) {
+        delete odc;
+        return NULL;
+    }
+
+    hash.insert( nl, odc );
+    return odc;
 }
 
 KSPlanet::KSPlanet( const QString &s, const QString &imfile, const QColor & c, double pSize ) :
     KSPlanetBase(s, imfile, c, pSize ),
-    data_loaded(false)
+    data_loaded(false),
+    m_OrbitData(NULL)
 { }
 
 KSPlanet::KSPlanet( int n ) 
-    : KSPlanetBase()
+    : KSPlanetBase(),
+      data_loaded(false),
+      m_OrbitData(NULL)
 {
     switch ( n ) {
         case MERCURY:
@@ -175,23 +348,20 @@ QString KSPlanet::untranslatedName() const {
         return name();
 }
 
-//we don't need the reference to the ODC, so just give it a junk variable
+const KSPlanet::OrbitDataColl *KSPlanet::orbitData() const {
+    if ( ! m_OrbitData )
+        m_OrbitData = odm.loadData( untranslatedName() );
+    return m_OrbitData;
+}
+
 bool KSPlanet::loadData() {
-    OrbitDataColl odc;
-    return odm.loadData( odc, untranslatedName() );
+    return orbitData() != NULL;
 }
 
 void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const {
-    double sum[6];
-    OrbitDataColl odc;
-    double Tpow[6];
+    const OrbitDataColl *odc = orbitData();
 
-    Tpow[0] = 1.0;
-    for (int i=1; i<6; ++i) {
-        Tpow[i] = Tpow[i-1] * Tau;
-    }
-
-    if ( ! odm.loadData( odc, untranslatedName() ) ) {
+    if ( ! odc ) {
         epret.longitude = dms(0.0);
         epret.latitude  = dms(0.0);
         epret.radius    = 0.0;
@@ -199,52 +369,13 @@ void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const {
         return;
     }
 
-    //Ecliptic Longitude
-    for (int i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Lon[i].size(); ++j) {
-            sum[i] += odc.Lon[i][j].A * cos( odc.Lon[i][j].B + odc.Lon[i][j].C*Tau );
-            /*
-            qDebug() << "sum[" << i <<"] =" << sum[i] <<
-            	" A = " << odc.Lon[i][j].A << " B = " << odc.Lon[i][j].B <<
-            	" C = " << odc.Lon[i][j].C << endl;
-            	*/
-        }
-        sum[i] *= Tpow[i];
-        //qDebug() << name() << " : sum[" << i << "] = " << sum[i];
-    }
+    double lbr[3];
+    odc->position( Tau, lbr );
 
-    epret.longitude.setRadians( sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5] );
+    epret.longitude.setRadians( lbr[0] );
     epret.longitude.setD( epret.longitude.reduce().Degrees() );
-
-    //Compute Ecliptic Latitude
-    for (uint i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Lat[i].size(); ++j) {
-            sum[i] += odc.Lat[i][j].A * cos( odc.Lat[i][j].B + odc.Lat[i][j].C*Tau );
-        }
-        sum[i] *= Tpow[i];
-    }
-
-
-    epret.latitude.setRadians( sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5] );
-
-    //Compute Heliocentric Distance
-    for (uint i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Dst[i].size(); ++j) {
-            sum[i] += odc.Dst[i][j].A * cos( odc.Dst[i][j].B + odc.Dst[i][j].C*Tau );
-        }
-        sum[i] *= Tpow[i];
-    }
-
-    epret.radius = sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5];
-
-    /*
-    qDebug() << name() << " pre: Lat = " << epret.latitude.toDMSString() << " Long = " <<
-    	epret.longitude.toDMSString() << " Dist = " << epret.radius << endl;
-    */
-
+    epret.latitude.setRadians( lbr[1] );
+    epret.radius = lbr[2];
 }
 
 bool KSPlanet::findGeocentricPosition( const KSNumbers *num, const KSPlanetBase *Earth ) {
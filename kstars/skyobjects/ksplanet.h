@@ -20,6 +20,7 @@
 
 #include <QVector>
 #include <QHash>
+#include <QMutex>
 
 #include "ksplanetbase.h"
 #include "dms.h"
@@ -95,55 +96,95 @@ protected:
     	*/
     virtual bool findGeocentricPosition( const KSNumbers *num, const KSPlanetBase *Earth=NULL );
 
-    /** @class OrbitData
-    	*This class contains doubles A,B,C which represent a single term in a planet's
-    	*positional expansion sums (each sum-term is A*COS(B+C*T)).
+    /** OrbitDataColl contains the whole VSOP87 expansion of a planet, i.e. the
+    	*terms A*COS(B+C*T) of the six sums that yield the planet's Longitude,
+    	*Latitude and Distance, respectively.  The terms are packed into three
+    	*contiguous arrays of A, B and C values, so that a sum is a single tight
+    	*loop which the compiler can turn into SIMD code.
+    	*
+    	*Evaluating all the terms is expensive, so OrbitDataColl also keeps a cache
+    	*of Chebyshev polynomials fitted to the expansion over consecutive segments
+    	*of time (see Options::planetEphemerisSpan()).  The polynomials reproduce the
+    	*full expansion to about 1e-10 radians, and are shared by all copies of
+    	*the planet.  A segment is only fitted once it is used at a second epoch;
+    	*until then, its positions come from the full expansion.
     	*@author Mark Hollomon
-    	*@version 1.0
+    	*@version 2.0
     	*/
-    class OrbitData  {
+    class OrbitDataColl {
     public:
-        /**
-        	*Default constructor
+        /** The three coordinates of the expansion */
+        enum Coordinate { LONGITUDE = 0, LATITUDE = 1, DISTANCE = 2 };
+
+        /**Constructor*/
+        OrbitDataColl();
+
+        /** Read the terms of a planet from disk.
+        	*@param name the lower case name of the planet
+        	*@return true if any data file of the planet was found
         	*/
-        OrbitData() : A(0.), B(0.), C(0.) {}
-        /**
-        	*Constructor 
-        	*@param a the A value
-        	*@param b the B value
-        	*@param c the C value
+        bool read( const QString &name );
+
+        /** @return the number of terms of all sums */
+        inline int size() const { return A.size(); }
+
+        /** Evaluate the full expansion of a coordinate.
+        	*@param coord the coordinate to evaluate
+        	*@param Tau Julian Millenia since J2000
+        	*@return the coordinate, in radians or AU. The longitude is not reduced.
         	*/
-        OrbitData(double a, double b, double c) : A(a), B(b), C(c) {}
+        double evaluate( Coordinate coord, double Tau ) const;
 
-        /**
-        	*Assignment operator
+        /** Compute the heliocentric ecliptic coordinates of the planet, from the
+        	*ephemeris cache if it is enabled.
+        	*@param Tau Julian Millenia since J2000
+        	*@param lbr the longitude (not reduced) and latitude in radians, and the
+        	*distance in AU, are returned in lbr[0], lbr[1] and lbr[2]
         	*/
-        OrbitData operator= ( const OrbitData o ) { return o; }
+        void position( double Tau, double lbr[3] ) const;
 
-        double A, B, C;
-    };
+    private:
+        /** Number of Chebyshev coefficients per coordinate and segment */
+        enum { CHEBYSHEV_TERMS = 12 };
+
+        /** Chebyshev coefficients of the three coordinates over one segment */
+        struct Segment {
+            double coeff[3][CHEBYSHEV_TERMS];
+        };
+
+        /** Read the terms of a single data file and append them to the arrays.
+        	*The data files are named "name.[LBR][0...5].vsop", where
+        	*"L"=Longitude data, "B"=Latitude data, and R=Radius data.
+        	*@param fname the filename to be read.
+        	*@return true if the file was found
+        	*/
+        bool readOrbitData( const QString &fname );
 
-    typedef QVector<OrbitData> OBArray[6];
+        /** Fit the Chebyshev coefficients of segment number index, which covers
+        	*the days [ index * span, ( index + 1 ) * span ) since J2000.
+        	*/
+        void fitSegment( qint64 index, double span, Segment &seg ) const;
 
-    /** OrbitDataColl contains three groups of six QVectors.  Each QVector is a
-    	*list of OrbitData objects, representing a single sum used in computing
-    	*the planet's position.  A set of six of these vectors comprises the large
-    	*"meta-sum" which yields the planet's Longitude, Latitude, or Distance value.
-    	*@author Mark Hollomon
-    	*@version 1.0
-    	*/
-    class OrbitDataColl {
-    public:
-        /**Constructor*/
-        OrbitDataColl();
+        // The terms of the sum of coordinate c multiplied by T^i
+        // are A[j], B[j], C[j] for start[c][i] <= j < start[c][i+1]
+        QVector<double> A, B, C;
+        int start[3][7];
+
+        mutable QMutex mutex;
+        mutable QHash<qint64, Segment> segments;
+        mutable QHash<qint64, double> touched;  // first Tau of the segments used at one epoch only
+        mutable double segmentSpan;
+        mutable quint64 fitCount;               // segments fitted so far
 
-        OBArray Lon;
-        OBArray Lat;
-        OBArray Dst;
+#ifdef UNIT_TEST
+        friend class TestKSPlanet; // Test class
+#endif
+
+        Q_DISABLE_COPY( OrbitDataColl )
     };
 
 
-    /** OrbitDataManager places the OrbitDataColl objects for all planets in a QDict
+    /** OrbitDataManager places the OrbitDataColl objects for all planets in a QHash
     	*indexed by the planets' names.  It also loads the positional data of each planet
     	*from disk.
     	*@author Mark Hollomon
@@ -154,32 +195,37 @@ protected:
         /** Constructor*/
         OrbitDataManager();
 
-        /** Load orbital data for a planet from disk.
+        /** Destructor*/
+        ~OrbitDataManager();
+
+        /** Load orbital data for a planet from disk, if not done yet.
         	*The data is stored on disk in a series of files named 
         	*"name.[LBR][0...5].vsop", where "L"=Longitude data, "B"=Latitude data,
         	*and R=Radius data.
         	*@param n the name of the planet whose data is to be loaded from disk.
-        	*@param odc reference to the OrbitDataColl containing the planet's orbital data.
-        	*@return true if data successfully loaded
+        	*@return the planet's orbital data, or NULL if the data could not be loaded.
+        	*The data stays valid as long as the OrbitDataManager exists.
         	*/
-        bool loadData( OrbitDataColl &odc, const QString &n);
+        const OrbitDataColl *loadData( const QString &n );
 
     private:
-        /** Read a single orbital data file from disk into an OrbitData vector.
-        *The data files are named "name.[LBR][0...5].vsop", where 
-        *"L"=Longitude data, "B"=Latitude data, and R=Radius data.
-        *@param fname the filename to be read.
-        *@param vector pointer to the OrbitData vector to be filled with these data.
-        */
-        bool readOrbitData(const QString &fname, QVector<KSPlanet::OrbitData> *vector);
-
-        QHash<QString, OrbitDataColl> hash;
+        QMutex mutex;
+        QHash<QString, OrbitDataColl *> hash;
     };
 
     static OrbitDataManager odm;
 
+#ifdef UNIT_TEST
+    friend class TestKSPlanet; // Test class
+#endif
+
 private:
     virtual void findMagnitude(const KSNumbers*);
+
+    /** @return the orbital data of the planet, loading it on first use */
+    const OrbitDataColl *orbitData() const;
+
+    mutable const OrbitDataColl *m_OrbitData;
 };
 
 #endif
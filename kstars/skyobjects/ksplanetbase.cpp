@@ -123,7 +123,10 @@ void KSPlanetBase::updateCoords( const KSNumbers *num, bool includePlanets, cons
 void KSPlanetBase::findPosition( const KSNumbers *num, const CachingDms *lat, const CachingDms *LST, const KSPlanetBase *Earth ) {
     // DEBUG edit
     findGeocentricPosition( num, Earth );  //private function, reimplemented in each subclass
-    findPhase();
+    if ( Earth )
+        findPhaseFromEarth( Earth );
+    else
+        findPhase();
     setAngularSize( asin(physicalSize()/Rearth/AU_KM)*60.*180./dms::PI ); //angular size in arcmin
 
     if ( lat && LST )
@@ -276,8 +279,12 @@ double KSPlanetBase::labelOffset() const {
 }
 
 void KSPlanetBase::findPhase() {
+    findPhaseFromEarth( KStarsData::Instance()->skyComposite()->earth() );
+}
+
+void KSPlanetBase::findPhaseFromEarth( const KSPlanetBase *Earth ) {
     /* Compute the phase of the planet in degrees */
-    double earthSun = KStarsData::Instance()->skyComposite()->earth()->rsun();
+    double earthSun = Earth->rsun();
     double cosPhase = (rsun()*rsun() + rearth()*rearth() - earthSun*earthSun)
         / (2 * rsun() * rearth() );
     Phase = acos ( cosPhase ) * 180.0 / dms::PI;
@@ -154,7 +154,8 @@ public:
      * @param num KSNumbers pointer for the target date/time
      * @param lat pointer to the geographic latitude; if NULL, we skip localizeCoords()
      * @param LST pointer to the local sidereal time; if NULL, we skip localizeCoords()
-     * @param Earth pointer to the Earth (not used for the Moon)
+     * @param Earth pointer to the Earth at the same time (not used for the position of the Moon).
+     * The phase is found from it too; if NULL, from the Earth of the sky map.
      */
     void findPosition( const KSNumbers *num, const CachingDms *lat=0, const CachingDms *LST=0, const KSPlanetBase *Earth = 0 );
 
@@ -233,6 +234,11 @@ protected:
     /** Determine the phase of the planet. */
     virtual void findPhase();
 
+    /** Determine the phase of the planet as seen from the given Earth,
+     * which findPosition() uses instead of the Earth of the sky map
+     * when it is given one. */
+    void findPhaseFromEarth( const KSPlanetBase *Earth );
+
     // Geocentric ecliptic position, but distance to the Sun
     EclipticPosition ep;
 
@@ -19,11 +19,17 @@
 #include "satellite.h"
 
 #include <typeinfo>
+#include <cmath>
 
 #include "math.h"
 #include <QDebug>
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include "kstarsdata.h"
+#include "geolocation.h"
+#include "nan.h"
 #include "ksplanetbase.h"
 #include "skymapcomposite.h"
 #include "kssun.h"
@@ -62,6 +68,14 @@
 #define F       3.35281066474748e-3         // Flattening factor
 #define MFACTOR 7.292115e-5
 
+// Below this many satellites per chunk, the cost of handing work to the
+// thread pool exceeds the cost of propagating the orbits.
+#define MIN_SATELLITES_PER_CHUNK 32
+
+// Number of chunks per worker thread, to even out the load between
+// near-Earth and the more expensive deep-space orbits.
+#define CHUNKS_PER_THREAD 4
+
 
 Satellite::Satellite( const QString name, const QString line1, const QString line2 )
 {
@@ -158,6 +172,8 @@ void Satellite::init()
     method = 'n';
 
     m_is_visible = false;
+    m_is_eclipsed = false;
+    m_phase = PIO2;
 
     // Divisor for divide by zero check on inclination
     const double temp4 =  1.5e-12;
@@ -654,16 +670,156 @@ void Satellite::init()
     }
 }
 
+Satellite::Context Satellite::context( const KStarsDateTime &ut, GeoLocation *geo )
+{
+    Context ctx;
+
+    ctx.jd  = ut.djd();
+    ctx.lat = *geo->lat();
+    ctx.lst = geo->GSTtoLST( ut.gst() );
+
+    // Observer ECI position
+    ctx.sinlat = sin( geo->lat()->radians() );
+    ctx.coslat = cos( geo->lat()->radians() );
+    ctx.theta  = geo->LMST( ctx.jd );
+    double sintheta = sin( ctx.theta );
+    double costheta = cos( ctx.theta );
+    double c = 1.0 / sqrt( 1.0 + F * ( F - 2.0 ) * ctx.sinlat * ctx.sinlat );
+    double sq = ( 1.0 - F ) * ( 1.0 - F ) * c;
+    double achcp = ( RADIUSEARTHKM * c + MEANALT) * ctx.coslat;
+    ctx.obs[0] = achcp * costheta;
+    ctx.obs[1] = achcp * sintheta;
+    ctx.obs[2] = ( RADIUSEARTHKM * sq + MEANALT ) * ctx.sinlat;
+    ctx.obsDist = sqrt( ctx.obs[0]*ctx.obs[0] + ctx.obs[1]*ctx.obs[1] + ctx.obs[2]*ctx.obs[2] );
+
+    // Find ECI coordinates of the sun
+    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
+
+    mjd  = ctx.jd - 2415020.0;
+    year = 1900.0 + mjd / 365.25;
+    T    = ( mjd + deltaET( year ) / ( MINPD * 60.0 ) ) / 36525.0;
+    M    = DEG2RAD * ( Modulus( 358.47583 + Modulus( 35999.04975 * T, 360.0 ) - ( 0.000150 + 0.0000033 * T ) * T*T, 360.0 ) );
+    L    = DEG2RAD * ( Modulus( 279.69668 + Modulus( 36000.76892 * T, 360.0 ) + 0.0003025 * T*T, 360.0 ) );
+    e    = 0.01675104 - ( 0.0000418 + 0.000000126 * T ) * T;
+    C    = DEG2RAD * ( ( 1.919460 - ( 0.004789 + 0.000014 * T ) * T ) *
+           sin( M ) + ( 0.020094 - 0.000100 *  T) *
+           sin( 2 * M ) + 0.000293 * sin( 3 * M ) );
+    O    = DEG2RAD * ( Modulus( 259.18 - 1934.142 * T, 360.0 ) );
+    Lsa  = Modulus( L + C - DEG2RAD * ( 0.00569  -0.00479 * sin( O ) ), TWOPI );
+    nu   = Modulus( M + C, TWOPI);
+    R    = 1.0000002 * ( 1.0 - e*e ) / ( 1.0 + e * cos( nu ) );
+    eps  = DEG2RAD * ( 23.452294 - ( 0.0130125 + ( 0.00000164 - 0.000000503 * T ) * T ) * T + 0.00256 * cos( O ) );
+    R    = AU * R;
+
+    ctx.sun[0] = R * cos( Lsa );
+    ctx.sun[1] = R * sin( Lsa ) * cos( eps );
+    ctx.sun[2] = R * sin( Lsa ) * sin( eps );
+
+    // Altitude of the Sun, from the direction of the local vertical
+    double zenith = ( ctx.coslat * costheta * ctx.sun[0] + ctx.coslat * sintheta * ctx.sun[1] + ctx.sinlat * ctx.sun[2] ) / R;
+    ctx.sunAlt = arcSin( zenith ) / DEG2RAD;
+
+    return ctx;
+}
+
+QVector<int> Satellite::updatePositions( const QVector<Satellite *> &sats, const Context &ctx )
+{
+    const int count = sats.size();
+    QVector<int> rc( count, 0 );
+
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    if( nThreads <= 1 || count < 2 * MIN_SATELLITES_PER_CHUNK ) {
+        for( int i = 0; i < count; ++i )
+            rc[i] = sats.at( i )->updatePos( ctx );
+        return rc;
+    }
+
+    int chunkSize = ( count + nThreads * CHUNKS_PER_THREAD - 1 ) / ( nThreads * CHUNKS_PER_THREAD );
+    if( chunkSize < MIN_SATELLITES_PER_CHUNK )
+        chunkSize = MIN_SATELLITES_PER_CHUNK;
+
+    QVector< QPair<int, int> > chunks;
+    chunks.reserve( count / chunkSize + 1 );
+    for( int begin = 0; begin < count; begin += chunkSize )
+        chunks.append( qMakePair( begin, qMin( begin + chunkSize, count ) ) );
+
+    int *results = rc.data();
+    QtConcurrent::blockingMap( chunks, [&sats, &ctx, results]( QPair<int, int> &chunk ) {
+        for( int i = chunk.first; i < chunk.second; ++i )
+            results[i] = sats.at( i )->updatePos( ctx );
+    } );
+
+    return rc;
+}
+
 int Satellite::updatePos()
 {
     KStarsData *data = KStarsData::Instance();
-    return sgp4( ( data->clock()->utc().djd() - m_tle_jd ) * MINPD );
+    return updatePos( context( data->clock()->utc(), data->geo() ) );
 }
 
-int Satellite::sgp4( double tsince )
+int Satellite::updatePos( const Context &ctx )
+{
+    double sat_pos[3], sat_vel[3];
+
+    int rc = sgp4( ( ctx.jd - m_tle_jd ) * MINPD, sat_pos, sat_vel );
+    if ( rc != 0 )
+        return rc;
+
+    double sat_posw = sqrt( sat_pos[0]*sat_pos[0] + sat_pos[1]*sat_pos[1] + sat_pos[2]*sat_pos[2] );
+    m_velocity = sqrt( sat_vel[0]*sat_vel[0] + sat_vel[1]*sat_vel[1] + sat_vel[2]*sat_vel[2] );
+    m_altitude = sat_posw - ctx.obsDist + MEANALT;
+
+    // Az and Dec
+    double sintheta = sin( ctx.theta );
+    double costheta = cos( ctx.theta );
+    double range_posx = sat_pos[0] - ctx.obs[0];
+    double range_posy = sat_pos[1] - ctx.obs[1];
+    double range_posz = sat_pos[2] - ctx.obs[2];
+    m_range = sqrt( range_posx*range_posx + range_posy*range_posy + range_posz*range_posz );
+
+    double top_s = ctx.sinlat*costheta*range_posx + ctx.sinlat*sintheta*range_posy - ctx.coslat*range_posz;
+    double top_e = -sintheta*range_posx + costheta*range_posy;
+    double top_z = ctx.coslat*costheta*range_posx + ctx.coslat*sintheta*range_posy + ctx.sinlat*range_posz;
+
+    double azimut = atan( -top_e / top_s );
+    if ( top_s > 0. )
+        azimut += PI;
+    if ( azimut < 0. )
+        azimut += TWOPI;
+    double elevation = arcSin( top_z / m_range );
+
+    setAz( azimut / DEG2RAD );
+    setAlt( elevation / DEG2RAD );
+    HorizontalToEquatorial( &ctx.lst, &ctx.lat );
+
+    // is the satellite visible ?
+    // Calculates satellite's eclipse status and depth
+    double sd_sun, sd_earth, delta, depth;
+    double sun_posw = sqrt( ctx.sun[0]*ctx.sun[0] + ctx.sun[1]*ctx.sun[1] + ctx.sun[2]*ctx.sun[2] );
+
+    // Determine partial eclipse
+    sd_earth = arcSin( RADIUSEARTHKM / sat_posw );
+    double rho_x = ctx.sun[0] - sat_pos[0];
+    double rho_y = ctx.sun[1] - sat_pos[1];
+    double rho_z = ctx.sun[2] - sat_pos[2];
+    double rho_w = sqrt( rho_x*rho_x + rho_y*rho_y + rho_z*rho_z );
+    sd_sun = arcSin( SR / rho_w );
+    delta = PIO2 - arcSin( -( ctx.sun[0]*sat_pos[0] + ctx.sun[1]*sat_pos[1] + ctx.sun[2]*sat_pos[2] ) / ( sun_posw*sat_posw ) );
+    depth = sd_earth - sd_sun - delta;
+
+    m_is_eclipsed = sd_earth >= sd_sun  &&  depth >= 0;
+    m_is_visible  = !m_is_eclipsed && ctx.sunAlt <= -12.0 && elevation >= 0.0;
+
+    // Phase angle, between the directions to the Sun and to the observer
+    double cosPhase = -( rho_x*range_posx + rho_y*range_posy + rho_z*range_posz ) / ( rho_w * m_range );
+    m_phase = acos( qBound( -1.0, cosPhase, 1.0 ) );
+
+    return( 0 );
+}
+
+int Satellite::sgp4( double tsince, double pos[3], double vel[3] )
 {
-    KStarsData *data = KStarsData::Instance();
-    
     int ktr;
     double am   , axnl  , aynl , betal ,  cosim , cnod  ,
            cos2u, coseo1, cosi , cosip ,  cosisq, cossu , cosu,
@@ -676,16 +832,10 @@ int Satellite::sgp4( double tsince )
            uy   , uz    , vx   , vy    ,  vz    , inclm , mm  ,
            nm   , nodem , xinc , xincp ,  xl    , xlm   , mp  ,
            xmdf , xmx   , xmy  , nodedf, xnode  , nodep , tc  ,
-           sat_posx, sat_posy , sat_posz, sat_posw, sat_velx ,
-           sat_vely  , sat_velz , sinlat, obs_posx, obs_posy,
-           obs_posz, obs_posw, /*obs_velx, obs_vely, obs_velz,*/
-           coslat, thetageo, sintheta, costheta, c, sq, achcp,
            vkmpersec;
 
     const double temp4 =   1.5e-12;
 
-    double jul_utc = data->clock()->utc().djd();
-
     vkmpersec = RADIUSEARTHKM * XKE / 60.0;
 
     // Update for secular gravity and atmospheric drag
@@ -1049,121 +1199,145 @@ int Satellite::sgp4( double tsince )
     vz    =  sini * cossu;
 
     // Position and velocity (in km and km/sec)
-    sat_posx = ( mrt * ux )* RADIUSEARTHKM;
-    sat_posy = ( mrt * uy )* RADIUSEARTHKM;
-    sat_posz = ( mrt * uz )* RADIUSEARTHKM;
-    sat_posw = sqrt( sat_posx*sat_posx + sat_posy*sat_posy + sat_posz*sat_posz );
-    sat_velx = ( mvt * ux + rvdot * vx ) * vkmpersec;
-    sat_vely = ( mvt * uy + rvdot * vy ) * vkmpersec;
-    sat_velz = ( mvt * uz + rvdot * vz ) * vkmpersec;
-    m_velocity =  sqrt( sat_velx*sat_velx + sat_vely*sat_vely + sat_velz*sat_velz );
-
-//     printf("tsince=%.15f\n", tsince);
-//     printf("sat_posx=%.15f\n", sat_posx);
-//     printf("sat_posy=%.15f\n", sat_posy);
-//     printf("sat_posz=%.15f\n", sat_posz);
-//     printf("sat_velx=%.15f\n", sat_velx);
-//     printf("sat_vely=%.15f\n", sat_vely);
-//     printf("sat_velz=%.15f\n", sat_velz);
+    pos[0] = ( mrt * ux )* RADIUSEARTHKM;
+    pos[1] = ( mrt * uy )* RADIUSEARTHKM;
+    pos[2] = ( mrt * uz )* RADIUSEARTHKM;
+    vel[0] = ( mvt * ux + rvdot * vx ) * vkmpersec;
+    vel[1] = ( mvt * uy + rvdot * vy ) * vkmpersec;
+    vel[2] = ( mvt * uz + rvdot * vz ) * vkmpersec;
 
     if ( mrt < 1.0 ) {
         qDebug() << "Satellite has decayed";
         return( 6 );
     }
 
-    // Observer ECI position and velocity
-    sinlat = sin( data->geo()->lat()->radians() );
-    coslat = cos( data->geo()->lat()->radians() );
-    thetageo = data->geo()->LMST( jul_utc );
-    sintheta = sin( thetageo );
-    costheta = cos( thetageo );
-    c = 1.0 / sqrt( 1.0 + F * ( F - 2.0 ) * sinlat * sinlat );
-    sq = ( 1.0 - F ) * ( 1.0 - F ) * c;
-    achcp = ( RADIUSEARTHKM * c + MEANALT) * coslat;
-    obs_posx = achcp * costheta;
-    obs_posy = achcp * sintheta;
-    obs_posz = ( RADIUSEARTHKM * sq + MEANALT ) * sinlat;
-    obs_posw = sqrt( obs_posx*obs_posx + obs_posy*sat_posy + obs_posz*obs_posz );
-    /*obs_velx = -MFACTOR * obs_posy;
-    obs_vely = MFACTOR * obs_posx;
-    obs_velz = 0.;*/
-
-    m_altitude = sat_posw - obs_posw + MEANALT;
-
-    // Az and Dec
-    double range_posx = sat_posx - obs_posx;
-    double range_posy = sat_posy - obs_posy;
-    double range_posz = sat_posz - obs_posz;
-    m_range = sqrt( range_posx*range_posx + range_posy*range_posy + range_posz*range_posz );
-//     double range_velx = sat_velx - obs_velx;
-//     double range_vely = sat_velx - obs_vely;
-//     double range_velz = sat_velx - obs_velz;
-
-    double top_s = sinlat*costheta*range_posx + sinlat*sintheta*range_posy - coslat*range_posz;
-    double top_e = -sintheta*range_posx + costheta*range_posy;
-    double top_z = coslat*costheta*range_posx + coslat*sintheta*range_posy + sinlat*range_posz;
-
-    double azimut = atan( -top_e / top_s );
-    if ( top_s > 0. )
-        azimut += PI;
-    if ( azimut < 0. )
-        azimut += TWOPI;
-    double elevation = arcSin( top_z / m_range );
-
-//     printf("azimut=%.15f\n\r", azimut / DEG2RAD);
-//     printf("elevation=%.15f\n\r", elevation / DEG2RAD);
+    return( 0 );
+}
 
-    setAz( azimut / DEG2RAD );
-    setAlt( elevation / DEG2RAD );
-    HorizontalToEquatorial( data->lst(), data->geo()->lat() );
+double Satellite::elevationAt( double jd, GeoLocation *geo )
+{
+    if ( updatePos( context( KStarsDateTime( jd ), geo ) ) != 0 )
+        return NaN::d;
 
-    // is the satellite visible ?
-    // Find ECI coordinates of the sun
-    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
+    return alt().radians();
+}
 
-    mjd  = jul_utc - 2415020.0;
-    year = 1900.0 + mjd / 365.25;
-    T    = ( mjd + deltaET( year ) / ( MINPD * 60.0 ) ) / 36525.0;
-    M    = DEG2RAD * ( Modulus( 358.47583 + Modulus( 35999.04975 * T, 360.0 ) - ( 0.000150 + 0.0000033 * T ) * T*T, 360.0 ) );
-    L    = DEG2RAD * ( Modulus( 279.69668 + Modulus( 36000.76892 * T, 360.0 ) + 0.0003025 * T*T, 360.0 ) );
-    e    = 0.01675104 - ( 0.0000418 + 0.000000126 * T ) * T;
-    C    = DEG2RAD * ( ( 1.919460 - ( 0.004789 + 0.000014 * T ) * T ) *
-           sin( M ) + ( 0.020094 - 0.000100 *  T) *
-           sin( 2 * M ) + 0.000293 * sin( 3 * M ) );
-    O    = DEG2RAD * ( Modulus( 259.18 - 1934.142 * T, 360.0 ) );
-    Lsa  = Modulus( L + C - DEG2RAD * ( 0.00569  -0.00479 * sin( O ) ), TWOPI );
-    nu   = Modulus( M + C, TWOPI);
-    R    = 1.0000002 * ( 1.0 - e*e ) / ( 1.0 + e * cos( nu ) );
-    eps  = DEG2RAD * ( 23.452294 - ( 0.0130125 + ( 0.00000164 - 0.000000503 * T ) * T ) * T + 0.00256 * cos( O ) );
-    R    = AU * R;
+QList<SatellitePass> Satellite::passes( const KStarsDateTime &start, const KStarsDateTime &end, GeoLocation *geo, double minAlt ) const
+{
+    QList<SatellitePass> result;
+
+    // Work on a copy, so that the position of this satellite is left alone
+    Satellite sat( *this );
+    const double threshold = minAlt * DEG2RAD;
+    const double precision = 1.0 / ( MINPD * 60.0 );   // One second
+
+    // Sample the elevation finely enough that even a short, low pass of a
+    // low orbit satellite spans a few steps
+    const double period = TWOPI / m_mean_motion;
+    const double step = qBound( 0.5, period / 90.0, 5.0 ) / MINPD;
+
+    // Time at which the elevation crosses the threshold, between lo and hi
+    auto crossing = [&sat, geo, threshold, precision]( double lo, double hi ) {
+        bool loUp = sat.elevationAt( lo, geo ) > threshold;
+        while ( hi - lo > precision ) {
+            double mid = 0.5 * ( lo + hi );
+            if ( ( sat.elevationAt( mid, geo ) > threshold ) == loUp )
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return 0.5 * ( lo + hi );
+    };
+
+    // Time of the highest elevation between lo and hi, by golden section search
+    auto culmination = [&sat, geo, precision]( double lo, double hi ) {
+        const double ratio = 0.6180339887498949;
+        double x1 = hi - ratio * ( hi - lo );
+        double x2 = lo + ratio * ( hi - lo );
+        double f1 = sat.elevationAt( x1, geo );
+        double f2 = sat.elevationAt( x2, geo );
+        while ( hi - lo > precision ) {
+            if ( f1 > f2 ) {
+                hi = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = hi - ratio * ( hi - lo );
+                f1 = sat.elevationAt( x1, geo );
+            } else {
+                lo = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = lo + ratio * ( hi - lo );
+                f2 = sat.elevationAt( x2, geo );
+            }
+        }
+        return 0.5 * ( lo + hi );
+    };
+
+    const double jdEnd = end.djd();
+    double prevJD = start.djd();
+    double elevation = sat.elevationAt( prevJD, geo );
+    if ( std::isnan( elevation ) )
+        return result;
+
+    // A pass in progress at the start of the range is not complete, skip it
+    bool up = elevation > threshold;
+    bool haveRise = false;
+    double riseJD = 0.0;
+
+    while ( prevJD < jdEnd ) {
+        double jd = qMin( prevJD + step, jdEnd );
+        elevation = sat.elevationAt( jd, geo );
+        if ( std::isnan( elevation ) )
+            break;
+
+        if ( ! up && elevation > threshold ) {
+            riseJD = crossing( prevJD, jd );
+            haveRise = true;
+            up = true;
+        } else if ( up && elevation <= threshold ) {
+            if ( haveRise ) {
+                double setJD = crossing( prevJD, jd );
+                SatellitePass pass;
+
+                sat.elevationAt( riseJD, geo );
+                pass.rise   = KStarsDateTime( riseJD );
+                pass.riseAz = sat.az();
+
+                sat.elevationAt( setJD, geo );
+                pass.set   = KStarsDateTime( setJD );
+                pass.setAz = sat.az();
+
+                double culmJD = culmination( riseJD, setJD );
+                sat.elevationAt( culmJD, geo );
+                pass.culmination = KStarsDateTime( culmJD );
+                pass.maxAlt      = sat.alt();
+                pass.magnitude   = sat.magnitude();
+                pass.visible     = sat.isVisible();
+
+                result.append( pass );
+            }
+            haveRise = false;
+            up = false;
+        }
 
-    double sun_posx = R * cos( Lsa );
-    double sun_posy = R * sin( Lsa ) * cos( eps );
-    double sun_posz = R * sin( Lsa ) * sin( eps );
-    double sun_posw = R;
+        prevJD = jd;
+    }
 
-    // Calculates satellite's eclipse status and depth
-    double sd_sun, sd_earth, delta, depth;
+    return result;
+}
 
-    // Determine partial eclipse
-    sd_earth = arcSin( RADIUSEARTHKM / sat_posw );
-    double rho_x = sun_posx - sat_posx;
-    double rho_y = sun_posy - sat_posy;
-    double rho_z = sun_posz - sat_posz;
-    double rho_w = sqrt( rho_x*rho_x + rho_y*rho_y + rho_z*rho_z );
-    sd_sun = arcSin( SR / rho_w );
-    double earth_x = -1.0 * sat_posx;
-    double earth_y = -1.0 * sat_posy;
-    double earth_z = -1.0 * sat_posz;
-    double earth_w = sat_posw;
-    delta = PIO2 - arcSin( ( sun_posx*earth_x + sun_posy*earth_y + sun_posz*earth_z )  / ( sun_posw*earth_w ) );
-    depth = sd_earth - sd_sun - delta;
-    KSSun *sun = (KSSun*)data->skyComposite()->findByName( "Sun" );
+double Satellite::magnitude() const
+{
+    if ( m_is_eclipsed )
+        return NaN::d;
 
-    m_is_eclipsed = sd_earth >= sd_sun  &&  depth >= 0;
-    m_is_visible  = !m_is_eclipsed && sun->alt().Degrees() <= -12.0 && elevation >= 0.0;
+    // Diffuse sphere phase function, normalized to 1 at half phase
+    double phaseFactor = sin( m_phase ) + ( PI - m_phase ) * cos( m_phase );
+    if ( phaseFactor <= 0.0 )
+        return NaN::d;
 
-    return( 0 );
+    return 4.0 + 5.0 * log10( m_range / 1000.0 ) - 2.5 * log10( phaseFactor );
 }
 
 QString Satellite::sgp4ErrorString(int code)
@@ -20,11 +20,32 @@
 
 
 #include <QString>
+#include <QList>
+#include <QVector>
 
 #include "skyobject.h"
 #include "skypoint.h"
+#include "kstarsdatetime.h"
 
 class KSPopupMenu;
+class GeoLocation;
+
+/**
+    *@class SatellitePass
+    *A pass of an artificial satellite above the horizon of an observer.
+    */
+class SatellitePass
+{
+public:
+    KStarsDateTime rise;        // Time (UT) the satellite rises above the minimum altitude
+    KStarsDateTime culmination; // Time (UT) of the highest altitude
+    KStarsDateTime set;         // Time (UT) the satellite sets below the minimum altitude
+    dms riseAz;                 // Azimuth at rise
+    dms maxAlt;                 // Altitude at culmination
+    dms setAz;                  // Azimuth at set
+    double magnitude;           // Estimated visual magnitude at culmination, or NaN if eclipsed
+    bool visible;               // True if the satellite is visible at culmination (see Satellite::isVisible())
+};
 
 /**
     *@class Satellite
@@ -35,6 +56,43 @@ class KSPopupMenu;
 class Satellite : public SkyObject
 {
 public:
+    /**
+     *@struct Satellite::Context
+     *The quantities that depend on time and place only, and that are shared by
+     *all satellites when their positions are computed for the same instant:
+     *the sidereal time, the position of the observer and the position of the Sun.
+     */
+    struct Context {
+        double jd;              // Julian Day (UTC)
+        double sinlat, coslat;  // Geodetic latitude of the observer
+        double theta;           // Local mean sidereal time [Radians]
+        double obs[3];          // ECI position of the observer [km]
+        double obsDist;         // Distance of the observer from the center of the Earth [km]
+        double sun[3];          // ECI position of the Sun [km]
+        double sunAlt;          // Altitude of the Sun [Degrees]
+        dms lst;                // Local sidereal time
+        dms lat;                // Latitude of the observer
+    };
+
+    /**
+     *@short Compute the shared quantities for the given time and place
+     *@param ut the Universal Time
+     *@param geo the location of the observer
+     */
+    static Context context( const KStarsDateTime &ut, GeoLocation *geo );
+
+    /**
+     *@short Update the positions of a batch of satellites
+     *
+     *The satellites are split into chunks that are propagated concurrently
+     *on the global thread pool. Each satellite is only touched by one thread,
+     *and the shared quantities are computed once for the whole batch.
+     *@param sats the satellites to update
+     *@param ctx the shared quantities for the time and place of the update
+     *@return for every satellite, the error code of the SGP4 propagation (0 on success)
+     */
+    static QVector<int> updatePositions( const QVector<Satellite *> &sats, const Context &ctx );
+
     /**
      *@short Constructor
      */
@@ -52,10 +110,40 @@ public:
     ~Satellite();
 
     /**
-     *@short Update satellite position
+     *@short Update satellite position for the current time and location
      */
     int updatePos();
 
+    /**
+     *@short Update satellite position for the time and location of the given context
+     *@note This only modifies this satellite and may be called concurrently on different satellites.
+     *@return 0 on success, or the error code of the SGP4 propagation
+     */
+    int updatePos( const Context &ctx );
+
+    /**
+     *@short Predict the passes of the satellite over a time range
+     *
+     *The elevation of the satellite is sampled along its orbit, and the times of
+     *rise, culmination and set of every pass are then refined to about a second.
+     *Only complete passes are returned: a pass in progress at @p start or @p end
+     *is skipped. The position of this satellite is not modified.
+     *@param start the beginning of the range (UT)
+     *@param end the end of the range (UT)
+     *@param geo the location of the observer
+     *@param minAlt the altitude, in degrees, above which the satellite is considered up
+     *@return the passes, in chronological order
+     */
+    QList<SatellitePass> passes( const KStarsDateTime &start, const KStarsDateTime &end, GeoLocation *geo, double minAlt = 0.0 ) const;
+
+    /**
+     *@return the estimated visual magnitude of the satellite at its last computed position,
+     *or NaN if the satellite is in the shadow of the Earth
+     *@note The magnitude assumes a standard magnitude of 4.0 at 1000 km and half phase,
+     *since the TLEs do not provide the size of the satellite.
+     */
+    double magnitude() const;
+
     /**
      *@return True if the satellite is visible (above horizon, in the sunlight and sun at least 12° under horizon)
      */
@@ -105,14 +193,25 @@ private:
     void init();
 
     /**
-     *@short Compute satellite position
+     *@short Compute satellite position and velocity with SGP4
+     *@param tsince time since the TLE epoch [Minutes]
+     *@param pos the ECI position of the satellite [km] is returned here
+     *@param vel the ECI velocity of the satellite [km/s] is returned here
+     *@return 0 on success, or an error code (see sgp4ErrorString())
+     */
+    int sgp4( double tsince, double pos[3], double vel[3] );
+
+    /**
+     *@return Altitude of the satellite [Radians] at the given time
+     *@note Used by passes() to find rise, culmination and set. Returns NaN if the
+     *position cannot be computed.
      */
-    int sgp4( double tsince );    
+    double elevationAt( double jd, GeoLocation *geo );
 
     /**
      *@return Arcsine of the argument
      */
-    double arcSin( double arg );
+    static double arcSin( double arg );
 
     /**
      *Provides the difference between UT (approximately the same as UTC)
@@ -120,12 +219,12 @@ private:
      *This function is based on a least squares fit of data from 1950
      *to 1991 and will need to be updated periodically.
      */
-    double deltaET( double year );
+    static double deltaET( double year );
 
     /**
      *@return arg1 mod arg2
      */
-    double Modulus(double arg1, double arg2);
+    static double Modulus(double arg1, double arg2);
 
     
     virtual void initPopupMenu( KSPopupMenu *pmenu );
@@ -157,6 +256,7 @@ private:
     double m_velocity;          // Satellite velocity in km/s
     double m_altitude;          // Satellite altitude in km
     double m_range;             // Satellite range from observer in km
+    double m_phase;             // Angle Sun - satellite - observer [Radians]
 
     // Near Earth
     bool isimp;
@@ -22,6 +22,7 @@
 #include "satellitegroup.h"
 #include "ksutils.h"
 #include "kspaths.h"
+#include "kstarsdata.h"
 
 SatelliteGroup::SatelliteGroup( QString name, QString tle_filename, QUrl update_url )
 {
@@ -64,19 +65,28 @@ void SatelliteGroup::readTLE()
 
 void SatelliteGroup::updateSatellitesPos()
 {
-    QMutableListIterator<Satellite *> sats(*this);
-    while (sats.hasNext())
-    {
-        Satellite *sat = sats.next();
+    QVector<Satellite *> sats = selectedSatellites();
+    if ( sats.isEmpty() )
+        return;
 
+    KStarsData *data = KStarsData::Instance();
+    QVector<int> rc = Satellite::updatePositions( sats, Satellite::context( data->clock()->utc(), data->geo() ) );
+
+    // If position cannot be calculated, remove it from list
+    for ( int i = 0; i < sats.size(); ++i ) {
+        if ( rc.at( i ) != 0 )
+            removeOne( sats.at( i ) );
+    }
+}
+
+QVector<Satellite *> SatelliteGroup::selectedSatellites() const
+{
+    QVector<Satellite *> sats;
+    foreach ( Satellite *sat, *this ) {
         if ( sat->selected() )
-        {
-            int rc = sat->updatePos();
-            // If position cannot be calculated, remove it from list
-            if (rc != 0)
-                sats.remove();
-        }
+            sats.append( sat );
     }
+    return sats;
 }
 
 QUrl SatelliteGroup::tleFilename()
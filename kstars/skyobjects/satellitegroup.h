@@ -55,6 +55,11 @@ public:
      */
     void updateSatellitesPos();
 
+    /**
+     *@return the satellites of the group that are selected for display
+     */
+    QVector<Satellite *> selectedSatellites() const;
+
     /**
      *@return TLE filename
      */
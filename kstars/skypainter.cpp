@@ -29,6 +29,7 @@
 #include "skyobjects/kscomet.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/ksplanetbase.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/trailobject.h"
 #include "skyobjects/constellationsart.h"
 
@@ -48,6 +49,26 @@ void SkyPainter::setSizeMagLimit(float sizeMagLim)
     m_sizeMagLim = sizeMagLim;
 }
 
+void SkyPainter::beginLineBatch()
+{
+}
+
+void SkyPainter::endLineBatch()
+{
+}
+
+int SkyPainter::drawPointSources(StarObject *const *stars, int count, bool *drawn)
+{
+    int drawnCount = 0;
+    for( int i = 0; i < count; ++i ) {
+        StarObject *star = stars[i];
+        bool visible = drawPointSource( star, star->mag(), star->spchar() );
+        if( visible ) ++drawnCount;
+        if( drawn ) drawn[i] = visible;
+    }
+    return drawnCount;
+}
+
 float SkyPainter::starWidth(float mag) const
 {
     //adjust maglimit for ZoomLevel
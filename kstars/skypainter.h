@@ -29,6 +29,7 @@ class KSPlanetBase;
 class DeepSkyObject;
 class SkyPoint;
 class SkyObject;
+class StarObject;
 class SkyMap;
 class SkipList;
 class LineList;
@@ -102,6 +103,16 @@ public:
     virtual void drawSkyPolyline(LineList* list, SkipList *skipList = 0,
                                  LineListLabel *label = 0) =0;
 
+    /** @short Start collecting the segments of drawSkyPolyline() calls.
+        Until the matching endLineBatch(), backends may keep the segments of
+        the polylines and draw them all at once, so the pen must not change
+        in between. The default implementation does nothing.
+        */
+    virtual void beginLineBatch();
+
+    /** @short Draw the segments collected since beginLineBatch(). */
+    virtual void endLineBatch();
+
     /** @short Draw a polygon in the sky.
         @param list a list of points in the sky
         @param forceClip If true (default), it enforces clipping of the polygon, otherwise, it draws the
@@ -118,6 +129,16 @@ public:
         */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') =0;
 
+    /** @short Draw many stars at once, with their magnitude and spectral class.
+        The default implementation calls drawPointSource() for each of them;
+        backends can override it to project all stars in one batch.
+        @param stars the stars to draw
+        @param count the number of stars
+        @param drawn if not null, set to whether each star was drawn
+        @return the number of stars drawn
+        */
+    virtual int drawPointSources(StarObject *const *stars, int count, bool *drawn = 0);
+
     /** @short Draw a deep sky object
         @param obj the object to draw
         @param drawImage if true, try to draw the image of the object
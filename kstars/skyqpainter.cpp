@@ -31,6 +31,7 @@
 #include "skycomponents/satellitescomponent.h"
 
 #include "skyobjects/deepskyobject.h"
+#include "skyobjects/starobject.h"
 #include "skyobjects/kscomet.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/trailobject.h"
@@ -41,6 +42,7 @@
 #include "ksutils.h"
 
 #include <QMap>
+#include <QVarLengthArray>
 #include <QWidget>
 
 #include <functional>
@@ -87,6 +89,8 @@ SkyQPainter::SkyQPainter( QPaintDevice *pd )
     m_pd = pd;
     m_size = QSize( pd->width(), pd->height() );
     m_vectorStars = false;
+    m_lineBatchDepth = 0;
+    m_drawCalls = 0;
 }
 
 SkyQPainter::SkyQPainter( QPaintDevice *pd, const QSize &size )
@@ -96,6 +100,8 @@ SkyQPainter::SkyQPainter( QPaintDevice *pd, const QSize &size )
     m_pd = pd;
     m_size = size;
     m_vectorStars = false;
+    m_lineBatchDepth = 0;
+    m_drawCalls = 0;
 }
 
 SkyQPainter::SkyQPainter( QWidget *widget, QPaintDevice *pd )
@@ -106,6 +112,8 @@ SkyQPainter::SkyQPainter( QWidget *widget, QPaintDevice *pd )
     m_pd = ( pd ? pd : widget );
     m_size = widget->size();
     m_vectorStars = false;
+    m_lineBatchDepth = 0;
+    m_drawCalls = 0;
 }
 
 SkyQPainter::~SkyQPainter()
@@ -119,10 +127,13 @@ void SkyQPainter::begin()
     setRenderHint(QPainter::Antialiasing, aa );
     setRenderHint(QPainter::HighQualityAntialiasing, aa);
     m_proj = m_sm->projector();
+    m_lineBatchDepth = 0;
+    m_drawCalls = 0;
 }
 
 void SkyQPainter::end()
 {
+    flushLineBatch();
     QPainter::end();
 }
 
@@ -130,10 +141,13 @@ void SkyQPainter::drawSkyBackground()
 {
     //FIXME use projector
     fillRect( 0, 0, m_size.width(), m_size.height(), KStarsData::Instance()->colorScheme()->colorNamed( "SkyColor" ) );
+    ++m_drawCalls;
 }
 
 void SkyQPainter::setPen(const QPen& pen)
 {
+    // Segments collected so far are drawn with the pen they were meant for
+    flushLineBatch();
     QPainter::setPen(pen);
 }
 
@@ -142,6 +156,26 @@ void SkyQPainter::setBrush(const QBrush& brush)
     QPainter::setBrush(brush);
 }
 
+void SkyQPainter::beginLineBatch()
+{
+    ++m_lineBatchDepth;
+}
+
+void SkyQPainter::endLineBatch()
+{
+    if( m_lineBatchDepth > 0 && --m_lineBatchDepth == 0 )
+        flushLineBatch();
+}
+
+void SkyQPainter::flushLineBatch()
+{
+    if( m_lineBatch.isEmpty() )
+        return;
+    drawLines( m_lineBatch.constData(), m_lineBatch.size() );
+    ++m_drawCalls;
+    m_lineBatch.resize( 0 );
+}
+
 void SkyQPainter::initStarImages()
 {
 
@@ -235,6 +269,7 @@ void SkyQPainter::drawSkyLine(SkyPoint* a, SkyPoint* b)
     QPointF bScreen = m_proj->toScreen(b,true,&bVisible);
 
     drawLine(aScreen, bScreen);
+    ++m_drawCalls;
     return;
 
     //THREE CASES:
@@ -253,26 +288,33 @@ void SkyQPainter::drawSkyLine(SkyPoint* a, SkyPoint* b)
 void SkyQPainter::drawSkyPolyline(LineList* list, SkipList* skipList, LineListLabel* label)
 {
     SkyList *points = list->points();
-    bool isVisible, isVisibleLast;
+    const int count = points->size();
+    if ( count == 0 )
+        return;
 
-    QPointF   oLast = m_proj->toScreen( points->first(), true, &isVisibleLast );
-    // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility( points->first() );
-    QPointF oThis, oThis2;
-
-    for ( int j = 1 ; j < points->size() ; j++ ) {
-        SkyPoint* pThis = points->at( j );
-        oThis2 = oThis = m_proj->toScreen( pThis, true, &isVisible );
-        // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+    // Project the whole line at once. Points must be on the visible hemisphere,
+    // and pass checkVisibility() to clip away things below horizon.
+    QVarLengthArray<Vector2f, 256> screen( count );
+    QVarLengthArray<quint8, 256> flags( count );
+    m_proj->toScreenBatch( points->constData(), count, screen.data(), flags.data() );
+    const quint8 visibleFlags = Projector::OnVisibleHemisphere | Projector::InView;
+
+    //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
+    const bool isGnomonic = SkyMap::Instance()->projector()->type() == Projector::Gnomonic;
+
+    QPointF oLast = KSUtils::vecToPoint( screen[0] );
+    bool isVisibleLast = ( flags[0] & visibleFlags ) == visibleFlags;
+
+    for ( int j = 1 ; j < count ; j++ ) {
+        QPointF oThis = KSUtils::vecToPoint( screen[j] );
+        bool isVisible = ( flags[j] & visibleFlags ) == visibleFlags;
         bool doSkip = false;
         if( skipList ) {
             doSkip = skipList->skip(j);
         }
 
         bool pointsVisible = false;
-        //Temporary solution to avoid random lines in Gnomonic projection and draw lines up to horizon
-        if(SkyMap::Instance()->projector()->type() == Projector::Gnomonic) {
+        if( isGnomonic ) {
             if ( isVisible && isVisibleLast ) pointsVisible = true;
         } else {
             if ( isVisible || isVisibleLast ) pointsVisible = true;
@@ -280,50 +322,64 @@ void SkyQPainter::drawSkyPolyline(LineList* list, SkipList* skipList, LineListLa
 
         if ( !doSkip ) {
             if(pointsVisible) {
-                drawLine( oLast, oThis );
+                m_lineBatch.append( QLineF( oLast, oThis ) );
                 if ( label )
                     label->updateLabelCandidates( oThis.x(), oThis.y(), list, j );
             }
         }
 
-        oLast = oThis2;
+        oLast = oThis;
         isVisibleLast = isVisible;
     }
+
+    // Draw all visible segments with one call, unless a batch collects them
+    if ( m_lineBatchDepth == 0 )
+        flushLineBatch();
 }
 
 void SkyQPainter::drawSkyPolygon(LineList* list, bool forceClip)
 {
-    bool isVisible, isVisibleLast;
     SkyList *points = list->points();
+    const int count = points->size();
+    if ( count == 0 )
+        return;
+
+    QVarLengthArray<Vector2f, 256> screen( count );
+    QVarLengthArray<quint8, 256> flags( count );
     QPolygonF polygon;
 
     if (forceClip == false)
     {
-        for ( int i = 0; i < points->size(); ++i )
+        m_proj->toScreenBatch( points->constData(), count, screen.data(), flags.data(), false );
+
+        bool isVisible = false;
+        polygon.reserve( count );
+        for ( int i = 0; i < count; ++i )
         {
-            polygon << m_proj->toScreen( points->at( i ), false, &isVisibleLast);
-            isVisible |= isVisibleLast;
+            polygon << KSUtils::vecToPoint( screen[i] );
+            isVisible |= ( flags[i] & Projector::OnVisibleHemisphere ) != 0;
         }
 
         // If 1+ points are visible, draw it
-        if ( polygon.size() && isVisible)
+        if ( isVisible ) {
             drawPolygon(polygon);
+            ++m_drawCalls;
+        }
 
         return;
     }
 
+    // & with the result of checkVisibility to clip away things below horizon
+    m_proj->toScreenBatch( points->constData(), count, screen.data(), flags.data() );
+    const quint8 visibleFlags = Projector::OnVisibleHemisphere | Projector::InView;
 
     SkyPoint* pLast = points->last();
-    QPointF   oLast = m_proj->toScreen( pLast, true, &isVisibleLast );
-    // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(pLast);
+    bool isVisibleLast = ( flags[count - 1] & visibleFlags ) == visibleFlags;
 
-    for ( int i = 0; i < points->size(); ++i ) {
+    for ( int i = 0; i < count; ++i ) {
         SkyPoint* pThis = points->at( i );
-        QPointF oThis = m_proj->toScreen( pThis, true, &isVisible );
-        // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
-
+        QPointF oThis = KSUtils::vecToPoint( screen[i] );
+        bool isVisible = ( flags[i] & visibleFlags ) == visibleFlags;
 
         if ( isVisible && isVisibleLast ) {
             polygon << oThis;
@@ -337,12 +393,13 @@ void SkyQPainter::drawSkyPolygon(LineList* list, bool forceClip)
         }
 
         pLast = pThis;
-        oLast = oThis;
         isVisibleLast = isVisible;
     }
 
-    if ( polygon.size() )
+    if ( polygon.size() ) {
         drawPolygon(polygon);
+        ++m_drawCalls;
+    }
 
 }
 
@@ -396,6 +453,7 @@ bool SkyQPainter::drawPlanet(KSPlanetBase* planet)
         } else { //Otherwise, draw a simple circle.
             drawEllipse( pos, size, size );
         }
+        ++m_drawCalls;
     }
     return true;
 }
@@ -415,6 +473,31 @@ bool SkyQPainter::drawPointSource(SkyPoint* loc, float mag, char sp)
     }
 }
 
+int SkyQPainter::drawPointSources(StarObject *const *stars, int count, bool *drawn)
+{
+    if( count <= 0 ) return 0;
+
+    QVarLengthArray<Vector2f, 256> screen( count );
+    QVarLengthArray<quint8, 256> flags( count );
+    m_proj->toScreenBatch( stars, count, screen.data(), flags.data() );
+    const quint8 visibleFlags = Projector::OnVisibleHemisphere | Projector::InView;
+
+    int drawnCount = 0;
+    for( int i = 0; i < count; ++i ) {
+        bool visible = false;
+        if( ( flags[i] & visibleFlags ) == visibleFlags ) {
+            QPointF pos = KSUtils::vecToPoint( screen[i] );
+            if( m_proj->onScreen(pos) ) {
+                drawPointSource( pos, starWidth( stars[i]->mag() ), stars[i]->spchar() );
+                visible = true;
+                ++drawnCount;
+            }
+        }
+        if( drawn ) drawn[i] = visible;
+    }
+    return drawnCount;
+}
+
 void SkyQPainter::drawPointSource(const QPointF& pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
@@ -423,6 +506,7 @@ void SkyQPainter::drawPointSource(const QPointF& pos, float size, char sp)
         QPixmap* im = imageCache[ harvardToIndex(sp) ][isize];
         float offset = 0.5 * im->width();
         drawPixmap( QPointF(pos.x()-offset, pos.y()-offset), *im );
+        ++m_drawCalls;
     }
     else {
         // Draw stars as vectors, for better printing / SVG export etc.
@@ -444,6 +528,7 @@ void SkyQPainter::drawPointSource(const QPointF& pos, float size, char sp)
             drawEllipse( pos.x() - 0.5 * size, pos.y() - 0.5 * size, int(size), int(size) );
         else if( size >= 1 )
             drawPoint( pos.x(), pos.y() );
+        ++m_drawCalls;
     }
 }
 
@@ -474,6 +559,7 @@ bool SkyQPainter::drawConstellationArtImage(ConstellationsArt *obj)
     rotate(positionangle);
     setOpacity(0.7);
     drawImage( QRect(-0.5*w, -0.5*h, w, h), obj->image() );
+    ++m_drawCalls;
     setOpacity(1);
 
     setRenderHint(QPainter::SmoothPixmapTransform, false);
@@ -519,6 +605,7 @@ bool SkyQPainter::drawDeepSkyImage(const QPointF& pos, DeepSkyObject* obj, float
     translate(pos);
     rotate( positionAngle );
     drawImage( QRect(-0.5*w, -0.5*h, w, h), obj->image() );
+    ++m_drawCalls;
     restore();
 
     return true;
@@ -563,25 +650,31 @@ void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, fl
     if ( Options::useAntialias() ) {
         lambdaDrawEllipse = [this]( float x, float y, float width, float height ) {
             drawEllipse( QRectF( x, y, width, height ) );
+            ++m_drawCalls;
         };
         lambdaDrawLine = [this]( float x1, float y1, float x2, float y2 ) {
             drawLine( QLineF( x1, y1, x2, y2 ) );
+            ++m_drawCalls;
         };
         lambdaDrawCross = [this]( float centerX, float centerY, float sizeX, float sizeY ) {
             drawLine( QLineF( centerX - sizeX/2., centerY, centerX + sizeX/2., centerY ) );
             drawLine( QLineF( centerX, centerY - sizeY/2., centerX, centerY + sizeY/2. ) );
+            m_drawCalls += 2;
         };
     }
     else {
         lambdaDrawEllipse = [this]( float x, float y, float width, float height ) {
             drawEllipse( QRect( x, y, width, height ) );
+            ++m_drawCalls;
         };
         lambdaDrawLine = [this]( float x1, float y1, float x2, float y2 ) {
             drawLine( QLine( x1, y1, x2, y2 ) );
+            ++m_drawCalls;
         };
         lambdaDrawCross = [this]( float centerX, float centerY, float sizeX, float sizeY ) {
             drawLine( QLine( centerX - sizeX/2., centerY, centerX + sizeX/2., centerY ) );
             drawLine( QLine( centerX, centerY - sizeY/2., centerX, centerY + sizeY/2. ) );
+            m_drawCalls += 2;
         };
     }
 
@@ -679,6 +772,7 @@ void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, fl
 
         } else if ( size>0. ) {
             drawPoint( QPointF(x, y) );
+            ++m_drawCalls;
         }
         break;
     case 14: { // Galaxy cluster - draw a dashed circle
@@ -718,6 +812,7 @@ void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, fl
                 int idx1 = int(dx1); int idy1 = int(dy1);
                 drawText( QRect(idx1, idy1, isize, int(e*size)), Qt::AlignCenter, qMark );
             }
+            ++m_drawCalls;
             restore(); //reset coordinate system (and font?)
         }
         else if ( size>0. ) {
@@ -725,6 +820,7 @@ void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, fl
                 drawPoint( QPointF(x, y) );
             else
                 drawPoint( QPoint( x, y ) );
+            ++m_drawCalls;
         }
     }
 
@@ -742,6 +838,7 @@ void SkyQPainter::drawObservingList(const QList< SkyObject* >& obs)
         float y1 = o.y() - 0.5*size;
         drawArc( QRectF(x1, y1, size, size), -60*16, 120*16 );
         drawArc( QRectF(x1, y1, size, size), 120*16, 120*16 );
+        m_drawCalls += 2;
     }
 }
 
@@ -774,6 +871,7 @@ void SkyQPainter::drawFlags()
         setPen( data->skyComposite()->flags()->labelColor( i ) );
         setFont( QFont( "Courier New", 10, QFont::Bold ) );
         drawText( pos.x()+10, pos.y()-10, data->skyComposite()->flags()->label( i ) );
+        m_drawCalls += 2;
     }
 }
 
@@ -790,6 +888,7 @@ void SkyQPainter::drawHorizon(bool filled, SkyPoint* labelPoint, bool* drawLabel
             groundPoly.append( groundPoly.first() );
             drawPolyline(groundPoly);
         }
+        ++m_drawCalls;
     }
 }
 
@@ -817,6 +916,7 @@ void SkyQPainter::drawSatellite( Satellite* sat ) {
         drawLine( QPoint( pos.x() + 0.5, pos.y() - 0.5 ), QPoint( pos.x() + 0.5, pos.y() + 0.5 ) );
         drawLine( QPoint( pos.x() + 0.5, pos.y() + 0.5 ), QPoint( pos.x() - 0.5, pos.y() + 0.5 ) );
         drawLine( QPoint( pos.x() - 0.5, pos.y() + 0.5 ), QPoint( pos.x() - 0.5, pos.y() - 0.5 ) );
+        m_drawCalls += 4;
     }
 
     if ( Options::showSatellitesLabels() )
@@ -838,5 +938,6 @@ bool SkyQPainter::drawSupernova(Supernova* sup)
     //qDebug()<<"Here"<<endl;
     drawLine ( QPoint( pos.x () - 2.0, pos.y() ), QPoint( pos.x() + 2.0, pos.y() ) );
     drawLine ( QPoint( pos.x (), pos.y() - 2.0 ), QPoint( pos.x(), pos.y() + 2.0 ) );
+    m_drawCalls += 2;
     return true;
 }
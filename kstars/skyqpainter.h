@@ -66,6 +66,10 @@ public:
 
     virtual void begin();
     virtual void end();
+
+    /** @return the number of QPainter drawing calls issued since begin(),
+     * i.e. in the current frame when drawing the sky map. */
+    inline int drawCallCount() const { return m_drawCalls; }
     
     /** Recalculates the star pixmaps. */
     static void initStarImages();
@@ -75,8 +79,11 @@ public:
     virtual void drawSkyLine(SkyPoint* a, SkyPoint* b);
     virtual void drawSkyPolyline(LineList* list, SkipList *skipList = 0,
                                  LineListLabel *label = 0);
+    virtual void beginLineBatch();
+    virtual void endLineBatch();
     virtual void drawSkyPolygon(LineList* list, bool forceClip=true);
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A');
+    virtual int drawPointSources(StarObject *const *stars, int count, bool *drawn = 0);
     virtual bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false);
     virtual bool drawPlanet(KSPlanetBase *planet);
     virtual void drawObservingList(const QList<SkyObject*>& obs);
@@ -93,10 +100,16 @@ public:
 private:
     virtual bool drawDeepSkyImage (const QPointF& pos, DeepSkyObject* obj,
                                          float positionAngle);
+    /** Draw the segments of m_lineBatch with one QPainter call */
+    void flushLineBatch();
+
     QPaintDevice *m_pd;
     const Projector* m_proj;
     bool m_vectorStars;
     QSize m_size;
+    QVector<QLineF> m_lineBatch; // Polyline segments waiting to be drawn
+    int m_lineBatchDepth;        // Number of beginLineBatch() without endLineBatch()
+    int m_drawCalls;             // QPainter drawing calls since begin()
     static int starColorMode;
     static QColor m_starColor;
     static QMap<char, QColor> ColorMap;
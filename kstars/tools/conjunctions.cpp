@@ -240,7 +240,6 @@ void ConjunctionsTool::slotCompute (void)
     if( Opposition->currentIndex() ) opposition = true;
     QStringList objects;                                // List of sky object used as Object1
     KStarsData *data = KStarsData::Instance();
-    int progress = 0;
 
     // Check if we have a valid angle in maxSeparationBox
     dms maxSeparation( 0.0 );
@@ -334,28 +333,31 @@ void ConjunctionsTool::slotCompute (void)
         objects.removeAll( "Iapetus" );
     }
 
+    // KSConjunct keeps processing events while it computes
+    ComputeButton->setEnabled( false );
+
     if ( FilterTypeComboBox->currentIndex() != 0 ) {
+        QList<SkyObject *> bodies;
+        foreach( const QString &object, objects ) {
+            SkyObject *body = data->skyComposite()->findByName( object );
+            if ( body )
+                bodies.append( body );
+        }
+
         // Show a progress dialog while processing
-        QProgressDialog progressDlg( i18n( "Compute conjunction..." ), i18n( "Abort" ), 0, objects.count(), this);
+        QProgressDialog progressDlg( i18n( "Compute conjunction..." ), i18n( "Abort" ), 0, 100, this);
         progressDlg.setWindowModality( Qt::WindowModal );
+        progressDlg.setLabelText( i18np( "Compute conjunctions between %2 and 1 object", "Compute conjunctions between %2 and %1 objects", bodies.count(), Object2->name() ) );
         progressDlg.setValue( 0 );
+        connect( &ksc, SIGNAL(madeProgress(int)), &progressDlg, SLOT(setValue(int)) );
+        connect( &progressDlg, SIGNAL(canceled()), &ksc, SLOT(cancel()) );
 
-        foreach( QString object, objects ) {
-            // If the user click on the 'cancel' button
-            if ( progressDlg.wasCanceled() )
-                break;
-
-            // Update progress dialog
-            ++progress;
-            progressDlg.setValue( progress );
-            progressDlg.setLabelText( i18n( "Compute conjunction between %1 and %2", Object2->name(), object ) );
+        // Compute conjunctions of all objects at once
+        QVector< QMap<long double, dms> > results = ksc.findClosestApproaches( bodies, *Object2, startJD, stopJD, maxSeparation, opposition );
+        for ( int i = 0; i < bodies.count(); ++i )
+            showConjunctions( results.at( i ), bodies.at( i )->name(), Object2->name() );
 
-            // Compute conjuction
-            Object1 = data->skyComposite()->findByName( object );
-            showConjunctions( ksc.findClosestApproach(*Object1, *Object2, startJD, stopJD, maxSeparation, opposition), object, Object2->name() );
-        }
-
-        progressDlg.setValue( objects.count() );
+        progressDlg.setValue( 100 );
     } else {
         // Change cursor while we search for conjunction
         QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
@@ -368,6 +370,8 @@ void ConjunctionsTool::slotCompute (void)
         QApplication::restoreOverrideCursor();
     }
 
+    ComputeButton->setEnabled( true );
+
     delete Object2;
     Object2 = NULL;
 }
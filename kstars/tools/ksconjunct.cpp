@@ -19,6 +19,12 @@
 
 #include <cmath>
 
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include "Options.h"
 #include "ksnumbers.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skyobjects/ksplanet.h"
@@ -26,179 +32,239 @@
 #include "skyobjects/kscomet.h"
 #include "kstarsdata.h"
 
-KSConjunct::KSConjunct() {
-    geoPlace = KStarsData::Instance()->geo();
+// Conjunctions are located to this many days
+#define PRECISION ( 1.0 / ( 24.0 * 60.0 ) )
+
+KSConjunct::KSConjunct() : opposition( false ), m_StartJD( 0 ), m_Step( 1.0 ) {
+    geoPlace = KStarsData::Instance() ? KStarsData::Instance()->geo() : NULL;
+    m_Earth = new KSPlanet( I18N_NOOP( "Earth" ), QString(), QColor( "white" ), 12756.28 /*diameter in km*/ );
+    m_Earth->loadData();
+}
+
+KSConjunct::~KSConjunct() {
+    delete m_Earth;
 }
 
 void KSConjunct::setGeoLocation( GeoLocation *geo ) {
     if( geo != NULL )
         geoPlace = geo;
-    else
+    else if( KStarsData::Instance() )
         geoPlace = KStarsData::Instance()->geo();
 }
 
+void KSConjunct::cancel() {
+    m_Canceled.store( 1 );
+}
+
 QMap<long double, dms> KSConjunct::findClosestApproach(SkyObject& Object1, KSPlanetBase& Object2, long double startJD, long double stopJD, dms maxSeparation,bool _opposition) {
+    return findClosestApproaches( QList<SkyObject *>() << &Object1, Object2, startJD, stopJD, maxSeparation, _opposition ).first();
+}
 
-  QMap<long double, dms> Separations;
-  QPair<long double, dms> extremum;
-  dms Dist;
-  dms prevDist;
-  double step, step0;
-  int Sign, prevSign;
-  opposition=_opposition;
-  //  qDebug() << "Entered KSConjunct::findClosestApproach() with startJD = " << (double)startJD;
-  //  qDebug() << "Initial Positional Information: \n";
-  //  qDebug() << Object1.name() << ": RA = " << Object1.ra() -> toHMSString() << "; Dec = " << Object1.dec() -> toDMSString() << "\n";
-  //  qDebug() << Object2.name() << ": RA = " << Object2.ra() -> toHMSString() << "; Dec = " << Object2.dec() -> toDMSString() << "\n";
-  prevSign = 0;
-
-  step0 = (stopJD - startJD) / 4.0;  // I'm an idiot for having done this without having the lines that follow -- asimha
-
-  // TODO: Work out a solid footing on which one can decide step0. -- asimha
-  if( step0 > 24.8 * 365.25 ) // Sample pluto's orbit (248.09 years) at least 10 times.
-      step0 = 24.8 * 365.25;
-
-  // FIXME: This can be done better, but for now, I'm doing it the dumb way -- asimha
-  if( Object1.name() == i18n( "Neptune" ) || Object2.name() == i18n( "Neptune" ) || Object1.name() == i18n( "Uranus" ) || Object2.name() == i18n( "Uranus" ) )
-      if( step0 > 3652.5 )
-          step0 = 3652.5;
-  if( Object1.name() == i18n( "Jupiter" ) || Object2.name() == i18n( "Jupiter" ) || Object1.name() == i18n( "Saturn" ) || Object2.name() == i18n( "Saturn" ) )
-      if( step0 > 365.25 )
-          step0 = 365;
-  if(Object1.name() == i18n( "Mars" ) || Object2.name() == i18n( "Mars" ))
-    if (step0 > 10.0)
-      step0 = 10.0;
-  if(Object1.name() == i18n( "Venus" ) || Object1.name() == i18n( "Mercury" ) || Object2.name() == i18n( "Mercury" ) || Object2.name() == i18n( "Venus" ))
-    if (step0 > 5.0)
-      step0 = 5.0;
-  if(Object1.name() == "Moon" || Object2.name() == "Moon")
-    if (step0 > 0.25)
-      step0 = 0.25;
-
-  step = step0;
-
-  //	qDebug() << "Initial Separation between " << Object1.name() << " and " << Object2.name() << " = " << (prevDist.toDMSString());
-
-  long double jd = startJD;
-  prevDist = findDistance(jd, &Object1, &Object2);
-  jd += step;
-  while ( jd <= stopJD ) {
-    int progress = int( 100.0*(jd - startJD)/(stopJD - startJD) );
-    emit madeProgress( progress );
-
-    Dist = findDistance(jd, &Object1, &Object2);
-    Sign = sgn(Dist - prevDist);
-    //	qDebug() << "Dist = " << Dist.toDMSString() << "; prevDist = " << prevDist.toDMSString() << "; Difference = " << (Dist.Degrees() - prevDist.Degrees()) << "; Step = " << step;
-
-    //How close are we to a conjunction, and how fast are we approaching one?
-    double factor = fabs( (Dist.Degrees() - prevDist.Degrees()) / Dist.Degrees());
-    if ( factor > 10.0 ) { //let's go faster!
-        step = step0 * factor/10.0;
-    } else { //slow down, we're getting close!
-        step = step0;
+QVector< QMap<long double, dms> > KSConjunct::findClosestApproaches( const QList<SkyObject *> &objects, KSPlanetBase &Object2, long double startJD, long double stopJD, dms maxSeparation, bool _opposition ) {
+    QVector< QMap<long double, dms> > Separations( objects.size() );
+    if( objects.isEmpty() || stopJD <= startJD || ! geoPlace )
+        return Separations;
+
+    opposition = _opposition;
+    m_StartJD = startJD;
+    m_MaxSeparation = maxSeparation;
+    m_Canceled.store( 0 );
+    m_SamplesDone.store( 0 );
+
+    // All objects are sampled on the same grid, at the finest step any of them needs
+    m_Step = ( stopJD - startJD ) / 4.0;
+    foreach( SkyObject *object, objects )
+        m_Step = qMin( m_Step, sampleStep( object, &Object2, startJD, stopJD ) );
+    const int nSamples = int( ( stopJD - startJD ) / m_Step ) + 1;
+
+    // SkyPoint::checkBendLight() looks up the Sun lazily and caches it
+    // in a static member. Make sure that happens here, and not
+    // concurrently from the workers.
+    if( Options::useRelativistic() && KStarsData::Instance() )
+        objects.first()->checkBendLight();
+
+    // The track of the planet is shared by all objects
+    m_Track.resize( nSamples );
+    for( int i = 0; i < nSamples; ++i ) {
+        findPositions( startJD + i * m_Step, m_Earth, &Object2 );
+        m_Track[i] = SkyPoint( Object2.ra(), Object2.dec() );
     }
 
-    if( Sign != prevSign && prevSign == -1) { //all right, we may have just passed a conjunction
-        if ( step > step0 ) { //mini-loop to back up and make sure we're close enough
-            //            qDebug() << "Entering slow loop: " << endl;
-            jd -= step;
-            step = step0;
-            Sign = prevSign;
-            while ( jd <= stopJD ) {
-                Dist = findDistance(jd, &Object1, &Object2);
-                Sign = sgn(Dist - prevDist);
-                //	qDebug() << "Dist=" << Dist.toDMSString() << "; prevDist=" << prevDist.toDMSString() << "; Diff=" << (Dist.Degrees() - prevDist.Degrees()) << "djd=" << (int)(jd - startJD);
-                if ( Sign != prevSign ) break;
-
-                prevDist = Dist;
-                prevSign = Sign;
-                jd += step;
-            }
+    // Every task works on its own copies of the bodies. They are set up
+    // here because copying some of them touches static data.
+    QVector<ConjunctionTask> tasks( objects.size() );
+    for( int i = 0; i < objects.size(); ++i ) {
+        ConjunctionTask &task = tasks[i];
+        task.object = objects.at( i )->clone();
+        task.planet = static_cast<KSPlanetBase *>( Object2.clone() );
+        task.earth = m_Earth->clone();
+        foreach( SkyObject *body, QList<SkyObject *>() << task.object << task.planet ) {
+            TrailObject *trail = dynamic_cast<TrailObject *>( body );
+            if( trail )
+                trail->clearTrail();
         }
-
-        //	qDebug() << "Sign = " << Sign << " and " << "prevSign = " << prevSign << ": Entering findPrecise()\n";
-        if(findPrecise(&extremum, &Object1, &Object2, jd, step, Sign))
-            if(extremum.second.radians() < maxSeparation.radians())
-                Separations.insert(extremum.first, extremum.second);
     }
 
-    prevDist = Dist;
-    prevSign = Sign;
-    jd += step;
-  }
-
-  return Separations;
+    const int total = nSamples * tasks.size();
+    QEventLoop loop;
+    QTimer progressTimer;
+    QFutureWatcher<void> watcher;
+    connect( &progressTimer, &QTimer::timeout, [this, total]() {
+        emit madeProgress( int( 100.0 * m_SamplesDone.load() / total ) );
+    } );
+    connect( &watcher, SIGNAL( finished() ), &loop, SLOT( quit() ) );
+    watcher.setFuture( QtConcurrent::map( tasks, [this]( ConjunctionTask &task ) {
+        searchTask( task );
+    } ) );
+    progressTimer.start( 100 );
+    loop.exec();
+    progressTimer.stop();
+    emit madeProgress( 100 );
+
+    for( int i = 0; i < tasks.size(); ++i ) {
+        Separations[i] = tasks[i].result;
+        delete tasks[i].object;
+        delete tasks[i].planet;
+        delete tasks[i].earth;
+    }
+    m_Track.clear();
+    return Separations;
 }
 
+void KSConjunct::searchTask( ConjunctionTask &task ) {
+    const int nSamples = m_Track.size();
+    double prevDist = 0, Dist = 0, nextDist = 0;
 
-dms KSConjunct::findDistance(long double jd, SkyObject *Object1, KSPlanetBase *Object2)
-{
-  KStarsDateTime t(jd);
-  KSNumbers num(jd);
-  dms dist;
-
-  KSPlanet *m_Earth = new KSPlanet( I18N_NOOP( "Earth" ), QString(), QColor( "white" ), 12756.28 /*diameter in km*/ );
-  m_Earth -> findPosition( &num );
-  CachingDms LST(geoPlace->GSTtoLST(t.gst()));
-
-  KSPlanetBase* p = dynamic_cast<KSPlanetBase*>(Object1);
-  if( p )
-      p->findPosition(&num, geoPlace->lat(), &LST, m_Earth);
-  else
-      Object1->updateCoordsNow( &num );
-
-  Object2->findPosition(&num, geoPlace->lat(), &LST, m_Earth);
-  dist.setRadians(Object1 -> angularDistanceTo(Object2).radians());
-  if( opposition ) {
-      dist.setD( 180 - dist.Degrees() );
-  }
-  return dist;
-}
+    for( int i = 0; i < nSamples; ++i ) {
+        if( m_Canceled.load() ) {
+            task.result.clear();
+            return;
+        }
 
-bool KSConjunct::findPrecise(QPair<long double, dms> *out, SkyObject *Object1, KSPlanetBase *Object2, long double jd, double step, int prevSign) {
-  dms prevDist;
-  int Sign;
-  dms Dist;
-
-  if( out == NULL ) {
-    qDebug() << "ERROR: Argument out to KSConjunct::findPrecise(...) was NULL!";
-    return false;
-  }
-
-  prevDist = findDistance(jd, Object1, Object2);
-
-  step = -step / 2.0;
-  prevSign = -prevSign;
-
-  while(true) {
-    jd += step;
-    Dist = findDistance(jd, Object1, Object2);
-    //    qDebug() << "Dist=" << Dist.toDMSString() << "; prevDist=" << prevDist.toDMSString() << "; Diff=" << (Dist.Degrees() - prevDist.Degrees()) << "step=" << step;
-
-    if(fabs(step) < 1.0 / (24.0*60.0) ) {
-      out -> first = jd - step / 2.0;
-      out -> second = findDistance(jd - step/2.0, Object1, Object2);
-      if(out -> second.radians() < findDistance(jd - 5.0, Object1, Object2).radians())
-        return true;
-      else
-        return false;
+        findPositions( m_StartJD + i * m_Step, task.earth, task.object );
+        prevDist = Dist;
+        Dist = nextDist;
+        nextDist = findDistance( task.object, &m_Track.at( i ) );
+        m_SamplesDone.ref();
+
+        // Samples i - 2, i - 1 and i bracket a minimum at i - 1
+        if( i >= 2 && Dist < prevDist && Dist <= nextDist ) {
+            QPair<long double, dms> extremum;
+            findPrecise( task, m_StartJD + ( i - 2 ) * m_Step, m_StartJD + ( i - 1 ) * m_Step, m_StartJD + i * m_Step, Dist, &extremum );
+            if( extremum.second.radians() < m_MaxSeparation.radians() )
+                task.result.insert( extremum.first, extremum.second );
+        }
     }
-    Sign = sgn(Dist - prevDist);
-    if(Sign != prevSign) {
-      step = -step / 2.0;
-      Sign = -Sign;
+}
+
+void KSConjunct::findPositions( long double jd, KSPlanetBase *Earth, SkyObject *Object1, SkyObject *Object2 ) {
+    KStarsDateTime t(jd);
+    KSNumbers num(jd);
+
+    Earth->findPosition( &num );
+    CachingDms LST(geoPlace->GSTtoLST(t.gst()));
+
+    foreach( SkyObject *object, QList<SkyObject *>() << Object1 << Object2 ) {
+        if( ! object )
+            continue;
+        KSPlanetBase* p = dynamic_cast<KSPlanetBase*>(object);
+        if( p )
+            p->findPosition(&num, geoPlace->lat(), &LST, Earth);
+        else
+            object->updateCoordsNow( &num );
     }
-    prevSign = Sign;
-    prevDist = Dist;
-  }
 }
 
-int KSConjunct::sgn(dms a) {
+double KSConjunct::findDistance( const SkyPoint *p1, const SkyPoint *p2 ) const {
+    double dist = p1->angularDistanceTo( p2 ).radians();
+    return opposition ? dms::PI - dist : dist;
+}
 
-  // Auxiliary function used by the KSConjunct::findClosestApproach(...)
-  // method and the KSConjunct::findPrecise(...) method
+void KSConjunct::findPrecise( ConjunctionTask &task, long double a, long double b, long double c, double fb, QPair<long double, dms> *out ) {
+    // Brent's method for the minimum of a function, see e.g. Numerical
+    // Recipes, section 10.2. Times are in days relative to a.
+    const double CGOLD = 0.3819660112501051;
+    const double tol = PRECISION / 2.0;
+
+    double lo = 0.0, hi = double( c - a );
+    double x = double( b - a ), w = x, v = x;
+    double fx = fb, fw = fb, fv = fb;
+    double d = 0.0, e = 0.0;
+
+    for( int iter = 0; iter < 100; ++iter ) {
+        double xm = 0.5 * ( lo + hi );
+        if( fabs( x - xm ) <= 2.0 * tol - 0.5 * ( hi - lo ) )
+            break;
+
+        if( fabs( e ) > tol ) {
+            // Try a parabolic step through x, w and v
+            double r = ( x - w ) * ( fx - fv );
+            double q = ( x - v ) * ( fx - fw );
+            double p = ( x - v ) * q - ( x - w ) * r;
+            q = 2.0 * ( q - r );
+            if( q > 0.0 )
+                p = -p;
+            q = fabs( q );
+            double etemp = e;
+            e = d;
+            if( fabs( p ) >= fabs( 0.5 * q * etemp ) || p <= q * ( lo - x ) || p >= q * ( hi - x ) ) {
+                e = ( x >= xm ) ? lo - x : hi - x;
+                d = CGOLD * e;
+            } else {
+                d = p / q;
+                double u = x + d;
+                if( u - lo < 2.0 * tol || hi - u < 2.0 * tol )
+                    d = ( xm >= x ) ? tol : -tol;
+            }
+        } else {
+            // Golden section step into the larger part of the bracket
+            e = ( x >= xm ) ? lo - x : hi - x;
+            d = CGOLD * e;
+        }
 
-  return ((a.radians() > 0)?1:((a.radians() < 0)?-1:0));
+        double u = ( fabs( d ) >= tol ) ? x + d : x + ( d >= 0.0 ? tol : -tol );
+        findPositions( a + u, task.earth, task.object, task.planet );
+        double fu = findDistance( task.object, task.planet );
+
+        if( fu <= fx ) {
+            if( u >= x )
+                lo = x;
+            else
+                hi = x;
+            v = w; fv = fw;
+            w = x; fw = fx;
+            x = u; fx = fu;
+        } else {
+            if( u < x )
+                lo = u;
+            else
+                hi = u;
+            if( fu <= fw || w == x ) {
+                v = w; fv = fw;
+                w = u; fw = fu;
+            } else if( fu <= fv || v == x || v == w ) {
+                v = u; fv = fu;
+            }
+        }
+    }
 
+    out->first = a + x;
+    out->second.setRadians( fx );
 }
 
+double KSConjunct::sampleStep( const SkyObject *Object1, const KSPlanetBase *Object2, long double startJD, long double stopJD ) const {
+    // The separation is sampled often enough that there is at most one
+    // minimum between three consecutive samples. The outer planets are
+    // dominated by the motion of the Earth, which makes them loop back
+    // within a few months.
+    double step = qMin( double( ( stopJD - startJD ) / 4.0 ), 10.0 );
+
+    if( Object1->name() == i18n( "Venus" ) || Object1->name() == i18n( "Mercury" ) || Object1->name() == i18n( "Sun" ) ||
+        Object2->name() == i18n( "Venus" ) || Object2->name() == i18n( "Mercury" ) || Object2->name() == i18n( "Sun" ) ||
+        Object1->type() == SkyObject::ASTEROID || Object1->type() == SkyObject::COMET )
+        step = qMin( step, 5.0 );
+    if( Object1->type() == SkyObject::MOON || Object2->type() == SkyObject::MOON )
+        step = qMin( step, 0.25 );
+
+    return step;
+}
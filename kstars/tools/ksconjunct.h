@@ -21,6 +21,9 @@
 
 #include <QMap>
 #include <QObject>
+#include <QPair>
+#include <QVector>
+#include <QAtomicInt>
 
 #include "dms.h"
 #include "skyobjects/skyobject.h"
@@ -39,9 +42,14 @@ class dms;
   *A class that implements a method to compute close conjunctions between any two solar system
   *objects excluding planetary moons. Given two such objects, this class has implementations of
   *algorithms required to find the time of closest approach in a given range of time.
+  *
+  *The search samples the separation of the objects on a regular grid of times, brackets every
+  *local minimum between three samples and then locates it with Brent's method. When several
+  *objects are tested against the same planet, the position of the planet on the grid is
+  *computed once and shared, and the objects are searched in parallel on the global thread pool.
   *@short Implements algorithms to find close conjunctions of planets in a given time range.
   *@author Akarsh Simha
-  *@version 1.0
+  *@version 2.0
   */
 
 class KSConjunct :public QObject {
@@ -49,16 +57,16 @@ class KSConjunct :public QObject {
  
  public:
   /**
-    *Constructor.  Instantiates a KSNumbers for internal computations.
+    *Constructor.  Uses the current geographic location of KStarsData, if any.
     */
   
   KSConjunct();
 
   /**
-   *Destructor.  (Empty)
+   *Destructor.
    */
 
-  ~KSConjunct() { }
+  ~KSConjunct();
 
   /**
    *@short Sets the geographic location to compute conjunctions at
@@ -81,54 +89,99 @@ class KSConjunct :public QObject {
    */
 
   QMap<long double, dms> findClosestApproach(SkyObject& Object1, KSPlanetBase& Object2, long double startJD, long double stopJD, dms maxSeparation, bool _opposition=false);
-  
+
+  /**
+   *@short Compute the closest approaches of each of several objects to a planet in the given range
+   *
+   *The objects are searched concurrently. This method keeps processing events of the calling
+   *thread while it waits, so that madeProgress() is delivered and cancel() can be called.
+   *The objects themselves are not modified; the search works on copies of them.
+   *
+   *@param objects  The objects to test against Object2
+   *@param Object2  The planet
+   *@param startJD  Julian Day corresponding to start of the calculation period
+   *@param stopJD   Julian Day corresponding to end of the calculation period
+   *@param maxSeparation   Maximum separation of the conjunctions to be output
+   *@param opposition A parameter to see if we are computing conjunction or opposition
+   *@return For every object, in the same order, the julian days of close conjunctions against
+   *        separation. If the search was canceled, the objects that were not done yet have no entries.
+   */
+
+  QVector< QMap<long double, dms> > findClosestApproaches( const QList<SkyObject *> &objects, KSPlanetBase &Object2, long double startJD, long double stopJD, dms maxSeparation, bool _opposition=false );
+
+ public slots:
+  /**
+   *@short Stop a running findClosestApproaches() as soon as possible. Thread-safe.
+   */
+  void cancel();
+
  signals:
+  /** Emitted with the percentage of the search done so far */
   void madeProgress( int progress );
 
  private:
 
   /**
-    *@short Finds the angular distance between two solar system objects.
+    *@class ConjunctionTask
+    *The private copies of the bodies used to search the conjunctions of one object
+    */
+  struct ConjunctionTask {
+    SkyObject *object;        // Copy of the object tested against the planet
+    KSPlanetBase *planet;     // Copy of the planet, for the refinement of minima
+    KSPlanetBase *earth;      // Copy of the Earth
+    QMap<long double, dms> result;
+  };
+
+  /**
+    *@short Compute the positions of the Earth and of the given objects at a given time
     *
     *@param jd  Julian Day corresponding to the time of computation
-    *@param Object1  A pointer to the first solar system object
-    *@param Object2  A pointer to the second solar system object
-    *
-    *@return The angular distance between the two bodies.
+    *@param Earth  A pointer to the Earth
+    *@param Object1  A pointer to the first object
+    *@param Object2  A pointer to the second object, or NULL
     */
 
-  // TODO: Make pointers to Object1 and Object2 private objects instead of passing them to the methods again and again. 
-  //       Should improve performance, at least marginally.
-
-  dms findDistance(long double jd, SkyObject *Object1, KSPlanetBase *Object2);
+  void findPositions(long double jd, KSPlanetBase *Earth, SkyObject *Object1, SkyObject *Object2=NULL);
 
   /**
-    *@short Compute the precise value of the extremum once the extremum has been detected.
-    *
-    *@param out  A pointer to a QPair that stores the Julian Day and Separation corresponding to the extremum
-    *@param Object1  A pointer to the first solar system body
-    *@param Object2  A pointer to the second solar system body
-    *@param jd  Julian day corresponding to the endpoint of the interval where extremum was detected.
-    *@param step  The step in jd taken during computation earlier. (Defines the interval size)
-    *@param prevSign The previous sign of increment in moving from jd - step to jd
-    *
-    *@return true if the extremum is a minimum
+    *@return The angular distance between the two points, in radians. For oppositions,
+    *        this is 180 degrees minus the angular distance.
     */
 
-  bool findPrecise(QPair<long double, dms> *out, SkyObject *Object1, KSPlanetBase *Object2, long double jd, double step, int prevSign);
+  double findDistance(const SkyPoint *p1, const SkyPoint *p2) const;
 
   /**
-    *@short Return the sign of an angle
-    *
-    *@param a  The angle whose sign has to be returned
+    *@short Search the conjunctions of one object over the sampling grid
+    */
+  void searchTask( ConjunctionTask &task );
+
+  /**
+    *@short Locate the minimum of the distance in the bracket a < b < c with Brent's method
     *
-    *@return (-1, 0, 1) if a.radians() is (-ve, zero, +ve)
+    *@param task  The bodies to compute the distance of
+    *@param a, b, c  Julian Days with distance(b) < distance(a), distance(c)
+    *@param fb  The distance at b
+    *@param out  The Julian Day and distance of the minimum are returned here
     */
+  void findPrecise( ConjunctionTask &task, long double a, long double b, long double c, double fb, QPair<long double, dms> *out );
 
-  int sgn(dms a);
+  /**
+    *@return the interval at which the separation of the two objects must be sampled so that
+    *        no conjunction is missed
+    */
+  double sampleStep( const SkyObject *Object1, const KSPlanetBase *Object2, long double startJD, long double stopJD ) const;
 
   bool opposition;
   GeoLocation *geoPlace;
+  KSPlanet *m_Earth;
+
+  // State of the running search, shared by all tasks
+  long double m_StartJD;
+  double m_Step;
+  dms m_MaxSeparation;
+  QVector<SkyPoint> m_Track;     // Position of the planet at every sample
+  QAtomicInt m_Canceled;
+  QAtomicInt m_SamplesDone;
 };
 
 #endif
@@ -22,6 +22,8 @@
 #include <QDoubleSpinBox>
 #include <QPushButton>
 #include <QDialogButtonBox>
+#include <QProgressDialog>
+#include <QSet>
 
 #include "kstarsdata.h"
 #include "geolocation.h"
@@ -33,6 +35,7 @@
 #include "widgets/magnitudespinbox.h"
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/skymapcomposite.h"
+#include "tools/visibilityengine.h"
 
 ObsListWizardUI::ObsListWizardUI( QWidget *p ) : QFrame ( p ) {
     setupUi( this );
@@ -388,6 +391,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
     KStarsData* data = KStarsData::Instance();
     if ( doBuildList )
         obsList().clear();
+    ObservableCandidates.clear();
 
     //We don't need to call applyRegionFilter() if no region filter is selected, *and*
     //we are just counting items (i.e., doBuildList is false)
@@ -451,7 +455,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                 filterPass = applyRegionFilter( o, doBuildList, !doBuildList);
             //Filter objects visible from geo at Date if region filter passes
             if ( olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter( o, doBuildList, !doBuildList);
+                ObservableCandidates.append( o );
         }
     }
 
@@ -470,7 +474,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName("Sun"), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Sun"), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName("Sun") );
 
             if (maglimit < data->skyComposite()->findByName("Moon")->mag())
             {
@@ -483,7 +487,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName("Moon"), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Moon"), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName("Moon") );
 
             if (maglimit < data->skyComposite()->findByName("Mercury")->mag())
             {
@@ -496,7 +500,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                 applyObservableFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
+                 ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Mercury" )) );
 
             if (maglimit < data->skyComposite()->findByName("Venus")->mag())
             {
@@ -510,7 +514,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Venus" )) );
 
             if (maglimit < data->skyComposite()->findByName("Mars")->mag())
             {
@@ -523,7 +527,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Mars" )) );
 
             if (maglimit < data->skyComposite()->findByName("Jupiter")->mag())
             {
@@ -536,7 +540,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Jupiter" )) );
 
             if (maglimit < data->skyComposite()->findByName("Saturn")->mag())
             {
@@ -550,7 +554,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Saturn" )) );
 
             if (maglimit < data->skyComposite()->findByName("Uranus")->mag())
             {
@@ -564,7 +568,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Uranus" )) );
 
             if (maglimit < data->skyComposite()->findByName("Neptune")->mag())
             {
@@ -579,7 +583,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Neptune" )) );
 
             if (maglimit < data->skyComposite()->findByName("Pluto")->mag())
             {
@@ -593,7 +597,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             if ( needRegion && filterPass)
                 filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
             if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
+                ObservableCandidates.append( data->skyComposite()->findByName(i18n( "Pluto" )) );
         }
 
     //Deep sky objects
@@ -656,7 +660,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                             if ( needRegion )
                                 filterPass = applyRegionFilter( o, doBuildList );
                             if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
+                                ObservableCandidates.append( o );
                         }
                         else if ( ! doBuildList )
                             --ObjectCount;
@@ -668,7 +672,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                             if ( needRegion )
                                 filterPass = applyRegionFilter( o, doBuildList );
                             if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
+                                ObservableCandidates.append( o );
                         } else if ( ! doBuildList )
                             --ObjectCount;
                     }
@@ -678,7 +682,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                     if ( needRegion )
                         filterPass = applyRegionFilter( o, doBuildList );
                     if ( olw->SelectByDate->isChecked() && filterPass)
-                        applyObservableFilter( o, doBuildList );
+                        ObservableCandidates.append( o );
                 }
             }
         }
@@ -698,7 +702,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                         if ( needRegion )
                             filterPass = applyRegionFilter( o, doBuildList );
                         if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                            ObservableCandidates.append( o );
                     }
                     else if ( ! doBuildList )
                             --ObjectCount;
@@ -710,7 +714,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                         if ( needRegion )
                             filterPass = applyRegionFilter( o, doBuildList );
                         if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                            ObservableCandidates.append( o );
                     }
                     else if ( ! doBuildList )
                             --ObjectCount;
@@ -721,7 +725,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                 if ( needRegion )
                     filterPass = applyRegionFilter( o, doBuildList );
                 if ( olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter( o, doBuildList );
+                    ObservableCandidates.append( o );
             }
         }
     }
@@ -740,7 +744,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                         if ( needRegion )
                             filterPass = applyRegionFilter( o, doBuildList );
                         if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                            ObservableCandidates.append( o );
                     }
                     else if ( ! doBuildList )
                         --ObjectCount;
@@ -752,7 +756,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                         if ( needRegion )
                             filterPass = applyRegionFilter( o, doBuildList );
                         if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                            ObservableCandidates.append( o );
                     }
                     else if ( ! doBuildList )
                         --ObjectCount;
@@ -763,11 +767,15 @@ void ObsListWizard::applyFilters( bool doBuildList )
                 if ( needRegion )
                     filterPass = applyRegionFilter( o, doBuildList );
                 if ( olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter( o, doBuildList );
+                    ObservableCandidates.append( o );
             }
         }
     }
 
+    //Filter all objects visible from geo at Date at once
+    if ( olw->SelectByDate->isChecked() )
+        applyObservableFilter( doBuildList );
+
     //Update the object count label
     if ( doBuildList )
         ObjectCount = obsList().size();
@@ -858,12 +866,10 @@ bool ObsListWizard::applyRegionFilter( SkyObject *o, bool doBuildList,
     return true;
 }
 
-bool ObsListWizard::applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount)
+void ObsListWizard::applyObservableFilter( bool doBuildList )
 {
-    SkyPoint p = *o;
-
-    //Check altitude of object every hour from 18:00 to midnight
-    //If it's ever above 15 degrees, flag it as visible
+    //Check whether each candidate is between minAlt and maxAlt at any time
+    //from 18:00 to midnight, local time
     KStarsDateTime Evening( olw->Date->date(), QTime( 18, 0, 0 ) );
     KStarsDateTime Midnight( olw->Date->date().addDays(1), QTime( 0, 0, 0 ) );
     double minAlt=15, maxAlt=90;
@@ -882,30 +888,42 @@ bool ObsListWizard::applyObservableFilter( SkyObject *o, bool doBuildList, bool
         maxAlt = olw->maxAlt->value();
     }
 
-    bool visible = false;
-    for ( KStarsDateTime t = Evening; t < Midnight; t = t.addSecs( 3600.0 ) )
-    {
-        dms LST = geo->GSTtoLST( t.gst() );
-        p.EquatorialToHorizontal( &LST, geo->lat() );
+    KStarsDateTime start = geo->LTtoUT( Evening );
+    VisibilityEngine engine;
+    engine.setPeriod( start, start.secsTo( geo->LTtoUT( Midnight ) ), geo );
 
-        if ( p.alt().Degrees() >= minAlt && p.alt().Degrees() <= maxAlt )
-        {
-            visible = true;
-            break;
-        }
-    }
+    QProgressDialog progressDlg( i18n( "Checking visibility..." ), i18n( "Abort" ), 0, 100, this );
+    progressDlg.setWindowModality( Qt::WindowModal );
+    progressDlg.setMinimumDuration( 1000 );
+    connect( &engine, SIGNAL(madeProgress(int)), &progressDlg, SLOT(setValue(int)) );
+    connect( &progressDlg, SIGNAL(canceled()), &engine, SLOT(cancel()) );
 
+    // Objects not reached by an aborted computation are left out
+    QVector<VisibilityEngine::Result> results = engine.compute( ObservableCandidates );
 
-    if (visible )
-        return true;
+    QSet<SkyObject*> rejected;
+    for ( int i = 0; i < ObservableCandidates.size(); ++i )
+    {
+        if ( results.at(i).reaches( minAlt, maxAlt ) )
+            continue;
 
-    if ( doAdjustCount )
+        if ( doBuildList )
+            rejected.insert( ObservableCandidates.at(i) );
+        else
             --ObjectCount;
-    if ( doBuildList )
-            obsList().takeAt( obsList().indexOf(o) );
+    }
 
-    return false;
+    if ( ! rejected.isEmpty() )
+    {
+        QList<SkyObject*> visible;
+        visible.reserve( obsList().size() - rejected.size() );
+        foreach ( SkyObject *o, obsList() )
+        {
+            if ( ! rejected.contains( o ) )
+                visible.append( o );
+        }
+        obsList() = visible;
+    }
 
+    ObservableCandidates.clear();
 }
-
-
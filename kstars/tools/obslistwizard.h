@@ -71,7 +71,11 @@ private:
     void applyFilters( bool doBuildList );
     /** @return true if the object passes the filter region constraints, false otherwise.*/
     bool applyRegionFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true );
-    bool applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true);
+    /**
+    	*Remove the objects collected in ObservableCandidates that are never between the
+    	*selected altitudes during the selected time, from the list or from the count.
+    	*/
+    void applyObservableFilter( bool doBuildList );
 
     /**
     	*Convenience function for safely getting the selected state of a QListWidget item by name.
@@ -93,6 +97,7 @@ private:
     void setItemSelected( const QString &name, QListWidget *listWidget, bool value, bool *ok=0 );
 
     QList<SkyObject*> ObsList;
+    QList<SkyObject*> ObservableCandidates; // Objects that passed the other filters, for applyObservableFilter()
     ObsListWizardUI *olw;
     uint ObjectCount, StarCount, PlanetCount, CometCount, AsteroidCount;
     uint GalaxyCount, OpenClusterCount, GlobClusterCount, GasNebCount, PlanNebCount;
@@ -26,6 +26,10 @@
 
 #include <QList>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 
 QList<StarObject *> * StarHopper::computePath( const SkyPoint &src, const SkyPoint &dest, float fov__, float maglim__, QStringList *metadata_ ) {
     QList<const StarObject *> starHopList_const = computePath_const( src, dest, fov__, maglim__, metadata_ );
@@ -36,6 +40,83 @@ QList<StarObject *> * StarHopper::computePath( const SkyPoint &src, const SkyPoi
     return starHopList_unconst;
 }
 
+StarHopper::StarHopper() : fov( 0 ), maglim( 0 ), start( 0 ), end( 0 ) {
+}
+
+StarHopper::~StarHopper() {
+}
+
+void StarHopper::collectStars( QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim ) {
+    // starsInAperture() needs (RA0, Dec0) of the center
+    SkyPoint centerJ2000( center );
+    centerJ2000.deprecess( KStarsData::Instance()->updateNum() );
+    StarComponent::Instance()->starsInAperture( list, centerJ2000, radius, maglim );
+}
+
+void StarHopper::StarIndex::build( const QList<StarObject *> &stars ) {
+    m_Nodes.resize( stars.size() );
+    for( int i = 0; i < stars.size(); ++i ) {
+        StarObject *star = stars.at( i );
+        double sinRA, cosRA, sinDec, cosDec;
+        star->ra().SinCos( sinRA, cosRA );
+        star->dec().SinCos( sinDec, cosDec );
+        Node &node = m_Nodes[ i ];
+        node.p[0] = cosDec * cosRA;
+        node.p[1] = cosDec * sinRA;
+        node.p[2] = sinDec;
+        node.mag = star->mag();
+        node.star = star;
+    }
+    build( 0, m_Nodes.size(), 0 );
+}
+
+void StarHopper::StarIndex::build( int begin, int end, int axis ) {
+    if( end - begin < 2 )
+        return;
+    int mid = ( begin + end ) / 2;
+    std::nth_element( m_Nodes.begin() + begin, m_Nodes.begin() + mid, m_Nodes.begin() + end,
+                      [axis]( const Node &a, const Node &b ) { return a.p[ axis ] < b.p[ axis ]; } );
+    build( begin, mid, ( axis + 1 ) % 3 );
+    build( mid + 1, end, ( axis + 1 ) % 3 );
+}
+
+void StarHopper::StarIndex::starsWithin( QVector<int> &list, const SkyPoint &center, double radius, float maglim ) const {
+    double sinRA, cosRA, sinDec, cosDec;
+    center.ra().SinCos( sinRA, cosRA );
+    center.dec().SinCos( sinDec, cosDec );
+    double p[3] = { cosDec * cosRA, cosDec * sinRA, sinDec };
+
+    // Squared length of the chord subtending the radius
+    double chord2 = 2.0 - 2.0 * cos( radius * dms::DegToRad );
+    search( 0, m_Nodes.size(), 0, p, chord2, maglim, list );
+}
+
+void StarHopper::StarIndex::search( int begin, int end, int axis, const double p[3], double chord2, float maglim, QVector<int> &list ) const {
+    while( begin < end ) {
+        int mid = ( begin + end ) / 2;
+        const Node &node = m_Nodes.at( mid );
+        double dx = p[0] - node.p[0], dy = p[1] - node.p[1], dz = p[2] - node.p[2];
+        if( dx * dx + dy * dy + dz * dz <= chord2 && node.mag <= maglim )
+            list.append( mid );
+
+        double d = p[ axis ] - node.p[ axis ];
+        int next = ( axis + 1 ) % 3;
+        // Descend into the side of the split that holds p, and only
+        // visit the other side if the sphere around p crosses the split
+        if( d < 0 ) {
+            if( d * d <= chord2 )
+                search( mid + 1, end, next, p, chord2, maglim, list );
+            end = mid;
+        }
+        else {
+            if( d * d <= chord2 )
+                search( begin, mid, next, p, chord2, maglim, list );
+            begin = mid + 1;
+        }
+        axis = next;
+    }
+}
+
 QList<const StarObject *> StarHopper::computePath_const( const SkyPoint &src, const SkyPoint &dest, float fov_, float maglim_, QStringList *metadata ) {
 
     fov = fov_;
@@ -43,39 +124,62 @@ QList<const StarObject *> StarHopper::computePath_const( const SkyPoint &src, co
     start = &src;
     end = &dest;
 
-    came_from.clear();
     result_path.clear();
+    patternNames.clear();
+
+    double hopDistance = src.angularDistanceTo( &dest ).Degrees();
+    qDebug() << "StarHopper is trying to compute a path from source: " << src.ra().toHMSString() << src.dec().toDMSString() << " to destination: " << dest.ra().toHMSString() << dest.dec().toDMSString() << "; a starhop of " << hopDistance << " degrees!";
+
+    // Collect the candidate stars once. Nodes farther from the
+    // destination than 1.2 times the start are not expanded (see
+    // below), their neighbors are within a field of view, and the
+    // cost of a neighbor looks at stars within another field of view
+    // around it, one magnitude fainter than the limit. The margin
+    // covers the difference between catalog and current coordinates.
+    QList<StarObject *> candidates;
+    collectStars( candidates, dest, 1.2 * hopDistance + 2.0 * fov + 0.5, maglim + 1.0 );
+    m_Index.build( candidates );
+    qDebug() << "StarHopper has " << m_Index.size() << " candidate stars";
+
+    // Implements the A* search algorithm, with the open set in a
+    // binary heap. Stars are identified by their index in m_Index,
+    // and the start point comes after them. Nodes whose score improves
+    // are pushed again, and the outdated entries are skipped.
+
+    const int startNode = m_Index.size();
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    QVector<double> g_score( startNode + 1, infinity );
+    QVector<double> h_score( startNode + 1, -1.0 );
+    QVector<bool> cSet( startNode + 1, false );
+    m_CameFrom.fill( -1, startNode + 1 );
+    m_StarCost.fill( std::numeric_limits<float>::quiet_NaN(), startNode );
+
+    typedef QPair<double, int> OpenEntry; // f_score, node
+    QVector<OpenEntry> oSet;
+    auto lowestFirst = []( const OpenEntry &a, const OpenEntry &b ) { return a.first > b.first; };
+
+    g_score[ startNode ] = 0;
+    h_score[ startNode ] = hopDistance / fov;
+    oSet.append( OpenEntry( h_score[ startNode ], startNode ) );
+
+    QVector<int> neighbors;
 
-    // Implements the A* search algorithm
-
-    QList<SkyPoint const *> cSet;
-    QList<SkyPoint const *> oSet;
-    QHash<SkyPoint const *, double> g_score;
-    QHash<SkyPoint const *, double> f_score;
-    QHash<SkyPoint const *, double> h_score;
+    while( !oSet.isEmpty() ) {
+        // Take the node with the lowest f_score value
+        std::pop_heap( oSet.begin(), oSet.end(), lowestFirst );
+        OpenEntry entry = oSet.last();
+        oSet.removeLast();
 
-    qDebug() << "StarHopper is trying to compute a path from source: " << src.ra().toHMSString() << src.dec().toDMSString() << " to destination: " << dest.ra().toHMSString() << dest.dec().toDMSString() << "; a starhop of " << src.angularDistanceTo( &dest ).Degrees() << " degrees!";
+        int curr = entry.second;
+        if( cSet.at( curr ) || entry.first > g_score.at( curr ) + h_score.at( curr ) )
+            continue;
 
-    oSet.append( &src );
-    g_score[ &src ] = 0;
-    h_score[ &src ] = src.angularDistanceTo( &dest ).Degrees()/fov;
-    f_score[ &src ] = h_score[ &src ];
+        SkyPoint const *curr_node = ( curr == startNode ) ? start : m_Index.star( curr );
 
-    while( !oSet.isEmpty() ) {
-        qDebug() << "Next step";
-        // Find the node with the lowest f_score value
-        SkyPoint const *curr_node = NULL;
-        double lowfscore = 1.0e8;
-        foreach( const SkyPoint *sp, oSet ) {
-            if( f_score[ sp ] < lowfscore ) {
-                lowfscore = f_score[ sp ];
-                curr_node = sp;
-            }
-        }
-        qDebug() << "Lowest fscore (vertex distance-plus-cost score) is " << lowfscore << " with coords: " << curr_node->ra().toHMSString() << curr_node->dec().toDMSString() << ". Considering this node now.";
-        if( curr_node == &dest || (curr_node != &src && h_score[ curr_node ] < 0.5) ) {
+        if( curr != startNode && h_score.at( curr ) < 0.5 ) {
             // We are at destination
-            reconstructPath( came_from[ curr_node ] );
+            reconstructPath( m_CameFrom.at( curr ) );
             qDebug() << "We've arrived at the destination! Yay! Result path count: " << result_path.count();
 
             // Just a test -- try to print out useful instructions to the debug console. Once we make star hopper unexperimental, we should move this to some sort of a display
@@ -103,7 +207,6 @@ QList<const StarObject *> StarHopper::computePath_const( const SkyPoint &src, co
                         qDebug() << starHopDirections;
                     }
                     metadata->append( starHopDirections );
-                    qDebug() << "Appended starHopDirections to metadata";
                 }
                 prevHop = hopStar;
 
@@ -113,55 +216,34 @@ QList<const StarObject *> StarHopper::computePath_const( const SkyPoint &src, co
             return result_path;
         }
 
-        oSet.removeOne( curr_node );
-        cSet.append( curr_node );
+        cSet[ curr ] = true;
 
         // FIXME: Make sense. If current node ---> dest distance is
         // larger than src --> dest distance by more than 20%, don't
         // even bother considering it.
 
-        if( h_score[ curr_node ] > h_score[ &src ] * 1.2 ) {
-            qDebug() << "Node under consideration has larger distance to destination (h-score) than start node! Ignoring it.";
+        if( h_score.at( curr ) > h_score.at( startNode ) * 1.2 )
             continue;
-        }
-
-        SkyPoint const *nhd_node;
 
         // Get the list of stars that are neighbours of this node
-        QList<StarObject *> neighbors;
-
-        // FIXME: Actually, this should be done in
-        // HorizontalToEquatorial, but we do it here because SkyPoint
-        // needs a lot of fixing to handle unprecessed and precessed,
-        // equatorial and horizontal coordinates nicely
-        SkyPoint *CurrentNode = const_cast<SkyPoint *>(curr_node);
-        CurrentNode->deprecess( KStarsData::Instance()->updateNum() );
-        qDebug() << "Calling starsInAperture";
-        StarComponent::Instance()->starsInAperture( neighbors, *curr_node, fov, maglim );
-        qDebug() << "Choosing next node from a set of " << neighbors.count();
+        neighbors.clear();
+        m_Index.starsWithin( neighbors, *curr_node, fov, maglim );
+
         // Look for the potential next node
-        double curr_g_score = g_score[ curr_node ];
-        foreach( nhd_node, neighbors ) {
-            if( cSet.contains( nhd_node ) )
+        double curr_g_score = g_score.at( curr );
+        foreach( int nhd, neighbors ) {
+            if( cSet.at( nhd ) )
                 continue;
 
             // Compute the tentative g_score
-            double tentative_g_score = curr_g_score + cost( curr_node, nhd_node );
-            bool tentative_better;
-            if( !oSet.contains( nhd_node ) ) {
-                oSet.append( nhd_node );
-                tentative_better = true;
-            }
-            else if( tentative_g_score < g_score[ nhd_node ] )
-                tentative_better = true;
-            else
-                tentative_better = false;
-
-            if( tentative_better ) {
-                came_from[ nhd_node ] = curr_node;
-                g_score[ nhd_node ] = tentative_g_score;
-                h_score[ nhd_node ] = nhd_node->angularDistanceTo( &dest ).Degrees() / fov;
-                f_score[ nhd_node ] = g_score[ nhd_node ] + h_score[ nhd_node ];
+            double tentative_g_score = curr_g_score + cost( curr_node, nhd );
+            if( tentative_g_score < g_score.at( nhd ) ) {
+                m_CameFrom[ nhd ] = curr;
+                g_score[ nhd ] = tentative_g_score;
+                if( h_score.at( nhd ) < 0 )
+                    h_score[ nhd ] = m_Index.star( nhd )->angularDistanceTo( &dest ).Degrees() / fov;
+                oSet.append( OpenEntry( g_score.at( nhd ) + h_score.at( nhd ), nhd ) );
+                std::push_heap( oSet.begin(), oSet.end(), lowestFirst );
             }
         }
     }
@@ -169,73 +251,49 @@ QList<const StarObject *> StarHopper::computePath_const( const SkyPoint &src, co
     return QList<StarObject const *>(); // Return an empty QList
 }
 
-void StarHopper::reconstructPath( SkyPoint const *curr_node ) {
-    if( curr_node != start ) {
-        StarObject const *s = dynamic_cast<StarObject const *>(curr_node);
-        Q_ASSERT( s );
-        result_path.prepend( s );
-        reconstructPath( came_from[ s ] );
+void StarHopper::reconstructPath( int curr_node ) {
+    while( curr_node >= 0 && curr_node < m_Index.size() ) {
+        result_path.prepend( m_Index.star( curr_node ) );
+        curr_node = m_CameFrom.at( curr_node );
     }
 }
 
-float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
+float StarHopper::cost( const SkyPoint *curr, int next ) {
 
     // This is a very heuristic method, that tries to produce a cost
     // for each hop.
 
-    float netcost = 0;
-
-    // Convert 'next' into a StarObject
-    if( next == start ) {
-        // If the next hop is back to square one, junk it
-        return 1e8;
-    }
-    bool isThisTheEnd = (next == end);
-
-    float magcost, speccost;
-    magcost = speccost = 0;
-
-    if( !isThisTheEnd ) {
-        // We ought to be dealing with a star
-        StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
-        Q_ASSERT( nextstar );
-
-        // Test 1: How bright is the star?
-        magcost = nextstar->mag() - 7.0 + 5 * log10( fov ); // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star. Should actually depend on FOV, something like log( FOV ).
-
-        // Test 2: Is the star strikingly red / yellow coloured?
-        QString SpType = nextstar->sptype();
-        char spclass = SpType.at( 0 ).toLatin1();
-        speccost = ( spclass == 'G' || spclass == 'K' || spclass == 'M' ) ? -0.3 : 0;
-        /*
-        // Test 3: Is the star in the general direction of the object?
-        // We use the cosine rule to find the angle between the hop direction, and the direction to destination
-        // a = side joining curr to end
-        // b = side joining curr to next
-        // c = side joining next to end
-        // C = angle between curr-next and curr-end
-        double sina, sinb, cosa, cosb;
-        curr->angularDistanceTo(dest).SinCos( &sina, &cosa );
-        curr->angularDistanceTo(next).SinCos( &sinb, &cosb );
-        double cosc = cos(next->angularDistanceTo(end).radians());
-        double cosC = ( cosc - cosa * cosb ) / (sina * sinb);
-        float dircost;
-        if( cosC < 0 ) // Wrong direction!
-        dircost = 1e8; // Some humongous number;
-        else
-        dircost = sqrt( 1 - cosC * cosC ) / cosC; // tan( C )
-        */
-    }
+    float &nextcost = m_StarCost[ next ];
+    if( std::isnan( nextcost ) )
+        nextcost = starCost( next );
 
     // Test 4: How far is the hop?
-    double distcost = (curr->angularDistanceTo( next ).Degrees() / fov); // 1 "magnitude" incremental cost for 1 FOV. Is this even required, or is it just equivalent to halving our distance unit? I think it is required since the hop is not necessarily in the direction of the object -- asimha
+    double distcost = (curr->angularDistanceTo( m_Index.star( next ) ).Degrees() / fov); // 1 "magnitude" incremental cost for 1 FOV. Is this even required, or is it just equivalent to halving our distance unit? I think it is required since the hop is not necessarily in the direction of the object -- asimha
 
     // Test 5: How effective is the hop? [Might not be required with A*]
     //    double distredcost = -((src->angularDistanceTo( dest ).Degrees() - next->angularDistanceTo( dest ).Degrees()) * 60 / fov)*3; // 3 "magnitudes" for 1 FOV closer
 
+    float netcost = nextcost + distcost;
+    if( netcost < 0 )
+        netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
+    return netcost;
+}
+
+float StarHopper::starCost( int next ) {
+
+    StarObject const *nextstar = m_Index.star( next );
+
+    // Test 1: How bright is the star?
+    float magcost = nextstar->mag() - 7.0 + 5 * log10( fov ); // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star. Should actually depend on FOV, something like log( FOV ).
+
+    // Test 2: Is the star strikingly red / yellow coloured?
+    QString SpType = nextstar->sptype();
+    char spclass = SpType.isEmpty() ? '\0' : SpType.at( 0 ).toLatin1();
+    float speccost = ( spclass == 'G' || spclass == 'K' || spclass == 'M' ) ? -0.3 : 0;
+
     // Test 6: Is the destination an asterism? Are there bright stars clustered nearby?
-    QList<StarObject *> localNeighbors;
-    StarComponent::Instance()->starsInAperture( localNeighbors, *next, fov/10, maglim + 1.0 );
+    QVector<int> localNeighbors;
+    m_Index.starsWithin( localNeighbors, *nextstar, fov/10, maglim + 1.0 );
     double stardensitycost = 1 - localNeighbors.count(); // -1 "magnitude" for every neighbouring star
 
     // Test 7: Identify star patterns
@@ -245,73 +303,63 @@ float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
 
     double patterncost = 0;
     QString patternName;
-    if( !isThisTheEnd ) {
-        // We ought to be dealing with a star
-        StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
-        Q_ASSERT( nextstar );
-
-        float factor = 1.0;
-        while( factor <= 10.0 ) {
-            localNeighbors.clear();
-            StarComponent::Instance()->starsInAperture( localNeighbors, *next, fov/factor, nextstar->mag() + 1.0 ); // Use a larger aperture for pattern identification; max 1.0 mag difference
-            foreach( StarObject *star, localNeighbors ) {
-                if( star == nextstar )
-                    localNeighbors.removeOne( star );
-                else if( fabs( star->mag() - nextstar->mag() ) > 1.0 )
-                    localNeighbors.removeOne( star );
-            } // Now, we should have a pruned list
-            factor += 1.0;
-            if( localNeighbors.size() == 2 )
-                break;
+
+    float factor = 1.0;
+    while( factor <= 10.0 ) {
+        localNeighbors.clear();
+        m_Index.starsWithin( localNeighbors, *nextstar, fov/factor, nextstar->mag() + 1.0 ); // Use a larger aperture for pattern identification; max 1.0 mag difference
+        for( int i = localNeighbors.size() - 1; i >= 0; --i ) {
+            StarObject const *star = m_Index.star( localNeighbors.at( i ) );
+            if( star == nextstar || fabs( star->mag() - nextstar->mag() ) > 1.0 )
+                localNeighbors.remove( i );
+        } // Now, we should have a pruned list
+        factor += 1.0;
+        if( localNeighbors.size() == 2 )
+            break;
+    }
+    factor -= 1.0;
+    if( localNeighbors.size() == 2 ) {
+        patternName = "triangle (of similar magnitudes)"; // any three stars form a triangle!
+        // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
+        StarObject *star1 = m_Index.star( localNeighbors[0] );
+        double dRA1 = nextstar->ra().radians() - star1->ra().radians();
+        double dDec1 = nextstar->dec().radians() - star1->dec().radians();
+        double dist1sqr = dRA1 * dRA1 + dDec1 * dDec1;
+
+        StarObject *star2 = m_Index.star( localNeighbors[1] );
+        double dRA2 = nextstar->ra().radians() - star2->ra().radians();
+        double dDec2 = nextstar->dec().radians() - star2->dec().radians();
+        double dist2sqr = dRA2 * dRA2 + dDec2 * dDec2;
+
+        // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
+        if( fabs( (dRA1 * dRA2 - dDec1 * dDec2)/sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
+            // We have a right angled triangle! Give -3 magnitudes!
+            patterncost += -3;
+            patternName = "right-angled triangle";
         }
-        factor -= 1.0;
-        if( localNeighbors.size() == 2 ) {
-            patternName = "triangle (of similar magnitudes)"; // any three stars form a triangle!
-            // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
-            StarObject *star1 = localNeighbors[0];
-            double dRA1 = nextstar->ra().radians() - star1->ra().radians();
-            double dDec1 = nextstar->dec().radians() - star1->dec().radians();
-            double dist1sqr = dRA1 * dRA1 + dDec1 * dDec1;
-
-            StarObject *star2 = localNeighbors[1];
-            double dRA2 = nextstar->ra().radians() - star2->ra().radians();
-            double dDec2 = nextstar->dec().radians() - star2->dec().radians();
-            double dist2sqr = dRA2 * dRA2 + dDec2 * dDec2;
-
-            // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
-            if( fabs( (dRA1 * dRA2 - dDec1 * dDec2)/sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
-                // We have a right angled triangle! Give -3 magnitudes!
-                patterncost += -3;
-                patternName = "right-angled triangle";
-            }
 
-            // Check for isosceles triangles (without loss of generality, this is the vertex)
-            if( fabs( (dist1sqr - dist2sqr) / (dist1sqr) ) < EQUAL_EDGE_THRESHOLD ) {
+        // Check for isosceles triangles (without loss of generality, this is the vertex)
+        if( fabs( (dist1sqr - dist2sqr) / (dist1sqr) ) < EQUAL_EDGE_THRESHOLD ) {
+            patterncost += -1;
+            patternName = "isosceles triangle";
+            if( fabs( (dRA2 * dDec1 - dRA1 * dDec2) / sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
                 patterncost += -1;
-                patternName = "isosceles triangle";
-                if( fabs( (dRA2 * dDec1 - dRA1 * dDec2) / sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
-                    patterncost += -1;
-                    patternName = "straight line of 3 stars";
-                }
-                // Check for equilateral triangles
-                double dist3 = star1->angularDistanceTo( star2 ).radians();
-                double dist3sqr = dist3 * dist3;
-                if( fabs( (dist3sqr - dist1sqr) / dist1sqr ) < EQUAL_EDGE_THRESHOLD ) {
-                    patterncost += -1;
-                    patternName = "equilateral triangle";
-                }
+                patternName = "straight line of 3 stars";
+            }
+            // Check for equilateral triangles
+            double dist3 = star1->angularDistanceTo( star2 ).radians();
+            double dist3sqr = dist3 * dist3;
+            if( fabs( (dist3sqr - dist1sqr) / dist1sqr ) < EQUAL_EDGE_THRESHOLD ) {
+                patterncost += -1;
+                patternName = "equilateral triangle";
             }
         }
-        // TODO: Identify squares.
-        if( ! patternName.isEmpty() ) {
-            patternName += QString(" within %1% of FOV of the marked star").arg( (int)( 100.0/factor ) );
-            patternNames.insert( nextstar, patternName );
-        }
+    }
+    // TODO: Identify squares.
+    if( ! patternName.isEmpty() ) {
+        patternName += QString(" within %1% of FOV of the marked star").arg( (int)( 100.0/factor ) );
+        patternNames.insert( nextstar, patternName );
     }
 
-    netcost = magcost + speccost + distcost + stardensitycost + patterncost;
-    if( netcost < 0 )
-        netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
-    qDebug() << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Dist Cost: " << distcost << "; Density cost: " << stardensitycost << "; Pattern cost: " << patterncost << "; Net cost: " << netcost << "; Pattern: " << patternName;
-    return netcost;
+    return magcost + speccost + stardensitycost + patterncost;
 }
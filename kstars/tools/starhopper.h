@@ -25,12 +25,17 @@
  *@author Akarsh Simha
  */
 
+#include <QVector>
+
 #include "skypoint.h"
 #include "skyobject.h"
 #include "starobject.h"
 
 class StarHopper {
  public:
+    StarHopper();
+    virtual ~StarHopper();
+
     /**
      *@short Computes path for Star Hop
      *@param src SkyPoint to source of the Star Hop
@@ -44,6 +49,46 @@ class StarHopper {
     QList<StarObject *> * computePath( const SkyPoint &src, const SkyPoint &dest, float fov__, float maglim__, QStringList *metadata_ = 0 );
 
  private:
+    /**
+     *@class StarIndex
+     *@short KD-tree of the candidate stars of a star hop, for fast
+     * lookup of the stars around a point
+     *
+     *The stars are indexed by their current (RA, Dec) as unit
+     *vectors. The tree is implicit: the stars are reordered so that
+     *the median of every range along the splitting axis sits in the
+     *middle of the range.
+     */
+    class StarIndex {
+    public:
+        /** @short Rebuild the index from the given stars, reusing the allocated memory */
+        void build( const QList<StarObject *> &stars );
+
+        /** @return the number of stars in the index */
+        inline int size() const { return m_Nodes.size(); }
+
+        /** @return the i-th star of the index */
+        inline StarObject *star( int i ) const { return m_Nodes.at( i ).star; }
+
+        /**
+         *@short Append to list the indices of the stars that are within
+         * radius (in degrees) of center, and not fainter than maglim
+         */
+        void starsWithin( QVector<int> &list, const SkyPoint &center, double radius, float maglim ) const;
+
+    private:
+        struct Node {
+            double p[3];
+            float mag;
+            StarObject *star;
+        };
+
+        void build( int begin, int end, int axis );
+        void search( int begin, int end, int axis, const double p[3], double chord2, float maglim, QVector<int> &list ) const;
+
+        QVector<Node> m_Nodes;
+    };
+
     float fov;
     float maglim;
     QString starHopDirections;
@@ -51,25 +96,31 @@ class StarHopper {
     // Useful for internal computations
     SkyPoint const *start;
     SkyPoint const *end;
-    QHash<const SkyPoint *, const SkyPoint *> came_from; // Used by the A* search algorithm
+    StarIndex m_Index;             // Candidate stars of the current star hop
+    QVector<int> m_CameFrom;       // Used by the A* search algorithm; the start point has index m_Index.size()
+    QVector<float> m_StarCost;     // Part of the cost of hopping to a star that does not depend on where we come from
     QList<StarObject const *> result_path;
 
     /**
      *@short The cost function for hopping from current position to the a given star, in view of the final destination
      *@param curr Source SkyPoint
-     *@param next Next point in the hop.
-     *@note If 'next' is neither the starting point of the hop, nor
-     * the ending point, it _has_ to be a StarObject. A dynamic cast
-     * followed by a Q_ASSERT will ensure this.
+     *@param next Index of the next star of the hop in m_Index
+     */
+    float cost( const SkyPoint *curr, int next );
+
+    /**
+     *@short The part of the cost of hopping to a star that only depends
+     * on the star: its brightness, its color, and the stars around it
+     *@param next Index of the star in m_Index
      */
-    float cost( const SkyPoint *curr, const SkyPoint *next );
+    float starCost( int next );
 
     /**
      *@short For internal use by the A* Search Algorithm. Completes
      * the star-hop path. See
      * http://en.wikipedia.org/wiki/A*_search_algorithm for details
      */
-    void reconstructPath( SkyPoint const *curr_node );
+    void reconstructPath( int curr_node );
 
     QHash< SkyPoint const *, QString > patternNames; // if patterns were identified, they are added to this hash.
 
@@ -77,6 +128,19 @@ class StarHopper {
     //Returns a list of constant StarObject pointers which form the resultant path of Star Hop
     QList<const StarObject *> computePath_const( const SkyPoint &src, const SkyPoint &dest, float fov_, float maglim_, QStringList *metadata = 0 );
 
+    /**
+     *@short Collect the stars that may take part in a star hop
+     *
+     *This is called once per path computation, and all the neighbor
+     *lookups of the search are then answered from an index of these
+     *stars. The default implementation queries StarComponent.
+     *@param list the stars are appended here
+     *@param center the center of the region
+     *@param radius the radius of the region, in degrees
+     *@param maglim the faintest magnitude to collect
+     */
+    virtual void collectStars( QList<StarObject *> &list, const SkyPoint &center, float radius, float maglim );
+
 };
 
 #endif
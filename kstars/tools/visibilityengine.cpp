@@ -0,0 +1,404 @@
+/***************************************************************************
+                  visibilityengine.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "visibilityengine.h"
+
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QPair>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <cmath>
+
+#include "geolocation.h"
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "skyobjects/skyobject.h"
+
+// The altitude kernel processes VF_WIDTH objects at a time using AVX
+// when KStars is compiled for it, and SSE otherwise. The remaining
+// objects, and all objects on other architectures, go through the
+// scalar loop.
+#if defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VF_WIDTH 8
+#define vf_load    _mm256_loadu_ps
+#define vf_store   _mm256_storeu_ps
+#define vf_set1    _mm256_set1_ps
+#define vf_add     _mm256_add_ps
+#define vf_sub     _mm256_sub_ps
+#define vf_mul     _mm256_mul_ps
+#define vf_sqrt    _mm256_sqrt_ps
+#define vf_max     _mm256_max_ps
+#define vf_min     _mm256_min_ps
+#define vf_and     _mm256_and_ps
+#define vf_andnot  _mm256_andnot_ps
+#define vf_or      _mm256_or_ps
+#define vf_cmpge( a, b ) _mm256_cmp_ps( a, b, _CMP_GE_OQ )
+#define vf_cmple( a, b ) _mm256_cmp_ps( a, b, _CMP_LE_OQ )
+#define vf_cmpgt( a, b ) _mm256_cmp_ps( a, b, _CMP_GT_OQ )
+#define vf_cmplt( a, b ) _mm256_cmp_ps( a, b, _CMP_LT_OQ )
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VF_WIDTH 4
+#define vf_load    _mm_loadu_ps
+#define vf_store   _mm_storeu_ps
+#define vf_set1    _mm_set1_ps
+#define vf_add     _mm_add_ps
+#define vf_sub     _mm_sub_ps
+#define vf_mul     _mm_mul_ps
+#define vf_sqrt    _mm_sqrt_ps
+#define vf_max     _mm_max_ps
+#define vf_min     _mm_min_ps
+#define vf_and     _mm_and_ps
+#define vf_andnot  _mm_andnot_ps
+#define vf_or      _mm_or_ps
+#define vf_cmpge   _mm_cmpge_ps
+#define vf_cmple   _mm_cmple_ps
+#define vf_cmpgt   _mm_cmpgt_ps
+#define vf_cmplt   _mm_cmplt_ps
+#endif
+
+// Below this many objects per chunk, handing work to the thread pool
+// costs more than the computation itself
+#define MIN_OBJECTS_PER_CHUNK 1024
+
+// Above this many objects per chunk, progress is reported too rarely
+#define MAX_OBJECTS_PER_CHUNK 16384
+
+// Number of chunks per worker thread, to even out the load
+#define CHUNKS_PER_THREAD 4
+
+// Rate of the local sidereal time, radians per second of universal time
+#define SIDEREAL_RATE ( 2.0 * M_PI * 1.00273790935 / 86400.0 )
+
+namespace {
+
+/**
+ * How the hour angles swept by the period cover the circle. The arc
+ * tests below only work for arcs shorter than half a turn, so for
+ * longer periods the complement of the swept arc is tested instead.
+ */
+enum Sweep { SWEEP_SHORT, SWEEP_LONG, SWEEP_FULL };
+
+/** The quantities shared by all objects of the altitude kernel */
+struct AltitudeSetup {
+    float sinLat, cosLat;
+    float c0x, c0y;         // Direction of the sidereal time at the start of the period
+    float c1x, c1y;         // Direction of the sidereal time at its end
+    float bx, by;           // Bisector of the swept arc, for SWEEP_SHORT
+    Sweep sweep;
+};
+
+/**
+ * Multiply each vector (x[i], y[i], z[i]) by the row-major 3x3 matrix
+ * M in place, for 0 <= i < count.
+ */
+void transform( const float M[9], float *x, float *y, float *z, int count )
+{
+    int i = 0;
+#ifdef VF_WIDTH
+    const vfloat m0 = vf_set1( M[0] ), m1 = vf_set1( M[1] ), m2 = vf_set1( M[2] );
+    const vfloat m3 = vf_set1( M[3] ), m4 = vf_set1( M[4] ), m5 = vf_set1( M[5] );
+    const vfloat m6 = vf_set1( M[6] ), m7 = vf_set1( M[7] ), m8 = vf_set1( M[8] );
+    for( ; i + VF_WIDTH <= count; i += VF_WIDTH ) {
+        vfloat vx = vf_load( x + i ), vy = vf_load( y + i ), vz = vf_load( z + i );
+        vf_store( x + i, vf_add( vf_add( vf_mul( m0, vx ), vf_mul( m1, vy ) ), vf_mul( m2, vz ) ) );
+        vf_store( y + i, vf_add( vf_add( vf_mul( m3, vx ), vf_mul( m4, vy ) ), vf_mul( m5, vz ) ) );
+        vf_store( z + i, vf_add( vf_add( vf_mul( m6, vx ), vf_mul( m7, vy ) ), vf_mul( m8, vz ) ) );
+    }
+#endif
+    for( ; i < count; ++i ) {
+        float vx = x[i], vy = y[i], vz = z[i];
+        x[i] = M[0] * vx + M[1] * vy + M[2] * vz;
+        y[i] = M[3] * vx + M[4] * vy + M[5] * vz;
+        z[i] = M[6] * vx + M[7] * vy + M[8] * vz;
+    }
+}
+
+/**
+ * Find the sines of the highest and lowest altitudes during the period
+ * of the objects with unit vectors (x[i], y[i], z[i]) of date.
+ *
+ * With d the direction of the object in the equatorial plane, the sine
+ * of the altitude at sidereal time L is
+ *   sin(lat) z + cos(lat) ( x cos(L) + y sin(L) ),
+ * so it is highest at the transit, where L points along d, and lowest
+ * where L points along -d. If the period does not contain these, the
+ * extremes are at its start or end. Whether the swept arc of sidereal
+ * times contains a direction follows from the signs of cross products.
+ */
+void altitudeRange( const AltitudeSetup &s, const float *x, const float *y, const float *z,
+                    float *maxSin, float *minSin, int count )
+{
+    int i = 0;
+#ifdef VF_WIDTH
+    const vfloat sinLat = vf_set1( s.sinLat ), cosLat = vf_set1( s.cosLat );
+    const vfloat c0x = vf_set1( s.c0x ), c0y = vf_set1( s.c0y );
+    const vfloat c1x = vf_set1( s.c1x ), c1y = vf_set1( s.c1y );
+    const vfloat bx = vf_set1( s.bx ), by = vf_set1( s.by );
+    const vfloat zero = vf_set1( 0.0f ), all = vf_cmple( zero, zero );
+    for( ; i + VF_WIDTH <= count; i += VF_WIDTH ) {
+        vfloat vx = vf_load( x + i ), vy = vf_load( y + i ), vz = vf_load( z + i );
+        vfloat a = vf_mul( sinLat, vz );
+        vfloat r = vf_mul( cosLat, vf_sqrt( vf_add( vf_mul( vx, vx ), vf_mul( vy, vy ) ) ) );
+        vfloat s0 = vf_add( a, vf_mul( cosLat, vf_add( vf_mul( vx, c0x ), vf_mul( vy, c0y ) ) ) );
+        vfloat s1 = vf_add( a, vf_mul( cosLat, vf_add( vf_mul( vx, c1x ), vf_mul( vy, c1y ) ) ) );
+        vfloat cr0 = vf_sub( vf_mul( c0x, vy ), vf_mul( c0y, vx ) );
+        vfloat cr1 = vf_sub( vf_mul( vx, c1y ), vf_mul( vy, c1x ) );
+        vfloat upperIn, lowerIn;
+        switch( s.sweep ) {
+        case SWEEP_SHORT: {
+            vfloat db = vf_add( vf_mul( vx, bx ), vf_mul( vy, by ) );
+            upperIn = vf_and( vf_and( vf_cmpge( cr0, zero ), vf_cmpge( cr1, zero ) ), vf_cmpge( db, zero ) );
+            lowerIn = vf_and( vf_and( vf_cmple( cr0, zero ), vf_cmple( cr1, zero ) ), vf_cmple( db, zero ) );
+            break;
+        }
+        case SWEEP_LONG:
+            upperIn = vf_andnot( vf_and( vf_cmplt( cr0, zero ), vf_cmplt( cr1, zero ) ), all );
+            lowerIn = vf_andnot( vf_and( vf_cmpgt( cr0, zero ), vf_cmpgt( cr1, zero ) ), all );
+            break;
+        default:
+            upperIn = lowerIn = all;
+            break;
+        }
+        vfloat upper = vf_add( a, r ), lower = vf_sub( a, r );
+        vf_store( maxSin + i, vf_or( vf_and( upperIn, upper ), vf_andnot( upperIn, vf_max( s0, s1 ) ) ) );
+        vf_store( minSin + i, vf_or( vf_and( lowerIn, lower ), vf_andnot( lowerIn, vf_min( s0, s1 ) ) ) );
+    }
+#endif
+    for( ; i < count; ++i ) {
+        float vx = x[i], vy = y[i];
+        float a = s.sinLat * z[i];
+        float r = s.cosLat * std::sqrt( vx * vx + vy * vy );
+        float s0 = a + s.cosLat * ( vx * s.c0x + vy * s.c0y );
+        float s1 = a + s.cosLat * ( vx * s.c1x + vy * s.c1y );
+        float cr0 = s.c0x * vy - s.c0y * vx;
+        float cr1 = vx * s.c1y - vy * s.c1x;
+        bool upperIn, lowerIn;
+        switch( s.sweep ) {
+        case SWEEP_SHORT: {
+            float db = vx * s.bx + vy * s.by;
+            upperIn = cr0 >= 0 && cr1 >= 0 && db >= 0;
+            lowerIn = cr0 <= 0 && cr1 <= 0 && db <= 0;
+            break;
+        }
+        case SWEEP_LONG:
+            upperIn = !( cr0 < 0 && cr1 < 0 );
+            lowerIn = !( cr0 > 0 && cr1 > 0 );
+            break;
+        default:
+            upperIn = lowerIn = true;
+            break;
+        }
+        maxSin[i] = upperIn ? a + r : qMax( s0, s1 );
+        minSin[i] = lowerIn ? a - r : qMin( s0, s1 );
+    }
+}
+
+/** @return the arcsine of x in degrees, with x clamped to [-1, 1] */
+inline double asinDegrees( float x )
+{
+    return asin( qBound( -1.0, double( x ), 1.0 ) ) * 180.0 / M_PI;
+}
+
+}
+
+VisibilityEngine::VisibilityEngine( QObject *parent ) :
+    QObject( parent ), m_Duration( 0.0 ), m_StartLST( 0.0 ), m_SinLat( 0.0 ), m_CosLat( 1.0 ), m_SinHorizon( 0.0 )
+{
+    for( int i = 0; i < 9; ++i )
+        m_Precession[i] = ( i % 4 == 0 ) ? 1.0f : 0.0f;
+}
+
+void VisibilityEngine::setPeriod( const KStarsDateTime &start, double duration, const GeoLocation *geo )
+{
+    m_Duration = qMax( 0.0, duration );
+    m_StartLST = geo->GSTtoLST( start.gst() ).radians();
+    geo->lat()->SinCos( m_SinLat, m_CosLat );
+
+    KSNumbers num( start.djd() + m_Duration / 2.0 / 86400.0 );
+    const Eigen::Matrix3d &P = num.p2();
+    for( int i = 0; i < 3; ++i )
+        for( int j = 0; j < 3; ++j )
+            m_Precession[3 * i + j] = P( i, j );
+}
+
+void VisibilityEngine::setHorizon( double altitude )
+{
+    m_SinHorizon = sin( altitude * M_PI / 180.0 );
+}
+
+void VisibilityEngine::cancel()
+{
+    m_Canceled.store( 1 );
+}
+
+QVector<VisibilityEngine::Result> VisibilityEngine::compute( const QList<SkyObject *> &objects )
+{
+    QVector<double> ra( objects.size() ), dec( objects.size() );
+    KStarsData *data = KStarsData::Instance();
+    for( int i = 0; i < objects.size(); ++i ) {
+        SkyObject *o = objects.at( i );
+        if( o->isSolarSystem() && data ) {
+            SkyPoint p = o->deprecess( data->updateNum() );
+            ra[i] = p.ra().radians();
+            dec[i] = p.dec().radians();
+        } else {
+            ra[i] = o->ra0().radians();
+            dec[i] = o->dec0().radians();
+        }
+    }
+    return compute( ra, dec );
+}
+
+QVector<VisibilityEngine::Result> VisibilityEngine::compute( const QVector<double> &ra, const QVector<double> &dec )
+{
+    const int count = qMin( ra.size(), dec.size() );
+    QVector<Result> results( count );
+    m_Canceled.store( 0 );
+    m_Done.store( 0 );
+    if( count == 0 )
+        return results;
+
+    Result *out = results.data();
+    int nThreads = QThreadPool::globalInstance()->maxThreadCount();
+    if( nThreads <= 1 || count < 2 * MIN_OBJECTS_PER_CHUNK ) {
+        computeRange( ra.constData(), dec.constData(), out, 0, count );
+        return results;
+    }
+
+    int chunkSize = ( count + nThreads * CHUNKS_PER_THREAD - 1 ) / ( nThreads * CHUNKS_PER_THREAD );
+    chunkSize = qBound( MIN_OBJECTS_PER_CHUNK, chunkSize, MAX_OBJECTS_PER_CHUNK );
+    QVector< QPair<int, int> > chunks;
+    chunks.reserve( count / chunkSize + 1 );
+    for( int begin = 0; begin < count; begin += chunkSize )
+        chunks.append( qMakePair( begin, qMin( begin + chunkSize, count ) ) );
+
+    const double *raData = ra.constData(), *decData = dec.constData();
+    QEventLoop loop;
+    QTimer progressTimer;
+    QFutureWatcher<void> watcher;
+    connect( &progressTimer, &QTimer::timeout, [this, count]() {
+        emit madeProgress( int( 100.0 * m_Done.load() / count ) );
+    } );
+    connect( &watcher, SIGNAL( finished() ), &loop, SLOT( quit() ) );
+    watcher.setFuture( QtConcurrent::map( chunks, [this, raData, decData, out]( QPair<int, int> &chunk ) {
+        if( m_Canceled.load() )
+            return;
+        computeRange( raData, decData, out, chunk.first, chunk.second );
+        m_Done.fetchAndAddRelaxed( chunk.second - chunk.first );
+    } ) );
+    progressTimer.start( 100 );
+    loop.exec();
+    progressTimer.stop();
+    emit madeProgress( 100 );
+
+    return results;
+}
+
+void VisibilityEngine::computeRange( const double *ra, const double *dec, Result *results, int begin, int end ) const
+{
+    const int n = end - begin;
+    QVector<float> buffer( 5 * n );
+    float *x = buffer.data(), *y = x + n, *z = y + n, *maxSin = z + n, *minSin = maxSin + n;
+
+    for( int i = 0; i < n; ++i ) {
+        double cosDec = cos( dec[begin + i] );
+        x[i] = cos( ra[begin + i] ) * cosDec;
+        y[i] = sin( ra[begin + i] ) * cosDec;
+        z[i] = sin( dec[begin + i] );
+    }
+    transform( m_Precession, x, y, z, n );
+
+    const double sweep = SIDEREAL_RATE * m_Duration;
+    const double endLST = m_StartLST + sweep;
+    AltitudeSetup setup;
+    setup.sinLat = m_SinLat;
+    setup.cosLat = m_CosLat;
+    setup.c0x = cos( m_StartLST );
+    setup.c0y = sin( m_StartLST );
+    setup.c1x = cos( endLST );
+    setup.c1y = sin( endLST );
+    setup.bx = setup.c0x + setup.c1x;
+    setup.by = setup.c0y + setup.c1y;
+    setup.sweep = ( sweep < M_PI ) ? SWEEP_SHORT : ( sweep < 2.0 * M_PI ) ? SWEEP_LONG : SWEEP_FULL;
+    altitudeRange( setup, x, y, z, maxSin, minSin, n );
+
+    for( int i = 0; i < n; ++i ) {
+        Result &result = results[begin + i];
+        result.maxAltitude = asinDegrees( maxSin[i] );
+        result.minAltitude = asinDegrees( minSin[i] );
+        findTimes( x[i], y[i], z[i], result );
+        result.valid = true;
+    }
+}
+
+void VisibilityEngine::findTimes( double x, double y, double z, Result &result ) const
+{
+    const double rho = sqrt( x * x + y * y );
+    const double middle = m_Duration / 2.0;
+
+    // Hour angle at the middle of the period, in [-pi, pi)
+    double H = fmod( m_StartLST + SIDEREAL_RATE * middle - atan2( y, x ) + M_PI, 2.0 * M_PI );
+    if( H < 0 )
+        H += 2.0 * M_PI;
+    H -= M_PI;
+    result.transit = middle - H / SIDEREAL_RATE;
+
+    // The object is above the horizon altitude while its hour angle is
+    // within +-Hs of a transit, with cos(Hs) as below
+    result.aboveTime = 0.0;
+    result.intervalCount = 0;
+    const double denominator = m_CosLat * rho;
+    double cosHs;
+    if( denominator < 1.0e-9 )
+        cosHs = ( m_SinLat * z >= m_SinHorizon ) ? -1.0 : 1.0;
+    else
+        cosHs = ( m_SinHorizon - m_SinLat * z ) / denominator;
+
+    if( cosHs >= 1.0 )
+        return;
+    if( cosHs <= -1.0 ) {
+        result.aboveTime = m_Duration;
+        result.intervalCount = 1;
+        result.intervals[0].begin = 0.0;
+        result.intervals[0].end = m_Duration;
+        return;
+    }
+
+    const double halfWidth = acos( cosHs ) / SIDEREAL_RATE;
+    const double day = 2.0 * M_PI / SIDEREAL_RATE;
+    int first = int( floor( ( -halfWidth - result.transit ) / day ) );
+    int last = int( ceil( ( m_Duration + halfWidth - result.transit ) / day ) );
+    for( int k = first; k <= last; ++k ) {
+        double center = result.transit + k * day;
+        double begin = qMax( 0.0, center - halfWidth ), end = qMin( m_Duration, center + halfWidth );
+        if( end < begin || ( end == begin && m_Duration > 0.0 ) )
+            continue;
+        result.aboveTime += end - begin;
+        if( result.intervalCount < MAX_INTERVALS ) {
+            result.intervals[result.intervalCount].begin = begin;
+            result.intervals[result.intervalCount].end = end;
+            ++result.intervalCount;
+        }
+    }
+}
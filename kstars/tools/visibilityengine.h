@@ -0,0 +1,151 @@
+/***************************************************************************
+                   visibilityengine.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sun 18 Oct 2026
+    copyright            : (C) 2026 by KStars developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef VISIBILITYENGINE_H
+#define VISIBILITYENGINE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QVector>
+
+#include "kstarsdatetime.h"
+
+class GeoLocation;
+class SkyObject;
+
+/**
+ *@class VisibilityEngine
+ *@short Computes when many fixed objects are observable during a period of time
+ *
+ *The altitude of an object with fixed equatorial coordinates only depends
+ *on its hour angle, which grows linearly with time. So its highest and
+ *lowest altitudes in a period, its transit and the times it spends above
+ *a given altitude all follow in closed form from the sidereal times at the
+ *start and end of the period, without stepping through it.
+ *
+ *compute() takes the J2000 coordinates of any number of objects. They are
+ *precessed to the middle of the period with one rotation matrix, and the
+ *extreme altitudes are found with vector instructions, several objects at
+ *a time, with no trigonometric function per object. The objects are split
+ *into chunks that run concurrently on the global thread pool. Large
+ *computations report their progress through madeProgress() and can be
+ *stopped with cancel().
+ *
+ *Nutation, aberration and refraction are ignored: they change altitudes by
+ *less than a few arcminutes near the horizon. Moving objects are taken
+ *at their position at the time compute() is called.
+ *@author KStars developers
+ */
+class VisibilityEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** The most intervals above the horizon reported per object */
+    static const int MAX_INTERVALS = 2;
+
+    /** @short A time interval, in seconds from the start of the period */
+    struct Interval {
+        double begin;
+        double end;
+    };
+
+    /** @short What compute() finds out about one object */
+    struct Result {
+        bool valid;                 // False if the computation was canceled before reaching the object
+        double maxAltitude;         // Highest altitude during the period, degrees
+        double minAltitude;         // Lowest altitude during the period, degrees
+        double transit;             // Time of the upper transit closest to the middle of the period, seconds
+                                    // from its start. May lie outside of the period.
+        double aboveTime;           // Total time spent above the horizon altitude, seconds
+        int intervalCount;          // Number of intervals above the horizon altitude
+        Interval intervals[MAX_INTERVALS]; // The first intervals above the horizon altitude, clipped to the period
+
+        /** @return true if the object is between minAlt and maxAlt degrees at some time of the period */
+        inline bool reaches( double minAlt, double maxAlt ) const {
+            return valid && maxAltitude >= minAlt && minAltitude <= maxAlt;
+        }
+    };
+
+    explicit VisibilityEngine( QObject *parent = 0 );
+
+    /**
+     *@short Set the period and the place to compute for
+     *@param start Universal time at which the period starts
+     *@param duration Length of the period in seconds. Zero computes the
+     *       altitudes at the start time only.
+     *@param geo The location of the observer
+     */
+    void setPeriod( const KStarsDateTime &start, double duration, const GeoLocation *geo );
+
+    /**
+     *@short Set the altitude above which an object counts as above the horizon, for
+     *the intervals and aboveTime of the results. Zero by default.
+     *@param altitude degrees
+     */
+    void setHorizon( double altitude );
+
+    /**
+     *@short Compute the results for objects with the given J2000 coordinates
+     *
+     *Large inputs are split over the global thread pool. This method keeps
+     *processing events of the calling thread while it waits, so that
+     *madeProgress() is delivered and cancel() can be called.
+     *@param ra Right ascensions, radians
+     *@param dec Declinations, radians, as many as ra
+     *@return one result per object, in the same order
+     */
+    QVector<Result> compute( const QVector<double> &ra, const QVector<double> &dec );
+
+    /**
+     *@short Compute the results for the given sky objects
+     *
+     *Objects of the solar system are taken at their current position,
+     *all others at their catalog position.
+     */
+    QVector<Result> compute( const QList<SkyObject *> &objects );
+
+    /** @return true if the last compute() was stopped by cancel() */
+    inline bool isCanceled() const { return m_Canceled.load() != 0; }
+
+public slots:
+    /** @short Stop a running compute() as soon as possible. Thread-safe. */
+    void cancel();
+
+signals:
+    /** Emitted with the percentage of the objects done so far */
+    void madeProgress( int progress );
+
+private:
+    /** @short Compute the results of objects begin ... end - 1 */
+    void computeRange( const double *ra, const double *dec, Result *results, int begin, int end ) const;
+
+    /** @short Fill in the transit and the intervals above the horizon of one object */
+    void findTimes( double x, double y, double z, Result &result ) const;
+
+    double m_Duration;          // Length of the period, seconds
+    double m_StartLST;          // Local sidereal time at the start of the period, radians
+    double m_SinLat, m_CosLat;
+    double m_SinHorizon;
+    float m_Precession[9];      // J2000 to the middle of the period, row-major
+
+    QAtomicInt m_Canceled;
+    QAtomicInt m_Done;
+};
+
+#endif
@@ -96,57 +96,33 @@ void ModelManager::updateModels(ObsConditions *obs)
         }
     }
 
-    foreach (SkyObject *so, m_InitObjects.value(Star_Model))
+    // Evaluate the visibility of all objects in a single pass
+    QList<SkyObject *> objects;
+    QList<SkyObjListModel *> models;
+    const ModelType types[] = { Star_Model, Galaxy_Model, Constellation_Model, Cluster_Model, Nebula_Model };
+    SkyObjListModel *const typeModels[] = { m_StarsModel, m_GalModel, m_ConModel, m_ClustModel, m_NebModel };
+    for (int i = 0; i < 5; ++i)
     {
-        //qDebug()<<so->longname()<<so->typeName();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
+        foreach (SkyObject *so, m_InitObjects.value(types[i]))
         {
-            m_StarsModel->addSkyObject(new SkyObjItem(so));
+            objects.append(so);
+            models.append(typeModels[i]);
         }
     }
 
-    foreach (SkyObject *so, m_InitObjects.value(Galaxy_Model))
-    {
-        //qDebug()<<so->longname()<<so->typeName();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_GalModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
-
-    foreach (SkyObject *so, m_InitObjects.value(Constellation_Model))
-    {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_ConModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
-
-    foreach (SkyObject *so, m_InitObjects.value(Cluster_Model))
-    {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_ClustModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
-
-    foreach (SkyObject *so, m_InitObjects.value(Nebula_Model))
+    foreach (const QString &name, data->skyComposite()->objectNames(SkyObject::PLANET))
     {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_NebModel->addSkyObject(new SkyObjItem(so));
-        }
+        SkyObject *so = data->skyComposite()->findByName(name);
+        if (!so || so->name() == "Sun") continue;
+        objects.append(so);
+        models.append(m_PlanetsModel);
     }
 
-    foreach (const QString &name, data->skyComposite()->objectNames(SkyObject::PLANET))
+    QVector<bool> visible = m_ObsConditions->isVisible(data->geo(), data->ut(), objects);
+    for (int i = 0; i < objects.size(); ++i)
     {
-        SkyObject *so = data->skyComposite()->findByName(name);
-        //qDebug()<<so->name()<<so->mag();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            if (so->name() == "Sun") continue;
-            m_PlanetsModel->addSkyObject(new SkyObjItem(so));
-        }
+        if (visible.at(i))
+            models.at(i)->addSkyObject(new SkyObjItem(objects.at(i)));
     }
 }
 
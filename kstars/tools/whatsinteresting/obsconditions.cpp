@@ -16,6 +16,7 @@
  ***************************************************************************/
 
 #include "obsconditions.h"
+#include "tools/visibilityengine.h"
 #include "math.h"
 #include <QDebug>
 
@@ -104,6 +105,19 @@ bool ObsConditions::isVisible(GeoLocation *geo, dms *lst, SkyObject *so)
     return (sp.alt().Degrees() > 6.0 && so->mag() < getTrueMagLim());
 }
 
+QVector<bool> ObsConditions::isVisible(GeoLocation *geo, const KStarsDateTime &ut, const QList<SkyObject *> &objects)
+{
+    VisibilityEngine engine;
+    engine.setPeriod(ut, 0, geo);
+    QVector<VisibilityEngine::Result> results = engine.compute(objects);
+
+    double magLim = getTrueMagLim();
+    QVector<bool> visible(objects.size());
+    for (int i = 0; i < objects.size(); ++i)
+        visible[i] = (results.at(i).maxAltitude > 6.0 && objects.at(i)->mag() < magLim);
+    return visible;
+}
+
 void ObsConditions::setObsConditions(int bortle, double aperture, ObsConditions::Equipment equip, ObsConditions::TelescopeType telType)
 {
     m_BortleClass = bortle;
@@ -98,6 +98,16 @@ public:
      */
     bool isVisible(GeoLocation *geo, dms *lst, SkyObject *so);
 
+    /**
+     * \brief Evaluate visibility of many sky-objects at once, with the same criteria as
+     * isVisible(), at the given time.
+     * \return Visibility of each sky-object, in the order of objects.
+     * \param geo       Geographic location of user.
+     * \param ut        Universal time at which visibility is to be evaluated.
+     * \param objects   SkyObjects for which visibility is to be evaluated.
+     */
+    QVector<bool> isVisible(GeoLocation *geo, const KStarsDateTime &ut, const QList<SkyObject *> &objects);
+
     /**
      * \brief Create QMap<int, double> to be initialised to static member variable m_LMMap
      * \return QMap<int, double> to be initialised to static member variable m_LMMap
@@ -24,6 +24,7 @@
 #include <QComboBox>
 #include <KLocalizedString>
 #include <QPushButton>
+#include <QProgressDialog>
 
 #include "ui_wutdialog.h"
 
@@ -39,6 +40,7 @@
 #include "skyobjects/ksmoon.h"
 #include "skycomponents/skymapcomposite.h"
 #include "tools/observinglist.h"
+#include "tools/visibilityengine.h"
 
 WUTDialogUI::WUTDialogUI( QWidget *p ) : QFrame( p ) {
     setupUi( this );
@@ -263,12 +265,17 @@ void WUTDialog::slotLoadList( const QString &c ) {
 
     if ( ! isCategoryInitialized(c) ) {
 
+        QList<SkyObject*> candidates;
+        QStringList candidateCategories;
+
         if ( c == m_Categories[0] ) { //Planets
             foreach ( const QString &name, data->skyComposite()->objectNames( SkyObject::PLANET ) ) {
                 SkyObject *o = data->skyComposite()->findByName( name );
 
-                if ( checkVisibility( o ) && o->mag() <= m_Mag )
-                    visibleObjects(c).append(o);
+                if ( o->mag() <= m_Mag ) {
+                    candidates.append(o);
+                    candidateCategories.append(c);
+                }
             }
 
             m_CategoryInitialized[ c ] = true;
@@ -276,32 +283,39 @@ void WUTDialog::slotLoadList( const QString &c ) {
 
         else if ( c == m_Categories[1] ) { //Stars
             foreach ( SkyObject *o, data->skyComposite()->stars() )
-            if ( o->name() != i18n("star") && checkVisibility(o) && o->mag() <= m_Mag )
-                visibleObjects(c).append(o);
+            if ( o->name() != i18n("star") && o->mag() <= m_Mag ) {
+                candidates.append(o);
+                candidateCategories.append(c);
+            }
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[5] ) { //Constellations
-            foreach ( SkyObject *o, data->skyComposite()->constellationNames() )
-            if ( checkVisibility(o) )
-                visibleObjects(c).append(o);
+            foreach ( SkyObject *o, data->skyComposite()->constellationNames() ) {
+                candidates.append(o);
+                candidateCategories.append(c);
+            }
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[6] ) { //Asteroids
             foreach ( SkyObject *o, data->skyComposite()->asteroids() )
-            if ( checkVisibility(o) && o->name() != i18n("Pluto") && o->mag() <= m_Mag )
-                visibleObjects(c).append(o);
+            if ( o->name() != i18n("Pluto") && o->mag() <= m_Mag ) {
+                candidates.append(o);
+                candidateCategories.append(c);
+            }
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[7] ) { //Comets
             foreach ( SkyObject *o, data->skyComposite()->comets() )
-            if ( checkVisibility(o) && o->mag() <= m_Mag)
-                visibleObjects(c).append(o);
+            if ( o->mag() <= m_Mag ) {
+                candidates.append(o);
+                candidateCategories.append(c);
+            }
 
             m_CategoryInitialized[ c ] = true;
         }
@@ -309,28 +323,38 @@ void WUTDialog::slotLoadList( const QString &c ) {
         else { //all deep-sky objects, need to split clusters, nebulae and galaxies
             foreach ( DeepSkyObject *dso, data->skyComposite()->deepSkyObjects() ) {
                 SkyObject *o = (SkyObject*)dso;
-                if ( checkVisibility(o) && o->mag() <= m_Mag ) {
-                    switch( o->type() ) {
-                    case SkyObject::OPEN_CLUSTER: //fall through
-                    case SkyObject::GLOBULAR_CLUSTER:
-                        visibleObjects(m_Categories[4]).append(o); //star clusters
-                        break;
-                    case SkyObject::GASEOUS_NEBULA: //fall through
-                    case SkyObject::PLANETARY_NEBULA: //fall through
-                    case SkyObject::SUPERNOVA_REMNANT:
-                        visibleObjects(m_Categories[2]).append(o); //nebulae
-                        break;
-                    case SkyObject::GALAXY:
-                        visibleObjects(m_Categories[3]).append(o); //galaxies
-                        break;
-                    }
+                if ( o->mag() > m_Mag )
+                    continue;
+
+                switch( o->type() ) {
+                case SkyObject::OPEN_CLUSTER: //fall through
+                case SkyObject::GLOBULAR_CLUSTER:
+                    candidateCategories.append(m_Categories[4]); //star clusters
+                    break;
+                case SkyObject::GASEOUS_NEBULA: //fall through
+                case SkyObject::PLANETARY_NEBULA: //fall through
+                case SkyObject::SUPERNOVA_REMNANT:
+                    candidateCategories.append(m_Categories[2]); //nebulae
+                    break;
+                case SkyObject::GALAXY:
+                    candidateCategories.append(m_Categories[3]); //galaxies
+                    break;
+                default:
+                    continue;
                 }
+                candidates.append(o);
             }
 
             m_CategoryInitialized[ m_Categories[2] ] = true;
             m_CategoryInitialized[ m_Categories[3] ] = true;
             m_CategoryInitialized[ m_Categories[4] ] = true;
         }
+
+        //Check the visibility of all candidates at once
+        QVector<bool> visible = checkVisibility( candidates );
+        for ( int i = 0; i < candidates.size(); ++i )
+            if ( visible.at(i) )
+                visibleObjects( candidateCategories.at(i) ).append( candidates.at(i) );
     }
 
     //Now the category has been initialized, we can populate the list widget
@@ -347,11 +371,11 @@ void WUTDialog::slotLoadList( const QString &c ) {
 }
 
 bool WUTDialog::checkVisibility(SkyObject *o) {
-    bool visible( false );
-    double minAlt = 6.0; //An object is considered 'visible' if it is above horizon during civil twilight.
+    return checkVisibility( QList<SkyObject*>() << o ).first();
+}
 
-    // reject objects that never rise
-    if (o->checkCircumpolar(geo->lat()) == true && o->alt().Degrees() <= 0) return false;
+QVector<bool> WUTDialog::checkVisibility( const QList<SkyObject*> &objects ) {
+    double minAlt = 6.0; //An object is considered 'visible' if it is above horizon during civil twilight.
 
     //Initial values for T1, T2 assume all night option of EveningMorningBox
     KStarsDateTime T1 = Evening;
@@ -366,20 +390,23 @@ bool WUTDialog::checkVisibility(SkyObject *o) {
         T1 = T0; //midnight
     }
 
-    for ( KStarsDateTime test = T1; test < T2; test = test.addSecs(3600) ) {
-        //Need LST of the test time, expressed as a dms object.
-        KStarsDateTime ut = geo->LTtoUT( test );
-        dms LST = geo->GSTtoLST( ut.gst() );
-        SkyPoint sp = o->recomputeCoords( ut, geo );
+    QVector<bool> visible( objects.size(), false );
+    if ( T1 >= T2 || objects.isEmpty() )
+        return visible;
 
-        //check altitude of object at this time.
-        sp.EquatorialToHorizontal( &LST, geo->lat() );
+    KStarsDateTime start = geo->LTtoUT( T1 );
+    VisibilityEngine engine;
+    engine.setPeriod( start, start.secsTo( geo->LTtoUT( T2 ) ), geo );
 
-        if ( sp.alt().Degrees() > minAlt ) {
-            visible = true;
-            break;
-        }
-    }
+    QProgressDialog progressDlg( i18n( "Checking visibility..." ), i18n( "Abort" ), 0, 100, this );
+    progressDlg.setWindowModality( Qt::WindowModal );
+    progressDlg.setMinimumDuration( 1000 );
+    connect( &engine, SIGNAL(madeProgress(int)), &progressDlg, SLOT(setValue(int)) );
+    connect( &progressDlg, SIGNAL(canceled()), &engine, SLOT(cancel()) );
+
+    QVector<VisibilityEngine::Result> results = engine.compute( objects );
+    for ( int i = 0; i < objects.size(); ++i )
+        visible[i] = results.at(i).valid && results.at(i).maxAltitude > minAlt;
 
     return visible;
 }
@@ -58,6 +58,12 @@ public:
         */
     bool checkVisibility(SkyObject *o);
 
+    /** @short Check visibility of many objects at once
+        *@p objects the objects to check
+        *@return for each object, true if visible
+        */
+    QVector<bool> checkVisibility( const QList<SkyObject*> &objects );
+
 public slots:
     /** @short Determine which objects are visible, and store them in
         *an array of lists, classified by object type 